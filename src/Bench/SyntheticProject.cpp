@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * SyntheticProject.cpp: Generates a timeline for benchmarking purpose
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "SyntheticProject.h"
+#include "Clip.h"
+#include "Library.h"
+#include "MainWorkflow.h"
+#include "Media.h"
+#include "MetaDataManager.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+#include <QTimer>
+#include <QtDebug>
+
+SyntheticProject::SyntheticProject( const Parameters& params ) :
+        m_params( params ),
+        m_video( NULL )
+{
+    m_directory = QDir::tempPath() + "/vlmc-bench-" +
+                  QString::number( QCoreApplication::applicationPid() );
+}
+
+SyntheticProject::~SyntheticProject()
+{
+    QDir    dir( m_directory );
+
+    for ( int i = 0; i < nbImages; ++i )
+        dir.remove( QString( "image%1.png" ).arg( i ) );
+    QDir::temp().rmdir( m_directory );
+}
+
+QString
+SyntheticProject::createImage( int index )
+{
+    QImage      image( m_params.width, m_params.height, QImage::Format_RGB32 );
+    QPainter    painter( &image );
+    QColor      color = QColor::fromHsv( index * 360 / nbImages, 200, 220 );
+
+    //A gradient, so that the images don't compress to nothing.
+    QLinearGradient gradient( 0, 0, m_params.width, m_params.height );
+    gradient.setColorAt( 0, color );
+    gradient.setColorAt( 1, color.darker( 300 ) );
+    painter.fillRect( image.rect(), gradient );
+    painter.end();
+
+    QString     fileName = m_directory + QString( "/image%1.png" ).arg( index );
+    if ( image.save( fileName ) == false )
+        return QString();
+    return fileName;
+}
+
+void
+SyntheticProject::generate()
+{
+    Library*    library = Library::getInstance();
+
+    qsrand( m_params.seed );
+    QDir::temp().mkpath( m_directory );
+    for ( int i = 0; i < nbImages; ++i )
+    {
+        QString     fileName = createImage( i );
+        if ( fileName.isEmpty() == true )
+        {
+            qCritical() << "Can't write the synthetic images in" << m_directory;
+            emit failed();
+            return ;
+        }
+        Media*      media = new Media( fileName );
+        MetaDataManager::getInstance()->computeMediaMetadata( media );
+        library->addMedia( media );
+        m_images.append( media );
+    }
+    if ( m_params.videoFileName.isEmpty() == false )
+    {
+        m_video = new Media( m_params.videoFileName );
+        MetaDataManager::getInstance()->computeMediaMetadata( m_video );
+        library->addMedia( m_video );
+    }
+    //Clip lengths depend on the medias' length.
+    MetaDataManager*    mdm = MetaDataManager::getInstance();
+    if ( mdm->isComputing() == true )
+        connect( mdm, SIGNAL( allComputed() ), this, SLOT( populate() ), Qt::QueuedConnection );
+    else
+        QTimer::singleShot( 0, this, SLOT( populate() ) );
+}
+
+Media*
+SyntheticProject::pickMedia()
+{
+    if ( m_video == NULL || qrand() < m_params.imageRatio * RAND_MAX )
+        return m_images[qrand() % nbImages];
+    return m_video;
+}
+
+void
+SyntheticProject::populate()
+{
+    MainWorkflow*   mainWorkflow = MainWorkflow::getInstance();
+    //The average clip length, in frames.
+    qint64          clipLength = qMax( (qint64)( m_params.fps / m_params.cutDensity ), (qint64)2 );
+
+    disconnect( MetaDataManager::getInstance(), SIGNAL( allComputed() ), this, SLOT( populate() ) );
+    if ( m_video != NULL && m_video->nbFrames() <= 0 )
+    {
+        qCritical() << "Can't use" << m_params.videoFileName << "as a sample video";
+        emit failed();
+        return ;
+    }
+    for ( int track = 0; track < m_params.nbTracks; ++track )
+    {
+        //Shift each track, so that the cuts don't all happen at the same frame.
+        qint64      position = track * clipLength / m_params.nbTracks;
+
+        for ( int i = 0; i < m_params.nbClips; ++i )
+        {
+            Media*  media = pickMedia();
+            //Between half and one and a half time the average length.
+            qint64  length = clipLength / 2 + qrand() % clipLength;
+            qint64  begin = 0;
+
+            length = qMin( length, media->nbFrames() );
+            if ( media->nbFrames() > length )
+                begin = qrand() % ( media->nbFrames() - length );
+            mainWorkflow->addClip( new Clip( media, begin, begin + length ), track,
+                                   position, MainWorkflow::VideoTrack );
+            if ( media->hasAudioTrack() == true )
+                mainWorkflow->addClip( new Clip( media, begin, begin + length ), track,
+                                       position, MainWorkflow::AudioTrack );
+            m_cuts.insert( position );
+            position += length;
+        }
+        //Whatever lies underneath shows up once the track ends.
+        m_cuts.insert( position );
+    }
+    emit ready();
+}
+
+const QSet<qint64>&
+SyntheticProject::cuts() const
+{
+    return m_cuts;
+}
@@ -0,0 +1,103 @@
+/*****************************************************************************
+ * SyntheticProject.h: Generates a timeline for benchmarking purpose
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SYNTHETICPROJECT_H
+#define SYNTHETICPROJECT_H
+
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class   Media;
+
+/**
+ *  \class  Fills the timeline with a reproducible set of clips.
+ *
+ *  Image clips are generated on the fly. Video clips all come from a single
+ *  sample file given by the user, at random positions.
+ */
+class   SyntheticProject : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( SyntheticProject )
+
+    public:
+        struct  Parameters
+        {
+            int             nbTracks;
+            int             nbClips; ///< Number of clips per track
+            /// Average number of cuts per second, on each track
+            double          cutDensity;
+            /// The part of the clips that are image clips, between 0 and 1
+            double          imageRatio;
+            /**
+             *  The sample video, or an empty string to only use image clips.
+             *  \sa Media::generatorPrefix
+             */
+            QString         videoFileName;
+            quint32         width;
+            quint32         height;
+            double          fps;
+            unsigned int    seed;
+        };
+
+        SyntheticProject( const Parameters& params );
+        ~SyntheticProject();
+
+        /**
+         *  \brief  Create the medias. ready() is emitted once the clips have
+         *          been added to the MainWorkflow.
+         */
+        void                        generate();
+
+        /**
+         *  \brief  The timeline frames where a clip starts, on any track.
+         *
+         *  The frame numbers of the output only need to follow each other
+         *  between two of these.
+         */
+        const QSet<qint64>&         cuts() const;
+
+        /// Number of distinct generated images
+        static const int            nbImages = 8;
+
+    private:
+        Media*                      pickMedia();
+        QString                     createImage( int index );
+
+    private:
+        Parameters                  m_params;
+        QString                     m_directory;
+        QList<Media*>               m_images;
+        Media*                      m_video;
+        QSet<qint64>                m_cuts;
+
+    private slots:
+        void                        populate();
+
+    signals:
+        void                        ready();
+        void                        failed();
+};
+
+#endif // SYNTHETICPROJECT_H
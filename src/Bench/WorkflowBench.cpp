@@ -0,0 +1,387 @@
+/*****************************************************************************
+ * WorkflowBench.cpp: Measures the workflow throughput
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "WorkflowBench.h"
+#include "EffectsEngine.h"
+#include "GeneratorClipWorkflow.h"
+#include "LightVideoFrame.h"
+#include "MainWorkflow.h"
+#include "MediaPlayerPool.h"
+#include "ProjectManager.h"
+#include "SettingsManager.h"
+#include "StillImageCache.h"
+#include "VLCInstance.h"
+#include "mdate.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QTime>
+#include <QtDebug>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+const char* const   WorkflowBench::stageNames[] =
+{
+    "clip_fetch",
+    "effects",
+    "output_copy",
+    "frame",
+};
+
+WorkflowBench::WorkflowBench() :
+        m_effects( false ),
+        m_nbFrames( -1 ),
+        m_project( NULL ),
+        m_worker( NULL ),
+        m_nbRendered( 0 ),
+        m_nbNumbered( 0 ),
+        m_nbMisnumbered( 0 )
+{
+    m_params.nbTracks = 4;
+    m_params.nbClips = 20;
+    m_params.cutDensity = 0.5;
+    m_params.imageRatio = 0.5;
+    m_params.width = 0;
+    m_params.height = 0;
+    m_params.fps = .0;
+    m_params.seed = 42;
+    qRegisterMetaType<MainWorkflow::TrackType>( "MainWorkflow::TrackType" );
+    qRegisterMetaType<MainWorkflow::FrameChangedReason>( "MainWorkflow::FrameChangedReason" );
+    qRegisterMetaType<QVariant>( "QVariant" );
+}
+
+WorkflowBench::~WorkflowBench()
+{
+    delete m_worker;
+    MainWorkflow::destroyInstance();
+    MediaPlayerPool::destroyInstance();
+    StillImageCache::destroyInstance();
+    delete m_project;
+}
+
+void
+WorkflowBench::printUsage()
+{
+    QTextStream     err( stderr );
+
+    err << "Usage: vlmc-bench [options]" << endl
+        << "Options:" << endl
+        << "  --tracks <n>        Number of video tracks (default 4)" << endl
+        << "  --clips <n>         Number of clips per track (default 20)" << endl
+        << "  --cut-density <d>   Average number of cuts per second, per track (default 0.5)" << endl
+        << "  --image-ratio <r>   Part of the clips that are image clips (default 0.5)" << endl
+        << "  --media <file>      Sample video used for the video clips. Without it," << endl
+        << "                      only image clips are generated. A generator:// mrl," << endl
+        << "                      such as generator://bars?duration=600, needs no decoder" << endl
+        << "  --effects           Render through the effects patch" << endl
+        << "  --frames <n>        Stop after n frames (default: the whole project)" << endl
+        << "  --width <pixels>    Output width (defaults to the project's)" << endl
+        << "  --height <pixels>   Output height (defaults to the project's)" << endl
+        << "  --fps <fps>         Output framerate (defaults to the project's)" << endl
+        << "  --seed <n>          Seed of the project generation (default 42)" << endl
+        << "  --out <file>        Write the JSON report to file instead of stdout" << endl
+        << "  --trace=<file>      Save a Chrome trace of the run to file" << endl;
+}
+
+bool
+WorkflowBench::parseArguments( const QStringList& args )
+{
+    //Skip the program name.
+    for ( int i = 1; i < args.size(); ++i )
+    {
+        const QString&  arg = args[i];
+
+        //Handled by the Tracer.
+        if ( arg.startsWith( "--trace=" ) == true )
+            continue ;
+        if ( arg == "--effects" )
+        {
+            m_effects = true;
+            continue ;
+        }
+        if ( i + 1 >= args.size() )
+        {
+            qCritical() << "Missing value for" << arg;
+            printUsage();
+            return false;
+        }
+        const QString&  value = args[++i];
+        bool            ok = true;
+
+        if ( arg == "--tracks" )
+        {
+            m_params.nbTracks = value.toInt( &ok );
+            ok = ( ok == true && m_params.nbTracks > 0 );
+        }
+        else if ( arg == "--clips" )
+        {
+            m_params.nbClips = value.toInt( &ok );
+            ok = ( ok == true && m_params.nbClips > 0 );
+        }
+        else if ( arg == "--cut-density" )
+        {
+            m_params.cutDensity = value.toDouble( &ok );
+            ok = ( ok == true && m_params.cutDensity > .0 );
+        }
+        else if ( arg == "--image-ratio" )
+        {
+            m_params.imageRatio = value.toDouble( &ok );
+            ok = ( ok == true && m_params.imageRatio >= .0 && m_params.imageRatio <= 1.0 );
+        }
+        else if ( arg == "--media" )
+            m_params.videoFileName = value;
+        else if ( arg == "--frames" )
+            m_nbFrames = value.toLongLong( &ok );
+        else if ( arg == "--width" )
+            m_params.width = value.toUInt( &ok );
+        else if ( arg == "--height" )
+            m_params.height = value.toUInt( &ok );
+        else if ( arg == "--fps" )
+            m_params.fps = value.toDouble( &ok );
+        else if ( arg == "--seed" )
+            m_params.seed = value.toUInt( &ok );
+        else if ( arg == "--out" )
+            m_outputFileName = value;
+        else
+        {
+            qCritical() << "Unknown option" << arg;
+            printUsage();
+            return false;
+        }
+        if ( ok == false )
+        {
+            qCritical() << "Invalid value for" << arg << ':' << value;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+WorkflowBench::start()
+{
+    LibVLCpp::Instance::getInstance( this );
+    //Creating the project manager first (so it can create all the project variables)
+    ProjectManager::getInstance();
+
+    if ( m_params.width == 0 )
+        m_params.width = VLMC_PROJECT_GET_UINT( "video/VideoProjectWidth" );
+    if ( m_params.height == 0 )
+        m_params.height = VLMC_PROJECT_GET_UINT( "video/VideoProjectHeight" );
+    if ( m_params.fps <= .0 )
+        m_params.fps = VLMC_PROJECT_GET_DOUBLE( "video/VLMCOutputFPS" );
+
+    m_project = new SyntheticProject( m_params );
+    connect( m_project, SIGNAL( ready() ), this, SLOT( projectReady() ) );
+    connect( m_project, SIGNAL( failed() ), this, SLOT( projectFailed() ) );
+    m_project->generate();
+}
+
+void
+WorkflowBench::projectFailed()
+{
+    QCoreApplication::exit( 1 );
+}
+
+void
+WorkflowBench::projectReady()
+{
+    MainWorkflow*   mainWorkflow = MainWorkflow::getInstance();
+
+    if ( m_nbFrames < 0 || m_nbFrames > mainWorkflow->getLengthFrame() )
+        m_nbFrames = mainWorkflow->getLengthFrame();
+    for ( unsigned int i = 0; i < NbStages; ++i )
+        m_samples[i].reserve( m_nbFrames );
+    if ( m_effects == true )
+        mainWorkflow->getEffectsEngine()->enable();
+    mainWorkflow->setFullSpeedRender( true );
+    mainWorkflow->startRender( m_params.width, m_params.height );
+
+    m_worker = new Worker( this );
+    connect( m_worker, SIGNAL( finished() ), this, SLOT( renderFinished() ),
+             Qt::QueuedConnection );
+    m_worker->start();
+}
+
+WorkflowBench::Worker::Worker( WorkflowBench* bench ) :
+        m_bench( bench )
+{
+}
+
+void
+WorkflowBench::Worker::run()
+{
+    QTime   time;
+
+    time.start();
+    m_bench->renderFrames();
+    m_bench->writeReport( time.elapsed() );
+}
+
+void
+WorkflowBench::renderFrames()
+{
+    MainWorkflow*   mainWorkflow = MainWorkflow::getInstance();
+    quint32         size = m_params.width * m_params.height * Pixel::NbComposantes;
+    quint8*         buffer = new quint8[size];
+    qint64          previousNumber = -1;
+
+    for ( m_nbRendered = 0; m_nbRendered < m_nbFrames; ++m_nbRendered )
+    {
+        qint64      videoFetch;
+        qint64      audioFetch;
+        qint64      effects;
+        qint64      unused;
+        mtime_t     begin = mdate();
+
+        const LightVideoFrame&  frame =
+                *( mainWorkflow->getOutput( MainWorkflow::VideoTrack, false )->video );
+        mainWorkflow->getOutputTimings( MainWorkflow::VideoTrack, videoFetch, effects );
+        mtime_t     copyBegin = mdate();
+        memcpy( buffer, frame->frame.octets, qMin( frame->nboctets, size ) );
+        mtime_t     copyEnd = mdate();
+        checkFrameNumber( frame, previousNumber );
+        mainWorkflow->nextFrame( MainWorkflow::VideoTrack );
+
+        mainWorkflow->getOutput( MainWorkflow::AudioTrack, false );
+        mainWorkflow->getOutputTimings( MainWorkflow::AudioTrack, audioFetch, unused );
+        mainWorkflow->nextFrame( MainWorkflow::AudioTrack );
+
+        m_samples[ClipFetch].append( videoFetch + audioFetch );
+        m_samples[Effects].append( effects );
+        m_samples[OutputCopy].append( copyEnd - copyBegin );
+        m_samples[Frame].append( mdate() - begin );
+    }
+    delete[] buffer;
+}
+
+void
+WorkflowBench::checkFrameNumber( const LightVideoFrame& frame, qint64& previousNumber )
+{
+    qint64      number = decodeGeneratedFrameNumber( frame );
+
+    if ( number < 0 )
+    {
+        previousNumber = -1;
+        return ;
+    }
+    ++m_nbNumbered;
+    //A new clip may show up at a cut, and start anywhere in its media.
+    if ( previousNumber >= 0 && number != previousNumber + 1 &&
+         m_project->cuts().contains( m_nbRendered ) == false )
+    {
+        qWarning() << "Frame" << m_nbRendered << "shows the generated frame" << number
+                << "after" << previousNumber;
+        ++m_nbMisnumbered;
+    }
+    previousNumber = number;
+}
+
+qint64
+WorkflowBench::percentile( const QVector<qint64>& sorted, int percent )
+{
+    if ( sorted.isEmpty() == true )
+        return 0;
+    return sorted[( sorted.size() - 1 ) * percent / 100];
+}
+
+qint64
+WorkflowBench::peakMemory()
+{
+#ifdef Q_OS_UNIX
+    struct rusage   usage;
+
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return -1;
+# ifdef Q_OS_MAC
+    //Reported in bytes on Mac OS X, and in kilobytes elsewhere.
+    return usage.ru_maxrss / 1024;
+# else
+    return usage.ru_maxrss;
+# endif
+#else
+    return -1;
+#endif
+}
+
+void
+WorkflowBench::writeReport( qint64 elapsed )
+{
+    QFile           file( m_outputFileName );
+    bool            opened;
+
+    if ( m_outputFileName.isEmpty() == true )
+        opened = file.open( stdout, QIODevice::WriteOnly );
+    else
+        opened = file.open( QIODevice::WriteOnly );
+    if ( opened == false )
+    {
+        qCritical() << "Can't write the report to" << m_outputFileName;
+        return ;
+    }
+    QTextStream     out( &file );
+
+    out << "{" << endl
+        << "  \"project\": {" << endl
+        << "    \"tracks\": " << m_params.nbTracks << ',' << endl
+        << "    \"clips_per_track\": " << m_params.nbClips << ',' << endl
+        << "    \"cut_density\": " << m_params.cutDensity << ',' << endl
+        << "    \"image_ratio\": " << ( m_params.videoFileName.isEmpty() ? 1.0 : m_params.imageRatio ) << ',' << endl
+        << "    \"effects\": " << ( m_effects ? "true" : "false" ) << ',' << endl
+        << "    \"width\": " << m_params.width << ',' << endl
+        << "    \"height\": " << m_params.height << ',' << endl
+        << "    \"fps\": " << m_params.fps << ',' << endl
+        << "    \"seed\": " << m_params.seed << endl
+        << "  }," << endl
+        << "  \"frames\": " << m_nbRendered << ',' << endl
+        << "  \"seconds\": " << elapsed / 1000.0 << ',' << endl
+        << "  \"fps\": " << ( elapsed > 0 ? m_nbRendered * 1000.0 / elapsed : 0.0 ) << ',' << endl
+        << "  \"stages_us\": {" << endl;
+    for ( unsigned int i = 0; i < NbStages; ++i )
+    {
+        QVector<qint64>     sorted = m_samples[i];
+
+        qSort( sorted );
+        out << "    \"" << stageNames[i] << "\": { "
+            << "\"p50\": " << percentile( sorted, 50 ) << ", "
+            << "\"p90\": " << percentile( sorted, 90 ) << ", "
+            << "\"p99\": " << percentile( sorted, 99 ) << ", "
+            << "\"max\": " << ( sorted.isEmpty() ? 0 : sorted.last() ) << " }"
+            << ( i + 1 < NbStages ? "," : "" ) << endl;
+    }
+    out << "  }," << endl
+        << "  \"numbered_frames\": " << m_nbNumbered << ',' << endl
+        << "  \"misnumbered_frames\": " << m_nbMisnumbered << ',' << endl
+        << "  \"peak_rss_kb\": " << peakMemory() << endl
+        << "}" << endl;
+}
+
+void
+WorkflowBench::renderFinished()
+{
+    MainWorkflow::getInstance()->stop();
+    QCoreApplication::exit( m_nbMisnumbered > 0 ? 1 : 0 );
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * WorkflowBench.h: Measures the workflow throughput
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef WORKFLOWBENCH_H
+#define WORKFLOWBENCH_H
+
+#include "SyntheticProject.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+class   LightVideoFrame;
+
+/**
+ *  \class  Renders a synthetic project as fast as possible, without any output.
+ *
+ *  The frames are fetched from MainWorkflow::getOutput() and copied out, as the
+ *  export does, and the time spent in each stage is reported as JSON.
+ *
+ *  When the output shows a generated clip (see Media::generatorPrefix), the
+ *  frame number drawn in it is checked against the previous frame's, to catch
+ *  dropped or reordered frames.
+ */
+class   WorkflowBench : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( WorkflowBench )
+
+    public:
+        enum    Stage
+        {
+            ClipFetch, ///< Fetching the video and audio clips output
+            Effects, ///< Compositing in the effects engine
+            OutputCopy, ///< Copying the output frame
+            Frame, ///< The whole frame
+            NbStages
+        };
+
+        WorkflowBench();
+        ~WorkflowBench();
+
+        /**
+         *  \return false if the arguments are invalid. The usage has then been
+         *          printed, and the application should exit.
+         */
+        bool                        parseArguments( const QStringList& args );
+        void                        start();
+        static void                 printUsage();
+
+    private:
+        class   Worker : public QThread
+        {
+            public:
+                Worker( WorkflowBench* bench );
+            protected:
+                virtual void        run();
+            private:
+                WorkflowBench*      m_bench;
+        };
+
+        void                        renderFrames();
+        void                        checkFrameNumber( const LightVideoFrame& frame,
+                                                      qint64& previousNumber );
+        void                        writeReport( qint64 elapsed );
+        static qint64               percentile( const QVector<qint64>& sorted, int percent );
+        static qint64               peakMemory();
+
+    private:
+        SyntheticProject::Parameters    m_params;
+        bool                        m_effects;
+        qint64                      m_nbFrames;
+        QString                     m_outputFileName;
+        SyntheticProject*           m_project;
+        Worker*                     m_worker;
+        qint64                      m_nbRendered;
+        /// Number of output frames carrying a generated frame number
+        qint64                      m_nbNumbered;
+        /// Number of frames whose number doesn't follow the previous one's
+        qint64                      m_nbMisnumbered;
+        /// The duration of each frame's stages in microseconds, indexed by Stage
+        QVector<qint64>             m_samples[NbStages];
+        static const char* const    stageNames[NbStages];
+
+    private slots:
+        void                        projectReady();
+        void                        projectFailed();
+        void                        renderFinished();
+};
+
+#endif // WORKFLOWBENCH_H
@@ -0,0 +1,48 @@
+/*****************************************************************************
+ * main.cpp: vlmc-bench entry point
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/** \file
+ *  This file contains the vlmc-bench main function.
+ *  It generates a synthetic project, and renders it without any display.
+ */
+
+#include "Tracer.h"
+#include "WorkflowBench.h"
+
+#include <QApplication>
+
+int
+main( int argc, char **argv )
+{
+    //No GUI, so that no display is required.
+    QApplication    app( argc, argv, false );
+    app.setApplicationName( "vlmc" );
+    app.setOrganizationName( "vlmc" );
+    app.setOrganizationDomain( "vlmc.org" );
+    Tracer::getInstance()->setup( app.arguments() );
+
+    WorkflowBench   bench;
+    if ( bench.parseArguments( app.arguments() ) == false )
+        return 1;
+    bench.start();
+    return app.exec();
+}
@@ -26,12 +26,24 @@
 #include "UndoStack.h"
 #include "MainWorkflow.h"
 #include "Clip.h"
+#include "ProjectJournal.h"
+#include "ProjectManager.h"
 
 void Commands::trigger( QUndoCommand* command )
 {
     UndoStack::getInstance()->push( command );
 }
 
+/**
+ *  Every command records the changes it did into the project journal, both
+ *  when it's done and undone, so that the journal always describes the
+ *  current timeline.
+ */
+static ProjectJournal*  journal()
+{
+    return ProjectManager::getInstance()->journal();
+}
+
 Commands::MainWorkflow::AddClip::AddClip( Clip* clip,
                                           unsigned int trackNumber, qint64 pos,
                                           ::MainWorkflow::TrackType trackType ) :
@@ -51,11 +63,13 @@ Commands::MainWorkflow::AddClip::~AddClip()
 void Commands::MainWorkflow::AddClip::redo()
 {
     ::MainWorkflow::getInstance()->addClip( m_clip, m_trackNumber, m_pos, m_trackType );
+    journal()->clipAdded( m_clip, m_trackNumber, m_pos, m_trackType );
 }
 
 void Commands::MainWorkflow::AddClip::undo()
 {
     ::MainWorkflow::getInstance()->removeClip( m_clip->uuid(), m_trackNumber, m_trackType );
+    journal()->clipRemoved( m_trackNumber, m_pos, m_trackType );
 }
 
 Commands::MainWorkflow::MoveClip::MoveClip( ::MainWorkflow* workflow, const QUuid& uuid,
@@ -77,6 +91,7 @@ void Commands::MainWorkflow::MoveClip::redo()
 {
 //    qDebug() << "Moving clip from track" << m_oldTrack << "to" << m_newTrack << "at position:" << m_pos;
     m_workflow->moveClip( m_uuid, m_oldTrack, m_newTrack, m_pos, m_trackType, m_undoRedoAction );
+    journal()->clipMoved( m_oldTrack, m_oldPos, m_newTrack, m_pos, m_trackType );
     m_undoRedoAction = true;
 }
 
@@ -84,6 +99,7 @@ void Commands::MainWorkflow::MoveClip::undo()
 {
 //    qDebug() << "Undo moving clip from track" << m_newTrack << "to" << m_oldTrack << "at position:" << m_oldPos;
     m_workflow->moveClip( m_uuid, m_newTrack, m_oldTrack, m_oldPos, m_trackType, m_undoRedoAction );
+    journal()->clipMoved( m_newTrack, m_pos, m_oldTrack, m_oldPos, m_trackType );
     m_undoRedoAction = true;
 }
 
@@ -98,10 +114,12 @@ Commands::MainWorkflow::RemoveClip::RemoveClip( Clip* clip, quint32 trackNumber,
 void Commands::MainWorkflow::RemoveClip::redo()
 {
     ::MainWorkflow::getInstance()->removeClip( m_clip->uuid(), m_trackNumber, m_trackType );
+    journal()->clipRemoved( m_trackNumber, m_pos, m_trackType );
 }
 void Commands::MainWorkflow::RemoveClip::undo()
 {
     ::MainWorkflow::getInstance()->addClip( m_clip, m_trackNumber, m_pos, m_trackType );
+    journal()->clipAdded( m_clip, m_trackNumber, m_pos, m_trackType );
 }
 
 Commands::MainWorkflow::ResizeClip::ResizeClip( const QUuid& uuid,
@@ -127,8 +145,13 @@ Commands::MainWorkflow::ResizeClip::ResizeClip( const QUuid& uuid,
 
 void Commands::MainWorkflow::ResizeClip::redo()
 {
-    ::MainWorkflow::getInstance()->resizeClip( m_clip, m_newBegin, m_newEnd, m_newPos, m_trackId, m_trackType, m_undoRedoAction );
+    ::MainWorkflow*     workflow = ::MainWorkflow::getInstance();
+    qint64              pos = workflow->getClipPosition( m_uuid, m_trackId, m_trackType );
+
+    workflow->resizeClip( m_clip, m_newBegin, m_newEnd, m_newPos, m_trackId, m_trackType, m_undoRedoAction );
     m_undoRedoAction = true;
+    journal()->clipResized( m_trackId, pos, workflow->getClipPosition( m_uuid, m_trackId, m_trackType ),
+                            m_clip->begin(), m_clip->end(), m_trackType );
 }
 
 void Commands::MainWorkflow::ResizeClip::undo()
@@ -136,15 +159,20 @@ void Commands::MainWorkflow::ResizeClip::undo()
     //This code is complete crap.
     // We need to case, because when we redo a "begin-resize", we need to first resize, then move.
     //In the other cases, we need to move, then resize.
+    ::MainWorkflow*     workflow = ::MainWorkflow::getInstance();
+    qint64              pos = workflow->getClipPosition( m_uuid, m_trackId, m_trackType );
+
     if ( m_oldBegin == m_newBegin )
     {
-        ::MainWorkflow::getInstance()->resizeClip( m_clip, m_oldBegin, m_oldEnd, m_oldPos, m_trackId, m_trackType, m_undoRedoAction );
+        workflow->resizeClip( m_clip, m_oldBegin, m_oldEnd, m_oldPos, m_trackId, m_trackType, m_undoRedoAction );
     }
     else
     {
         m_clip->setBoundaries( m_oldBegin, m_oldEnd );
-        ::MainWorkflow::getInstance()->moveClip( m_clip->uuid(), m_trackId, m_trackId, m_oldPos, m_trackType, m_undoRedoAction );
+        workflow->moveClip( m_clip->uuid(), m_trackId, m_trackId, m_oldPos, m_trackType, m_undoRedoAction );
     }
+    journal()->clipResized( m_trackId, pos, workflow->getClipPosition( m_uuid, m_trackId, m_trackType ),
+                            m_clip->begin(), m_clip->end(), m_trackType );
 }
 
 Commands::MainWorkflow::SplitClip::SplitClip( Clip* toSplit, quint32 trackId,
@@ -167,10 +195,20 @@ Commands::MainWorkflow::SplitClip::~SplitClip()
 
 void    Commands::MainWorkflow::SplitClip::redo()
 {
-    m_newClip = ::MainWorkflow::getInstance()->split( m_toSplit, m_newClip, m_trackId, m_newClipPos, m_newClipBegin, m_trackType );
+    ::MainWorkflow*     workflow = ::MainWorkflow::getInstance();
+    qint64              pos = workflow->getClipPosition( m_toSplit->uuid(), m_trackId, m_trackType );
+
+    m_newClip = workflow->split( m_toSplit, m_newClip, m_trackId, m_newClipPos, m_newClipBegin, m_trackType );
+    journal()->clipResized( m_trackId, pos, pos, m_toSplit->begin(), m_toSplit->end(), m_trackType );
+    journal()->clipAdded( m_newClip, m_trackId, m_newClipPos, m_trackType );
 }
 
 void    Commands::MainWorkflow::SplitClip::undo()
 {
-    ::MainWorkflow::getInstance()->unsplit( m_toSplit, m_newClip, m_trackId, m_trackType );
+    ::MainWorkflow*     workflow = ::MainWorkflow::getInstance();
+    qint64              pos = workflow->getClipPosition( m_toSplit->uuid(), m_trackId, m_trackType );
+
+    workflow->unsplit( m_toSplit, m_newClip, m_trackId, m_trackType );
+    journal()->clipRemoved( m_trackId, m_newClipPos, m_trackType );
+    journal()->clipResized( m_trackId, pos, pos, m_toSplit->begin(), m_toSplit->end(), m_trackType );
 }
@@ -23,9 +23,9 @@
 #include "SettingsManager.h"
 
 #include "SettingValue.h"
+#include "ProjectCache.h"
 
 #include <QSettings>
-#include <QDomDocument>
 #include <QWriteLocker>
 #include <QReadLocker>
 #include <QXmlStreamWriter>
@@ -175,7 +175,7 @@ SettingsManager::save() const
 }
 
 void
-SettingsManager::save( QDomDocument &xmlfile, QDomElement &root ) const
+SettingsManager::save( QXmlStreamWriter& writer ) const
 {
     typedef QPair<QString, SettingValue*> settingPair;
     QMultiHash<QString, settingPair>  parts;
@@ -199,44 +199,51 @@ SettingsManager::save( QDomDocument &xmlfile, QDomElement &root ) const
     QList<QString>  keys = parts.uniqueKeys();
     foreach( QString xmlKey, keys )
     {
-        QDomElement node = xmlfile.createElement( xmlKey );
+        writer.writeStartElement( xmlKey );
         QList<settingPair>  pairs = parts.values( xmlKey );
         foreach( settingPair pair, pairs )
         {
-            QDomElement item = xmlfile.createElement( pair.first );
-            item.setAttribute( "value", pair.second->get().toString() );
-            node.appendChild( item );
+            writer.writeEmptyElement( pair.first );
+            writer.writeAttribute( "value", pair.second->get().toString() );
         }
-        root.appendChild( node );
+        writer.writeEndElement();
+    }
+}
+
+void
+SettingsManager::save( ProjectCacheWriter& writer ) const
+{
+    QReadLocker rl( &m_rwLock );
+    SettingHash::const_iterator it;
+    SettingHash::const_iterator ed = m_xmlSettings.end();
+
+    for ( it = m_xmlSettings.begin(); it != ed; ++it )
+    {
+        if ( it.key().count( "/" ) == 1 )
+            writer.addSetting( it.key(), it.value()->get().toString() );
     }
 }
 
 bool
-SettingsManager::load( const QDomElement &element )
+SettingsManager::load( const QString& part, const QHash<QString, QString>& values )
 {
     //For now it only handle a project node.
-    if ( element.isNull() == true || element.tagName() != "project" )
+    if ( part != "project" )
     {
         qWarning() << "Invalid settings node";
         return false ;
     }
     QWriteLocker    wLock( &m_rwLock );
-    QDomNodeList list = element.childNodes();
-    int nbChild = list.size();
+    QHash<QString, QString>::const_iterator     it = values.begin();
+    QHash<QString, QString>::const_iterator     end = values.end();
 
-     for ( int idx = 0; idx < nbChild; ++idx )
+    for ( ; it != end; ++it )
     {
-        QDomNamedNodeMap attrMap = list.at( idx ).attributes();
-        if ( attrMap.count() > 1 )
-        {
-            qWarning() << "Invalid number of attributes for" << list.at( idx ).nodeName();
-            continue ;
-        }
-        QString key = "project/" + list.at( idx ).toElement().tagName();
+        QString key = part + '/' + it.key();
         if ( m_xmlSettings.contains( key ) )
-            m_xmlSettings[key]->set( QVariant( attrMap.item( 0 ).nodeValue() ) );
+            m_xmlSettings[key]->set( QVariant( it.value() ) );
     }
-     return true;
+    return true;
 }
 
 bool
@@ -34,8 +34,7 @@
 
 class SettingValue;
 class QXmlStreamWriter;
-class QDomElement;
-class QDomDocument;
+class ProjectCacheWriter;
 
 
 //Var helpers :
@@ -115,8 +114,21 @@ class   SettingsManager : public QObject, public Singleton<SettingsManager>
                                                 SettingsManager::Type type,
                                                 Qt::ConnectionType cType = Qt::AutoConnection );
         void                        save() const;
-        void                        save( QDomDocument &xmlfile, QDomElement& root ) const;
-        bool                        load( const QDomElement &element );
+        /**
+         *  \brief  Write the project settings, one element per settings group.
+         */
+        void                        save( QXmlStreamWriter& writer ) const;
+        /**
+         *  \brief  Add the project settings to a binary project cache.
+         */
+        void                        save( ProjectCacheWriter& writer ) const;
+        /**
+         *  \brief  Load project settings.
+         *  \param  part    The settings group. Only "project" is handled for now.
+         *  \param  values  The values, indexed by setting name.
+         */
+        bool                        load( const QString& part,
+                                          const QHash<QString, QString>& values );
 
         bool                        commit( SettingsManager::Type type );
         void                        flush();
@@ -24,6 +24,7 @@
 
 #include "IEffectNode.h"
 #include "IEffectPlugin.h"
+#include "Tracer.h"
 
 #include <QObject>
 #include <QReadLocker>
@@ -83,6 +84,7 @@ EffectNode::~EffectNode()
 void
 EffectNode::render( void )
 {
+    VLMC_TRACE_SCOPE( "EffectNode::render" );
     if ( m_plugin != NULL )
         m_plugin->render();
     else
@@ -8,6 +8,7 @@ FORMS += ui/About.ui \
     ui/WorkflowFileRendererDialog.ui
 HEADERS += About.h \
     timeline/AbstractGraphicsMediaItem.h \
+    timeline/FilmstripCache.h \
     ClickableLabel.h \
     ClipProperty.h \
     DockWidgetManager.h \
@@ -23,6 +24,7 @@ HEADERS += About.h \
     MainWindow.h \
     PreviewRuler.h \
     PreviewWidget.h \
+    RenderQueueWidget.h \
     TagWidget.h \
     timeline/Timeline.h \
     timeline/TracksControls.h \
@@ -30,10 +32,10 @@ HEADERS += About.h \
     timeline/TracksScene.h \
     timeline/TracksView.h \
     UndoStack.h \
-    WorkflowFileRendererDialog.h \
-    AudioSpectrumDrawer.h
+    WorkflowFileRendererDialog.h
 SOURCES += About.cpp \
     timeline/AbstractGraphicsMediaItem.cpp \
+    timeline/FilmstripCache.cpp \
     ClickableLabel.cpp \
     ClipProperty.cpp \
     DockWidgetManager.cpp \
@@ -48,6 +50,7 @@ SOURCES += About.cpp \
     MainWindow.cpp \
     PreviewRuler.cpp \
     PreviewWidget.cpp \
+    RenderQueueWidget.cpp \
     TagWidget.cpp \
     timeline/Timeline.cpp \
     timeline/TracksControls.cpp \
@@ -55,5 +58,4 @@ SOURCES += About.cpp \
     timeline/TracksScene.cpp \
     timeline/TracksView.cpp \
     UndoStack.cpp \
-    WorkflowFileRendererDialog.cpp \
-    AudioSpectrumDrawer.cpp
+    WorkflowFileRendererDialog.cpp
@@ -23,6 +23,7 @@
 
 #include <QSizePolicy>
 #include <QDockWidget>
+#include <QDir>
 #include <QFileDialog>
 #include <QSlider>
 #include <QMessageBox>
@@ -36,9 +37,11 @@
 #include "About.h"
 #include "ProjectManager.h"
 #include "VlmcDebug.h"
+#include "Tracer.h"
 
 #include "MainWorkflow.h"
-#include "WorkflowFileRenderer.h"
+#include "ExportJob.h"
+#include "RenderQueue.h"
 #include "WorkflowRenderer.h"
 #include "ClipRenderer.h"
 #include "EffectsEngine.h"
@@ -48,9 +51,11 @@
 #include "UndoStack.h"
 #include "PreviewWidget.h"
 #include "MediaLibraryWidget.h"
+#include "RenderQueueWidget.h"
 #include "timeline/Timeline.h"
 #include "timeline/TracksView.h"
 #include "ImportController.h"
+#include "export/RendererSettings.h"
 
 /* Settings / Preferences */
 #include "ProjectManager.h"
@@ -63,7 +68,7 @@
 #include "VLCInstance.h"
 
 MainWindow::MainWindow( QWidget *parent ) :
-    QMainWindow( parent ), m_fileRenderer( NULL )
+    QMainWindow( parent )
 {
     m_ui.setupUi( this );
 
@@ -92,6 +97,8 @@ MainWindow::MainWindow( QWidget *parent ) :
 #ifdef WITH_CRASHBUTTON
     setupCrashTester();
 #endif
+    //Tracing may have been started from the command line.
+    m_ui.actionRecord_trace->setChecked( Tracer::isEnabled() );
 
     // Translations
     connect( this, SIGNAL( translateDockWidgetTitle() ),
@@ -145,9 +152,8 @@ MainWindow::~MainWindow()
     s.setValue( "CleanQuit", true );
     s.sync();
 
-    if ( m_fileRenderer )
-        delete m_fileRenderer;
     delete m_importController;
+    RenderQueue::destroyInstance();
 }
 
 void MainWindow::changeEvent( QEvent *e )
@@ -191,6 +197,8 @@ MainWindow::initVlmcPreferences()
     CREATE_MENU_SHORTCUT( "keyboard/importmedia", "Ctrl+I", "Import media", "Open the import window", actionImport );
     CREATE_MENU_SHORTCUT( "keyboard/renderproject", "Ctrl+R", "Render the project", "Render the project to a file", actionRender );
 
+    VLMC_CREATE_PREFERENCE_INT( "general/RenderQueueConcurrency", 2, "Simultaneous renders",
+                                "The number of renders and transcodes that can run at the same time" );
     VLMC_CREATE_PREFERENCE_LANGUAGE( "general/VLMCLang", "en_US", "Langage", "The VLMC's UI language" );
     SettingsManager::getInstance()->watchValue( "general/VLMCLang",
                                                 LanguageHelper::getInstance(),
@@ -366,6 +374,13 @@ void MainWindow::initializeDockWidgets( void )
                                   Qt::LeftDockWidgetArea );
     if ( dock != 0 )
         dock->hide();
+    dock = dockManager->addDockedWidget( new RenderQueueWidget( this ),
+                                  tr( "Render Queue" ),
+                                  Qt::AllDockWidgetAreas,
+                                  QDockWidget::AllDockWidgetFeatures,
+                                  Qt::BottomDockWidgetArea );
+    if ( dock != 0 )
+        dock->hide();
     setupLibrary();
 }
 
@@ -419,6 +434,26 @@ void MainWindow::on_actionTranscode_triggered()
     //Transcode::instance( this )->exec();
 }
 
+void    MainWindow::on_actionRecord_trace_toggled( bool checked )
+{
+    if ( checked == true )
+        Tracer::getInstance()->start();
+    else
+        Tracer::getInstance()->stop();
+}
+
+void    MainWindow::on_actionSave_trace_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName( this, tr( "Save Trace" ),
+                                                     QDir::homePath() + "/vlmc-trace.json",
+                                                     tr( "Chrome trace (*.json)" ) );
+    if ( fileName.isEmpty() == true )
+        return ;
+    if ( Tracer::getInstance()->save( fileName ) == false )
+        QMessageBox::warning( this, tr( "Save Trace" ),
+                              tr( "Can't write the trace to %1." ).arg( fileName ) );
+}
+
 void    MainWindow::on_actionRender_triggered()
 {
     if ( MainWorkflow::getInstance()->getLengthFrame() <= 0 )
@@ -426,15 +461,15 @@ void    MainWindow::on_actionRender_triggered()
         QMessageBox::warning( NULL, tr ( "VLMC Renderer" ), tr( "There is nothing to render." ) );
         return ;
     }
-    else
-    {
-        m_renderer->killRenderer();
-        if ( m_fileRenderer )
-            delete m_fileRenderer;
-        m_fileRenderer = new WorkflowFileRenderer();
-        m_fileRenderer->initializeRenderer();
-        m_fileRenderer->run();
-    }
+    RendererSettings    settings;
+    if ( settings.exec() == QDialog::Rejected )
+        return ;
+    //The job renders a snapshot of the project, so that editing can go on.
+    RenderQueue::getInstance()->enqueue( new ExportJob( settings.outputFileName(),
+                                                        settings.width(), settings.height(),
+                                                        settings.fps(),
+                                                        settings.videoBitrate(),
+                                                        settings.audioBitrate() ) );
 }
 
 void MainWindow::on_actionNew_Project_triggered()
@@ -37,7 +37,6 @@ class PreviewWidget;
 class Settings;
 class ProjectWizard;
 class ImportController;
-class WorkflowFileRenderer;
 class WorkflowRenderer;
 
 class MainWindow : public QMainWindow
@@ -83,7 +82,6 @@ private:
     Timeline*               m_timeline;
     PreviewWidget*          m_clipPreview;
     PreviewWidget*          m_projectPreview;
-    WorkflowFileRenderer*   m_fileRenderer;
     WorkflowRenderer        *m_renderer;
     Settings*               m_globalPreferences;
     Settings*               m_DefaultProjectPreferences;
@@ -98,6 +96,8 @@ private slots:
     void                    on_actionAbout_triggered();
     void                    on_actionPreferences_triggered();
     void                    on_actionTranscode_triggered();
+    void                    on_actionRecord_trace_toggled( bool checked );
+    void                    on_actionSave_trace_triggered();
     void                    on_actionRender_triggered();
     void                    on_actionNew_Project_triggered();
     void                    on_actionLoad_Project_triggered();
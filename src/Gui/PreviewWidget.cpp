@@ -26,12 +26,22 @@
 #include "ui_PreviewWidget.h"
 #include "ClipRenderer.h"
 #include "Clip.h"
+#include "MediaPlayerPool.h"
+#include "PlaybackStats.h"
+#include "WorkflowRenderer.h"
+
+#include <QAction>
+#include <QLabel>
+#include <QTimer>
 
 PreviewWidget::PreviewWidget( GenericRenderer* genericRenderer, QWidget *parent ) :
     QWidget( parent ),
     m_ui( new Ui::PreviewWidget ),
     m_renderer( genericRenderer ),
-    m_previewStopped( true )
+    m_previewStopped( true ),
+    m_statsAction( NULL ),
+    m_statsLabel( NULL ),
+    m_statsTimer( NULL )
 {
     m_ui->setupUi( this );
 
@@ -73,6 +83,22 @@ PreviewWidget::PreviewWidget( GenericRenderer* genericRenderer, QWidget *parent
     connect( m_ui->pushButtonMarkerStart, SIGNAL( clicked() ), this, SLOT( markerStartClicked() ) );
     connect( m_ui->pushButtonMarkerStop, SIGNAL( clicked() ), this, SLOT( markerStopClicked() ) );
     connect( m_ui->pushButtonCreateClip, SIGNAL( clicked() ), this, SLOT( createNewClipFromMarkers() ) );
+
+    //Playback statistics only make sense for the workflow.
+    if ( qobject_cast<WorkflowRenderer*>( genericRenderer ) != NULL )
+    {
+        m_statsAction = new QAction( tr( "Show Playback Statistics" ), this );
+        m_statsAction->setCheckable( true );
+        addAction( m_statsAction );
+        setContextMenuPolicy( Qt::ActionsContextMenu );
+        m_statsLabel = new QLabel( this );
+        m_statsLabel->hide();
+        m_ui->gridLayout->addWidget( m_statsLabel, 3, 0 );
+        m_statsTimer = new QTimer( this );
+        m_statsTimer->setInterval( 500 );
+        connect( m_statsAction, SIGNAL( toggled( bool ) ), this, SLOT( showPlaybackStats( bool ) ) );
+        connect( m_statsTimer, SIGNAL( timeout() ), this, SLOT( updatePlaybackStats() ) );
+    }
 }
 
 PreviewWidget::~PreviewWidget()
@@ -87,6 +113,8 @@ void    PreviewWidget::changeEvent( QEvent *e )
     {
     case QEvent::LanguageChange:
         m_ui->retranslateUi( this );
+        if ( m_statsAction != NULL )
+            m_statsAction->setText( tr( "Show Playback Statistics" ) );
         break;
     default:
         break;
@@ -210,3 +238,41 @@ void        PreviewWidget::createNewClipFromMarkers()
     emit addClip( part );
     return ;
 }
+
+void        PreviewWidget::showPlaybackStats( bool show )
+{
+    m_statsLabel->setVisible( show );
+    if ( show == true )
+    {
+        updatePlaybackStats();
+        m_statsTimer->start();
+    }
+    else
+        m_statsTimer->stop();
+}
+
+void        PreviewWidget::updatePlaybackStats()
+{
+    PlaybackStats::Snapshot stats = PlaybackStats::getInstance()->snapshot();
+    MediaPlayerPool::Stats  players = MediaPlayerPool::getInstance()->stats();
+    QString                 fill[MainWorkflow::NbTrackType];
+
+    for ( int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
+        if ( stats.bufferFill[i] < 0 )
+            fill[i] = "-";
+        else
+            fill[i] = QString::number( stats.bufferFill[i] ) + '%';
+    }
+    m_statsLabel->setText( tr( "Frames: %1/%2, %3 late | Buffers: video %4, audio %5 | "
+                               "Decoder pauses: %6, resumes: %7 | Audio underruns: %8 | "
+                               "Players: %9 in use, %10 idle, %11 reused, %12 created" )
+                           .arg( stats.deliveredFrames ).arg( stats.expectedFrames )
+                           .arg( stats.lateFrames )
+                           .arg( fill[MainWorkflow::VideoTrack] )
+                           .arg( fill[MainWorkflow::AudioTrack] )
+                           .arg( stats.pauses ).arg( stats.unpauses )
+                           .arg( stats.audioUnderruns )
+                           .arg( players.inUse ).arg( players.idle )
+                           .arg( players.hits ).arg( players.misses ) );
+}
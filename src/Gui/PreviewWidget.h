@@ -30,6 +30,10 @@
 
 class GenericRenderer;
 
+class QAction;
+class QLabel;
+class QTimer;
+
 namespace Ui {
     class PreviewWidget;
 }
@@ -50,6 +54,10 @@ private:
     bool                    m_endReached;
     bool                    m_previewStopped;
     QPalette                m_videoPalette;
+    /// \brief  Only created when previewing the workflow
+    QAction*                m_statsAction;
+    QLabel*                 m_statsLabel;
+    QTimer*                 m_statsTimer;
 
 protected:
     virtual void    changeEvent( QEvent *e );
@@ -70,6 +78,8 @@ private slots:
     void            markerStartClicked();
     void            markerStopClicked();
     void            createNewClipFromMarkers();
+    void            showPlaybackStats( bool show );
+    void            updatePlaybackStats();
 
 signals:
     void            addClip( Clip* clip );
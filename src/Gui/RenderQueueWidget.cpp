@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * RenderQueueWidget.cpp: Displays the render queue's jobs
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "RenderQueueWidget.h"
+#include "RenderJob.h"
+#include "RenderQueue.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+RenderQueueWidget::RenderQueueWidget( QWidget* parent ) :
+        QWidget( parent )
+{
+    RenderQueue*    queue = RenderQueue::getInstance();
+
+    m_tree = new QTreeWidget( this );
+    m_tree->setRootIsDecorated( false );
+    m_tree->setSelectionMode( QAbstractItemView::SingleSelection );
+    m_tree->setHeaderLabels( QStringList() << tr( "Name" ) << tr( "Status" )
+                             << tr( "Progress" ) << tr( "FPS" ) << tr( "ETA" ) );
+    m_tree->header()->setResizeMode( 0, QHeaderView::Stretch );
+    m_tree->header()->setStretchLastSection( false );
+
+    m_cancelButton = new QPushButton( tr( "Cancel" ), this );
+    m_cancelButton->setEnabled( false );
+    m_clearButton = new QPushButton( tr( "Clear finished" ), this );
+
+    QHBoxLayout*    buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget( m_cancelButton );
+    buttons->addWidget( m_clearButton );
+    QVBoxLayout*    layout = new QVBoxLayout( this );
+    layout->addWidget( m_tree );
+    layout->addLayout( buttons );
+
+    foreach ( RenderJob* job, queue->jobs() )
+        jobAdded( job );
+    connect( queue, SIGNAL( jobAdded( RenderJob* ) ), this, SLOT( jobAdded( RenderJob* ) ) );
+    connect( queue, SIGNAL( jobUpdated( RenderJob* ) ), this, SLOT( jobUpdated( RenderJob* ) ) );
+    connect( queue, SIGNAL( jobRemoved( RenderJob* ) ), this, SLOT( jobRemoved( RenderJob* ) ) );
+    connect( m_tree, SIGNAL( itemSelectionChanged() ), this, SLOT( selectionChanged() ) );
+    connect( m_cancelButton, SIGNAL( clicked() ), this, SLOT( cancelClicked() ) );
+    connect( m_clearButton, SIGNAL( clicked() ), this, SLOT( clearClicked() ) );
+}
+
+QString
+RenderQueueWidget::stateName( RenderJob* job )
+{
+    switch ( job->state() )
+    {
+    case RenderJob::Pending:
+        return tr( "Pending" );
+    case RenderJob::Running:
+        return tr( "Running" );
+    case RenderJob::Done:
+        return tr( "Done" );
+    case RenderJob::Failed:
+        return tr( "Failed" );
+    case RenderJob::Cancelled:
+        return tr( "Cancelled" );
+    }
+    return QString();
+}
+
+QString
+RenderQueueWidget::duration( qint64 seconds )
+{
+    if ( seconds < 0 )
+        return QString();
+    return QString( "%1:%2:%3" ).arg( seconds / 3600 )
+                                .arg( ( seconds / 60 ) % 60, 2, 10, QChar( '0' ) )
+                                .arg( seconds % 60, 2, 10, QChar( '0' ) );
+}
+
+void
+RenderQueueWidget::jobAdded( RenderJob* job )
+{
+    QTreeWidgetItem*    item = new QTreeWidgetItem( m_tree );
+
+    item->setText( 0, job->name() );
+    item->setToolTip( 0, job->outputFileName() );
+    m_items[job] = item;
+    jobUpdated( job );
+}
+
+void
+RenderQueueWidget::jobUpdated( RenderJob* job )
+{
+    QTreeWidgetItem*    item = m_items.value( job );
+
+    if ( item == NULL )
+        return ;
+    item->setText( 1, stateName( job ) );
+    item->setText( 2, QString::number( (int)( job->progress() * 100 ) ) + '%' );
+    if ( job->state() == RenderJob::Running )
+    {
+        item->setText( 3, QString::number( job->fps(), 'f', 1 ) );
+        item->setText( 4, duration( job->eta() ) );
+    }
+    else
+    {
+        item->setText( 3, QString() );
+        item->setText( 4, QString() );
+    }
+    if ( item->isSelected() == true )
+        selectionChanged();
+}
+
+void
+RenderQueueWidget::jobRemoved( RenderJob* job )
+{
+    delete m_items.take( job );
+}
+
+void
+RenderQueueWidget::cancelClicked()
+{
+    QList<QTreeWidgetItem*>     selected = m_tree->selectedItems();
+
+    if ( selected.isEmpty() == true )
+        return ;
+    RenderJob*  job = m_items.key( selected.first() );
+    if ( job != NULL )
+        RenderQueue::getInstance()->cancel( job );
+}
+
+void
+RenderQueueWidget::clearClicked()
+{
+    RenderQueue::getInstance()->clearFinished();
+}
+
+void
+RenderQueueWidget::selectionChanged()
+{
+    QList<QTreeWidgetItem*>     selected = m_tree->selectedItems();
+    RenderJob*                  job = NULL;
+
+    if ( selected.isEmpty() == false )
+        job = m_items.key( selected.first() );
+    m_cancelButton->setEnabled( job != NULL && job->isFinished() == false );
+}
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * RenderQueueWidget.h: Displays the render queue's jobs
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDERQUEUEWIDGET_H
+#define RENDERQUEUEWIDGET_H
+
+#include <QHash>
+#include <QWidget>
+
+class   QPushButton;
+class   QTreeWidget;
+class   QTreeWidgetItem;
+class   RenderJob;
+
+class   RenderQueueWidget : public QWidget
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( RenderQueueWidget )
+
+    public:
+        RenderQueueWidget( QWidget* parent = 0 );
+
+    private:
+        static QString              stateName( RenderJob* job );
+        static QString              duration( qint64 seconds );
+
+    private:
+        QTreeWidget*                m_tree;
+        QPushButton*                m_cancelButton;
+        QPushButton*                m_clearButton;
+        QHash<RenderJob*, QTreeWidgetItem*>     m_items;
+
+    private slots:
+        void                        jobAdded( RenderJob* job );
+        void                        jobUpdated( RenderJob* job );
+        void                        jobRemoved( RenderJob* job );
+        void                        cancelClicked();
+        void                        clearClicked();
+        void                        selectionChanged();
+};
+
+#endif // RENDERQUEUEWIDGET_H
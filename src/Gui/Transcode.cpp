@@ -20,25 +20,13 @@
  * foundation, inc., 51 franklin street, fifth floor, boston ma 02110-1301, usa.
  *****************************************************************************/
 
-//DEBUG
-#include <QtDebug>
-//DEBUG
 #include <QApplication>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDir>
 #include "Transcode.h"
-
-static bool catchVLCException( libvlc_exception_t *ex )
-{
-    if ( libvlc_exception_raised( ex ) )
-    {
-        qDebug() << libvlc_errmsg();
-        libvlc_exception_clear( ex );
-        return (true);
-    }
-    return (false);
-}
+#include "RenderQueue.h"
+#include "TranscodeJob.h"
 
 Transcode *Transcode::m_instance = NULL;
 
@@ -63,7 +51,7 @@ void Transcode::changeEvent( QEvent *e )
 }
 
 Transcode::Transcode( QWidget *parent )
-    : QDialog( parent ), m_running( false )
+    : QDialog( parent )
 {
     m_ui.setupUi( this );
     //TODO : load every known profiles
@@ -91,86 +79,11 @@ void Transcode::on_browseFileButton_clicked()
     m_ui.inputFileBox->setText( path );
 }
 
-bool Transcode::m_doTranscode( const QString &transStr )
-{
-    QString sout( ":sout=" );
-    sout += transStr;
-
-    char const *vlc_argv[] = 
-    {
-        "-I", "dummy", 
-        "--no-skip-frame",
-    };
-
-    int vlc_argc = sizeof( vlc_argv ) / sizeof( *vlc_argv );
-
-    libvlc_exception_init( &m_vlcEx );
-    
-    m_libvlc = libvlc_new( vlc_argc, vlc_argv, &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) )
-        return false;
-    
-    m_vlcMedia = libvlc_media_new( m_libvlc, m_origVidPath.toLocal8Bit(), &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-
-    libvlc_media_add_option(m_vlcMedia, sout.toStdString().c_str(), &m_vlcEx);
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-
-    m_vlcMp = libvlc_media_player_new_from_media( m_vlcMedia, &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) )
-        return false;
-
-    m_vlcEM = libvlc_media_player_event_manager( m_vlcMp, &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-
-    libvlc_event_attach( m_vlcEM, libvlc_MediaPlayerPlaying, m_callback, this, &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-    libvlc_event_attach( m_vlcEM, libvlc_MediaPlayerEndReached, m_callback, this,  &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-
-    libvlc_media_player_play( m_vlcMp, &m_vlcEx );
-    if ( catchVLCException( &m_vlcEx ) ) 
-        return false;
-    m_running = true;
-    m_initProgressDialog();
-
-    return true;
-}
-
-void Transcode::m_initProgressDialog()
-{
-    m_progress = new QProgressDialog( tr( "Transcode in progress" ), "Cancel", 0, 0);
-    QObject::connect( m_progress, SIGNAL( canceled() ),
-                      this, SLOT( cancelTranscode() ) );
-    m_timer = new QTimer( this );
-    QObject::connect( m_timer, SIGNAL( timeout() ),
-                      this, SLOT( calcTranscodePercentage() ) );
-    m_timer->start( 500 );
-}
-
-void Transcode::m_releaseVLCRessources()
-{
-    libvlc_media_release( m_vlcMedia );
-    libvlc_media_player_release( m_vlcMp );
-    libvlc_release( m_libvlc ); 
-}
-
-void Transcode::m_callback(const libvlc_event_t *event, void *ptr)
+void Transcode::m_doTranscode( const QString &transStr, const QString &outputPath )
 {
-    Transcode* self = reinterpret_cast<Transcode*>( ptr );
-    switch ( event->type )
-    {
-    case libvlc_MediaPlayerEndReached:
-        self->m_running = false;
-        break;
-    default:
-        break;
-    }
+    //The queue runs the job on the shared VLC instance, without blocking the UI.
+    RenderQueue::getInstance()->enqueue( new TranscodeJob( m_origVidPath, outputPath,
+                                                           transStr ) );
 }
 
 void Transcode::on_dialogButtonBox_accepted()
@@ -232,8 +145,7 @@ void Transcode::on_dialogButtonBox_accepted()
     transCodeString += path;
     transCodeString += "\"}}";
 
-    if ( !m_doTranscode( transCodeString ) )
-        return ;
+    m_doTranscode( transCodeString, path );
     close();
 }
 
@@ -256,27 +168,3 @@ void Transcode::on_deleteProfile_clicked()
 {
     //TODO : delete the selected profile
 }
-
-void Transcode::calcTranscodePercentage()
-{
-    m_progress->setValue( 10 );
-    if ( !m_running )
-    {
-        m_timer->stop();
-        m_releaseVLCRessources();
-        delete m_progress;
-        delete m_timer;
-        m_running = false;
-    }
-}
-
-void Transcode::cancelTranscode()
-{
-    m_timer->stop();
-    libvlc_media_player_pause( m_vlcMp, &m_vlcEx );
-    catchVLCException( &m_vlcEx );
-    m_releaseVLCRessources();
-    delete m_progress;
-    delete m_timer;
-    m_running = false;
-}
@@ -26,9 +26,6 @@
 #include <QDialog>
 #include <QString>
 #include <QEvent>
-#include <QProgressDialog>
-#include <QTimer>
-#include "vlc/vlc.h"
 
 //#include "ui_transcode.h"
 
@@ -44,28 +41,12 @@ class Transcode : public QDialog
 
     private:
         explicit Transcode( QWidget *parent = 0 );
-        bool m_doTranscode( const QString &transStr );
-        void m_initProgressDialog();
-        void m_releaseVLCRessources();
+        void m_doTranscode( const QString &transStr, const QString &outputPath );
 
         //Ui::Transcode m_ui;
         QString m_origVidPath;
 
-        libvlc_exception_t m_vlcEx;
-        libvlc_instance_t *m_libvlc;
-        libvlc_media_t *m_vlcMedia;
-        libvlc_media_player_t *m_vlcMp;
-        libvlc_event_manager_t *m_vlcEM;
-
-        qint64 m_origMediaLength;
-
-        QProgressDialog *m_progress;
-        QTimer          *m_timer;
-
-        bool m_running;
-
         static Transcode *m_instance;
-        static void m_callback(const libvlc_event_t *event, void *ptr);
 
     private slots:
         void on_browseFileButton_clicked();
@@ -76,9 +57,6 @@ class Transcode : public QDialog
         void on_addProfile_clicked();
         void on_editProfile_clicked();
         void on_deleteProfile_clicked();
-
-        void calcTranscodePercentage();
-        void cancelTranscode();
 };
 
 #endif
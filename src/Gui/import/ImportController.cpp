@@ -27,6 +27,7 @@
 
 #include "ClipRenderer.h"
 #include "ImportController.h"
+#include "ImportScanner.h"
 #include "Library.h"
 #include "MetaDataManager.h"
 
@@ -49,6 +50,7 @@ ImportController::ImportController(QWidget *parent) :
     m_mediaListController = new ImportMediaListController( m_stackNav );
     m_tag = new TagWidget( m_ui->tagContainer, 6 );
     m_filesModel = new QFileSystemModel( this );
+    m_scanner = new ImportScanner( this );
     m_stackNav->pushViewController( m_mediaListController );
 
     QStringList filters;
@@ -104,6 +106,8 @@ ImportController::ImportController(QWidget *parent) :
 
     connect( MetaDataManager::getInstance(), SIGNAL( failedToCompute( Media* ) ),
              this, SLOT( failedToLoad( Media* ) ) );
+    connect( m_scanner, SIGNAL( filesFound( const QStringList& ) ),
+             this, SLOT( importFiles( const QStringList& ) ) );
 }
 
 ImportController::~ImportController()
@@ -231,13 +235,12 @@ ImportController::setUIMetaData( Clip* clip )
 void
 ImportController::importMedia( const QString &filePath )
 {
-    ++m_nbMediaToLoad;
-    m_ui->progressBar->setMaximum( m_nbMediaToLoad );
-    foreach ( Media* media, m_temporaryMedias.values() )
-        if ( media->fileInfo()->filePath() == filePath )
-            return ;
+    if ( m_temporaryPaths.contains( QFileInfo( filePath ).filePath() ) == true )
+        return ;
     if ( Library::getInstance()->mediaAlreadyLoaded( filePath ) == true )
         return ;
+    ++m_nbMediaToLoad;
+    m_ui->progressBar->setMaximum( m_nbMediaToLoad );
 
     Media*          media = new Media( filePath );
     connect( media, SIGNAL( metaDataComputed( const Media* ) ),
@@ -247,33 +250,16 @@ ImportController::importMedia( const QString &filePath )
     connect( media, SIGNAL( snapshotComputed( const Media* ) ),
              this, SLOT( mediaLoaded() ) );
     m_temporaryMedias[media->uuid()] = media;
+    m_temporaryPaths.insert( media->fileInfo()->filePath() );
     MetaDataManager::getInstance()->computeMediaMetadata( media );
     m_mediaListController->addMedia( media );
 }
 
 void
-ImportController::importDir( const QString &path )
+ImportController::importFiles( const QStringList& files )
 {
-    QDir            dir( path );
-    QFileInfoList   files = dir.entryInfoList( QDir::NoDotAndDotDot | QDir::Readable
-                                               | QDir::AllEntries );
-
-    foreach ( QFileInfo fInfo, files )
-    {
-        if ( fInfo.isDir() == true )
-            importDir( fInfo.absolutePath() );
-        else
-        {
-            QString ext = fInfo.suffix();
-
-            if ( Media::AudioExtensions.contains( ext ) ||
-                 Media::VideoExtensions.contains( ext ) ||
-                 Media::ImageExtensions.contains( ext ) )
-            {
-                importMedia( fInfo.absoluteFilePath() );
-            }
-        }
-    }
+    foreach ( const QString& file, files )
+        importMedia( file );
 }
 
 void
@@ -285,7 +271,7 @@ ImportController::forwardButtonClicked()
     if ( !m_filesModel->isDir( index ) )
         importMedia( filePath );
     else
-        importDir( filePath );
+        m_scanner->scan( filePath );
 }
 
 void
@@ -310,6 +296,7 @@ void
 ImportController::reject()
 {
     m_preview->stop();
+    m_scanner->cancel();
     m_mediaListController->cleanAll();
     deleteTemporaryMedias();
     collapseAllButCurrentPath();
@@ -319,12 +306,14 @@ ImportController::reject()
 void
 ImportController::accept()
 {
+    m_scanner->cancel();
     m_mediaListController->cleanAll();
     m_preview->stop();
     collapseAllButCurrentPath();
     foreach ( Media* media, m_temporaryMedias.values() )
         Library::getInstance()->addMedia( media );
     m_temporaryMedias.clear();
+    m_temporaryPaths.clear();
     done( Accepted );
 }
 
@@ -334,6 +323,7 @@ ImportController::deleteTemporaryMedias()
     foreach ( Media* media, m_temporaryMedias.values() )
         delete media;
     m_temporaryMedias.clear();
+    m_temporaryPaths.clear();
 }
 
 void
@@ -356,7 +346,11 @@ ImportController::mediaDeletion( const QUuid& uuid )
 {
     m_mediaListController->removeMedia( uuid );
     if ( m_temporaryMedias.contains( uuid ) == true )
-        delete m_temporaryMedias.take( uuid );
+    {
+        Media*  media = m_temporaryMedias.take( uuid );
+        m_temporaryPaths.remove( media->fileInfo()->filePath() );
+        delete media;
+    }
 
     if ( uuid == m_currentUuid )
     {
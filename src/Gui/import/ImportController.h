@@ -41,6 +41,9 @@
 #include <QFileSystemModel>
 #include <QFileSystemWatcher>
 #include <QProgressDialog>
+#include <QSet>
+
+class   ImportScanner;
 
 namespace Ui
 {
@@ -70,7 +73,6 @@ class ImportController : public QDialog
         void                        collapseAllButCurrentPath();
         void                        deleteTemporaryMedias();
         void                        importMedia( const QString &filePath );
-        void                        importDir( const QString &path );
         Ui::ImportController*       m_ui;
         PreviewWidget*              m_preview;
         StackViewController*        m_stackNav;
@@ -83,6 +85,8 @@ class ImportController : public QDialog
         QUuid                       m_savedUuid;
         bool                        m_controllerSwitched;
         QHash< QUuid, Media*>       m_temporaryMedias;
+        QSet<QString>               m_temporaryPaths;
+        ImportScanner*              m_scanner;
         quint32                     m_nbMediaToLoad;
         quint32                     m_nbMediaLoaded;
 
@@ -102,6 +106,7 @@ class ImportController : public QDialog
         void        treeViewClicked( const QModelIndex& index );
         void        treeViewDoubleClicked( const QModelIndex& index );
         void        mediaLoaded();
+        void        importFiles( const QStringList& files );
         void        failedToLoad( Media* media );
         void        hideErrors();
 
@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * MediaItemDelegate.cpp: Draws the medias of the library list
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "MediaItemDelegate.h"
+
+#include "MediaListModel.h"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QTime>
+
+static const int    Margin = 10;
+static const int    IconSize = 16;
+
+MediaItemDelegate::MediaItemDelegate( QObject* parent ) :
+        QStyledItemDelegate( parent ),
+        m_deleteIcon( ":/images/images/clear.png" ),
+        m_arrowIcon( ":/images/images/marker_left.png" )
+{
+}
+
+void
+MediaItemDelegate::paint( QPainter* painter, const QStyleOptionViewItem& option,
+                          const QModelIndex& index ) const
+{
+    QStyleOptionViewItemV4  opt = option;
+    initStyleOption( &opt, index );
+    QStyle*     style = opt.widget != NULL ? opt.widget->style() : QApplication::style();
+    style->drawPrimitive( QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget );
+
+    QVariant    length = index.data( MediaListModel::LengthRole );
+    //The media is being removed.
+    if ( length.isValid() == false )
+        return ;
+
+    painter->save();
+    const QRect&    rect = opt.rect;
+    QPalette::ColorGroup    group = ( opt.state & QStyle::State_Enabled ) ?
+                                    QPalette::Normal : QPalette::Disabled;
+    painter->setPen( opt.palette.color( group, ( opt.state & QStyle::State_Selected ) ?
+                                                QPalette::HighlightedText : QPalette::Text ) );
+
+    QPixmap     thumbnail = qvariant_cast<QPixmap>( index.data( Qt::DecorationRole ) );
+    int         size = MediaListModel::ThumbnailSize;
+    QRect       thumbnailRect( rect.left() + Margin, rect.top() + ( rect.height() - size ) / 2,
+                               size, size );
+    painter->drawPixmap( thumbnailRect.left() + ( size - thumbnail.width() ) / 2,
+                         thumbnailRect.top() + ( size - thumbnail.height() ) / 2, thumbnail );
+
+    int         textLeft = thumbnailRect.right() + Margin;
+    int         textWidth = deleteRect( rect ).left() - Margin - textLeft;
+    QFont       titleFont = opt.font;
+    titleFont.setBold( true );
+    painter->setFont( titleFont );
+    QFontMetrics    titleMetrics( titleFont );
+    QRect       titleRect( textLeft, thumbnailRect.top(), textWidth, titleMetrics.height() );
+    painter->drawText( titleRect, Qt::AlignLeft | Qt::AlignVCenter,
+                       titleMetrics.elidedText( index.data( Qt::DisplayRole ).toString(),
+                                                Qt::ElideRight, textWidth ) );
+
+    QFont       infoFont = opt.font;
+    infoFont.setPointSizeF( infoFont.pointSizeF() * 0.8 );
+    painter->setFont( infoFont );
+    QFontMetrics    infoMetrics( infoFont );
+    int         nbClips = index.data( MediaListModel::ClipCountRole ).toInt();
+    QRect       infoRect( textLeft, thumbnailRect.bottom() - 2 * infoMetrics.height(),
+                          textWidth, infoMetrics.height() );
+    painter->drawText( infoRect, Qt::AlignLeft | Qt::AlignVCenter,
+                       tr( "clip count" ) + "  " + QString::number( nbClips ) );
+    infoRect.translate( 0, infoMetrics.height() );
+    QTime       duration;
+    duration = duration.addMSecs( length.toLongLong() );
+    painter->drawText( infoRect, Qt::AlignLeft | Qt::AlignVCenter,
+                       tr( "length" ) + "  " + duration.toString( "hh:mm:ss" ) );
+
+    painter->drawPixmap( deleteRect( rect ), m_deleteIcon );
+    if ( nbClips > 0 )
+        painter->drawPixmap( arrowRect( rect ), m_arrowIcon );
+
+    painter->setPen( opt.palette.color( QPalette::Mid ) );
+    painter->drawLine( rect.bottomLeft(), rect.bottomRight() );
+    painter->restore();
+}
+
+QSize
+MediaItemDelegate::sizeHint( const QStyleOptionViewItem&, const QModelIndex& ) const
+{
+    return QSize( MediaListModel::ThumbnailSize + 200, RowHeight );
+}
+
+bool
+MediaItemDelegate::editorEvent( QEvent* event, QAbstractItemModel* model,
+                                const QStyleOptionViewItem& option, const QModelIndex& index )
+{
+    if ( event->type() == QEvent::MouseButtonRelease )
+    {
+        QMouseEvent*    mouseEvent = static_cast<QMouseEvent*>( event );
+        if ( mouseEvent->button() == Qt::LeftButton )
+        {
+            if ( deleteRect( option.rect ).contains( mouseEvent->pos() ) == true )
+            {
+                emit deleteClicked( index );
+                return true;
+            }
+            if ( arrowRect( option.rect ).contains( mouseEvent->pos() ) == true &&
+                 index.data( MediaListModel::ClipCountRole ).toInt() > 0 )
+            {
+                emit arrowClicked( index );
+                return true;
+            }
+        }
+    }
+    return QStyledItemDelegate::editorEvent( event, model, option, index );
+}
+
+QRect
+MediaItemDelegate::deleteRect( const QRect& row ) const
+{
+    return QRect( row.right() - Margin - IconSize, row.top() + Margin, IconSize, IconSize );
+}
+
+QRect
+MediaItemDelegate::arrowRect( const QRect& row ) const
+{
+    return QRect( row.right() - Margin - IconSize, row.bottom() - Margin - IconSize,
+                  IconSize, IconSize );
+}
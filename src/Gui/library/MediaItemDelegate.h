@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * MediaItemDelegate.h: Draws the medias of the library list
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MEDIAITEMDELEGATE_H
+#define MEDIAITEMDELEGATE_H
+
+#include <QPixmap>
+#include <QStyledItemDelegate>
+
+/**
+ *  \brief  Draws the rows of a MediaListModel, the way MediaCellView lays
+ *          out a media, without creating a widget for each row.
+ */
+class   MediaItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( MediaItemDelegate );
+
+    public:
+        /// Height of a row, in pixels.
+        static const int        RowHeight = 70;
+
+        MediaItemDelegate( QObject* parent = 0 );
+
+        virtual void            paint( QPainter* painter, const QStyleOptionViewItem& option,
+                                       const QModelIndex& index ) const;
+        virtual QSize           sizeHint( const QStyleOptionViewItem& option,
+                                          const QModelIndex& index ) const;
+
+    protected:
+        virtual bool            editorEvent( QEvent* event, QAbstractItemModel* model,
+                                             const QStyleOptionViewItem& option,
+                                             const QModelIndex& index );
+
+    private:
+        QRect                   deleteRect( const QRect& row ) const;
+        QRect                   arrowRect( const QRect& row ) const;
+
+    private:
+        QPixmap                 m_deleteIcon;
+        QPixmap                 m_arrowIcon;
+
+    signals:
+        void                    deleteClicked( const QModelIndex& index );
+        void                    arrowClicked( const QModelIndex& index );
+};
+
+#endif // MEDIAITEMDELEGATE_H
@@ -0,0 +1,312 @@
+/*****************************************************************************
+ * MediaListModel.cpp: Model of the medias shown in the library
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "MediaListModel.h"
+
+#include "Clip.h"
+#include "Library.h"
+#include "Media.h"
+
+#include <QMimeData>
+#include <QTimer>
+
+MediaListModel::MediaListModel( QObject* parent ) :
+        QAbstractListModel( parent ),
+        m_thumbnails( ThumbnailsBudget )
+{
+    m_flushTimer = new QTimer( this );
+    m_flushTimer->setSingleShot( true );
+    m_flushTimer->setInterval( InsertDelay );
+    connect( m_flushTimer, SIGNAL( timeout() ), this, SLOT( flush() ) );
+
+    Library*    library = Library::getInstance();
+    connect( library, SIGNAL( newMediaLoaded( Media* ) ),
+             this, SLOT( newMediaLoaded( Media* ) ) );
+    connect( library, SIGNAL( mediaRemoved( const QUuid& ) ),
+             this, SLOT( mediaRemoved( const QUuid& ) ) );
+    connect( library, SIGNAL( projectLoaded() ), this, SLOT( projectLoaded() ) );
+}
+
+int
+MediaListModel::rowCount( const QModelIndex& parent ) const
+{
+    if ( parent.isValid() == true )
+        return 0;
+    return m_uuids.size();
+}
+
+QVariant
+MediaListModel::data( const QModelIndex& index, int role ) const
+{
+    if ( index.isValid() == false || index.row() >= m_uuids.size() )
+        return QVariant();
+    //The removed medias are already deleted, but their rows remain until the next flush.
+    Media*  media = Library::getInstance()->media( m_uuids.at( index.row() ) );
+    if ( media == NULL )
+        return QVariant();
+
+    switch ( role )
+    {
+    case Qt::DisplayRole:
+        return media->fileName();
+    case Qt::DecorationRole:
+        return thumbnail( media );
+    case Qt::ToolTipRole:
+        if ( media->fileInfo() == NULL )
+            return media->mrl();
+        return media->fileInfo()->absoluteFilePath();
+    case LengthRole:
+        return media->lengthMS();
+    case ClipCountRole:
+        return media->clips()->size();
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags
+MediaListModel::flags( const QModelIndex& index ) const
+{
+    if ( index.isValid() == false || index.row() >= m_uuids.size() )
+        return Qt::NoItemFlags;
+    Media*  media = Library::getInstance()->media( m_uuids.at( index.row() ) );
+    //The media can't be used before its metadata are computed.
+    if ( media == NULL || media->baseClip() == NULL )
+        return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
+
+QStringList
+MediaListModel::mimeTypes() const
+{
+    return QStringList() << "vlmc/uuid";
+}
+
+QMimeData*
+MediaListModel::mimeData( const QModelIndexList& indexes ) const
+{
+    if ( indexes.isEmpty() == true )
+        return NULL;
+    QUuid   uuid = this->uuid( indexes.first() );
+    if ( uuid.isNull() == true )
+        return NULL;
+    //FIXME the data is a media UUID instead of a Clip
+    // and this is not logical... but it works.
+    QMimeData*  mimeData = new QMimeData;
+    mimeData->setData( "vlmc/uuid", uuid.toString().toAscii() );
+    return mimeData;
+}
+
+QUuid
+MediaListModel::uuid( const QModelIndex& index ) const
+{
+    if ( index.isValid() == false || index.row() >= m_uuids.size() )
+        return QUuid();
+    return m_uuids.at( index.row() );
+}
+
+void
+MediaListModel::setFilter( const QString& text )
+{
+    QString     filter = text.trimmed();
+
+    if ( filter == m_filter )
+        return ;
+    m_filter = filter;
+    //The rows are rebuilt from every loaded media, keeping their order.
+    QSet<QUuid>     matching = matches();
+
+    m_uuids.clear();
+    foreach ( const QUuid& uuid, m_medias )
+    {
+        if ( m_filter.isEmpty() == true || matching.contains( uuid ) == true )
+            m_uuids.append( uuid );
+    }
+    updateRows();
+    reset();
+}
+
+QSet<QUuid>
+MediaListModel::matches() const
+{
+    if ( m_filter.isEmpty() == true )
+        return QSet<QUuid>();
+    Library*        library = Library::getInstance();
+    QSet<QUuid>     result = library->search( m_filter );
+
+    //A media is shown when one of its clips matches.
+    foreach ( const QUuid& uuid, result.toList() )
+    {
+        //Library::clip() would return a copy of a media's base clip.
+        if ( library->media( uuid ) != NULL )
+            continue ;
+        Clip*   clip = library->clip( uuid );
+        if ( clip != NULL && clip->getParent() != NULL )
+            result.insert( clip->getParent()->uuid() );
+    }
+    return result;
+}
+
+void
+MediaListModel::updateRows()
+{
+    m_rows.clear();
+    for ( int i = 0; i < m_uuids.size(); ++i )
+        m_rows.insert( m_uuids.at( i ), i );
+}
+
+void
+MediaListModel::mediaChanged( const QUuid& uuid )
+{
+    QHash<QUuid, int>::const_iterator   it = m_rows.find( uuid );
+    if ( it == m_rows.end() )
+        return ;
+    QModelIndex     idx = index( it.value() );
+    emit dataChanged( idx, idx );
+}
+
+QPixmap
+MediaListModel::thumbnail( const Media* media ) const
+{
+    QPixmap*    pixmap = m_thumbnails.object( media->uuid() );
+    if ( pixmap == NULL )
+    {
+        pixmap = new QPixmap( media->snapshot().scaled( ThumbnailSize, ThumbnailSize,
+                                                        Qt::KeepAspectRatio,
+                                                        Qt::SmoothTransformation ) );
+        m_thumbnails.insert( media->uuid(), pixmap,
+                             pixmap->width() * pixmap->height() * pixmap->depth() / 8 );
+    }
+    return *pixmap;
+}
+
+void
+MediaListModel::newMediaLoaded( Media* media )
+{
+    const QUuid&    uuid = media->uuid();
+
+    connect( media, SIGNAL( metaDataComputed( const Media* ) ),
+             this, SLOT( mediaUpdated( const Media* ) ) );
+    connect( media, SIGNAL( snapshotComputed( const Media* ) ),
+             this, SLOT( mediaUpdated( const Media* ) ) );
+    m_thumbnails.remove( uuid );
+    //A media removed then loaded again, when a project is reloaded, keeps its row.
+    if ( m_removed.remove( uuid ) == true )
+    {
+        mediaChanged( uuid );
+        return ;
+    }
+    m_pending.append( uuid );
+    m_pendingSet.insert( uuid );
+    if ( m_flushTimer->isActive() == false )
+        m_flushTimer->start();
+}
+
+void
+MediaListModel::mediaRemoved( const QUuid& uuid )
+{
+    if ( m_loaded.contains( uuid ) == false && m_pendingSet.contains( uuid ) == false )
+        return ;
+    m_thumbnails.remove( uuid );
+    m_removed.insert( uuid );
+    mediaChanged( uuid );
+    if ( m_flushTimer->isActive() == false )
+        m_flushTimer->start();
+}
+
+void
+MediaListModel::mediaUpdated( const Media* media )
+{
+    m_thumbnails.remove( media->uuid() );
+    mediaChanged( media->uuid() );
+}
+
+void
+MediaListModel::projectLoaded()
+{
+    //The clips of the project are added after their medias were loaded.
+    if ( m_uuids.isEmpty() == false )
+        emit dataChanged( index( 0 ), index( m_uuids.size() - 1 ) );
+}
+
+void
+MediaListModel::flush()
+{
+    if ( m_removed.isEmpty() == false )
+    {
+        //Remove the contiguous ranges of removed rows, starting from the end
+        //so that the rows left to check don't move.
+        int     row = m_uuids.size() - 1;
+        while ( row >= 0 )
+        {
+            if ( m_removed.contains( m_uuids.at( row ) ) == false )
+            {
+                --row;
+                continue ;
+            }
+            int     last = row;
+            while ( row > 0 && m_removed.contains( m_uuids.at( row - 1 ) ) == true )
+                --row;
+            beginRemoveRows( QModelIndex(), row, last );
+            m_uuids.erase( m_uuids.begin() + row, m_uuids.begin() + last + 1 );
+            endRemoveRows();
+            --row;
+        }
+        updateRows();
+
+        QList<QUuid>    medias;
+        foreach ( const QUuid& uuid, m_medias )
+        {
+            if ( m_removed.contains( uuid ) == false )
+                medias.append( uuid );
+            else
+                m_loaded.remove( uuid );
+        }
+        m_medias = medias;
+    }
+
+    QSet<QUuid>     matching = matches();
+    QList<QUuid>    inserted;
+    foreach ( const QUuid& uuid, m_pending )
+    {
+        if ( m_removed.contains( uuid ) == true )
+            continue ;
+        m_medias.append( uuid );
+        m_loaded.insert( uuid );
+        if ( m_filter.isEmpty() == true || matching.contains( uuid ) == true )
+            inserted.append( uuid );
+    }
+    m_pending.clear();
+    m_pendingSet.clear();
+    m_removed.clear();
+    if ( inserted.isEmpty() == true )
+        return ;
+
+    int     first = m_uuids.size();
+    beginInsertRows( QModelIndex(), first, first + inserted.size() - 1 );
+    for ( int i = 0; i < inserted.size(); ++i )
+    {
+        m_uuids.append( inserted.at( i ) );
+        m_rows.insert( inserted.at( i ), first + i );
+    }
+    endInsertRows();
+}
@@ -0,0 +1,122 @@
+/*****************************************************************************
+ * MediaListModel.h: Model of the medias shown in the library
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MEDIALISTMODEL_H
+#define MEDIALISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QSet>
+#include <QStringList>
+#include <QUuid>
+
+class   QTimer;
+
+class   Media;
+
+/**
+ *  \brief  List model of the medias loaded in the library.
+ *
+ *  The model only stores the uuid of each row, everything else is read from
+ *  the Library when a row gets drawn. The medias loaded in a burst are
+ *  appended together once every InsertDelay ms, and so are the removed
+ *  medias. Only the medias matching the filter, if any, get a row. The
+ *  thumbnails are scaled down from the media snapshot the first
+ *  time they are drawn, and kept in a cache bounded in size.
+ */
+class   MediaListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( MediaListModel );
+
+    public:
+        enum    Roles
+        {
+            /// The media length, in ms.
+            LengthRole = Qt::UserRole,
+            ClipCountRole
+        };
+        /// Size of the thumbnails, in pixels.
+        static const int        ThumbnailSize = 64;
+        /// Size of the thumbnails cache, in bytes.
+        static const int        ThumbnailsBudget = 8 * 1024 * 1024;
+        /// Delay during which the loaded and removed medias are batched, in ms.
+        static const int        InsertDelay = 50;
+
+        MediaListModel( QObject* parent = 0 );
+
+        virtual int             rowCount( const QModelIndex& parent = QModelIndex() ) const;
+        virtual QVariant        data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+        virtual Qt::ItemFlags   flags( const QModelIndex& index ) const;
+        virtual QStringList     mimeTypes() const;
+        virtual QMimeData*      mimeData( const QModelIndexList& indexes ) const;
+
+        /**
+         *  \return The uuid of the media at index, or a null uuid.
+         */
+        QUuid                   uuid( const QModelIndex& index ) const;
+        /**
+         *  \brief  Redraw the row of a media, for instance after its clips
+         *          changed.
+         */
+        void                    mediaChanged( const QUuid& uuid );
+        /**
+         *  \brief  Only show the medias matching a text, as searched by
+         *          Library::search. An empty text shows every media.
+         */
+        void                    setFilter( const QString& text );
+
+    private:
+        QPixmap                 thumbnail( const Media* media ) const;
+        /// \return The medias matching the filter, or an empty set without filter.
+        QSet<QUuid>             matches() const;
+        void                    updateRows();
+
+    private:
+        /// Every loaded media, in loading order.
+        QList<QUuid>                    m_medias;
+        QSet<QUuid>                     m_loaded;
+        /// The medias shown, in loading order.
+        QList<QUuid>                    m_uuids;
+        /// Row of each uuid of m_uuids.
+        QHash<QUuid, int>               m_rows;
+        /// Medias loaded since the last flush.
+        QList<QUuid>                    m_pending;
+        QSet<QUuid>                     m_pendingSet;
+        /// Medias removed since the last flush.
+        QSet<QUuid>                     m_removed;
+        QTimer*                         m_flushTimer;
+        mutable QCache<QUuid, QPixmap>  m_thumbnails;
+        QString                         m_filter;
+
+    private slots:
+        void                    newMediaLoaded( Media* media );
+        void                    mediaRemoved( const QUuid& uuid );
+        void                    mediaUpdated( const Media* media );
+        void                    projectLoaded();
+        void                    flush();
+};
+
+#endif // MEDIALISTMODEL_H
@@ -21,89 +21,129 @@
  *****************************************************************************/
 
 #include "MediaListViewController.h"
+#include "MediaItemDelegate.h"
+#include "MediaListModel.h"
+#include "ClipProperty.h"
 
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QToolButton>
+#include <QVBoxLayout>
 #include <QDebug>
 
 MediaListViewController::MediaListViewController( StackViewController* nav ) :
-        ListViewController( nav ), m_nav( nav ), m_clipsListView( 0 )
+        m_nav( nav ), m_title( "Media List" ), m_clipsListView( 0 )
 {
-    connect( Library::getInstance(), SIGNAL( newMediaLoaded( Media* ) ),
-             this, SLOT( newMediaLoaded( Media* ) ) );
-    m_cells = new QHash<QUuid, QWidget*>();
+    m_model = new MediaListModel( this );
+    m_delegate = new MediaItemDelegate( this );
+    m_widget = new QWidget();
+    m_filterInput = new QLineEdit( m_widget );
+    QToolButton*    clearFilterButton = new QToolButton( m_widget );
+    clearFilterButton->setIcon( QIcon( ":/images/images/clear.png" ) );
+    QHBoxLayout*    filterLayout = new QHBoxLayout;
+    filterLayout->addWidget( new QLabel( tr( "Filter:" ), m_widget ) );
+    filterLayout->addWidget( m_filterInput );
+    filterLayout->addWidget( clearFilterButton );
+
+    m_view = new QListView( m_widget );
+    m_view->setModel( m_model );
+    m_view->setItemDelegate( m_delegate );
+    //Only the visible rows are laid out and drawn.
+    m_view->setUniformItemSizes( true );
+    m_view->setSelectionMode( QAbstractItemView::SingleSelection );
+    m_view->setDragEnabled( true );
+    m_view->setDragDropMode( QAbstractItemView::DragOnly );
+    m_view->setVerticalScrollMode( QAbstractItemView::ScrollPerPixel );
+
+    QVBoxLayout*    layout = new QVBoxLayout( m_widget );
+    layout->setContentsMargins( 0, 0, 0, 0 );
+    layout->addLayout( filterLayout );
+    layout->addWidget( m_view );
+
+    connect( m_filterInput, SIGNAL( textChanged( const QString& ) ),
+             this, SLOT( filterChanged( const QString& ) ) );
+    connect( clearFilterButton, SIGNAL( clicked() ), m_filterInput, SLOT( clear() ) );
+
+    connect( m_view, SIGNAL( pressed( const QModelIndex& ) ),
+             this, SLOT( cellSelection( const QModelIndex& ) ) );
+    connect( m_view, SIGNAL( doubleClicked( const QModelIndex& ) ),
+             this, SLOT( showProperties( const QModelIndex& ) ) );
+    connect( m_delegate, SIGNAL( deleteClicked( const QModelIndex& ) ),
+             this, SLOT( cellDeletion( const QModelIndex& ) ) );
+    connect( m_delegate, SIGNAL( arrowClicked( const QModelIndex& ) ),
+             this, SLOT( arrowClicked( const QModelIndex& ) ) );
     connect( m_nav, SIGNAL( previousButtonPushed() ), this, SLOT( restoreContext() ) );
 }
 
 MediaListViewController::~MediaListViewController()
 {
-    delete m_cells;
+    delete m_widget;
 }
 
-void        MediaListViewController::newMediaLoaded( Media* media )
+QWidget*
+MediaListViewController::view() const
 {
-    MediaCellView* cell = new MediaCellView( media->uuid() );
-
-    connect( cell, SIGNAL ( cellSelected( QUuid ) ),
-             this, SLOT ( cellSelection( QUuid ) ) );
-    connect( cell, SIGNAL ( cellDeleted( QUuid ) ),
-             this, SIGNAL( mediaDeleted( QUuid ) ) );
-    connect( cell, SIGNAL( arrowClicked( const QUuid& ) ),
-             this, SLOT( showClipList( const QUuid& ) ) );
-    connect( media, SIGNAL( snapshotComputed( const Media* ) ),
-             this, SLOT( updateCell( const Media* ) ) );
-    cell->setNbClips( media->clips()->size() );
-    cell->setThumbnail( media->snapshot() );
-    cell->setTitle( media->fileName() );
-    cell->setLength( media->lengthMS() );
-    if ( media->baseClip() != NULL )
-        cell->setEnabled(true);
-    addCell(cell);
-    m_cells->insert( media->uuid(), cell );
+    return m_widget;
 }
 
-void    MediaListViewController::cellSelection( const QUuid& uuid )
+const QString&
+MediaListViewController::title() const
 {
-    if ( m_currentUuid == uuid )
+    return m_title;
+}
+
+void    MediaListViewController::cellSelection( const QModelIndex& index )
+{
+    QUuid   uuid = m_model->uuid( index );
+    if ( uuid.isNull() || m_currentUuid == uuid )
         return;
 
-    if ( m_cells->contains( uuid ) )
+    Media*  media = Library::getInstance()->media( uuid );
+    if ( media != NULL )
     {
-        if ( !m_currentUuid.isNull() && m_cells->contains( m_currentUuid ) )
-        {
-            QWidget* cell = m_cells->value( m_currentUuid );
-            cell->setPalette( m_cells->value( uuid )->palette() );
-        }
-        QPalette p = m_cells->value( uuid )->palette();
-        p.setColor( QPalette::Window, QColor( Qt::darkBlue ) );
-        m_cells->value( uuid )->setPalette( p );
         m_currentUuid = uuid;
-        emit mediaSelected( Library::getInstance()->media( uuid ) );
+        emit mediaSelected( media );
     }
 }
 
-void    MediaListViewController::mediaRemoved( const QUuid& uuid )
+void    MediaListViewController::cellDeletion( const QModelIndex& index )
 {
-    QWidget* cell = m_cells->value( uuid );
-    removeCell( cell );
-    m_cells->remove( uuid );
-    m_currentUuid = QUuid();
+    QUuid   uuid = m_model->uuid( index );
+    if ( uuid.isNull() == false )
+        emit mediaDeleted( uuid );
 }
 
-void    MediaListViewController::updateCell( const Media* media )
+void    MediaListViewController::arrowClicked( const QModelIndex& index )
 {
-    MediaCellView* cell = qobject_cast<MediaCellView*>( m_cells->value( media->uuid(), NULL ) );
-    if ( cell != NULL )
-    {
-        cell->setNbClips( media->clips()->size() );
-        cell->setLength( media->lengthMS() );
-        cell->setThumbnail( media->snapshot() );
-        cell->setEnabled(true);
-    }
+    showClipList( m_model->uuid( index ) );
+}
+
+void    MediaListViewController::showProperties( const QModelIndex& index )
+{
+    Clip* clip = Library::getInstance()->clip( m_model->uuid( index ) );
+    if ( clip == NULL )
+        return;
+    ClipProperty* mp = new ClipProperty( clip, m_view );
+    mp->setModal( true );
+    mp->show();
+}
+
+void    MediaListViewController::filterChanged( const QString& text )
+{
+    m_model->setFilter( text );
+}
+
+void    MediaListViewController::mediaRemoved( const QUuid& uuid )
+{
+    //The model removes the row by itself.
+    if ( m_currentUuid == uuid )
+        m_currentUuid = QUuid();
 }
 
 void    MediaListViewController::showClipList( const QUuid& uuid )
 {
-    if ( !m_cells->contains( uuid ) )
-        return ;
     if ( Library::getInstance()->media( uuid ) == NULL ||
          Library::getInstance()->media( uuid )->clips()->size() == 0 )
         return ;
@@ -119,31 +159,16 @@ void    MediaListViewController::newClipAdded( Clip* clip )
 {
     if ( clip->getParent() == 0 )
         return ;
-    const QUuid& uuid = clip->getParent()->uuid();
-
-    if ( m_cells->contains( uuid ) )
-    {
-        MediaCellView*  cell = qobject_cast<MediaCellView*>( m_cells->value( uuid, 0 ) );
-        if ( cell != 0 )
-        {
-            cell->incrementClipCount();
-        }
-    }
+    m_model->mediaChanged( clip->getParent()->uuid() );
 }
 
 void    MediaListViewController::restoreContext()
 {
     if ( m_clipsListView->getNbDeletion() != 0 )
     {
-        if ( m_cells->contains( m_lastUuidClipListAsked ) )
-        {
-            MediaCellView*  cell = qobject_cast<MediaCellView*>( m_cells->value( m_lastUuidClipListAsked, 0 ) );
-            if ( cell != 0 )
-            {
-                cell->decrementClipCount( m_clipsListView->getNbDeletion() );
-                m_clipsListView->resetNbDeletion();
-            }
-        }
+        //The clip count is read from the media.
+        m_model->mediaChanged( m_lastUuidClipListAsked );
+        m_clipsListView->resetNbDeletion();
     }
     delete m_clipsListView;
 }
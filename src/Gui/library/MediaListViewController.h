@@ -2,13 +2,19 @@
 #define MEDIALISTVIEWCONTROLLER_H
 
 #include "StackViewController.h"
-#include "ListViewController.h"
-#include "MediaCellView.h"
+#include "ViewController.h"
 #include "ClipListViewController.h"
 #include "Library.h"
 #include "Media.h"
 
-class MediaListViewController : public ListViewController
+class QLineEdit;
+class QListView;
+class QModelIndex;
+
+class MediaItemDelegate;
+class MediaListModel;
+
+class MediaListViewController : public ViewController
 {
     Q_OBJECT
 
@@ -16,26 +22,35 @@ public:
     MediaListViewController( StackViewController* nav );
     virtual ~MediaListViewController();
 
+    QWidget*        view() const;
+    const QString&  title() const;
+
 private:
-    void                    updateClipCount();
     StackViewController*    m_nav;
+    QString                 m_title;
+    /// The filter input and the list.
+    QWidget*                m_widget;
+    QLineEdit*              m_filterInput;
+    QListView*              m_view;
+    MediaListModel*         m_model;
+    MediaItemDelegate*      m_delegate;
     QUuid                   m_currentUuid;
-    QHash<QUuid, QWidget*>* m_cells;
     ClipListViewController* m_clipsListView;
     QUuid                   m_lastUuidClipListAsked;
 
 public slots:
-    //void        newMediaLoaded( Media* );
-    void        newMediaLoaded( Media* media );
-    void        cellSelection( const QUuid& uuid );
     void        mediaRemoved( const QUuid& uuid );
-    void        updateCell( const Media* media );
     void        showClipList( const QUuid& uuid );
     void        newClipAdded( Clip* clip );
     void        clipSelection( const QUuid& uuid );
 
 private slots:
-    void    restoreContext();
+    void        cellSelection( const QModelIndex& index );
+    void        cellDeletion( const QModelIndex& index );
+    void        arrowClicked( const QModelIndex& index );
+    void        showProperties( const QModelIndex& index );
+    void        restoreContext();
+    void        filterChanged( const QString& text );
 signals:
     void        mediaSelected( Media* media );
     void        mediaDeleted( const QUuid& uuid );
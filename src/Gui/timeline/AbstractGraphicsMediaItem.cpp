@@ -41,6 +41,10 @@ AbstractGraphicsMediaItem::AbstractGraphicsMediaItem() :
 AbstractGraphicsMediaItem::~AbstractGraphicsMediaItem()
 {
     ungroup();
+    // When the track itself is being deleted, it can't be casted anymore.
+    GraphicsTrack* track = qgraphicsitem_cast<GraphicsTrack*>( parentItem() );
+    if ( track )
+        track->unindexItem( this );
 }
 
 TracksScene* AbstractGraphicsMediaItem::scene()
@@ -62,6 +66,7 @@ void AbstractGraphicsMediaItem::setWidth( qint64 width )
 {
     prepareGeometryChange();
     m_width = width;
+    updateTrackIndex();
 }
 
 void AbstractGraphicsMediaItem::setHeight( qint64 height )
@@ -201,6 +206,28 @@ void AbstractGraphicsMediaItem::contextMenuEvent( QGraphicsSceneContextMenuEvent
 void AbstractGraphicsMediaItem::setStartPos( qint64 position )
 {
     QGraphicsItem::setPos( (qreal)position, 0 );
+    updateTrackIndex();
+}
+
+void AbstractGraphicsMediaItem::updateTrackIndex()
+{
+    GraphicsTrack* track = qgraphicsitem_cast<GraphicsTrack*>( parentItem() );
+    if ( track )
+        track->indexItem( this );
+}
+
+QVariant AbstractGraphicsMediaItem::itemChange( GraphicsItemChange change, const QVariant& value )
+{
+    // Keep the items indexed by the track they belong to
+    if ( change == ItemParentChange )
+    {
+        GraphicsTrack* track = qgraphicsitem_cast<GraphicsTrack*>( parentItem() );
+        if ( track )
+            track->unindexItem( this );
+    }
+    else if ( change == ItemParentHasChanged )
+        updateTrackIndex();
+    return QGraphicsItem::itemChange( change, value );
 }
 
 qint64 AbstractGraphicsMediaItem::startPos()
@@ -127,6 +127,7 @@ protected:
     void setHeight( qint64 height );
 
     virtual void contextMenuEvent( QGraphicsSceneContextMenuEvent* event );
+    virtual QVariant itemChange( GraphicsItemChange change, const QVariant& value );
 
 protected slots:
     /**
@@ -144,6 +145,9 @@ protected slots:
     QColor itemColor();
 
 private:
+    /// Update the position of the item in its track's index.
+    void updateTrackIndex();
+
     /// This pointer will be set when inserted in the tracksView.
     TracksView* m_tracksView;
 
@@ -0,0 +1,478 @@
+/*****************************************************************************
+ * FilmstripCache.cpp: Cache of the timeline's filmstrip thumbnails
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "FilmstripCache.h"
+#include "Media.h"
+#include "MediaPlayerPool.h"
+#include "VLCMedia.h"
+#include "VLCMediaPlayer.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QTime>
+#include <QWaitCondition>
+
+#include <cstdio>
+
+FilmstripCache::Worker::Worker( FilmstripCache* cache ) :
+        m_cache( cache )
+{
+}
+
+void
+FilmstripCache::Worker::run()
+{
+    m_cache->process();
+}
+
+FilmstripCache::FilmstripCache() :
+        m_running( false ),
+        m_stopped( false ),
+        m_diskSize( 0 ),
+        m_diskInitialized( false ),
+        m_frameBuffer( NULL ),
+        m_frameBufferSize( 0 ),
+        m_firstPts( -1 ),
+        m_lastPts( -1 ),
+        m_decodeError( false ),
+        m_decodeEnded( false )
+{
+    m_tiles.setMaxCost( MemoryBudget );
+    m_worker = new Worker( this );
+    m_jobsMutex = new QMutex;
+    m_frameMutex = new QMutex;
+    m_frameCond = new QWaitCondition;
+}
+
+FilmstripCache::~FilmstripCache()
+{
+    m_stopped = true;
+    {
+        QMutexLocker    lock( m_jobsMutex );
+        m_jobs.clear();
+        m_pending.clear();
+    }
+    {
+        //Don't wait for the thumbnail being decoded.
+        QMutexLocker    lock( m_frameMutex );
+        m_frameCond->wakeAll();
+    }
+    m_worker->wait();
+    delete m_worker;
+    delete m_frameCond;
+    delete m_frameMutex;
+    delete m_jobsMutex;
+    delete[] m_frameBuffer;
+}
+
+bool
+FilmstripCache::hasFilmstrip( const Media* media )
+{
+    return ( media->fileType() == Media::Video &&
+             media->inputType() == Media::File &&
+             media->fileInfo() != NULL &&
+             media->fps() > 0 && media->nbFrames() > 0 );
+}
+
+int
+FilmstripCache::thumbnailWidth( const Media* media, int height /*= ThumbnailHeight*/ )
+{
+    double  ratio = 16. / 9.;
+
+    if ( media->width() > 0 && media->height() > 0 )
+        ratio = (double)media->width() / media->height();
+    //Keep an even width, as expected by most of the chromas.
+    return qMax( 2, qRound( height * ratio ) & ~1 );
+}
+
+int
+FilmstripCache::level( double pixelsPerFrame, double thumbnailWidth )
+{
+    int     level = 0;
+
+    while ( level < MaxLevel && ( (qint64)1 << level ) * pixelsPerFrame < thumbnailWidth )
+        ++level;
+    return level;
+}
+
+QString
+FilmstripCache::mediaKey( const Media* media )
+{
+    QHash<QUuid, QString>::const_iterator   it = m_mediaKeys.constFind( media->uuid() );
+
+    if ( it != m_mediaKeys.constEnd() )
+        return it.value();
+    QCryptographicHash  hash( QCryptographicHash::Md5 );
+    const QFileInfo*    fileInfo = media->fileInfo();
+
+    hash.addData( fileInfo->absoluteFilePath().toUtf8() );
+    hash.addData( QByteArray::number( fileInfo->size() ) );
+    hash.addData( QByteArray::number( fileInfo->lastModified().toTime_t() ) );
+    QString             key = hash.result().toHex();
+    m_mediaKeys.insert( media->uuid(), key );
+    return key;
+}
+
+const QPixmap*
+FilmstripCache::tile( const Media* media, int level, qint64 index )
+{
+    QString     key = QString( "%1-%2-%3" ).arg( mediaKey( media ) ).arg( level ).arg( index );
+    QPixmap*    pixmap = m_tiles.object( key );
+
+    if ( pixmap == NULL && m_failed.contains( key ) == false )
+        request( media, level, index, key );
+    return pixmap;
+}
+
+void
+FilmstripCache::request( const Media* media, int level, qint64 index, const QString& key )
+{
+    QMutexLocker    lock( m_jobsMutex );
+
+    if ( m_pending.contains( key ) == true )
+    {
+        //The tile is still wanted: move it to the end, so that it's loaded sooner.
+        for ( int i = m_jobs.size() - 1; i >= 0; --i )
+        {
+            if ( m_jobs.at( i ).key == key )
+            {
+                m_jobs.move( i, m_jobs.size() - 1 );
+                break ;
+            }
+        }
+        return ;
+    }
+    Job     job;
+    job.key = key;
+    job.mediaUuid = media->uuid();
+    job.mrl = media->mrl();
+    job.fps = media->fps();
+    job.nbFrames = media->nbFrames();
+    job.thumbnailWidth = thumbnailWidth( media );
+    job.level = level;
+    job.index = index;
+    m_jobs.append( job );
+    m_pending.insert( key );
+    //The oldest requests are probably not visible anymore.
+    if ( m_jobs.size() > MaxPendingTiles )
+        m_pending.remove( m_jobs.takeFirst().key );
+    if ( m_running == false )
+    {
+        //The worker may still be returning from its last run.
+        m_worker->wait();
+        m_running = true;
+        m_worker->start( QThread::LowPriority );
+    }
+}
+
+void
+FilmstripCache::process()
+{
+    forever
+    {
+        Job     job;
+        {
+            QMutexLocker    lock( m_jobsMutex );
+            if ( m_jobs.isEmpty() == true || m_stopped == true )
+            {
+                m_running = false;
+                return ;
+            }
+            job = m_jobs.takeLast();
+        }
+        bool    failed;
+        QImage  tile = loadTile( job, failed );
+        QMetaObject::invokeMethod( this, "tileLoaded", Qt::QueuedConnection,
+                                   Q_ARG( QString, job.key ),
+                                   Q_ARG( QString, job.mediaUuid.toString() ),
+                                   Q_ARG( QImage, tile ),
+                                   Q_ARG( bool, failed ) );
+    }
+}
+
+QImage
+FilmstripCache::loadTile( const Job& job, bool& failed )
+{
+    failed = false;
+    if ( m_diskInitialized == false )
+        initDiskCache();
+
+    QHash<QString, DiskEntry>::iterator     it = m_diskEntries.find( job.key );
+    QString                                 fileName = m_diskDirectory + '/' + job.key + ".png";
+    if ( it != m_diskEntries.end() )
+    {
+        QImage  tile( fileName );
+        if ( tile.isNull() == false )
+        {
+            it.value().lastUse = QDateTime::currentDateTime().toTime_t();
+            return tile;
+        }
+        QFile::remove( fileName );
+        m_diskSize -= it.value().size;
+        m_diskEntries.erase( it );
+    }
+
+    QImage      tile( TileThumbnails * job.thumbnailWidth, ThumbnailHeight, QImage::Format_RGB32 );
+    qint64      nbThumbnails = qMin( (qint64)TileThumbnails,
+                                     ( ( job.nbFrames - 1 ) >> job.level ) - job.index * TileThumbnails + 1 );
+
+    tile.fill( 0 );
+    int         nbDecoded = decodeTile( job, tile, failed );
+    if ( nbDecoded == 0 || m_stopped == true )
+        return QImage();
+    //An incomplete tile is drawn, but not kept on the disk.
+    if ( nbDecoded == nbThumbnails )
+        storeTile( job.key, tile );
+    return tile;
+}
+
+int
+FilmstripCache::decodeTile( const Job& job, QImage& tile, bool& failed )
+{
+    char                    buffer[64];
+    qint64                  firstFrame = ( job.index * TileThumbnails ) << job.level;
+    LibVLCpp::Media*        vlcMedia = new LibVLCpp::Media( job.mrl );
+    LibVLCpp::MediaPlayer*  mediaPlayer = MediaPlayerPool::getInstance()->get();
+
+    vlcMedia->addOption( ":no-audio" );
+    vlcMedia->addOption( ":no-sout-audio" );
+    vlcMedia->addOption( ":sout=#transcode{}:smem" );
+    vlcMedia->setVideoDataCtx( this );
+    vlcMedia->setVideoLockCallback( reinterpret_cast<void*>( &FilmstripCache::lock ) );
+    vlcMedia->setVideoUnlockCallback( reinterpret_cast<void*>( &FilmstripCache::unlock ) );
+    vlcMedia->addOption( ":sout-transcode-vcodec=RV24" );
+    vlcMedia->addOption( ":no-sout-smem-time-sync" );
+    sprintf( buffer, ":sout-transcode-width=%i", job.thumbnailWidth );
+    vlcMedia->addOption( buffer );
+    sprintf( buffer, ":sout-transcode-height=%i", ThumbnailHeight );
+    vlcMedia->addOption( buffer );
+    sprintf( buffer, ":start-time=%f", firstFrame / job.fps );
+    vlcMedia->addOption( buffer );
+
+    m_frameMutex->lock();
+    m_thumbnailTimes.clear();
+    m_thumbnails.clear();
+    for ( int i = 0; i < TileThumbnails; ++i )
+    {
+        qint64  frame = firstFrame + ( (qint64)i << job.level );
+        if ( frame >= job.nbFrames )
+            break ;
+        m_thumbnailTimes.append( (qint64)( ( frame - firstFrame ) * 1000000. / job.fps ) );
+    }
+    m_firstPts = -1;
+    m_lastPts = -1;
+    m_decodeError = false;
+    m_decodeEnded = false;
+    m_frameMutex->unlock();
+
+    connect( mediaPlayer, SIGNAL( errorEncountered() ), this, SLOT( decodeError() ),
+             Qt::DirectConnection );
+    connect( mediaPlayer, SIGNAL( endReached() ), this, SLOT( decodeEnded() ),
+             Qt::DirectConnection );
+    mediaPlayer->setMedia( vlcMedia );
+    mediaPlayer->play();
+
+    QPainter    painter( &tile );
+    int         nbDecoded = 0;
+    forever
+    {
+        qint64  seekTime = -1;
+        {
+            QMutexLocker    lock( m_frameMutex );
+            QTime           timer;
+
+            timer.start();
+            while ( m_thumbnails.size() == nbDecoded &&
+                    m_decodeError == false && m_decodeEnded == false &&
+                    m_stopped == false && timer.elapsed() < DecodeTimeout )
+                m_frameCond->wait( m_frameMutex, DecodeTimeout - timer.elapsed() );
+            //Nothing could be decoded from the media: it won't get any better.
+            if ( m_decodeError == true || ( m_decodeEnded == true && m_thumbnails.isEmpty() == true ) )
+                failed = true;
+            for ( ; nbDecoded < m_thumbnails.size(); ++nbDecoded )
+                painter.drawImage( QRect( nbDecoded * job.thumbnailWidth, 0,
+                                          job.thumbnailWidth, ThumbnailHeight ),
+                                   m_thumbnails.at( nbDecoded ) );
+            //A timeout isn't a failure: the tile will be requested again.
+            if ( nbDecoded == m_thumbnailTimes.size() || failed == true ||
+                 m_decodeEnded == true || m_stopped == true || timer.elapsed() >= DecodeTimeout )
+                break ;
+            qint64  next = m_thumbnailTimes.at( nbDecoded );
+            if ( next - ( m_lastPts - m_firstPts ) > SeekThreshold * 1000 )
+                seekTime = (qint64)( firstFrame / job.fps * 1000 ) + next / 1000;
+        }
+        //Not while locked, as the decoder may be waiting for the lock.
+        if ( seekTime >= 0 )
+            mediaPlayer->setTime( seekTime );
+    }
+    painter.end();
+    mediaPlayer->stop();
+    disconnect( mediaPlayer, SIGNAL( errorEncountered() ), this, SLOT( decodeError() ) );
+    disconnect( mediaPlayer, SIGNAL( endReached() ), this, SLOT( decodeEnded() ) );
+    MediaPlayerPool::getInstance()->release( mediaPlayer );
+    delete vlcMedia;
+    //The player is stopped, so the callbacks won't be called anymore.
+    return nbDecoded;
+}
+
+void
+FilmstripCache::lock( FilmstripCache* cache, void** pp_ret, int size )
+{
+    if ( cache->m_frameBufferSize < size )
+    {
+        delete[] cache->m_frameBuffer;
+        cache->m_frameBuffer = new uchar[size];
+        cache->m_frameBufferSize = size;
+    }
+    *pp_ret = cache->m_frameBuffer;
+}
+
+void
+FilmstripCache::unlock( FilmstripCache* cache, void* buffer, int width,
+                        int height, int bpp, int size, qint64 pts )
+{
+    Q_UNUSED( bpp );
+    Q_UNUSED( size );
+    Q_UNUSED( pts );
+    QMutexLocker    lock( cache->m_frameMutex );
+
+    if ( cache->m_firstPts < 0 )
+        cache->m_firstPts = pts;
+    cache->m_lastPts = pts;
+    //Frames decoded before a seek, or between two thumbnails, are skipped.
+    int     index = cache->m_thumbnails.size();
+    if ( index >= cache->m_thumbnailTimes.size() ||
+         pts - cache->m_firstPts < cache->m_thumbnailTimes.at( index ) )
+        return ;
+    //RV24 is stored as BGR
+    QImage  frame = QImage( reinterpret_cast<const uchar*>( buffer ), width, height,
+                            width * 3, QImage::Format_RGB888 ).rgbSwapped();
+    //A frame may stand for several thumbnails, when frames are missing.
+    while ( index < cache->m_thumbnailTimes.size() &&
+            pts - cache->m_firstPts >= cache->m_thumbnailTimes.at( index ) )
+    {
+        cache->m_thumbnails.append( frame );
+        ++index;
+    }
+    cache->m_frameCond->wakeAll();
+}
+
+void
+FilmstripCache::decodeError()
+{
+    QMutexLocker    lock( m_frameMutex );
+
+    m_decodeError = true;
+    m_frameCond->wakeAll();
+}
+
+void
+FilmstripCache::decodeEnded()
+{
+    QMutexLocker    lock( m_frameMutex );
+
+    m_decodeEnded = true;
+    m_frameCond->wakeAll();
+}
+
+void
+FilmstripCache::initDiskCache()
+{
+    m_diskInitialized = true;
+    m_diskDirectory = QDesktopServices::storageLocation( QDesktopServices::CacheLocation );
+    if ( m_diskDirectory.isEmpty() == true )
+        m_diskDirectory = QDir::tempPath() + "/vlmc";
+    m_diskDirectory += "/filmstrip";
+    QDir().mkpath( m_diskDirectory );
+
+    QDir    directory( m_diskDirectory );
+    foreach ( const QFileInfo& fileInfo,
+              directory.entryInfoList( QStringList() << "*.png", QDir::Files ) )
+    {
+        DiskEntry   entry;
+        entry.size = fileInfo.size();
+        entry.lastUse = fileInfo.lastModified().toTime_t();
+        m_diskEntries.insert( fileInfo.completeBaseName(), entry );
+        m_diskSize += entry.size;
+    }
+    trimDiskCache();
+}
+
+void
+FilmstripCache::storeTile( const QString& key, const QImage& tile )
+{
+    QString     fileName = m_diskDirectory + '/' + key + ".png";
+
+    if ( tile.save( fileName, "PNG" ) == false )
+        return ;
+    DiskEntry   entry;
+    entry.size = QFileInfo( fileName ).size();
+    entry.lastUse = QDateTime::currentDateTime().toTime_t();
+    m_diskEntries.insert( key, entry );
+    m_diskSize += entry.size;
+    trimDiskCache();
+}
+
+void
+FilmstripCache::trimDiskCache()
+{
+    while ( m_diskSize > DiskBudget && m_diskEntries.isEmpty() == false )
+    {
+        QHash<QString, DiskEntry>::iterator     it = m_diskEntries.begin();
+        QHash<QString, DiskEntry>::iterator     end = m_diskEntries.end();
+        QHash<QString, DiskEntry>::iterator     oldest = it;
+
+        for ( ; it != end; ++it )
+        {
+            if ( it.value().lastUse < oldest.value().lastUse )
+                oldest = it;
+        }
+        QFile::remove( m_diskDirectory + '/' + oldest.key() + ".png" );
+        m_diskSize -= oldest.value().size;
+        m_diskEntries.erase( oldest );
+    }
+}
+
+void
+FilmstripCache::tileLoaded( const QString& key, const QString& mediaUuid,
+                            const QImage& tile, bool failed )
+{
+    {
+        QMutexLocker    lock( m_jobsMutex );
+        m_pending.remove( key );
+    }
+    if ( failed == true )
+        m_failed.insert( key );
+    if ( tile.isNull() == true )
+        return ;
+    m_tiles.insert( key, new QPixmap( QPixmap::fromImage( tile ) ),
+                    tile.width() * tile.height() * 4 );
+    emit tileReady( QUuid( mediaUuid ) );
+}
@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * FilmstripCache.h: Cache of the timeline's filmstrip thumbnails
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef FILMSTRIPCACHE_H
+#define FILMSTRIPCACHE_H
+
+#include "Singleton.hpp"
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QThread>
+#include <QUuid>
+
+class   QMutex;
+class   QWaitCondition;
+
+class   Media;
+
+/**
+ *  \brief  Thumbnails of the video medias, as drawn in the timeline.
+ *
+ *  The thumbnails are grouped by tiles of TileThumbnails consecutive
+ *  thumbnails. The thumbnails of the level n are 2^n frames apart, so that
+ *  the timeline can pick the level matching its zoom.
+ *
+ *  Requesting a tile never blocks: the missing tiles are loaded from the
+ *  disk cache or decoded by a worker thread, most recent requests first,
+ *  and tileReady() is emitted once they can be drawn. A tile is decoded by
+ *  a single player, that seeks between the thumbnails when they're far
+ *  apart. The decoded tiles are kept in a memory cache and in a disk cache,
+ *  both bounded in size, and evicting the least recently used tiles first.
+ *  Only the tiles of the medias that can't be decoded are never requested
+ *  again: a tile that timed out is decoded again the next time it's drawn.
+ */
+class   FilmstripCache : public QObject, public Singleton<FilmstripCache>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( FilmstripCache );
+
+    public:
+        /// Number of thumbnails in a tile.
+        static const int        TileThumbnails = 8;
+        /// Height of the decoded thumbnails, in pixels.
+        static const int        ThumbnailHeight = 32;
+        static const int        MaxLevel = 24;
+        /// Size of the memory cache, in bytes.
+        static const int        MemoryBudget = 32 * 1024 * 1024;
+        /// Size of the disk cache, in bytes.
+        static const qint64     DiskBudget = 256 * 1024 * 1024;
+        /// Number of pending requests after which the oldest ones are dropped.
+        static const int        MaxPendingTiles = 64;
+        /// Time given to libvlc to decode a thumbnail, in ms.
+        static const int        DecodeTimeout = 5000;
+        /// Distance from which the next thumbnail is sought rather than decoded to, in ms.
+        static const int        SeekThreshold = 2000;
+
+        /**
+         *  \return true if media can have thumbnails.
+         */
+        static bool             hasFilmstrip( const Media* media );
+        /**
+         *  \return The width of the thumbnails of media, for a given height.
+         */
+        static int              thumbnailWidth( const Media* media, int height = ThumbnailHeight );
+        /**
+         *  \brief  Get the level whose thumbnails are at least thumbnailWidth
+         *          pixels apart.
+         */
+        static int              level( double pixelsPerFrame, double thumbnailWidth );
+        /**
+         *  \brief  Get a tile of thumbnails, without blocking.
+         *
+         *  The thumbnail i of the tile shows the frame
+         *  ( index * TileThumbnails + i ) << level of the media.
+         *  \return The tile, or NULL if it isn't available yet, in which case
+         *          it is requested. The pointer is only valid until the
+         *          control returns to the event loop.
+         */
+        const QPixmap*          tile( const Media* media, int level, qint64 index );
+
+    private:
+        FilmstripCache();
+        ~FilmstripCache();
+
+        struct  Job
+        {
+            QString     key;
+            QUuid       mediaUuid;
+            QString     mrl;
+            float       fps;
+            qint64      nbFrames;
+            int         thumbnailWidth;
+            int         level;
+            qint64      index;
+        };
+        struct  DiskEntry
+        {
+            qint64      size;
+            uint        lastUse;
+        };
+
+        class   Worker : public QThread
+        {
+            public:
+                Worker( FilmstripCache* cache );
+            protected:
+                virtual void    run();
+            private:
+                FilmstripCache* m_cache;
+        };
+
+        /// Identifies a media file on the disk, whatever its uuid in a project.
+        QString                 mediaKey( const Media* media );
+        void                    request( const Media* media, int level, qint64 index,
+                                         const QString& key );
+        /// Process the jobs until the queue is empty. Runs in the worker thread.
+        void                    process();
+        /**
+         *  \param  failed  Set to true if the media can't be decoded, in
+         *                  which case the tile won't be requested again.
+         */
+        QImage                  loadTile( const Job& job, bool& failed );
+        /**
+         *  \brief  Decode the thumbnails of a tile, in order.
+         *  \return The number of thumbnails drawn in the tile.
+         */
+        int                     decodeTile( const Job& job, QImage& tile, bool& failed );
+        void                    initDiskCache();
+        void                    storeTile( const QString& key, const QImage& tile );
+        void                    trimDiskCache();
+
+        static void             lock( FilmstripCache* cache, void** pp_ret, int size );
+        static void             unlock( FilmstripCache* cache, void* buffer, int width,
+                                        int height, int bpp, int size, qint64 pts );
+
+    private:
+        QCache<QString, QPixmap>    m_tiles;
+        /// The tiles of the medias that can't be decoded, not to request them again.
+        QSet<QString>               m_failed;
+        QHash<QUuid, QString>       m_mediaKeys;
+
+        Worker*                     m_worker;
+        QMutex*                     m_jobsMutex;
+        /// The most recent requests are at the end of the list.
+        QList<Job>                  m_jobs;
+        QSet<QString>               m_pending;
+        bool                        m_running;
+        volatile bool               m_stopped;
+
+        /// The following members are only used by the worker thread.
+        QString                     m_diskDirectory;
+        QHash<QString, DiskEntry>   m_diskEntries;
+        qint64                      m_diskSize;
+        bool                        m_diskInitialized;
+
+        /// The following members are shared with the libvlc callbacks.
+        QMutex*                     m_frameMutex;
+        QWaitCondition*             m_frameCond;
+        uchar*                      m_frameBuffer;
+        int                         m_frameBufferSize;
+        /// Time of each thumbnail of the tile from the first one, in µs.
+        QList<qint64>               m_thumbnailTimes;
+        /// The decoded thumbnails, in the same order.
+        QList<QImage>               m_thumbnails;
+        /// Timestamp of the first decoded frame, or -1.
+        qint64                      m_firstPts;
+        qint64                      m_lastPts;
+        bool                        m_decodeError;
+        bool                        m_decodeEnded;
+
+        friend class                Singleton<FilmstripCache>;
+
+    private slots:
+        void                        tileLoaded( const QString& key, const QString& mediaUuid,
+                                                const QImage& tile, bool failed );
+        /// Called by the libvlc threads.
+        void                        decodeError();
+        void                        decodeEnded();
+
+    signals:
+        /**
+         *  \brief  Emitted when a tile of a media becomes available.
+         */
+        void                        tileReady( const QUuid& mediaUuid );
+};
+
+#endif // FILMSTRIPCACHE_H
@@ -25,9 +25,12 @@
 #include <QLinearGradient>
 #include <QDebug>
 #include <QTime>
+#include <QVector>
+#include <cmath>
 #include "GraphicsAudioItem.h"
 #include "TracksView.h"
 #include "Timeline.h"
+#include "Waveform.h"
 
 GraphicsAudioItem::GraphicsAudioItem( Clip* clip ) : m_clip( clip )
 {
@@ -45,6 +48,9 @@ GraphicsAudioItem::GraphicsAudioItem( Clip* clip ) : m_clip( clip )
     setWidth( clip->length() );
     // Automatically adjust future changes
     connect( clip, SIGNAL( lengthUpdated() ), this, SLOT( adjustLength() ) );
+    // Repaint once the peaks of the media are known
+    connect( clip->getParent(), SIGNAL( audioSpectrumComputed( const QUuid& ) ),
+             this, SLOT( waveformComputed() ) );
 }
 
 GraphicsAudioItem::~GraphicsAudioItem()
@@ -62,6 +68,10 @@ void GraphicsAudioItem::paint( QPainter* painter, const QStyleOptionGraphicsItem
     paintRect( painter, option );
     painter->restore();
 
+    painter->save();
+    paintWaveform( painter, option );
+    painter->restore();
+
     painter->save();
     paintTitle( painter, option );
     painter->restore();
@@ -143,6 +153,68 @@ void GraphicsAudioItem::paintRect( QPainter* painter, const QStyleOptionGraphics
         setZValue( Z_NOT_SELECTED );
 }
 
+void GraphicsAudioItem::paintWaveform( QPainter* painter, const QStyleOptionGraphicsItem* option )
+{
+    Media* media = m_clip->getParent();
+    const Waveform* waveform = media->waveform();
+
+    if ( waveform == NULL || waveform->nbSamples() == 0 || media->fps() <= 0 )
+        return;
+
+    // Disable the matrix transformations
+    painter->setWorldMatrixEnabled( false );
+
+    // Only the exposed columns are computed, whatever the zoom level
+    QRectF exposed = option->exposedRect & boundingRect();
+    QTransform viewPortTransform = Timeline::getInstance()->tracksView()->viewportTransform();
+    QRectF mapped = deviceTransform( viewPortTransform ).mapRect( exposed );
+    int nbPixels = qRound( mapped.width() );
+    if ( nbPixels <= 0 )
+        return;
+
+    double samplesPerFrame = waveform->rate() / media->fps();
+    double firstSample = ( m_clip->begin() + exposed.left() ) * samplesPerFrame;
+    double samplesPerPixel = exposed.width() * samplesPerFrame / nbPixels;
+
+    // Merge the channels into a single envelope
+    QVector<Waveform::Peak> envelope( nbPixels );
+    QVector<Waveform::Peak> peaks( nbPixels );
+    QVector<double> squares( nbPixels, 0. );
+    for ( unsigned int channel = 0; channel < waveform->channels(); ++channel )
+    {
+        Waveform::Peak* output = channel == 0 ? envelope.data() : peaks.data();
+        waveform->peaks( channel, firstSample, samplesPerPixel, nbPixels, output );
+        for ( int i = 0; i < nbPixels; ++i )
+        {
+            envelope[i].min = qMin( envelope[i].min, output[i].min );
+            envelope[i].max = qMax( envelope[i].max, output[i].max );
+            squares[i] += (double)output[i].rms * output[i].rms;
+        }
+    }
+
+    QRectF area = mapped.adjusted( 0, 4, 0, -4 );
+    qreal center = area.center().y();
+    qreal peakScale = area.height() / 2 / 32767.;
+    qreal rmsScale = area.height() / 2 / 65535.;
+    QVector<QLineF> peakLines;
+    QVector<QLineF> rmsLines;
+    peakLines.reserve( nbPixels );
+    rmsLines.reserve( nbPixels );
+    for ( int i = 0; i < nbPixels; ++i )
+    {
+        qreal x = mapped.left() + i + 0.5;
+        qreal rms = sqrt( squares[i] / waveform->channels() ) * rmsScale;
+        peakLines.append( QLineF( x, center - envelope[i].max * peakScale,
+                                  x, center - envelope[i].min * peakScale ) );
+        rmsLines.append( QLineF( x, center - rms, x, center + rms ) );
+    }
+
+    painter->setPen( QColor::fromRgb( 79, 106, 25 ) );
+    painter->drawLines( peakLines );
+    painter->setPen( QColor::fromRgb( 115, 155, 36 ) );
+    painter->drawLines( rmsLines );
+}
+
 void GraphicsAudioItem::paintTitle( QPainter* painter, const QStyleOptionGraphicsItem* option )
 {
     Q_UNUSED( option );
@@ -170,6 +242,11 @@ void GraphicsAudioItem::paintTitle( QPainter* painter, const QStyleOptionGraphic
     painter->drawText( mapped, Qt::AlignVCenter, fm.elidedText( text, Qt::ElideRight, mapped.width() ) );
 }
 
+void GraphicsAudioItem::waveformComputed()
+{
+    update();
+}
+
 void GraphicsAudioItem::hoverEnterEvent( QGraphicsSceneHoverEvent* event )
 {
     TracksView* tv = Timeline::getInstance()->tracksView();
@@ -69,6 +69,12 @@ protected:
      * \param option Painting options.
      */
     void                paintTitle( QPainter* painter, const QStyleOptionGraphicsItem* option );
+    /**
+     * \brief Paint the peaks of the exposed area, from the media's waveform.
+     * \param painter Pointer to a QPainter.
+     * \param option Painting options.
+     */
+    void                paintWaveform( QPainter* painter, const QStyleOptionGraphicsItem* option );
     virtual void        hoverEnterEvent( QGraphicsSceneHoverEvent* event );
     virtual void        hoverLeaveEvent( QGraphicsSceneHoverEvent* event );
     virtual void        hoverMoveEvent( QGraphicsSceneHoverEvent* event );
@@ -78,6 +84,9 @@ protected:
 private:
     Clip*               m_clip;
 
+private slots:
+    void                waveformComputed();
+
 signals:
     /**
      * \brief Emitted when the item detect a cut request.
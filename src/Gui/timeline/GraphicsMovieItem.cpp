@@ -25,7 +25,9 @@
 #include <QDebug>
 #include <QTime>
 #include <QFontMetrics>
+#include <cmath>
 #include "GraphicsMovieItem.h"
+#include "FilmstripCache.h"
 #include "TracksView.h"
 #include "Timeline.h"
 
@@ -45,6 +47,9 @@ GraphicsMovieItem::GraphicsMovieItem( Clip* clip ) : m_clip( clip )
     setWidth( clip->length() );
     // Automatically adjust for future changes
     connect( clip, SIGNAL( lengthUpdated() ), this, SLOT( adjustLength() ) );
+    // Repaint when a missing thumbnail is decoded
+    connect( FilmstripCache::getInstance(), SIGNAL( tileReady( const QUuid& ) ),
+             this, SLOT( tileReady( const QUuid& ) ) );
 }
 
 GraphicsMovieItem::~GraphicsMovieItem()
@@ -62,6 +67,10 @@ void GraphicsMovieItem::paint( QPainter* painter, const QStyleOptionGraphicsItem
     paintRect( painter, option );
     painter->restore();
 
+    painter->save();
+    paintFilmstrip( painter, option );
+    painter->restore();
+
     painter->save();
     paintTitle( painter, option );
     painter->restore();
@@ -142,6 +151,54 @@ void GraphicsMovieItem::paintRect( QPainter* painter, const QStyleOptionGraphics
         setZValue( Z_NOT_SELECTED );
 }
 
+void GraphicsMovieItem::paintFilmstrip( QPainter* painter, const QStyleOptionGraphicsItem* option )
+{
+    Media* media = m_clip->getParent();
+    if ( FilmstripCache::hasFilmstrip( media ) == false || boundingRect().width() <= 0 )
+        return;
+
+    // Disable the matrix transformations
+    painter->setWorldMatrixEnabled( false );
+
+    // Get the transformations required to map the thumbnails on the viewport
+    QTransform viewPortTransform = Timeline::getInstance()->tracksView()->viewportTransform();
+    QTransform transform = deviceTransform( viewPortTransform );
+    QRectF mapped = transform.mapRect( boundingRect() );
+    QRectF inner = mapped.adjusted( 1, 1, -1, -1 );
+    // Only the tiles of the exposed area are drawn or requested
+    QRectF exposed = transform.mapRect( option->exposedRect & boundingRect() ) & inner;
+    if ( exposed.isEmpty() )
+        return;
+
+    qreal pixelsPerFrame = mapped.width() / boundingRect().width();
+    qreal thumbnailWidth = FilmstripCache::thumbnailWidth( media, qRound( inner.height() ) );
+    int level = FilmstripCache::level( pixelsPerFrame, thumbnailWidth );
+    qint64 first = (qint64)floor( ( exposed.left() - inner.left() ) / thumbnailWidth );
+    qint64 last = (qint64)floor( ( exposed.right() - inner.left() ) / thumbnailWidth );
+    FilmstripCache* cache = FilmstripCache::getInstance();
+
+    painter->setClipRect( exposed );
+    for ( qint64 slot = first; slot <= last; ++slot )
+    {
+        // Each slot shows the last thumbnail of the level before its first frame
+        qint64 frame = m_clip->begin() + (qint64)( slot * thumbnailWidth / pixelsPerFrame );
+        qint64 thumbnail = frame >> level;
+        if ( ( thumbnail << level ) >= media->nbFrames() )
+            break;
+
+        const QPixmap* tile = cache->tile( media, level,
+                                           thumbnail / FilmstripCache::TileThumbnails );
+        if ( tile == NULL )
+            continue;
+        qreal sourceWidth = (qreal)tile->width() / FilmstripCache::TileThumbnails;
+        int position = thumbnail % FilmstripCache::TileThumbnails;
+        painter->drawPixmap( QRectF( inner.left() + slot * thumbnailWidth, inner.top(),
+                                     thumbnailWidth, inner.height() ),
+                             *tile,
+                             QRectF( position * sourceWidth, 0, sourceWidth, tile->height() ) );
+    }
+}
+
 void GraphicsMovieItem::paintTitle( QPainter* painter, const QStyleOptionGraphicsItem* option )
 {
     Q_UNUSED( option );
@@ -169,6 +226,12 @@ void GraphicsMovieItem::paintTitle( QPainter* painter, const QStyleOptionGraphic
     painter->drawText( mapped, Qt::AlignVCenter, fm.elidedText( text, Qt::ElideRight, mapped.width() ) );
 }
 
+void GraphicsMovieItem::tileReady( const QUuid& mediaUuid )
+{
+    if ( mediaUuid == m_clip->getParent()->uuid() )
+        update();
+}
+
 void GraphicsMovieItem::hoverEnterEvent( QGraphicsSceneHoverEvent* event )
 {
     TracksView* tv = Timeline::getInstance()->tracksView();
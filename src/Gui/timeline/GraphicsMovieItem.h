@@ -68,6 +68,14 @@ protected:
      * \param option Painting options.
      */
     void                paintTitle( QPainter* painter, const QStyleOptionGraphicsItem* option );
+    /**
+     * \brief Paint the thumbnails of the exposed area.
+     * \details Only the thumbnails already decoded are drawn, the missing
+     * ones are requested to the FilmstripCache.
+     * \param painter Pointer to a QPainter.
+     * \param option Painting options.
+     */
+    void                paintFilmstrip( QPainter* painter, const QStyleOptionGraphicsItem* option );
     virtual void        hoverEnterEvent( QGraphicsSceneHoverEvent* event );
     virtual void        hoverLeaveEvent( QGraphicsSceneHoverEvent* event );
     virtual void        hoverMoveEvent( QGraphicsSceneHoverEvent* event );
@@ -77,6 +85,9 @@ protected:
 private:
     Clip*               m_clip;
 
+private slots:
+    void                tileReady( const QUuid& mediaUuid );
+
 signals:
     /**
      * \brief Emitted when the item detect a cut request.
@@ -83,17 +83,87 @@ GraphicsTrack::mediaType()
 
 QList<AbstractGraphicsMediaItem*>
 GraphicsTrack::childs()
+{
+    return m_items.values();
+}
+
+QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator
+GraphicsTrack::lowerBound( qint64 frame ) const
+{
+    // The items of a track don't overlap, as findPosition() ensures: only the
+    // last ones starting before the frame can reach it.
+    QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator it = m_items.upperBound( frame );
+    if ( it == m_items.constBegin() )
+        return it;
+    --it;
+    return m_items.lowerBound( it.key() );
+}
+
+QList<AbstractGraphicsMediaItem*>
+GraphicsTrack::items( qint64 begin, qint64 end, const AbstractGraphicsMediaItem* ignore ) const
 {
     QList<AbstractGraphicsMediaItem*> list;
-    QList<QGraphicsItem*> items = childItems();
-    AbstractGraphicsMediaItem* item;
+    QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator it = lowerBound( begin );
 
-    for ( int i = 0; i < items.count(); ++i )
+    for ( ; it != m_items.constEnd() && it.key() < end; ++it )
     {
-        item = dynamic_cast<AbstractGraphicsMediaItem*>( items.at( i ) );
-        if ( !item )
+        if ( it.value() == ignore )
             continue;
-        list.append( item );
+        if ( it.key() + m_intervals.value( it.value() ).length > begin )
+            list.append( it.value() );
     }
     return list;
 }
+
+AbstractGraphicsMediaItem*
+GraphicsTrack::collidingItem( qint64 begin, qint64 end, const AbstractGraphicsMediaItem* ignore ) const
+{
+    QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator it = lowerBound( begin );
+
+    for ( ; it != m_items.constEnd() && it.key() < end; ++it )
+    {
+        if ( it.value() == ignore )
+            continue;
+        if ( it.key() + m_intervals.value( it.value() ).length > begin )
+            return it.value();
+    }
+    return NULL;
+}
+
+qint64
+GraphicsTrack::end() const
+{
+    qint64 end = 0;
+
+    if ( m_items.isEmpty() )
+        return 0;
+    // Without overlap, the last item to start is the last to end.
+    QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator it =
+            m_items.lowerBound( ( m_items.constEnd() - 1 ).key() );
+    for ( ; it != m_items.constEnd(); ++it )
+        end = qMax( end, it.key() + m_intervals.value( it.value() ).length );
+    return end;
+}
+
+void
+GraphicsTrack::indexItem( AbstractGraphicsMediaItem* item )
+{
+    unindexItem( item );
+
+    Interval interval;
+    interval.begin = item->startPos();
+    interval.length = qRound64( item->boundingRect().width() );
+    m_items.insert( interval.begin, item );
+    m_intervals.insert( item, interval );
+}
+
+void
+GraphicsTrack::unindexItem( AbstractGraphicsMediaItem* item )
+{
+    QHash<AbstractGraphicsMediaItem*, Interval>::iterator it = m_intervals.find( item );
+    if ( it == m_intervals.end() )
+        return;
+
+    m_items.remove( it.value().begin, item );
+    m_intervals.erase( it );
+}
@@ -24,7 +24,9 @@
 #define GRAPHICSTRACK_H
 
 #include <QGraphicsWidget>
+#include <QHash>
 #include <QList>
+#include <QMap>
 #include "MainWorkflow.h"
 
 class AbstractGraphicsMediaItem;
@@ -47,12 +49,56 @@ public:
     MainWorkflow::TrackType mediaType();
     virtual int type() const { return Type; }
 
+    /**
+     * \brief Return the media items of the track, sorted by position.
+     */
     QList<AbstractGraphicsMediaItem*> childs();
+    /**
+     * \brief Return the media items overlapping the [begin;end[ interval.
+     * \param begin The first frame of the interval.
+     * \param end The first frame after the interval.
+     * \param ignore An item to leave out of the result, if any.
+     * \return The items, sorted by position.
+     */
+    QList<AbstractGraphicsMediaItem*> items( qint64 begin, qint64 end,
+                                             const AbstractGraphicsMediaItem* ignore = NULL ) const;
+    /**
+     * \brief Return the first media item overlapping the [begin;end[ interval.
+     * \return The item, or NULL if the interval is free.
+     */
+    AbstractGraphicsMediaItem* collidingItem( qint64 begin, qint64 end,
+                                              const AbstractGraphicsMediaItem* ignore = NULL ) const;
+    /**
+     * \brief Return the frame following the last media item of the track.
+     */
+    qint64 end() const;
 
 private:
+    struct Interval
+    {
+        qint64 begin;
+        qint64 length;
+    };
+
+    /**
+     * \brief Insert an item in the index, or update its interval.
+     * \details Called by the items when their parent, position or width changes.
+     */
+    void indexItem( AbstractGraphicsMediaItem* item );
+    void unindexItem( AbstractGraphicsMediaItem* item );
+    /// The first item that may overlap a frame: the last ones starting before it.
+    QMultiMap<qint64, AbstractGraphicsMediaItem*>::const_iterator lowerBound( qint64 frame ) const;
+
     MainWorkflow::TrackType m_type;
     quint32 m_trackNumber;
     bool m_enabled;
+
+    /// The media items, by start position.
+    QMultiMap<qint64, AbstractGraphicsMediaItem*> m_items;
+    /// The interval each item is indexed at.
+    QHash<AbstractGraphicsMediaItem*, Interval> m_intervals;
+
+    friend class AbstractGraphicsMediaItem;
 };
 
 #endif // GRAPHICSTRACK_H
@@ -24,6 +24,9 @@
 #include <QScrollBar>
 #include <QtDebug>
 #include "Timeline.h"
+#include "FilmstripCache.h"
+#include "MediaPlayerPool.h"
+#include "StillImageCache.h"
 #include "TracksView.h"
 #include "TracksScene.h"
 #include "TracksControls.h"
@@ -119,7 +122,11 @@ Timeline::Timeline( WorkflowRenderer* renderer, QWidget *parent ) :
 
 Timeline::~Timeline()
 {
+    // The thumbnails are decoded using the MediaPlayerPool
+    FilmstripCache::destroyInstance();
     MainWorkflow::destroyInstance();
+    MediaPlayerPool::destroyInstance();
+    StillImageCache::destroyInstance();
 }
 
 void Timeline::changeEvent( QEvent *e )
@@ -35,8 +35,8 @@
 #include <QWheelEvent>
 #include <QGraphicsLinearLayout>
 #include <QGraphicsWidget>
-#include <QGraphicsRectItem>
 #include <QtDebug>
+#include <cmath>
 
 TracksView::TracksView( QGraphicsScene *scene, MainWorkflow *mainWorkflow,
                         WorkflowRenderer *renderer, QWidget *parent )
@@ -248,12 +248,10 @@ TracksView::addMediaItem( Clip *clip, unsigned int track, MainWorkflow::TrackTyp
             addAudioTrack();
     }
     // Is the clip already existing in the timeline ?
-    QList<QGraphicsItem*> trackItems = getTrack( trackType, track )->childItems();;
+    QList<AbstractGraphicsMediaItem*> trackItems = getTrack( trackType, track )->childs();
     for ( int i = 0; i < trackItems.size(); ++i )
     {
-        AbstractGraphicsMediaItem *item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( trackItems.at( i ) );
-        if ( !item || item->uuid() != clip->uuid() ) continue;
+        if ( trackItems.at( i )->uuid() != clip->uuid() ) continue;
         // Item already exist: goodbye!
         return;
     }
@@ -350,13 +348,12 @@ TracksView::dragMoveEvent( QDragMoveEvent *event )
 bool
 TracksView::setItemOldTrack( const QUuid &uuid, quint32 oldTrackNumber )
 {
-    QList<QGraphicsItem*> sceneItems = m_scene->items();
+    QList<AbstractGraphicsMediaItem*> items = mediaItems();
 
-    for ( int i = 0; i < sceneItems.size(); ++i )
+    for ( int i = 0; i < items.size(); ++i )
     {
-        AbstractGraphicsMediaItem* item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( sceneItems.at( i ) );
-        if ( !item || item->uuid() != uuid ) continue;
+        AbstractGraphicsMediaItem* item = items.at( i );
+        if ( item->uuid() != uuid ) continue;
         item->oldTrackNumber = oldTrackNumber;
         return true;
     }
@@ -366,13 +363,12 @@ TracksView::setItemOldTrack( const QUuid &uuid, quint32 oldTrackNumber )
 void
 TracksView::moveMediaItem( const QUuid &uuid, unsigned int track, qint64 time )
 {
-    QList<QGraphicsItem*> sceneItems = m_scene->items();
+    QList<AbstractGraphicsMediaItem*> items = mediaItems();
 
-    for ( int i = 0; i < sceneItems.size(); ++i )
+    for ( int i = 0; i < items.size(); ++i )
     {
-        AbstractGraphicsMediaItem* item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( sceneItems.at( i ) );
-        if ( !item || item->uuid() != uuid ) continue;
+        AbstractGraphicsMediaItem* item = items.at( i );
+        if ( item->uuid() != uuid ) continue;
         moveMediaItem( item, track, time );
     }
 }
@@ -381,14 +377,7 @@ void
 TracksView::moveMediaItem( AbstractGraphicsMediaItem *item, QPoint position )
 {
     static GraphicsTrack *lastKnownTrack = NULL;
-    GraphicsTrack *track = NULL;
-
-    QList<QGraphicsItem*> list = items( 0, position.y() );
-    for ( int i = 0; i < list.size(); ++i )
-    {
-        track = qgraphicsitem_cast<GraphicsTrack*>( list.at(i) );
-        if (track) break;
-    }
+    GraphicsTrack *track = trackAt( mapToScene( position ).y() );
 
     if ( !track )
     {
@@ -484,119 +473,65 @@ TracksView::moveMediaItem( AbstractGraphicsMediaItem *item, quint32 track, qint6
 ItemPosition
 TracksView::findPosition( AbstractGraphicsMediaItem *item, quint32 track, qint64 time )
 {
+    GraphicsTrack *oldTrack = qgraphicsitem_cast<GraphicsTrack*>( item->parentItem() );
+    GraphicsTrack *target = getTrack( item->mediaType(), track );
+    qint64 length = qRound64( item->boundingRect().width() );
+    qint64 oldPos = item->startPos();
 
-    // Create a fake item for computing collisions
-    QGraphicsRectItem *chkItem = new QGraphicsRectItem( item->boundingRect() );
-    chkItem->setParentItem( getTrack( item->mediaType(), track ) );
-    chkItem->setPos( time, 0 );
-
-    QGraphicsItem *oldParent = item->parentItem();
-    qreal oldPos = item->startPos();
+    Q_ASSERT( target != NULL );
 
     // Check for vertical collisions
-    bool continueSearch = true;
-    while ( continueSearch )
+    while ( target->collidingItem( time, time + length, item ) != NULL )
     {
-        QList<QGraphicsItem*> colliding = chkItem->collidingItems( Qt::IntersectsItemShape );
-        bool itemCollision = false;
-        for ( int i = 0; i < colliding.size(); ++i )
+        if ( track < 1 )
         {
-            AbstractGraphicsMediaItem *currentItem = dynamic_cast<AbstractGraphicsMediaItem*>( colliding.at( i ) );
-            if ( currentItem && currentItem != item )
-            {
-                // Collision with an item of the same type
-                itemCollision = true;
-                if ( currentItem->trackNumber() >= track )
-                {
-                    if ( track < 1 )
-                    {
-                        chkItem->setParentItem( oldParent );
-                        continueSearch = false;
-                        break;
-                    }
-                    track -= 1;
-                }
-                else if ( currentItem->trackNumber() < track )
-                {
-                    if ( track >= m_numVideoTrack - 1 )
-                    {
-                        chkItem->setParentItem( oldParent );
-                        continueSearch = false;
-                        break;
-                    }
-                    track += 1;
-                }
-                Q_ASSERT( getTrack( item->mediaType(), track ) != NULL );
-                chkItem->setParentItem( getTrack( item->mediaType(), track ) );
-            }
+            target = oldTrack;
+            break;
         }
-        if ( !itemCollision )
-            continueSearch = false;
+        track -= 1;
+        target = getTrack( item->mediaType(), track );
+        Q_ASSERT( target != NULL );
     }
 
+    Q_ASSERT( target );
 
     // Check for horizontal collisions
-    chkItem->setPos( qMax( time, (qint64)0 ), 0 );
+    qint64 pos = qMax( time, (qint64)0 );
 
-    AbstractGraphicsMediaItem *hItem = NULL;
-    QList<QGraphicsItem*> collide = chkItem->collidingItems( Qt::IntersectsItemShape );
-    for ( int i = 0; i < collide.count(); ++i )
+    AbstractGraphicsMediaItem *hItem = target->collidingItem( pos, pos + length, item );
+    if ( hItem )
     {
-        hItem = dynamic_cast<AbstractGraphicsMediaItem*>( collide.at( i ) );
-        if ( hItem && hItem != item ) break;
-    }
-
-    if ( hItem && hItem != item )
-    {
-        qreal newpos;
+        qint64 newpos;
+        qint64 hPos = hItem->startPos();
         // Evaluate a possible solution
-        if ( chkItem->pos().x() > hItem->pos().x() )
-            newpos = hItem->pos().x() + hItem->boundingRect().width();
+        if ( pos > hPos )
+            newpos = hPos + qRound64( hItem->boundingRect().width() );
         else
-            newpos = hItem->pos().x() - chkItem->boundingRect().width();
+            newpos = hPos - length;
 
-        if ( newpos < 0 || newpos == hItem->pos().x() )
-            chkItem->setPos( oldPos, 0 ); // Fail
+        if ( newpos < 0 || newpos == hPos )
+            pos = oldPos; // Fail
+        else if ( target->collidingItem( newpos, newpos + length, item ) != NULL )
+            pos = oldPos; // Fail
         else
-        {
-            // A solution may be found
-            chkItem->setPos( qRound64( newpos ), 0 );
-            QList<QGraphicsItem*> collideAgain = chkItem->collidingItems( Qt::IntersectsItemShape );
-            for ( int i = 0; i < collideAgain.count(); ++i )
-            {
-                AbstractGraphicsMediaItem *currentItem =
-                        dynamic_cast<AbstractGraphicsMediaItem*>( collideAgain.at( i ) );
-                if ( currentItem && currentItem != item )
-                {
-                    chkItem->setPos( oldPos, 0 ); // Fail
-                    break;
-                }
-            }
-        }
+            pos = newpos; // A solution has been found
     }
 
-    GraphicsTrack *t = static_cast<GraphicsTrack*>( chkItem->parentItem() );
-
-    Q_ASSERT( t );
-
     ItemPosition p;
-    p.setTrack( t->trackNumber() );
-    p.setTime( chkItem->pos().x() );
-
-    delete chkItem;
+    p.setTrack( target->trackNumber() );
+    p.setTime( pos );
     return p;
 }
 
 void
 TracksView::removeMediaItem( const QUuid &uuid, unsigned int track, MainWorkflow::TrackType trackType )
 {
-    QList<QGraphicsItem*> trackItems = getTrack( trackType, track )->childItems();;
+    QList<AbstractGraphicsMediaItem*> trackItems = getTrack( trackType, track )->childs();
 
     for ( int i = 0; i < trackItems.size(); ++i )
     {
-        AbstractGraphicsMediaItem *item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( trackItems.at( i ) );
-        if ( !item || item->uuid() != uuid ) continue;
+        AbstractGraphicsMediaItem *item = trackItems.at( i );
+        if ( item->uuid() != uuid ) continue;
         removeMediaItem( item );
     }
 }
@@ -791,26 +726,12 @@ TracksView::mouseMoveEvent( QMouseEvent *event )
         QPointF itemPos = m_actionItem->mapToScene( 0, 0 );
         QPointF itemNewSize = mapToScene( event->pos() ) - itemPos;
 
-        //FIXME: BEGIN UGLY
         GraphicsTrack *track = getTrack( m_actionItem->mediaType(), m_actionItem->trackNumber() );
         Q_ASSERT( track );
 
-        QPointF collidePos = track->sceneBoundingRect().topRight();
-        collidePos.setX( itemPos.x() + itemNewSize.x() );
-
-        QList<QGraphicsItem*> gi = scene()->items( collidePos );
-
-        bool collide = false;
-        for ( int i = 0; i < gi.count(); ++i )
-        {
-            AbstractGraphicsMediaItem* mi = dynamic_cast<AbstractGraphicsMediaItem*>( gi.at( i ) );
-            if ( mi && mi != m_actionItem )
-            {
-                collide = true;
-                break;
-            }
-        }
-        // END UGLY
+        // Is the new edge of the item over another item?
+        qint64 edge = (qint64)floor( itemPos.x() + itemNewSize.x() );
+        bool collide = ( track->collidingItem( edge, edge + 1, m_actionItem ) != NULL );
 
         if ( !collide )
         {
@@ -997,32 +918,24 @@ TracksView::wheelEvent( QWheelEvent *event )
 QList<AbstractGraphicsMediaItem*>
 TracksView::mediaItems( const QPoint &pos )
 {
-    //TODO optimization needed!
-    QList<QGraphicsItem*> collisionList = items( pos );
-    QList<AbstractGraphicsMediaItem*> mediaCollisionList;
-    for ( int i = 0; i < collisionList.size(); ++i )
-    {
-        AbstractGraphicsMediaItem* item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( collisionList.at( i ) );
-        if ( item )
-            mediaCollisionList.append( item );
-    }
-    return mediaCollisionList;
+    // The frames covered by the pixel
+    QRectF area = mapToScene( QRect( pos, QSize( 1, 1 ) ) ).boundingRect();
+    GraphicsTrack *track = trackAt( area.center().y() );
+
+    if ( !track )
+        return QList<AbstractGraphicsMediaItem*>();
+    return track->items( (qint64)floor( area.left() ), (qint64)ceil( area.right() ) );
 }
 
 QList<AbstractGraphicsMediaItem*>
 TracksView::mediaItems()
 {
-    //TODO optimization needed!
-    QGraphicsItem *item;
-    AbstractGraphicsMediaItem *ami;
     QList<AbstractGraphicsMediaItem*> outlist;
-    QList<QGraphicsItem*> list = items();
-    foreach( item, list )
+    for ( int i = 0; i < m_layout->count(); ++i )
     {
-        ami = dynamic_cast<AbstractGraphicsMediaItem*>( item );
-        if ( ami )
-            outlist.append( ami );
+        GraphicsTrack *track = qgraphicsitem_cast<GraphicsTrack*>( m_layout->itemAt( i )->graphicsItem() );
+        if ( track )
+            outlist.append( track->childs() );
     }
     return outlist;
 }
@@ -1075,17 +988,12 @@ TracksView::ensureCursorVisible()
 void
 TracksView::updateDuration()
 {
-    //TODO this should use a variant of mediaItems( const QPoint& )
-    QList<QGraphicsItem*> sceneItems = m_scene->items();
-
     int projectDuration = 0;
-    for ( int i = 0; i < sceneItems.size(); ++i )
+    for ( int i = 0; i < m_layout->count(); ++i )
     {
-        AbstractGraphicsMediaItem *item =
-                dynamic_cast<AbstractGraphicsMediaItem*>( sceneItems.at( i ) );
-        if ( !item ) continue;
-        if ( ( item->startPos() + item->boundingRect().width() ) > projectDuration )
-            projectDuration = ( int ) ( item->startPos() + item->boundingRect().width() );
+        GraphicsTrack *track = qgraphicsitem_cast<GraphicsTrack*>( m_layout->itemAt( i )->graphicsItem() );
+        if ( track )
+            projectDuration = qMax( projectDuration, (int)track->end() );
     }
 
     m_projectDuration = projectDuration;
@@ -1149,6 +1057,20 @@ TracksView::cleanUnusedTracks()
     cleanTracks( MainWorkflow::AudioTrack );
 }
 
+GraphicsTrack*
+TracksView::trackAt( qreal y )
+{
+    for ( int i = 0; i < m_layout->count(); ++i )
+    {
+        GraphicsTrack *track = qgraphicsitem_cast<GraphicsTrack*>( m_layout->itemAt( i )->graphicsItem() );
+        if ( !track ) continue;
+        QRectF trackRect = track->sceneBoundingRect();
+        if ( y >= trackRect.top() && y < trackRect.bottom() )
+            return track;
+    }
+    return NULL;
+}
+
 GraphicsTrack*
 TracksView::getTrack( MainWorkflow::TrackType type, unsigned int number )
 {
@@ -142,13 +142,12 @@ public:
      *        in the timeline at the given position.
      * \param pos The position to look at.
      * \return A list of pointer to AbstractGraphicsMediaItem.
-     * \warning Calling this method can be excessively slow!
      * \sa mediaItems()
      */
     QList<AbstractGraphicsMediaItem*> mediaItems( const QPoint &pos );
     /**
      * \brief This is an overloaded method provided for convenience.
-     * \warning Calling this method can be excessively slow!
+     * \return Every item of the timeline, sorted by track and position.
      * \sa mediaItems( const QPoint& pos )
      */
     QList<AbstractGraphicsMediaItem*> mediaItems();
@@ -309,6 +308,12 @@ private:
      * \return A pointer to the GraphicsTrack.
      */
     GraphicsTrack           *getTrack( MainWorkflow::TrackType type, unsigned int number );
+    /**
+     * \brief Return the track at the given height.
+     * \param y The vertical position in scene coordinates.
+     * \return A pointer to the GraphicsTrack, or NULL if there is no track there.
+     */
+    GraphicsTrack           *trackAt( qreal y );
     QGraphicsScene          *m_scene;
     int                     m_tracksHeight;
     unsigned int            m_tracksCount;
@@ -91,3 +91,60 @@ const QString&          Media::getFileName() const
 {
     return m_fileName;
 }
+
+bool                    Media::getTrack( libvlc_track_type_t type,
+                                         libvlc_media_track_info_t& track )
+{
+    libvlc_media_track_info_t*  tracks = NULL;
+    bool                        found = false;
+    int                         nbTracks = libvlc_media_get_tracks_info( m_internalPtr, &tracks );
+
+    for ( int i = 0; i < nbTracks; ++i )
+    {
+        if ( tracks[i].i_type == type )
+        {
+            track = tracks[i];
+            found = true;
+            break ;
+        }
+    }
+    free( tracks );
+    return found;
+}
+
+quint32                 Media::getCodec( libvlc_track_type_t type )
+{
+    libvlc_media_track_info_t   track;
+
+    if ( getTrack( type, track ) == false )
+        return 0;
+    return track.i_codec;
+}
+
+quint32                 Media::getVideoCodec()
+{
+    return getCodec( libvlc_track_video );
+}
+
+quint32                 Media::getAudioCodec()
+{
+    return getCodec( libvlc_track_audio );
+}
+
+unsigned int            Media::getAudioChannels()
+{
+    libvlc_media_track_info_t   track;
+
+    if ( getTrack( libvlc_track_audio, track ) == false )
+        return 0;
+    return track.u.audio.i_channels;
+}
+
+unsigned int            Media::getAudioSampleRate()
+{
+    libvlc_media_track_info_t   track;
+
+    if ( getTrack( libvlc_track_audio, track ) == false )
+        return 0;
+    return track.u.audio.i_rate;
+}
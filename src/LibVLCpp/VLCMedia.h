@@ -46,6 +46,29 @@ namespace LibVLCpp
         void                setVideoDataCtx( void* dataCtx );
         void                setAudioDataCtx( void* dataCtx );
         const QString&      getFileName() const;
+        /**
+         *  \brief  Get the fourcc of the first video track, or 0 if none.
+         *
+         *  The media has to be parsed (ie. played) for this to be known.
+         */
+        quint32             getVideoCodec();
+        /**
+         *  \brief  Get the fourcc of the first audio track, or 0 if none.
+         */
+        quint32             getAudioCodec();
+        /**
+         *  \brief  Get the number of channels of the first audio track, or 0 if none.
+         */
+        unsigned int        getAudioChannels();
+        /**
+         *  \brief  Get the sample rate of the first audio track, or 0 if none.
+         */
+        unsigned int        getAudioSampleRate();
+
+    private:
+        bool                getTrack( libvlc_track_type_t type,
+                                      libvlc_media_track_info_t& track );
+        quint32             getCodec( libvlc_track_type_t type );
 
     private:
         QString             m_fileName;
@@ -0,0 +1,347 @@
+/*****************************************************************************
+ * ImportScanner.cpp: Background scanner of the folders to import
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "ImportScanner.h"
+#include "Library.h"
+#include "Media.h"
+
+#include <QDirIterator>
+#include <QFileSystemWatcher>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTimer>
+
+ImportScanner::Worker::Worker( ImportScanner* scanner ) :
+        m_scanner( scanner )
+{
+}
+
+void
+ImportScanner::Worker::run()
+{
+    m_scanner->process();
+}
+
+ImportScanner::ImportScanner( QObject* parent /*= NULL*/ ) :
+        QObject( parent ),
+        m_running( false ),
+        m_generation( 0 ),
+        m_stopped( 0 )
+{
+    m_worker = new Worker( this );
+    m_jobsMutex = new QMutex;
+    m_watcher = new QFileSystemWatcher( this );
+    m_watchTimer = new QTimer( this );
+    m_watchTimer->setSingleShot( true );
+    m_watchTimer->setInterval( WatchDelay );
+
+    connect( m_watcher, SIGNAL( directoryChanged( const QString& ) ),
+             this, SLOT( directoryChanged( const QString& ) ) );
+    connect( m_watchTimer, SIGNAL( timeout() ), this, SLOT( rescanChangedDirectories() ) );
+}
+
+ImportScanner::~ImportScanner()
+{
+    m_stopped.fetchAndStoreOrdered( 1 );
+    {
+        QMutexLocker    lock( m_jobsMutex );
+        m_jobs.clear();
+    }
+    m_worker->wait();
+    delete m_worker;
+    delete m_jobsMutex;
+}
+
+QSet<QString>
+ImportScanner::mediaExtensions()
+{
+    QStringList     filters;
+    QSet<QString>   extensions;
+
+    filters << Media::VideoExtensions.split( ' ', QString::SkipEmptyParts )
+            << Media::AudioExtensions.split( ' ', QString::SkipEmptyParts )
+            << Media::ImageExtensions.split( ' ', QString::SkipEmptyParts );
+    //The filters are like "*.avi"
+    foreach ( const QString& filter, filters )
+        extensions.insert( filter.mid( 2 ).toLower() );
+    return extensions;
+}
+
+bool
+ImportScanner::isMediaFile( const QFileInfo& fileInfo )
+{
+    static const QSet<QString>  extensions = ImportScanner::mediaExtensions();
+
+    return extensions.contains( fileInfo.suffix().toLower() );
+}
+
+void
+ImportScanner::scan( const QString& path )
+{
+    enqueue( path, QString(), m_generation );
+}
+
+void
+ImportScanner::cancel()
+{
+    //The batches already sent by the worker are recognized by their generation.
+    m_generation.fetchAndAddOrdered( 1 );
+
+    QMutexLocker    lock( m_jobsMutex );
+    QQueue<Job>     jobs;
+    foreach ( const Job& job, m_jobs )
+    {
+        if ( job.generation == -1 )
+            jobs.enqueue( job );
+    }
+    m_jobs = jobs;
+}
+
+void
+ImportScanner::enqueue( const QString& path, const QString& watchedRoot, int generation )
+{
+    Job     job;
+
+    job.path = path;
+    job.watchedRoot = watchedRoot;
+    job.generation = generation;
+
+    QMutexLocker    lock( m_jobsMutex );
+    m_jobs.enqueue( job );
+    if ( m_running == false )
+    {
+        //The worker may still be returning from its last run.
+        m_worker->wait();
+        m_running = true;
+        m_worker->start( QThread::LowPriority );
+    }
+}
+
+void
+ImportScanner::process()
+{
+    forever
+    {
+        Job     job;
+        {
+            QMutexLocker    lock( m_jobsMutex );
+            if ( m_jobs.isEmpty() == true )
+            {
+                m_running = false;
+                return ;
+            }
+            job = m_jobs.dequeue();
+        }
+        scanJob( job );
+    }
+}
+
+bool
+ImportScanner::isStale( const Job& job ) const
+{
+    if ( m_stopped != 0 )
+        return true;
+    return ( job.generation != -1 && job.generation != m_generation );
+}
+
+void
+ImportScanner::scanJob( const Job& job )
+{
+    QStringList     files;
+    QStringList     directories;
+    QFileInfo       info( job.path );
+
+    if ( info.isDir() == true )
+    {
+        QDirIterator    it( job.path, QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot |
+                            QDir::Readable, QDirIterator::Subdirectories );
+
+        while ( it.hasNext() == true )
+        {
+            if ( isStale( job ) == true )
+                return ;
+            it.next();
+
+            QFileInfo   fileInfo = it.fileInfo();
+            if ( fileInfo.isDir() == true )
+            {
+                if ( job.watchedRoot.isEmpty() == false )
+                    directories << fileInfo.absoluteFilePath();
+            }
+            else if ( ImportScanner::isMediaFile( fileInfo ) == true )
+                files << fileInfo.absoluteFilePath();
+            if ( files.size() >= BatchSize )
+            {
+                QMetaObject::invokeMethod( this, "batchScanned", Qt::QueuedConnection,
+                                           Q_ARG( int, job.generation ),
+                                           Q_ARG( QString, job.watchedRoot ),
+                                           Q_ARG( QStringList, files ),
+                                           Q_ARG( QStringList, directories ),
+                                           Q_ARG( bool, false ) );
+                files.clear();
+                directories.clear();
+            }
+        }
+    }
+    else if ( ImportScanner::isMediaFile( info ) == true )
+        files << info.absoluteFilePath();
+    QMetaObject::invokeMethod( this, "batchScanned", Qt::QueuedConnection,
+                               Q_ARG( int, job.generation ),
+                               Q_ARG( QString, job.watchedRoot ),
+                               Q_ARG( QStringList, files ),
+                               Q_ARG( QStringList, directories ),
+                               Q_ARG( bool, true ) );
+}
+
+void
+ImportScanner::batchScanned( int generation, const QString& watchedRoot,
+                             const QStringList& files, const QStringList& directories,
+                             bool finished )
+{
+    Library*        library = Library::getInstance();
+    QStringList     newFiles;
+
+    if ( watchedRoot.isEmpty() == true )
+    {
+        if ( generation != m_generation )
+            return ;
+        foreach ( const QString& file, files )
+        {
+            if ( library->mediaAlreadyLoaded( QFileInfo( file ) ) == false )
+                newFiles << file;
+        }
+        if ( newFiles.isEmpty() == false )
+            emit filesFound( newFiles );
+        return ;
+    }
+
+    //The directory may have been unwatched since.
+    QHash<QString, QSet<QString> >::iterator    known = m_knownFiles.find( watchedRoot );
+    if ( known == m_knownFiles.end() )
+        return ;
+    foreach ( const QString& directory, directories )
+    {
+        if ( m_watchedDirectories.contains( directory ) == false )
+        {
+            m_watchedDirectories[directory] = watchedRoot;
+            m_watcher->addPath( directory );
+        }
+    }
+    if ( m_initializing.contains( watchedRoot ) == true )
+    {
+        known.value().unite( files.toSet() );
+        if ( finished == true )
+            m_initializing.remove( watchedRoot );
+        return ;
+    }
+    foreach ( const QString& file, files )
+    {
+        if ( known.value().contains( file ) == true )
+            continue ;
+        known.value().insert( file );
+        if ( library->mediaAlreadyLoaded( QFileInfo( file ) ) == false )
+            newFiles << file;
+    }
+    if ( newFiles.isEmpty() == false )
+        emit newFilesDetected( newFiles );
+}
+
+void
+ImportScanner::setWatchedDirectories( const QStringList& directories )
+{
+    QSet<QString>   roots;
+
+    foreach ( const QString& directory, directories )
+    {
+        QFileInfo   info( directory );
+
+        if ( info.isDir() == true )
+            roots.insert( info.absoluteFilePath() );
+    }
+    foreach ( const QString& root, m_knownFiles.keys() )
+    {
+        if ( roots.contains( root ) == false )
+            unwatch( root );
+    }
+    foreach ( const QString& root, roots )
+    {
+        if ( m_knownFiles.contains( root ) == true )
+            continue ;
+        //The files already there when the directory gets watched aren't new.
+        m_knownFiles[root] = QSet<QString>();
+        m_initializing.insert( root );
+        m_watchedDirectories[root] = root;
+        m_watcher->addPath( root );
+        enqueue( root, root, -1 );
+    }
+}
+
+void
+ImportScanner::unwatch( const QString& root )
+{
+    QHash<QString, QString>::iterator   it = m_watchedDirectories.begin();
+
+    while ( it != m_watchedDirectories.end() )
+    {
+        if ( it.value() == root )
+        {
+            m_watcher->removePath( it.key() );
+            m_changedDirectories.remove( it.key() );
+            it = m_watchedDirectories.erase( it );
+        }
+        else
+            ++it;
+    }
+    m_knownFiles.remove( root );
+    m_initializing.remove( root );
+}
+
+void
+ImportScanner::directoryChanged( const QString& path )
+{
+    if ( m_watchedDirectories.contains( path ) == false )
+        return ;
+    m_changedDirectories.insert( path );
+    m_watchTimer->start();
+}
+
+void
+ImportScanner::rescanChangedDirectories()
+{
+    foreach ( const QString& directory, m_changedDirectories )
+    {
+        QHash<QString, QString>::const_iterator     it = m_watchedDirectories.find( directory );
+
+        if ( it == m_watchedDirectories.constEnd() )
+            continue ;
+        //A removed directory can't be watched anymore.
+        if ( QFileInfo( directory ).isDir() == false )
+        {
+            m_watcher->removePath( directory );
+            m_watchedDirectories.remove( directory );
+            continue ;
+        }
+        enqueue( directory, it.value(), -1 );
+    }
+    m_changedDirectories.clear();
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * ImportScanner.h: Background scanner of the folders to import
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef IMPORTSCANNER_H
+#define IMPORTSCANNER_H
+
+#include <QAtomicInt>
+#include <QFileInfo>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+
+class   QFileSystemWatcher;
+class   QMutex;
+class   QTimer;
+
+/**
+ *  \brief  Look for media files out of the GUI thread.
+ *
+ *  Directories are scanned recursively by a worker thread, and the files
+ *  with a known media extension are sent back in batches, so that the GUI
+ *  stays responsive while importing thousands of files. Files already in
+ *  the library are skipped.
+ *
+ *  The scanner can also watch some directories, and report the media files
+ *  that appear in them afterward.
+ */
+class   ImportScanner : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( ImportScanner );
+
+    public:
+        /// Maximum number of files sent to the GUI thread at once.
+        static const int    BatchSize = 64;
+        /// Time to wait after the last change of a watched directory before
+        /// scanning it, in ms, so that files being copied are complete.
+        static const int    WatchDelay = 2000;
+
+        ImportScanner( QObject* parent = NULL );
+        ~ImportScanner();
+
+        /**
+         *  \brief  Look for media files in path, or its subdirectories.
+         *
+         *  The files are reported by filesFound(). If path is a media file, it
+         *  is reported as is.
+         */
+        void                scan( const QString& path );
+        /**
+         *  \brief  Stop the pending scans. The files they found and that
+         *          haven't been reported yet are dropped.
+         */
+        void                cancel();
+        /**
+         *  \brief  Set the directories whose new files are reported by
+         *          newFilesDetected().
+         */
+        void                setWatchedDirectories( const QStringList& directories );
+        static bool         isMediaFile( const QFileInfo& fileInfo );
+
+    private:
+        struct  Job
+        {
+            QString     path;
+            /// The watched directory this job is rescanning, empty for an import.
+            QString     watchedRoot;
+            /// The import generation, or -1 for a watched directory.
+            int         generation;
+        };
+
+        class   Worker : public QThread
+        {
+            public:
+                Worker( ImportScanner* scanner );
+            protected:
+                virtual void    run();
+            private:
+                ImportScanner*  m_scanner;
+        };
+
+        static QSet<QString>    mediaExtensions();
+        void                enqueue( const QString& path, const QString& watchedRoot,
+                                     int generation );
+        /// Process the jobs until the queue is empty. Runs in the worker thread.
+        void                process();
+        void                scanJob( const Job& job );
+        bool                isStale( const Job& job ) const;
+        void                unwatch( const QString& root );
+
+    private:
+        Worker*                         m_worker;
+        QMutex*                         m_jobsMutex;
+        QQueue<Job>                     m_jobs;
+        bool                            m_running;
+        QAtomicInt                      m_generation;
+        QAtomicInt                      m_stopped;
+
+        QFileSystemWatcher*             m_watcher;
+        QTimer*                         m_watchTimer;
+        /// Every watched directory, and the root it belongs to
+        QHash<QString, QString>         m_watchedDirectories;
+        /// The files found so far in every watched root
+        QHash<QString, QSet<QString> >  m_knownFiles;
+        /// The roots whose first scan isn't over, and whose files aren't new.
+        QSet<QString>                   m_initializing;
+        QSet<QString>                   m_changedDirectories;
+
+    private slots:
+        void                batchScanned( int generation, const QString& watchedRoot,
+                                          const QStringList& files,
+                                          const QStringList& directories, bool finished );
+        void                directoryChanged( const QString& path );
+        void                rescanChangedDirectories();
+
+    signals:
+        void                filesFound( const QStringList& files );
+        void                newFilesDetected( const QStringList& files );
+};
+
+#endif // IMPORTSCANNER_H
@@ -28,20 +28,26 @@
   */
 
 #include "Clip.h"
+#include "ImportScanner.h"
 #include "Library.h"
 #include "Media.h"
 #include "MetaDataManager.h"
+#include "ProjectCache.h"
+#include "XmlStream.hpp"
 
 #include <QDebug>
 #include <QDir>
-#include <QDomElement>
 #include <QHash>
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QUuid>
+#include <QXmlStreamWriter>
 
 Library::Library()
 {
+    m_scanner = new ImportScanner( this );
+    connect( m_scanner, SIGNAL( newFilesDetected( const QStringList& ) ),
+             this, SLOT( ingestFiles( const QStringList& ) ) );
 }
 
 Media*
@@ -62,14 +68,7 @@ Library::clip( const QUuid& uuid )
         return clip;
     }
 
-    QUuid mediaUuid;
-    foreach( mediaUuid, m_medias.keys() )
-    {
-        Media* media = m_medias.value( mediaUuid );
-        if ( media != NULL && media->clips()->contains( uuid ) )
-            return getElementByUuid( *media->clips(), uuid );
-    }
-    return NULL;
+    return getElementByUuid( m_clips, uuid );
 }
 
 Clip*
@@ -85,6 +84,25 @@ Library::clip( const QUuid& mediaUuid, const QUuid& clipUuid )
     return NULL;
 }
 
+void
+Library::setWatchedFolders( const QVariant& folders )
+{
+    m_scanner->setWatchedDirectories( folders.toString().split( ';', QString::SkipEmptyParts ) );
+}
+
+void
+Library::ingestFiles( const QStringList& files )
+{
+    foreach ( const QString& file, files )
+        addMedia( QFileInfo( file ) );
+}
+
+Media*
+Library::mediaFromFile( const QFileInfo& fileInfo )
+{
+    return m_mediasByPath.value( fileInfo.absoluteFilePath(), NULL );
+}
+
 void
 Library::removingMediaAsked( const QUuid& uuid )
 {
@@ -96,22 +114,20 @@ void
 Library::deleteMedia( const QUuid& uuid )
 {
     if ( m_medias.contains( uuid ) )
-        delete m_medias.take( uuid );
+    {
+        Media*  media = m_medias.take( uuid );
+        unindexMedia( media );
+        delete media;
+    }
 }
 
 void
 Library::addMedia( const QFileInfo& fileInfo, const QString& uuid )
 {
+    if ( mediaAlreadyLoaded( fileInfo ) == true )
+        return ;
     Media* media = new Media( fileInfo.filePath(), uuid );
 
-    foreach( Media* it, m_medias.values() )
-    {
-        if ( it->fileInfo()->filePath() == media->fileInfo()->filePath() )
-        {
-            delete media;
-            return;
-        }
-    }
     MetaDataManager::getInstance()->computeMediaMetadata( media );
     addMedia( media );
 }
@@ -121,6 +137,9 @@ void
 Library::addMedia( Media *media )
 {
     m_medias[media->uuid()] = media;
+    indexMedia( media );
+    //Not for the medias of the import dialog, which may be thrown away.
+    MetaDataManager::getInstance()->computeAudioSpectrum( media );
     emit newMediaLoaded( media );
 }
 
@@ -128,151 +147,256 @@ void
 Library::addClip( Clip* clip )
 {
     Media* media = m_medias[clip->getParent()->uuid()];
+    //Indexed through the media's clipAdded signal.
     media->addClip( clip );
 }
 
 bool
 Library::mediaAlreadyLoaded( const QFileInfo& fileInfo )
 {
-    foreach( Media* media, m_medias.values() )
+    return m_mediasByPath.contains( fileInfo.absoluteFilePath() );
+}
+
+void
+Library::indexMedia( Media* media )
+{
+    //Generated and stream medias have no file.
+    if ( media->fileInfo() != NULL )
+        m_mediasByPath[media->fileInfo()->absoluteFilePath()] = media;
+    updateMediaSearchTerms( media );
+    connect( media, SIGNAL( metaTagsChanged( Media* ) ),
+             this, SLOT( updateMediaSearchTerms( Media* ) ) );
+    //Clips can be added or removed through the media itself.
+    connect( media, SIGNAL( clipAdded( Clip* ) ), this, SLOT( indexClip( Clip* ) ) );
+    connect( media, SIGNAL( clipRemoved( Clip* ) ), this, SLOT( unindexClip( Clip* ) ) );
+    foreach( Clip* clip, media->clips()->values() )
+        indexClip( clip );
+}
+
+void
+Library::unindexMedia( Media* media )
+{
+    if ( media->fileInfo() != NULL )
     {
-        if ( media->fileInfo()->filePath() == fileInfo.filePath() )
-            return true;
+        QHash<QString, Media*>::iterator    it =
+                m_mediasByPath.find( media->fileInfo()->absoluteFilePath() );
+
+        if ( it != m_mediasByPath.end() && it.value() == media )
+            m_mediasByPath.erase( it );
     }
-    return false;
+    m_searchIndex.remove( media->uuid() );
+    disconnect( media, SIGNAL( metaTagsChanged( Media* ) ),
+                this, SLOT( updateMediaSearchTerms( Media* ) ) );
+    disconnect( media, SIGNAL( clipAdded( Clip* ) ), this, SLOT( indexClip( Clip* ) ) );
+    disconnect( media, SIGNAL( clipRemoved( Clip* ) ), this, SLOT( unindexClip( Clip* ) ) );
+    foreach( Clip* clip, media->clips()->values() )
+        unindexClip( clip );
 }
 
 void
-Library::loadProject( const QDomElement& medias )
+Library::indexClip( Clip* clip )
 {
-    if ( medias.isNull() == true || medias.tagName() != "medias" )
-    {
-        qWarning() << "Invalid medias node";
+    //A clip may be added to its media more than once, as the preview
+    //widget adds it before the library does.
+    if ( m_clips.value( clip->uuid(), NULL ) == clip )
         return ;
+    m_clips[clip->uuid()] = clip;
+    updateClipSearchTerms( clip );
+    connect( clip, SIGNAL( annotationsChanged( Clip* ) ),
+             this, SLOT( updateClipSearchTerms( Clip* ) ) );
+}
+
+void
+Library::unindexClip( Clip* clip )
+{
+    m_clips.remove( clip->uuid() );
+    m_searchIndex.remove( clip->uuid() );
+    disconnect( clip, SIGNAL( annotationsChanged( Clip* ) ),
+                this, SLOT( updateClipSearchTerms( Clip* ) ) );
+}
+
+void
+Library::updateMediaSearchTerms( Media* media )
+{
+    m_searchIndex.insert( media->uuid(), QStringList( media->fileName() ) << media->metaTags() );
+}
+
+void
+Library::updateClipSearchTerms( Clip* clip )
+{
+    m_searchIndex.insert( clip->uuid(), QStringList( clip->notes() ) << clip->metaTags() );
+}
+
+QSet<QUuid>
+Library::search( const QString& text ) const
+{
+    QSet<QUuid>     result = m_searchIndex.search( text );
+
+    //A clip matches if its media does.
+    foreach ( const QUuid& uuid, result.toList() )
+    {
+        QHash<QUuid, Media*>::const_iterator    it = m_medias.find( uuid );
+
+        if ( it == m_medias.constEnd() )
+            continue ;
+        foreach ( const QUuid& clipUuid, it.value()->clips()->keys() )
+            result.insert( clipUuid );
     }
+    return result;
+}
 
-    QDomElement elem = medias.firstChild().toElement();
-    while ( elem.isNull() == false )
+void
+Library::loadProject( QXmlStreamReader& reader )
+{
+    while ( XmlStream::readNextChild( reader ) == true )
     {
-        QList<QDomElement>  clipList;
-        QDomElement mediaProperty = elem.firstChild().toElement();
+        if ( reader.name() != "media" )
+        {
+            qWarning() << "Unknown field" << reader.name().toString();
+            XmlStream::skipElement( reader );
+            continue ;
+        }
+        QList<QXmlStreamAttributes>  clipList;
         QString     path;
         QString     uuid;
 
-        while ( mediaProperty.isNull() == false )
+        while ( XmlStream::readNextChild( reader ) == true )
         {
-            QString tagName = mediaProperty.tagName();
-            if ( tagName == "path" )
-                path = mediaProperty.text();
-            else if ( tagName == "uuid" )
-                uuid = mediaProperty.text();
-            else if ( tagName == "clips" )
+            if ( reader.name() == "path" )
+                path = reader.readElementText();
+            else if ( reader.name() == "uuid" )
+                uuid = reader.readElementText();
+            else if ( reader.name() == "clips" )
             {
-                QDomElement clip = mediaProperty.firstChild().toElement();
-                while ( clip.isNull() == false )
+                while ( XmlStream::readNextChild( reader ) == true )
                 {
-                    clipList.push_back( clip );
-                    clip = clip.nextSibling().toElement();
+                    clipList.push_back( reader.attributes() );
+                    XmlStream::skipElement( reader );
                 }
             }
             else
-                qWarning() << "Unknown field" << tagName;
-            mediaProperty = mediaProperty.nextSibling().toElement();
-        }
-        //FIXME: This is verry redondant...
-        if ( mediaAlreadyLoaded( path ) == true )
-        {
-            Media*   media;
-            QHash<QUuid, Media*>::iterator   it = m_medias.begin();
-            QHash<QUuid, Media*>::iterator   end = m_medias.end();
-
-            for ( ; it != end; ++it )
             {
-                if ( it.value()->fileInfo()->absoluteFilePath() == path )
-                {
-                    media = it.value();
-                    media->setUuid( QUuid( uuid ) );
-                    m_medias.erase( it );
-                    m_medias[media->uuid()] = media;
-                    break ;
-                }
+                qWarning() << "Unknown field" << reader.name().toString();
+                XmlStream::skipElement( reader );
             }
         }
-        else
-        {
-            addMedia( path, uuid );
-        }
-        if ( clipList.size() != 0 )
+        loadProjectMedia( path, uuid );
+        foreach( const QXmlStreamAttributes& clip, clipList )
         {
-            foreach( QDomElement clip, clipList )
+            QString parentUuid = clip.value( "parentUuid" ).toString();
+            if ( parentUuid != "" && parentUuid == uuid )
             {
-                QString parentUuid = clip.attribute( "parentUuid", "");
-                if ( parentUuid != "" && parentUuid == uuid )
+                QString beg = clip.value( "begin" ).toString();
+                QString end = clip.value( "end" ).toString();
+                QString clipUuid = clip.value( "uuid" ).toString();
+                if ( beg != "" && end != "" && uuid != "" )
                 {
-                    QString beg = clip.attribute( "begin", "" );
-                    QString end = clip.attribute( "end", "" );
-                    QString clipUuid = clip.attribute( "uuid", "" );
-                    if ( beg != "" && end != "" && uuid != "" )
+                    Media* media = m_medias.value( QUuid( uuid ) );
+                    if ( media != 0 )
                     {
-                        Media* media = m_medias[QUuid( uuid )];
-                        if ( media != 0 )
-                        {
-                            Clip* clip = new Clip( media, beg.toInt(), end.toInt(), QUuid( clipUuid ) );
-                            media->addClip( clip );
-                        }
+                        Clip* clip = new Clip( media, beg.toInt(), end.toInt(), QUuid( clipUuid ) );
+                        media->addClip( clip );
                     }
                 }
             }
         }
-
-        elem = elem.nextSibling().toElement();
     }
     emit projectLoaded();
 }
 
 void
-Library::saveProject( QDomDocument& doc, QDomElement& rootNode )
+Library::loadProject( const ProjectCache& cache )
 {
-    QHash<QUuid, Media*>::iterator          it = m_medias.begin();
-    QHash<QUuid, Media*>::iterator          end = m_medias.end();
+    for ( quint32 i = 0; i < cache.nbMedias(); ++i )
+    {
+        const ProjectCache::MediaRecord&    record = cache.media( i );
+        loadProjectMedia( cache.string( record.path, record.pathLength ),
+                          ProjectCache::toUuid( record.uuid ).toString() );
+    }
+    for ( quint32 i = 0; i < cache.nbClips(); ++i )
+    {
+        const ProjectCache::ClipRecord&     record = cache.clip( i );
+        if ( record.media >= cache.nbMedias() )
+            continue ;
+        Media*  media = m_medias.value( ProjectCache::toUuid( cache.media( record.media ).uuid ) );
+        if ( media != NULL )
+        {
+            Clip*   clip = new Clip( media, record.begin, record.end,
+                                     ProjectCache::toUuid( record.uuid ) );
+            media->addClip( clip );
+        }
+    }
+    emit projectLoaded();
+}
 
-    QDomElement medias = doc.createElement( "medias" );
+void
+Library::loadProjectMedia( const QString& path, const QString& uuid )
+{
+    Media*  media = mediaFromFile( QFileInfo( path ) );
 
-    for ( ; it != end; ++it )
+    if ( media != NULL )
     {
-        QDomElement media = doc.createElement( "media" );
-
-        medias.appendChild( media );
-        QDomElement mrl = doc.createElement( "path" );
+        //The path index doesn't depend on the uuid, only the media table
+        //and the search index have to be updated.
+        m_medias.remove( media->uuid() );
+        m_searchIndex.remove( media->uuid() );
+        media->setUuid( QUuid( uuid ) );
+        m_medias[media->uuid()] = media;
+        updateMediaSearchTerms( media );
+    }
+    else
+    {
+        addMedia( path, uuid );
+    }
+}
 
-        QDomCharacterData text;
-        text = doc.createTextNode( it.value()->fileInfo()->absoluteFilePath() );
+void
+Library::saveProject( ProjectCacheWriter& writer )
+{
+    QHash<QUuid, Media*>::const_iterator    it = m_medias.constBegin();
+    QHash<QUuid, Media*>::const_iterator    end = m_medias.constEnd();
 
-        QDomElement uuid = doc.createElement( "uuid" );
-        QDomCharacterData text2 = doc.createTextNode( it.value()->uuid().toString() );
+    for ( ; it != end; ++it )
+        writer.addMedia( it.value() );
+    for ( it = m_medias.constBegin(); it != end; ++it )
+    {
+        foreach( Clip* c, it.value()->clips()->values() )
+            writer.addClip( c );
+    }
+}
 
-        mrl.appendChild( text );
-        uuid.appendChild( text2 );
+void
+Library::saveProject( QXmlStreamWriter& writer )
+{
+    QHash<QUuid, Media*>::iterator          it = m_medias.begin();
+    QHash<QUuid, Media*>::iterator          end = m_medias.end();
 
-        media.appendChild( mrl );
-        media.appendChild( uuid );
+    writer.writeStartElement( "medias" );
+    for ( ; it != end; ++it )
+    {
+        //Only the medias read from a file can be loaded again.
+        if ( it.value()->fileInfo() == NULL )
+            continue ;
+        writer.writeStartElement( "media" );
+        writer.writeTextElement( "path", it.value()->fileInfo()->absoluteFilePath() );
+        writer.writeTextElement( "uuid", it.value()->uuid().toString() );
         //Creating the clip branch
         if ( it.value()->clips()->size() != 0 )
         {
-            QDomElement clips = doc.createElement( "clips" );
+            writer.writeStartElement( "clips" );
             foreach( Clip* c, it.value()->clips()->values() )
             {
-                QDomElement clip = doc.createElement( "clip" );
-                clip.setAttribute( "begin", c->begin() );
-                clip.setAttribute( "end", c->end() );
-                clip.setAttribute( "uuid", c->uuid() );
-                clip.setAttribute( "parentUuid", c->getParent()->uuid() );
-                clips.appendChild( clip );
+                writer.writeEmptyElement( "clip" );
+                writer.writeAttribute( "begin", QString::number( c->begin() ) );
+                writer.writeAttribute( "end", QString::number( c->end() ) );
+                writer.writeAttribute( "uuid", c->uuid().toString() );
+                writer.writeAttribute( "parentUuid", c->getParent()->uuid().toString() );
             }
-            media.appendChild( clips );
+            writer.writeEndElement();
         }
+        writer.writeEndElement();
     }
-    rootNode.appendChild( medias );
+    writer.writeEndElement();
 }
 
 void
@@ -288,6 +412,9 @@ Library::clear()
         ++it;
     }
     m_medias.clear();
+    m_mediasByPath.clear();
+    m_clips.clear();
+    m_searchIndex.clear();
 }
 
 void
@@ -299,6 +426,7 @@ Library::removeClip( const QUuid& mediaId, const QUuid& clipId )
     else
         return;
 
+    //Unindexed through the media's clipRemoved signal.
     if ( med->clips()->contains( clipId ) )
         med->removeClip( clipId );
 }
@@ -30,19 +30,24 @@
 #ifndef LIBRARY_H
 #define LIBRARY_H
 
+#include "SearchIndex.h"
 #include "Singleton.hpp"
 
 #include <QHash>
 #include <QObject>
 #include <QUuid>
+#include <QVariant>
 #include <QFileInfo>
 #include <QMutex>
 #include <QMutexLocker>
-#include <QDomElement>
 #include <QProgressDialog>
 
-class QDomDocument;
-class QDomElement;
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+class ImportScanner;
+class ProjectCache;
+class ProjectCacheWriter;
 
 class Clip;
 class Media;
@@ -114,6 +119,21 @@ public:
      *  \return true if the file is already loaded, false otherwhise
      */
     bool    mediaAlreadyLoaded( const QFileInfo& fileInfo );
+    /**
+     *  \brief  returns the media loaded from a file
+     *  \param  fileInfo    The file infos
+     *  \return a pointer to the media, or NULL if the file isn't loaded
+     */
+    Media*  mediaFromFile( const QFileInfo& fileInfo );
+    /**
+     *  \brief  Search the medias and clips by file name, tags and notes.
+     *
+     *  Every word of the text must start a word of the media or clip. A clip
+     *  also matches when its media does.
+     *  \param  text    The searched text. An empty text matches everything.
+     *  \return the uuids of the matching medias and clips.
+     */
+    QSet<QUuid> search( const QString& text ) const;
 
 private:
     /**
@@ -127,11 +147,36 @@ private:
      *  \param  path The path of the media file
      *  \param  uuid The uuid you want for the new media
      */
+    void    loadProjectMedia( const QString& path, const QString& uuid );
+    /**
+     *  \brief  Add a media and its clips to the lookup tables.
+     */
+    void    indexMedia( Media* media );
+    /**
+     *  \brief  Remove a media and its clips from the lookup tables.
+     */
+    void    unindexMedia( Media* media );
 
     /**
      *  \brief The List of medias loaded into the library
      */
     QHash<QUuid, Media*>    m_medias;
+    /**
+     *  \brief The loaded medias, indexed by their absolute file path
+     */
+    QHash<QString, Media*>  m_mediasByPath;
+    /**
+     *  \brief The clips of every loaded media, indexed by their uuid
+     */
+    QHash<QUuid, Clip*>     m_clips;
+    /**
+     *  \brief The search terms of the medias and clips
+     */
+    SearchIndex             m_searchIndex;
+    /**
+     *  \brief Watches the folders whose new medias are added automatically
+     */
+    ImportScanner*          m_scanner;
     /**
      *  \brief  This method allows to get whereas Media or clip by uuid
      *  \param container The type of container used for storage, where T is Clip or Media
@@ -159,13 +204,23 @@ public slots:
      */
     void    deleteMedia( const QUuid& uuid );
     /**
-     *  \brief
+     *  \brief  Load the medias and clips from a project.
+     *  \param  reader  A reader positionned on the medias element start. It
+     *                  will be left on the element end.
      */
-    void    loadProject( const QDomElement& project );
+    void    loadProject( QXmlStreamReader& reader );
     /**
-     *  \brief
+     *  \brief  Write the medias and clips in a medias element.
+     */
+    void    saveProject( QXmlStreamWriter& writer );
+    /**
+     *  \brief  Load the medias and clips from a binary project cache.
+     */
+    void    loadProject( const ProjectCache& cache );
+    /**
+     *  \brief  Add the medias and clips to a binary project cache.
      */
-    void    saveProject( QDomDocument& doc, QDomElement& rootNode );
+    void    saveProject( ProjectCacheWriter& writer );
     /**
      *  \brief  Clear the library (remove all the loaded media and delete them)
      */
@@ -175,6 +230,19 @@ public slots:
      */
     void    removeClip( const QUuid& mediaId, const QUuid& clipId );
 
+    /**
+     *  \brief  Set the folders whose new medias are added automatically.
+     *  \param  folders The folders, separated by ';'
+     */
+    void    setWatchedFolders( const QVariant& folders );
+
+private slots:
+    void    ingestFiles( const QStringList& files );
+    void    updateMediaSearchTerms( Media* media );
+    void    updateClipSearchTerms( Clip* clip );
+    void    indexClip( Clip* clip );
+    void    unindexClip( Clip* clip );
+
 signals:
     /**
      *  \brief          This signal should be emitted to tell a new media have been added
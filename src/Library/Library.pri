@@ -1,4 +1,8 @@
-HEADERS	+=	Library.h
+HEADERS	+=	ImportScanner.h \
+	Library.h \
+	SearchIndex.h
 
-SOURCES	+= Library.cpp
+SOURCES	+= ImportScanner.cpp \
+	Library.cpp \
+	SearchIndex.cpp
 
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * SearchIndex.cpp: Inverted index of the library search terms
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "SearchIndex.h"
+
+#include <QRegExp>
+
+void
+SearchIndex::insert( const QUuid& uuid, const QStringList& texts )
+{
+    remove( uuid );
+
+    QSet<QString>   words;
+    foreach ( const QString& text, texts )
+        words.unite( SearchIndex::words( text ).toSet() );
+
+    QStringList&    elementWords = m_elements[uuid];
+    foreach ( const QString& word, words )
+    {
+        m_words[word].insert( uuid );
+        elementWords.append( word );
+    }
+}
+
+void
+SearchIndex::remove( const QUuid& uuid )
+{
+    QHash<QUuid, QStringList>::iterator     element = m_elements.find( uuid );
+
+    if ( element == m_elements.end() )
+        return ;
+    foreach ( const QString& word, element.value() )
+    {
+        QMap<QString, QSet<QUuid> >::iterator   it = m_words.find( word );
+
+        if ( it == m_words.end() )
+            continue ;
+        it.value().remove( uuid );
+        if ( it.value().isEmpty() == true )
+            m_words.erase( it );
+    }
+    m_elements.erase( element );
+}
+
+void
+SearchIndex::clear()
+{
+    m_words.clear();
+    m_elements.clear();
+}
+
+QSet<QUuid>
+SearchIndex::search( const QString& text ) const
+{
+    QStringList     prefixes = SearchIndex::words( text );
+    QSet<QUuid>     result;
+
+    if ( prefixes.isEmpty() == true )
+        return m_elements.keys().toSet();
+    match( prefixes.first(), result );
+    for ( int i = 1; i < prefixes.size() && result.isEmpty() == false; ++i )
+    {
+        QSet<QUuid>     matches;
+
+        match( prefixes.at( i ), matches );
+        result.intersect( matches );
+    }
+    return result;
+}
+
+void
+SearchIndex::match( const QString& prefix, QSet<QUuid>& result ) const
+{
+    QMap<QString, QSet<QUuid> >::const_iterator     it = m_words.lowerBound( prefix );
+    QMap<QString, QSet<QUuid> >::const_iterator     end = m_words.constEnd();
+
+    for ( ; it != end && it.key().startsWith( prefix ) == true; ++it )
+        result.unite( it.value() );
+}
+
+QStringList
+SearchIndex::words( const QString& text )
+{
+    static const QRegExp    separators( "[\\W_]+" );
+
+    return text.toLower().split( separators, QString::SkipEmptyParts );
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * SearchIndex.h: Inverted index of the library search terms
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QUuid>
+
+/**
+ *  \brief  Inverted index from words to the medias and clips they describe.
+ *
+ *  Each indexed element is described by a list of texts (file name, tags,
+ *  notes...), which are split into lower case words. The words are kept
+ *  sorted, so that all the words starting with a prefix are contiguous.
+ */
+class   SearchIndex
+{
+    public:
+        /**
+         *  \brief  Index an element, replacing its previous texts if any.
+         */
+        void                insert( const QUuid& uuid, const QStringList& texts );
+        void                remove( const QUuid& uuid );
+        void                clear();
+        /**
+         *  \brief  Find the elements matching every word of a text.
+         *
+         *  A word matches an element if one of the element's words starts with
+         *  it, ignoring the case. An empty text matches every element.
+         */
+        QSet<QUuid>         search( const QString& text ) const;
+        /**
+         *  \brief  Split a text into lower case words.
+         */
+        static QStringList  words( const QString& text );
+
+    private:
+        void                match( const QString& prefix, QSet<QUuid>& result ) const;
+
+    private:
+        QMap<QString, QSet<QUuid> >     m_words;
+        /// The words of every element, so that it can be removed.
+        QHash<QUuid, QStringList>       m_elements;
+};
+
+#endif // SEARCHINDEX_H
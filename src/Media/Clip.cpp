@@ -61,9 +61,9 @@ Clip::Clip( Media *parent, qint64 begin, qint64 end /*= -1*/ ) :
         m_maxEnd( end )
 {
     //FIXME: WTF ?
-    Q_ASSERT( parent->inputType() == Media::File || ( begin == 0 && end == m_parent->nbFrames() ) );
+    Q_ASSERT( parent->inputType() != Media::Stream || ( begin == 0 && end == m_parent->nbFrames() ) );
 
-    if ( parent->inputType() == Media::File && end < 0 )
+    if ( parent->inputType() != Media::Stream && end < 0 )
     {
         m_end = parent->nbFrames();
         m_maxEnd = m_end;
@@ -147,7 +147,7 @@ Clip::lengthSecond() const
 void
 Clip::computeLength()
 {
-    if ( m_parent->inputType() == Media::File )
+    if ( m_parent->inputType() != Media::Stream )
     {
         float   fps = m_parent->fps();
         if ( fps < 0.1f )
@@ -173,6 +173,7 @@ void
 Clip::setMetaTags( const QStringList &tags )
 {
     m_metaTags = tags;
+    emit annotationsChanged( this );
 }
 
 bool
@@ -201,6 +202,7 @@ void
 Clip::setNotes( const QString &notes )
 {
     m_notes = notes;
+    emit annotationsChanged( this );
 }
 
 const QUuid&
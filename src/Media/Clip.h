@@ -137,6 +137,10 @@ class   Clip : public QObject
 
     signals:
         void                lengthUpdated();
+        /**
+         *  \brief  Emitted when the clip's tags or notes have changed.
+         */
+        void                annotationsChanged( Clip* );
 };
 
 #endif //CLIP_H__
@@ -32,12 +32,14 @@
 #include "MetaDataManager.h"
 #include "VLCMedia.h"
 #include "Clip.h"
+#include "Waveform.h"
 
 QPixmap*        Media::defaultSnapshot = NULL;
 const QString   Media::VideoExtensions = "*.mov *.avi *.mkv *.mpg *.mpeg *.wmv *.mp4 *.ogg *.ogv";
 const QString   Media::ImageExtensions = "*.gif *.png *.jpg *.jpeg";
 const QString   Media::AudioExtensions = "*.mp3 *.oga *.flac *.aac *.wav";
 const QString   Media::streamPrefix = "stream://";
+const QString   Media::generatorPrefix = "generator://";
 
 Media::Media( const QString& filePath, const QString& uuid /*= QString()*/ )
     : m_vlcMedia( NULL ),
@@ -49,15 +51,37 @@ Media::Media( const QString& filePath, const QString& uuid /*= QString()*/ )
     m_height( 0 ),
     m_fps( .0f ),
     m_baseClip( NULL ),
+    m_waveform( NULL ),
     m_nbAudioTracks( 0 ),
-    m_nbVideoTracks( 0 )
+    m_nbVideoTracks( 0 ),
+    m_videoCodec( 0 ),
+    m_audioCodec( 0 ),
+    m_audioChannels( 0 ),
+    m_audioSampleRate( 0 )
 {
     if ( uuid.length() == 0 )
         m_uuid = QUuid::createUuid();
     else
         m_uuid = QUuid( uuid );
 
-    if ( filePath.startsWith( Media::streamPrefix ) == false )
+    if ( filePath.startsWith( Media::generatorPrefix ) == true )
+    {
+        m_inputType = Media::Generator;
+        m_mrl = filePath;
+        m_fileType = Media::Video;
+        m_fileName = m_mrl;
+        //There is nothing to probe: the metadata are given by the mrl.
+        QUrl    url( m_mrl );
+        qint64  duration = url.queryItemValue( "duration" ).toLongLong();
+        if ( duration <= 0 )
+            duration = 60;
+        m_fps = Clip::DefaultFPS;
+        m_lengthMS = duration * 1000;
+        m_nbFrames = duration * Clip::DefaultFPS;
+        m_nbVideoTracks = 1;
+        m_nbAudioTracks = 1;
+    }
+    else if ( filePath.startsWith( Media::streamPrefix ) == false )
     {
         m_inputType = Media::File;
         m_fileInfo = new QFileInfo( filePath );
@@ -79,7 +103,6 @@ Media::Media( const QString& filePath, const QString& uuid /*= QString()*/ )
         m_fileName = m_mrl;
         qDebug() << "Loading a stream";
     }
-    m_audioValueList = new QList<int>();
     m_vlcMedia = new LibVLCpp::Media( m_mrl );
 }
 
@@ -91,6 +114,7 @@ Media::~Media()
         delete m_snapshot;
     if ( m_fileInfo )
         delete m_fileInfo;
+    delete m_waveform;
 }
 
 void        Media::setFileType()
@@ -193,6 +217,46 @@ void                Media::setFps( float fps )
     m_fps = fps;
 }
 
+quint32             Media::videoCodec() const
+{
+    return m_videoCodec;
+}
+
+void                Media::setVideoCodec( quint32 codec )
+{
+    m_videoCodec = codec;
+}
+
+quint32             Media::audioCodec() const
+{
+    return m_audioCodec;
+}
+
+void                Media::setAudioCodec( quint32 codec )
+{
+    m_audioCodec = codec;
+}
+
+unsigned int        Media::audioChannels() const
+{
+    return m_audioChannels;
+}
+
+void                Media::setAudioChannels( unsigned int channels )
+{
+    m_audioChannels = channels;
+}
+
+unsigned int        Media::audioSampleRate() const
+{
+    return m_audioSampleRate;
+}
+
+void                Media::setAudioSampleRate( unsigned int rate )
+{
+    m_audioSampleRate = rate;
+}
+
 Media::FileType     Media::fileType() const
 {
     return m_fileType;
@@ -210,6 +274,13 @@ void            Media::emitSnapshotComputed()
     emit snapshotComputed( this );
 }
 
+void            Media::setWaveform( Waveform* waveform )
+{
+    Q_ASSERT( waveform == NULL || waveform->isFinished() == true );
+    delete m_waveform;
+    m_waveform = waveform;
+}
+
 void            Media::emitAudioSpectrumComuted()
 {
     emit audioSpectrumComputed( this->uuid() );
@@ -253,6 +324,7 @@ const QStringList&  Media::metaTags() const
 void                Media::setMetaTags( const QStringList& tags )
 {
     m_metaTags = tags;
+    emit metaTagsChanged( this );
 }
 
 bool                Media::matchMetaTag( const QString& tag ) const
@@ -271,11 +343,15 @@ bool                Media::matchMetaTag( const QString& tag ) const
 void            Media::addClip( Clip* clip )
 {
     m_clips.insert( clip->uuid(), clip );
+    emit clipAdded( clip );
 }
 
 void            Media::removeClip( const QUuid& uuid )
 {
-    m_clips.remove( uuid );
+    Clip*   clip = m_clips.take( uuid );
+
+    if ( clip != NULL )
+        emit clipRemoved( clip );
 }
 
 bool
@@ -42,6 +42,7 @@ namespace LibVLCpp
     class   Media;
 }
 class Clip;
+class Waveform;
 
 /**
   * Represents a basic container for media informations.
@@ -64,7 +65,9 @@ public:
     enum    InputType
     {
         File,
-        Stream
+        Stream,
+        /// Procedurally generated frames and samples, see GeneratorClipWorkflow
+        Generator
     };
     Media( const QString& filePath, const QString& uuid = QString() );
     virtual ~Media();
@@ -122,6 +125,27 @@ public:
     void                        setNbVideoTrack( int nbTrack );
     int                         nbAudioTracks() const;
     int                         nbVideoTracks() const;
+    /**
+     *  \return                 The fourcc of the first video track, or 0 if unknown.
+     */
+    quint32                     videoCodec() const;
+    void                        setVideoCodec( quint32 codec );
+    /**
+     *  \return                 The fourcc of the first audio track, or 0 if unknown.
+     */
+    quint32                     audioCodec() const;
+    void                        setAudioCodec( quint32 codec );
+    /**
+     *  \return                 The number of channels of the first audio track,
+     *                          or 0 if unknown.
+     */
+    unsigned int                audioChannels() const;
+    void                        setAudioChannels( unsigned int channels );
+    /**
+     *  \return                 The sample rate of the first audio track, or 0 if unknown.
+     */
+    unsigned int                audioSampleRate() const;
+    void                        setAudioSampleRate( unsigned int rate );
 
     FileType                    fileType() const;
     static const QString        VideoExtensions;
@@ -129,6 +153,14 @@ public:
     static const QString        ImageExtensions;
     InputType                   inputType() const;
     static const QString        streamPrefix;
+    /**
+     *  \brief  Prefix of the synthetic medias, as in
+     *          "generator://bars?duration=60&tone=1000"
+     *
+     *  The duration is in seconds (60 by default), and the tone frequency
+     *  in Hz (1000 by default, 0 for silence).
+     */
+    static const QString        generatorPrefix;
 
     const QStringList&          metaTags() const;
     void                        setMetaTags( const QStringList& tags );
@@ -145,7 +177,16 @@ public:
     Clip*                       clip( const QUuid& uuid ) const { return m_clips[uuid]; }
     const QHash<QUuid, Clip*>*  clips() const { return &m_clips; }
 
-    QList<int>*                 audioValues() { return m_audioValueList; }
+    /**
+     *  \return    The peaks of the audio track, or NULL if they haven't been
+     *              computed yet.
+     */
+    const Waveform*             waveform() const { return m_waveform; }
+    /**
+     *  \brief     Sets the peaks of the audio track. The media takes the
+     *              ownership of the finished waveform.
+     */
+    void                        setWaveform( Waveform* waveform );
 
     const Clip*                 baseClip() const { return m_baseClip; }
 
@@ -171,14 +212,21 @@ protected:
     QStringList                 m_metaTags;
     Clip*                       m_baseClip;
     QHash<QUuid, Clip*>         m_clips;
-    QList<int>*                 m_audioValueList;
+    Waveform*                   m_waveform;
     int                         m_nbAudioTracks;
     int                         m_nbVideoTracks;
+    quint32                     m_videoCodec;
+    quint32                     m_audioCodec;
+    unsigned int                m_audioChannels;
+    unsigned int                m_audioSampleRate;
 
 signals:
     void                        metaDataComputed( const Media* );
+    void                        metaTagsChanged( Media* );
     void                        snapshotComputed( const Media* );
     void                        audioSpectrumComputed( const QUuid& );
+    void                        clipAdded( Clip* );
+    void                        clipRemoved( Clip* );
 };
 
 #endif // CLIP_H__
@@ -1,6 +1,8 @@
 HEADERS	+=	Clip.h	\
-		Media.h
+		Media.h	\
+		Waveform.h
 
 SOURCES	+=	Clip.cpp	\
-		Media.cpp
+		Media.cpp	\
+		Waveform.cpp
 
@@ -0,0 +1,278 @@
+/*****************************************************************************
+ * Waveform.cpp: Multi resolution min/max peaks of an audio stream
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "Waveform.h"
+
+#include <limits>
+#include <cmath>
+
+#if defined( __SSE__ )
+# include <xmmintrin.h>
+#endif
+
+Waveform::Waveform( unsigned int channels, unsigned int rate ) :
+        m_channels( channels ),
+        m_rate( rate ),
+        m_nbSamples( 0 ),
+        m_bucketFill( 0 ),
+        m_bucketMin( channels ),
+        m_bucketMax( channels ),
+        m_bucketSquares( channels )
+{
+    Q_ASSERT( channels > 0 );
+    resetBucket();
+}
+
+void
+Waveform::appendSamples( const float* samples, unsigned int nbSamples )
+{
+    Q_ASSERT( isFinished() == false );
+    while ( nbSamples > 0 )
+    {
+        unsigned int    count = qMin( nbSamples, (unsigned int)( BaseResolution - m_bucketFill ) );
+
+        accumulate( samples, count );
+        samples += count * m_channels;
+        nbSamples -= count;
+        m_nbSamples += count;
+        m_bucketFill += count;
+        if ( m_bucketFill == BaseResolution )
+            flushBucket();
+    }
+}
+
+void
+Waveform::accumulate( const float* samples, unsigned int nbSamples )
+{
+    const unsigned int  total = nbSamples * m_channels;
+    unsigned int        i = 0;
+
+#if defined( __SSE__ )
+    //With 1, 2 or 4 channels, the lane n of a vector always holds the
+    //channel n % m_channels, so the whole chunk can be reduced 4 values at a
+    //time, and the lanes of a channel are merged at the end.
+    if ( 4 % m_channels == 0 && total >= 4 )
+    {
+        float   mins[4];
+        float   maxs[4];
+        float   squares[4];
+
+        for ( unsigned int lane = 0; lane < 4; ++lane )
+        {
+            mins[lane] = m_bucketMin[lane % m_channels];
+            maxs[lane] = m_bucketMax[lane % m_channels];
+        }
+        __m128  vmin = _mm_loadu_ps( mins );
+        __m128  vmax = _mm_loadu_ps( maxs );
+        __m128  vsquares = _mm_setzero_ps();
+        for ( ; i + 4 <= total; i += 4 )
+        {
+            __m128  v = _mm_loadu_ps( samples + i );
+            vmin = _mm_min_ps( vmin, v );
+            vmax = _mm_max_ps( vmax, v );
+            vsquares = _mm_add_ps( vsquares, _mm_mul_ps( v, v ) );
+        }
+        _mm_storeu_ps( mins, vmin );
+        _mm_storeu_ps( maxs, vmax );
+        _mm_storeu_ps( squares, vsquares );
+        for ( unsigned int lane = 0; lane < 4; ++lane )
+        {
+            unsigned int    channel = lane % m_channels;
+            m_bucketMin[channel] = qMin( m_bucketMin[channel], mins[lane] );
+            m_bucketMax[channel] = qMax( m_bucketMax[channel], maxs[lane] );
+            m_bucketSquares[channel] += squares[lane];
+        }
+    }
+#endif
+    for ( ; i < total; ++i )
+    {
+        unsigned int    channel = i % m_channels;
+        float           v = samples[i];
+
+        if ( v < m_bucketMin[channel] )
+            m_bucketMin[channel] = v;
+        if ( v > m_bucketMax[channel] )
+            m_bucketMax[channel] = v;
+        m_bucketSquares[channel] += v * v;
+    }
+}
+
+void
+Waveform::flushBucket()
+{
+    for ( unsigned int channel = 0; channel < m_channels; ++channel )
+    {
+        Peak    peak;
+        double  rms = sqrt( m_bucketSquares[channel] / m_bucketFill );
+
+        peak.min = qBound( -32767, qRound( m_bucketMin[channel] * 32767.f ), 32767 );
+        peak.max = qBound( -32767, qRound( m_bucketMax[channel] * 32767.f ), 32767 );
+        peak.rms = qMin( 65535, qRound( rms * 65535. ) );
+        m_peaks.append( peak );
+    }
+    resetBucket();
+}
+
+void
+Waveform::resetBucket()
+{
+    m_bucketFill = 0;
+    for ( unsigned int channel = 0; channel < m_channels; ++channel )
+    {
+        m_bucketMin[channel] = std::numeric_limits<float>::max();
+        m_bucketMax[channel] = -std::numeric_limits<float>::max();
+        m_bucketSquares[channel] = 0.;
+    }
+}
+
+void
+Waveform::finish()
+{
+    if ( isFinished() == true )
+        return ;
+    if ( m_bucketFill > 0 )
+        flushBucket();
+
+    int     count = m_peaks.size() / m_channels;
+    int     offset = 0;
+
+    //The upper levels can't be larger than the base level.
+    m_peaks.reserve( ( 2 * count + 1 ) * m_channels );
+    m_levels.append( 0 );
+    while ( count > 1 )
+    {
+        int     upperCount = ( count + 1 ) / 2;
+
+        for ( int i = 0; i < upperCount; ++i )
+        {
+            for ( unsigned int channel = 0; channel < m_channels; ++channel )
+            {
+                Peak    merged = m_peaks[( offset + 2 * i ) * m_channels + channel];
+                if ( 2 * i + 1 < count )
+                {
+                    const Peak  next = m_peaks[( offset + 2 * i + 1 ) * m_channels + channel];
+                    double      squares = (double)merged.rms * merged.rms +
+                                          (double)next.rms * next.rms;
+
+                    merged.min = qMin( merged.min, next.min );
+                    merged.max = qMax( merged.max, next.max );
+                    merged.rms = qRound( sqrt( squares / 2. ) );
+                }
+                m_peaks.append( merged );
+            }
+        }
+        offset += count;
+        count = upperCount;
+        m_levels.append( offset );
+    }
+    m_levels.append( offset + count );
+    m_bucketMin.clear();
+    m_bucketMax.clear();
+    m_bucketSquares.clear();
+}
+
+bool
+Waveform::isFinished() const
+{
+    return m_levels.isEmpty() == false;
+}
+
+unsigned int
+Waveform::channels() const
+{
+    return m_channels;
+}
+
+unsigned int
+Waveform::rate() const
+{
+    return m_rate;
+}
+
+qint64
+Waveform::nbSamples() const
+{
+    return m_nbSamples;
+}
+
+int
+Waveform::nbLevels() const
+{
+    if ( m_levels.isEmpty() == true )
+        return 0;
+    return m_levels.size() - 1;
+}
+
+int
+Waveform::level( double samplesPerPixel ) const
+{
+    int     level = 0;
+
+    while ( level + 1 < nbLevels() &&
+            ( (qint64)BaseResolution << ( level + 1 ) ) <= samplesPerPixel )
+        ++level;
+    return level;
+}
+
+void
+Waveform::peaks( unsigned int channel, double firstSample, double samplesPerPixel,
+                 int nbPixels, Peak* output ) const
+{
+    Q_ASSERT( channel < m_channels );
+    Peak    empty = { 0, 0, 0 };
+
+    if ( isFinished() == false || samplesPerPixel <= 0. )
+    {
+        for ( int i = 0; i < nbPixels; ++i )
+            output[i] = empty;
+        return ;
+    }
+    int             lvl = level( samplesPerPixel );
+    const double    peakSize = (double)( (qint64)BaseResolution << lvl );
+    const int       offset = m_levels[lvl];
+    const qint64    count = m_levels[lvl + 1] - offset;
+
+    for ( int i = 0; i < nbPixels; ++i )
+    {
+        double  from = firstSample + i * samplesPerPixel;
+        double  to = from + samplesPerPixel;
+        qint64  first = qMax( (qint64)0, (qint64)floor( from / peakSize ) );
+        qint64  last = qMin( count - 1, (qint64)ceil( to / peakSize ) - 1 );
+
+        if ( to <= 0. || first > last )
+        {
+            output[i] = empty;
+            continue ;
+        }
+        Peak    peak = m_peaks[( offset + first ) * m_channels + channel];
+        double  squares = (double)peak.rms * peak.rms;
+        for ( qint64 j = first + 1; j <= last; ++j )
+        {
+            const Peak& p = m_peaks[( offset + j ) * m_channels + channel];
+            peak.min = qMin( peak.min, p.min );
+            peak.max = qMax( peak.max, p.max );
+            squares += (double)p.rms * p.rms;
+        }
+        peak.rms = qRound( sqrt( squares / ( last - first + 1 ) ) );
+        output[i] = peak;
+    }
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * Waveform.h: Multi resolution min/max peaks of an audio stream
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/**
+ *  \brief  Min/max/RMS peaks of an audio stream, stored as a pyramid.
+ *
+ *  The base level holds one peak per channel for every BaseResolution
+ *  samples. Each upper level halves the resolution of the previous one, so
+ *  that a view can draw the waveform at any zoom by reading at most a
+ *  couple of peaks per pixel. All the levels live in a single array, level
+ *  after level, with the channels interleaved.
+ *
+ *  The samples are fed with appendSamples(), and the upper levels are built
+ *  by finish(). A Waveform can't be queried before being finished.
+ */
+class   Waveform
+{
+    public:
+        struct  Peak
+        {
+            qint16      min;
+            qint16      max;
+            quint16     rms;
+        };
+        /// Number of samples summarized by a peak of the base level.
+        static const int        BaseResolution = 256;
+
+        Waveform( unsigned int channels, unsigned int rate );
+
+        /**
+         *  \brief  Accumulates interleaved float samples, in [-1;1].
+         *  \param  nbSamples   The number of samples per channel.
+         */
+        void                    appendSamples( const float* samples, unsigned int nbSamples );
+        /**
+         *  \brief  Flushes the pending samples, and builds the upper levels.
+         */
+        void                    finish();
+        bool                    isFinished() const;
+
+        unsigned int            channels() const;
+        unsigned int            rate() const;
+        qint64                  nbSamples() const;
+        int                     nbLevels() const;
+        /**
+         *  \return The coarsest level whose peaks aren't wider than
+         *          samplesPerPixel.
+         */
+        int                     level( double samplesPerPixel ) const;
+        /**
+         *  \brief  Computes the peaks of nbPixels consecutive columns.
+         *
+         *  The column i covers the samples from
+         *  firstSample + i * samplesPerPixel to
+         *  firstSample + ( i + 1 ) * samplesPerPixel.
+         *  Columns outside of the stream get an empty peak.
+         */
+        void                    peaks( unsigned int channel, double firstSample,
+                                       double samplesPerPixel, int nbPixels,
+                                       Peak* output ) const;
+
+    private:
+        void                    accumulate( const float* samples, unsigned int nbSamples );
+        void                    flushBucket();
+        void                    resetBucket();
+
+    private:
+        unsigned int            m_channels;
+        unsigned int            m_rate;
+        qint64                  m_nbSamples;
+        /// Every level, from the base level to the single peak of the top.
+        QVector<Peak>           m_peaks;
+        /// Index of the first peak of each level, in peaks per channel.
+        QVector<int>            m_levels;
+
+        int                     m_bucketFill;
+        QVector<float>          m_bucketMin;
+        QVector<float>          m_bucketMax;
+        QVector<double>         m_bucketSquares;
+};
+
+#endif // WAVEFORM_H
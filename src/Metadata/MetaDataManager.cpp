@@ -20,15 +20,18 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include "Media.h"
 #include "MetaDataManager.h"
 #include "MetaDataWorker.h"
 #include "VLCMediaPlayer.h"
 
+#include <QApplication>
 #include <QtDebug>
 #include <QQueue>
 
 MetaDataManager::MetaDataManager() :
         m_computeInProgress( false ),
+        m_computingAudioSpectrum( false ),
         m_mediaPlayer( NULL )
 {
     m_computingMutex = new QMutex;
@@ -41,9 +44,10 @@ MetaDataManager::~MetaDataManager()
         delete m_mediaPlayer;
 }
 
-void    MetaDataManager::launchComputing( Media *media )
+void    MetaDataManager::launchComputing( Media *media, bool audioSpectrum )
 {
     m_computeInProgress = true;
+    m_computingAudioSpectrum = audioSpectrum;
     m_mediaPlayer = new LibVLCpp::MediaPlayer;
     MetaDataWorker* worker = new MetaDataWorker( m_mediaPlayer, media );
     connect( worker, SIGNAL( computed() ),
@@ -52,31 +56,119 @@ void    MetaDataManager::launchComputing( Media *media )
     connect( worker, SIGNAL( failed( Media* ) ),
              this, SLOT( computingFailed( Media* ) ),
              Qt::DirectConnection );
-    worker->compute();
+    if ( audioSpectrum == true )
+        worker->computeAudioSpectrum();
+    else
+        worker->compute();
 }
 
-void    MetaDataManager::computingCompleted()
+bool    MetaDataManager::launchNext()
 {
-    QMutexLocker lock( m_computingMutex );
+    if ( m_mediaToCompute.size() != 0 )
+        launchComputing( m_mediaToCompute.dequeue() );
+    else
+    {
+        while ( m_audioSpectrumToCompute.size() != 0 )
+        {
+            Media*  media = m_audioSpectrumToCompute.dequeue();
+            disconnect( media, SIGNAL( destroyed( QObject* ) ),
+                        this, SLOT( mediaDestroyed( QObject* ) ) );
+            //The metadata are known by now, as they are computed first.
+            if ( media->hasAudioTrack() == true )
+            {
+                launchComputing( media, true );
+                return true;
+            }
+        }
+        return false;
+    }
+    return true;
+}
 
+void    MetaDataManager::computingCompleted()
+{
+    m_computingMutex->lock();
     m_mediaPlayer->stop();
     delete m_mediaPlayer;
     m_mediaPlayer = NULL;
     m_computeInProgress = false;
-    if ( m_mediaToCompute.size() != 0 )
-        launchComputing( m_mediaToCompute.dequeue() );
+    if ( launchNext() == true )
+        m_computingMutex->unlock();
+    else
+    {
+        //Don't emit while locked, as a slot may want to compute another media.
+        m_computingMutex->unlock();
+        emit allComputed();
+    }
+}
+
+bool
+MetaDataManager::isComputing() const
+{
+    QMutexLocker lock( m_computingMutex );
+
+    return m_computeInProgress;
 }
 
 void
 MetaDataManager::computingFailed( Media* media )
 {
-    emit failedToCompute( media );
+    m_computingMutex->lock();
+    bool    audioSpectrum = m_computingAudioSpectrum;
+    m_computingMutex->unlock();
+
+    //The media is still usable without its waveform.
+    if ( audioSpectrum == true )
+        qWarning() << "Can't compute the audio spectrum of" << media->fileInfo()->absoluteFilePath();
+    else
+        emit failedToCompute( media );
     computingCompleted();
 }
 
+void
+MetaDataManager::computeAudioSpectrum( Media* media )
+{
+    //The waveform is only drawn in the timeline, and takes a full decoding
+    //of the audio: it's extracted once every pending metadata are known.
+    if ( QApplication::type() == QApplication::Tty ||
+         media->inputType() != Media::File ||
+         ( media->fileType() != Media::Video && media->fileType() != Media::Audio ) )
+        return ;
+    QMutexLocker lock( m_computingMutex );
+
+    m_audioSpectrumToCompute.enqueue( media );
+    connect( media, SIGNAL( destroyed( QObject* ) ),
+             this, SLOT( mediaDestroyed( QObject* ) ), Qt::DirectConnection );
+    if ( m_computeInProgress == false )
+        launchNext();
+}
+
+void
+MetaDataManager::mediaDestroyed( QObject* media )
+{
+    QMutexLocker lock( m_computingMutex );
+
+    QQueue<Media*>::iterator    it = m_audioSpectrumToCompute.begin();
+    while ( it != m_audioSpectrumToCompute.end() )
+    {
+        if ( static_cast<QObject*>( *it ) == media )
+            it = m_audioSpectrumToCompute.erase( it );
+        else
+            ++it;
+    }
+}
+
 void
 MetaDataManager::computeMediaMetadata( Media *media )
 {
+    if ( media->inputType() == Media::Generator )
+    {
+        //Generated medias know their metadata from the start.
+        media->emitMetaDataComputed();
+        if ( isComputing() == false )
+            emit allComputed();
+        return ;
+    }
     QMutexLocker lock( m_computingMutex );
 
     if ( m_computeInProgress == true )
@@ -41,25 +41,54 @@ class MetaDataManager : public QObject, public Singleton<MetaDataManager>
 
     public:
         void    computeMediaMetadata( Media* media );
+        /**
+         *  \return    true if some medias are still being computed.
+         */
+        bool    isComputing() const;
+        /**
+         *  \brief     Extract the waveform of a media, once every pending
+         *             metadata are computed. Does nothing for a media
+         *             without audio or not read from a file, or without a GUI.
+         *
+         *  The media must be owned by the Library: the pass is dropped if
+         *  it's deleted meanwhile.
+         */
+        void    computeAudioSpectrum( Media* media );
     private:
         MetaDataManager();
         ~MetaDataManager();
 
-        void                    launchComputing( Media *media );
+        void                    launchComputing( Media *media, bool audioSpectrum = false );
+        /**
+         *  \brief     Launch the next queued computing. The metadata of the
+         *             pending medias are computed before any audio spectrum.
+         *
+         *  \return    false if there was nothing left to compute.
+         */
+        bool                    launchNext();
 
     private:
         QMutex                  *m_computingMutex;
         QQueue<Media*>          m_mediaToCompute;
+        /// The medias whose metadata are known, and whose waveform has to be extracted.
+        QQueue<Media*>          m_audioSpectrumToCompute;
         bool                    m_computeInProgress;
+        bool                    m_computingAudioSpectrum;
         LibVLCpp::MediaPlayer   *m_mediaPlayer;
         friend class            Singleton<MetaDataManager>;
 
     private slots:
         void                    computingCompleted();
         void                    computingFailed( Media* media );
+        void                    mediaDestroyed( QObject* media );
 
     signals:
         void                    failedToCompute( Media* );
+        /**
+         *  \brief     Emitted when the last queued media has been computed,
+         *             including its audio spectrum.
+         */
+        void                    allComputed();
 };
 
 #endif //METADATAMANAGER_H
@@ -21,6 +21,7 @@
  *****************************************************************************/
 
 #include <QtDebug>
+#include <QApplication>
 #include <QPainter>
 #include <QLabel>
 #include <QImage>
@@ -28,31 +29,35 @@
 #include "MetaDataWorker.h"
 #include "Library.h"
 #include "SettingsManager.h"
+#include "Tracer.h"
 #include "VLCMediaPlayer.h"
 #include "VLCMedia.h"
 #include "Clip.h"
-
-#include <QThreadPool>
-#include <QRunnable>
+#include "Waveform.h"
 
 MetaDataWorker::MetaDataWorker( LibVLCpp::MediaPlayer* mediaPlayer, Media* media ) :
         m_mediaPlayer( mediaPlayer ),
         m_media( media ),
+        m_audioMedia( NULL ),
         m_mediaIsPlaying( false),
         m_lengthHasChanged( false ),
-        m_audioBuffer( NULL )
+        m_audioBuffer( NULL ),
+        m_audioBufferSize( 0 ),
+        m_waveform( NULL )
 {
 }
 
 MetaDataWorker::~MetaDataWorker()
 {
-    if ( m_audioBuffer )
-        delete m_audioBuffer;
+    delete[] m_audioBuffer;
+    delete m_waveform;
+    delete m_audioMedia;
 }
 
 void
 MetaDataWorker::compute()
 {
+    VLMC_TRACE_SCOPE( "MetaDataWorker::compute" );
     if ( m_media->fileType() == Media::Video ||
          m_media->fileType() == Media::Audio )
         computeDynamicFileMetaData();
@@ -68,6 +73,21 @@ MetaDataWorker::compute()
     m_media->flushVolatileParameters();
 }
 
+void
+MetaDataWorker::computeAudioSpectrum()
+{
+    VLMC_TRACE_SCOPE( "MetaDataWorker::computeAudioSpectrum" );
+    //The sout options can't be removed from a libvlc media, so the media
+    //played by the clips can't be used.
+    m_audioMedia = new LibVLCpp::Media( m_media->mrl() );
+    prepareAudioSpectrumComputing();
+    m_mediaPlayer->setMedia( m_audioMedia );
+    connect( m_mediaPlayer, SIGNAL( errorEncountered() ), this, SLOT( failure() ) );
+    //The media may be removed from the library while it's being decoded.
+    connect( m_media, SIGNAL( destroyed() ), this, SLOT( mediaDestroyed() ) );
+    m_mediaPlayer->play();
+}
+
 void
 MetaDataWorker::computeDynamicFileMetaData()
 {
@@ -92,20 +112,21 @@ MetaDataWorker::computeImageMetaData()
 void
 MetaDataWorker::prepareAudioSpectrumComputing()
 {
-    m_media->vlcMedia()->addOption( ":no-sout-video" );
-    m_media->vlcMedia()->addOption( ":sout=#transcode{}:smem" );
-    m_media->vlcMedia()->setAudioDataCtx( this );
-    m_media->vlcMedia()->setAudioLockCallback( reinterpret_cast<void*>( lock ) );
-    m_media->vlcMedia()->setAudioUnlockCallback( reinterpret_cast<void*>( unlock ) );
-    m_media->vlcMedia()->addOption( ":sout-transcode-acodec=fl32" );
-    m_media->vlcMedia()->addOption( ":no-sout-smem-time-sync" );
-    m_media->vlcMedia()->addOption( ":no-sout-keep" );
+    m_audioMedia->addOption( ":no-sout-video" );
+    m_audioMedia->addOption( ":sout=#transcode{}:smem" );
+    m_audioMedia->setAudioDataCtx( this );
+    m_audioMedia->setAudioLockCallback( reinterpret_cast<void*>( lock ) );
+    m_audioMedia->setAudioUnlockCallback( reinterpret_cast<void*>( unlock ) );
+    m_audioMedia->addOption( ":sout-transcode-acodec=fl32" );
+    m_audioMedia->addOption( ":no-sout-smem-time-sync" );
+    m_audioMedia->addOption( ":no-sout-keep" );
     connect( m_mediaPlayer, SIGNAL( endReached() ), this, SLOT( generateAudioSpectrum() ), Qt::QueuedConnection );
 }
 
 void
 MetaDataWorker::metaDataAvailable()
 {
+    VLMC_TRACE_SCOPE( "MetaDataWorker::metaDataAvailable" );
     m_mediaIsPlaying = false;
     m_lengthHasChanged = false;
 
@@ -146,12 +167,18 @@ MetaDataWorker::metaDataAvailable()
 
     m_media->setNbAudioTrack( m_mediaPlayer->getNbAudioTrack() );
     m_media->setNbVideoTrack( m_mediaPlayer->getNbVideoTrack() );
+    m_media->setVideoCodec( m_media->vlcMedia()->getVideoCodec() );
+    m_media->setAudioCodec( m_media->vlcMedia()->getAudioCodec() );
+    m_media->setAudioChannels( m_media->vlcMedia()->getAudioChannels() );
+    m_media->setAudioSampleRate( m_media->vlcMedia()->getAudioSampleRate() );
     m_media->setNbFrames( (m_media->lengthMS() / 1000) * m_media->fps() );
 
     m_media->emitMetaDataComputed();
     //Setting time for snapshot :
-    if ( m_media->fileType() == Media::Video ||
-         m_media->fileType() == Media::Image )
+    //Snapshots are QPixmap, that can't be used without a GUI (ie. when batch rendering)
+    if ( ( m_media->fileType() == Media::Video ||
+           m_media->fileType() == Media::Image ) &&
+         QApplication::type() != QApplication::Tty )
     {
         connect( m_mediaPlayer, SIGNAL( positionChanged( float ) ), this, SLOT( renderSnapshot() ) );
         m_mediaPlayer->setTime( m_mediaPlayer->getLength() / 3 );
@@ -163,6 +190,7 @@ MetaDataWorker::metaDataAvailable()
 void
 MetaDataWorker::renderSnapshot()
 {
+    VLMC_TRACE_SCOPE( "MetaDataWorker::renderSnapshot" );
     if ( m_media->fileType() == Media::Video ||
          m_media->fileType() == Media::Audio )
         disconnect( m_mediaPlayer, SIGNAL( positionChanged( float ) ), this, SLOT( renderSnapshot() ) );
@@ -181,6 +209,7 @@ MetaDataWorker::renderSnapshot()
 void
 MetaDataWorker::setSnapshot( const char* filename )
 {
+    VLMC_TRACE_SCOPE( "MetaDataWorker::setSnapshot" );
     QPixmap* pixmap = new QPixmap( filename );
     if ( pixmap->isNull() )
         delete pixmap;
@@ -233,8 +262,12 @@ MetaDataWorker::entrypointPlaying()
 void
 MetaDataWorker::lock( MetaDataWorker* metaDataWorker, uint8_t** pcm_buffer , unsigned int size )
 {
-    if ( metaDataWorker->m_audioBuffer == NULL )
+    if ( metaDataWorker->m_audioBufferSize < size )
+    {
+        delete[] metaDataWorker->m_audioBuffer;
         metaDataWorker->m_audioBuffer = new unsigned char[size];
+        metaDataWorker->m_audioBufferSize = size;
+    }
     *pcm_buffer = metaDataWorker->m_audioBuffer;
 }
 
@@ -244,58 +277,55 @@ MetaDataWorker::unlock( MetaDataWorker* metaDataWorker, uint8_t* pcm_buffer,
                                       unsigned int nb_samples, unsigned int bits_per_sample,
                                       unsigned int size, int pts )
 {
-    Q_UNUSED( rate );
     Q_UNUSED( size );
     Q_UNUSED( pts );
+    VLMC_TRACE_SCOPE( "MetaDataWorker::unlock" );
 
-    int bytePerChannelPerSample = bits_per_sample / 8;
-
-    int leftAverage = 0;
-    int rightAverage = 0;
-
-    int it = 0;
-    for ( unsigned int i = 0; i < nb_samples; i++)
-    {
-        int left = 0;
-        int right = 0;
-        for ( int u = 0 ; u < bytePerChannelPerSample; u++, it++ )
-        {
-            int increment = 0;
-            if ( channels == 2 )
-                increment = bytePerChannelPerSample;
-            left <<= 8;
-            left += pcm_buffer[ it ];
-            right <<= 8;
-            right += pcm_buffer[ it + increment ];
-        }
-        leftAverage += left;
-        rightAverage += right;
-    }
-    leftAverage /= nb_samples;
-    metaDataWorker->addAudioValue( leftAverage );
+    //The audio is transcoded to fl32, see prepareAudioSpectrumComputing()
+    if ( bits_per_sample != 32 || channels == 0 )
+        return ;
+    if ( metaDataWorker->m_waveform == NULL )
+        metaDataWorker->m_waveform = new Waveform( channels, rate );
+    else if ( metaDataWorker->m_waveform->channels() != channels )
+        return ;
+    metaDataWorker->m_waveform->appendSamples( reinterpret_cast<const float*>( pcm_buffer ),
+                                               nb_samples );
 }
 
 void
 MetaDataWorker::generateAudioSpectrum()
 {
+    VLMC_TRACE_SCOPE( "MetaDataWorker::generateAudioSpectrum" );
     disconnect( m_mediaPlayer, SIGNAL( endReached() ), this, SLOT( generateAudioSpectrum() ) );
     m_mediaPlayer->stop();
-//    AudioSpectrumHelper* audioSpectrum = new AudioSpectrumHelper( m_media->getAudioValues() );
-//    audioSpectrum->setAutoDelete( true );
-//    QThreadPool::globalInstance()->start( audioSpectrum );
+    if ( m_waveform != NULL )
+    {
+        //Building the upper levels is linear in the number of base peaks,
+        //which is a few thousands per minute of audio.
+        m_waveform->finish();
+        m_media->setWaveform( m_waveform );
+        m_waveform = NULL;
+    }
     m_media->emitAudioSpectrumComuted();
+    m_media->disconnect( this );
+    emit computed();
     delete this;
 }
 
 void
-MetaDataWorker::addAudioValue( int value )
+MetaDataWorker::failure()
 {
-    m_media->audioValues()->append( value );
+    m_media->disconnect( this );
+    emit failed( m_media );
+    deleteLater();
 }
 
 void
-MetaDataWorker::failure()
+MetaDataWorker::mediaDestroyed()
 {
-    emit failed( m_media );
-    deleteLater();
+    //Don't touch the media anymore, and let the next one be computed.
+    disconnect( m_mediaPlayer, SIGNAL( endReached() ), this, SLOT( generateAudioSpectrum() ) );
+    m_mediaPlayer->stop();
+    emit computed();
+    delete this;
 }
@@ -33,8 +33,10 @@
 
 namespace LibVLCpp
 {
+    class   Media;
     class   MediaPlayer;
 }
+class   Waveform;
 
 class MetaDataWorker : public QObject
 {
@@ -45,12 +47,17 @@ class MetaDataWorker : public QObject
         MetaDataWorker( LibVLCpp::MediaPlayer* mediaPlayer, Media* media );
         ~MetaDataWorker();
         void                        compute();
+        /**
+         *  \brief  Decode the whole audio of the media to build its waveform.
+         *
+         *  The media's metadata must have been computed first.
+         */
+        void                        computeAudioSpectrum();
 
     private:
         void                        computeDynamicFileMetaData();
         void                        computeImageMetaData();
         void                        prepareAudioSpectrumComputing();
-        void                        addAudioValue( int value );
         void                        finalize();
 
     private:
@@ -64,11 +71,15 @@ class MetaDataWorker : public QObject
     private:
         LibVLCpp::MediaPlayer*      m_mediaPlayer;
         Media*                      m_media;
+        /// \brief  The media the audio spectrum is extracted from.
+        LibVLCpp::Media*            m_audioMedia;
 
         bool                        m_mediaIsPlaying;
         bool                        m_lengthHasChanged;
 
         unsigned char*              m_audioBuffer;
+        unsigned int                m_audioBufferSize;
+        Waveform*                   m_waveform;
         QTime                       m_timer;
 
     private slots:
@@ -78,6 +89,7 @@ class MetaDataWorker : public QObject
         void    entrypointLengthChanged( qint64 );
         void    generateAudioSpectrum();
         void    failure();
+        void    mediaDestroyed();
 
     signals:
         void    computed();
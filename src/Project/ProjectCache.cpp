@@ -0,0 +1,333 @@
+/*****************************************************************************
+ * ProjectCache.cpp: Binary snapshot of a project, for fast reopening
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "ProjectCache.h"
+#include "Clip.h"
+#include "Media.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include <string.h>
+
+ProjectCache::ProjectCache() :
+        m_file( NULL ),
+        m_header( NULL ),
+        m_medias( NULL ),
+        m_clips( NULL ),
+        m_timelineClips( NULL ),
+        m_settings( NULL ),
+        m_strings( NULL )
+{
+}
+
+ProjectCache::~ProjectCache()
+{
+    //Closing the file also unmaps it.
+    delete m_file;
+}
+
+QString
+ProjectCache::fileName( const QString& projectFile )
+{
+    return projectFile + ".cache";
+}
+
+bool
+ProjectCache::open( const QString& projectFile )
+{
+    QFileInfo   project( projectFile );
+    QString     cacheFile = fileName( projectFile );
+
+    if ( m_file != NULL || QFile::exists( cacheFile ) == false )
+        return false;
+    m_file = new QFile( cacheFile );
+    if ( m_file->open( QFile::ReadOnly ) == false )
+        return false;
+
+    qint64          size = m_file->size();
+    const uchar*    data = size >= (qint64)sizeof( Header ) ? m_file->map( 0, size ) : NULL;
+    if ( data == NULL )
+        return false;
+    const Header*   header = reinterpret_cast<const Header*>( data );
+    if ( header->magic != Magic || header->version != Version )
+        return false;
+    if ( header->projectSize != project.size() ||
+         header->projectModified != project.lastModified().toTime_t() )
+        return false;
+    qint64          expected = sizeof( Header ) +
+                               header->nbMedias * (qint64)sizeof( MediaRecord ) +
+                               header->nbClips * (qint64)sizeof( ClipRecord ) +
+                               header->nbTimelineClips * (qint64)sizeof( TimelineClipRecord ) +
+                               header->nbSettings * (qint64)sizeof( SettingRecord ) +
+                               header->stringsSize * (qint64)sizeof( ushort );
+    if ( expected != size )
+        return false;
+
+    Header          copy = *header;
+    copy.checksum = 0;
+    quint32         crc = crc32( 0, reinterpret_cast<const uchar*>( &copy ), sizeof( Header ) );
+    crc = crc32( crc, data + sizeof( Header ), size - sizeof( Header ) );
+    if ( crc != header->checksum )
+    {
+        qWarning() << "Project cache" << cacheFile << "is corrupted";
+        return false;
+    }
+
+    m_header = header;
+    m_medias = reinterpret_cast<const MediaRecord*>( header + 1 );
+    m_clips = reinterpret_cast<const ClipRecord*>( m_medias + header->nbMedias );
+    m_timelineClips = reinterpret_cast<const TimelineClipRecord*>( m_clips + header->nbClips );
+    m_settings = reinterpret_cast<const SettingRecord*>( m_timelineClips + header->nbTimelineClips );
+    m_strings = reinterpret_cast<const ushort*>( m_settings + header->nbSettings );
+    return true;
+}
+
+quint32
+ProjectCache::nbMedias() const
+{
+    return m_header->nbMedias;
+}
+
+const ProjectCache::MediaRecord&
+ProjectCache::media( quint32 index ) const
+{
+    Q_ASSERT( index < m_header->nbMedias );
+    return m_medias[index];
+}
+
+quint32
+ProjectCache::nbClips() const
+{
+    return m_header->nbClips;
+}
+
+const ProjectCache::ClipRecord&
+ProjectCache::clip( quint32 index ) const
+{
+    Q_ASSERT( index < m_header->nbClips );
+    return m_clips[index];
+}
+
+quint32
+ProjectCache::nbTimelineClips() const
+{
+    return m_header->nbTimelineClips;
+}
+
+const ProjectCache::TimelineClipRecord&
+ProjectCache::timelineClip( quint32 index ) const
+{
+    Q_ASSERT( index < m_header->nbTimelineClips );
+    return m_timelineClips[index];
+}
+
+quint32
+ProjectCache::nbSettings() const
+{
+    return m_header->nbSettings;
+}
+
+const ProjectCache::SettingRecord&
+ProjectCache::setting( quint32 index ) const
+{
+    Q_ASSERT( index < m_header->nbSettings );
+    return m_settings[index];
+}
+
+QString
+ProjectCache::string( quint32 offset, quint32 length ) const
+{
+    //Records come from a checksummed file, but may still be inconsistent.
+    if ( (qint64)offset + length > m_header->stringsSize )
+        return QString();
+    return QString::fromUtf16( m_strings + offset, length );
+}
+
+QUuid
+ProjectCache::toUuid( const Uuid& uuid )
+{
+    return QUuid( uuid.data1, uuid.data2, uuid.data3,
+                  uuid.data4[0], uuid.data4[1], uuid.data4[2], uuid.data4[3],
+                  uuid.data4[4], uuid.data4[5], uuid.data4[6], uuid.data4[7] );
+}
+
+ProjectCache::Uuid
+ProjectCache::fromUuid( const QUuid& uuid )
+{
+    Uuid    ret;
+
+    ret.data1 = uuid.data1;
+    ret.data2 = uuid.data2;
+    ret.data3 = uuid.data3;
+    for ( int i = 0; i < 8; ++i )
+        ret.data4[i] = uuid.data4[i];
+    return ret;
+}
+
+quint32
+ProjectCache::crc32( quint32 crc, const uchar* data, qint64 size )
+{
+    static quint32  table[256];
+    static bool     tableInitialized = false;
+
+    if ( tableInitialized == false )
+    {
+        for ( quint32 i = 0; i < 256; ++i )
+        {
+            quint32     c = i;
+            for ( int k = 0; k < 8; ++k )
+                c = ( c & 1 ) ? 0xEDB88320 ^ ( c >> 1 ) : c >> 1;
+            table[i] = c;
+        }
+        tableInitialized = true;
+    }
+    crc = ~crc;
+    for ( qint64 i = 0; i < size; ++i )
+        crc = table[( crc ^ data[i] ) & 0xFF] ^ ( crc >> 8 );
+    return ~crc;
+}
+
+quint32
+ProjectCacheWriter::addString( const QString& str )
+{
+    quint32     offset = m_strings.size();
+
+    m_strings += str;
+    return offset;
+}
+
+void
+ProjectCacheWriter::addMedia( const Media* media )
+{
+    //As in the project file, only the medias read from a file are saved,
+    //and so are their clips.
+    if ( media->fileInfo() == NULL )
+        return ;
+    ProjectCache::MediaRecord   record;
+    QString                     path = media->fileInfo()->absoluteFilePath();
+
+    record.path = addString( path );
+    record.pathLength = path.size();
+    record.uuid = ProjectCache::fromUuid( media->uuid() );
+    m_mediaIndexes[media->uuid()] = m_medias.size();
+    m_medias.push_back( record );
+}
+
+void
+ProjectCacheWriter::addClip( Clip* clip )
+{
+    QHash<QUuid, quint32>::const_iterator   it = m_mediaIndexes.find( clip->getParent()->uuid() );
+    if ( it == m_mediaIndexes.end() )
+        return ;
+
+    ProjectCache::ClipRecord    record;
+    record.media = it.value();
+    record.reserved = 0;
+    record.begin = clip->begin();
+    record.end = clip->end();
+    record.uuid = ProjectCache::fromUuid( clip->uuid() );
+    m_clips.push_back( record );
+}
+
+void
+ProjectCacheWriter::addTimelineClip( unsigned int trackId, int trackType,
+                                     qint64 startFrame, Clip* clip )
+{
+    //Like with the XML project, clips from a media missing from the library
+    //are not loaded.
+    QHash<QUuid, quint32>::const_iterator   it = m_mediaIndexes.find( clip->getParent()->uuid() );
+    if ( it == m_mediaIndexes.end() )
+        return ;
+
+    ProjectCache::TimelineClipRecord    record;
+    record.media = it.value();
+    record.trackId = trackId;
+    record.trackType = trackType;
+    record.reserved = 0;
+    record.startFrame = startFrame;
+    record.begin = clip->begin();
+    record.end = clip->end();
+    m_timelineClips.push_back( record );
+}
+
+void
+ProjectCacheWriter::addSetting( const QString& key, const QString& value )
+{
+    ProjectCache::SettingRecord     record;
+
+    record.key = addString( key );
+    record.keyLength = key.size();
+    record.value = addString( value );
+    record.valueLength = value.size();
+    m_settings.push_back( record );
+}
+
+bool
+ProjectCacheWriter::write( QIODevice* device, const QFileInfo& project ) const
+{
+    ProjectCache::Header    header;
+
+    //Zero the whole header, padding included, as it is checksummed.
+    memset( &header, 0, sizeof( header ) );
+    header.magic = ProjectCache::Magic;
+    header.version = ProjectCache::Version;
+    header.nbMedias = m_medias.size();
+    header.nbClips = m_clips.size();
+    header.nbTimelineClips = m_timelineClips.size();
+    header.nbSettings = m_settings.size();
+    header.stringsSize = m_strings.size();
+    header.projectSize = project.size();
+    header.projectModified = project.lastModified().toTime_t();
+
+    const uchar*    parts[5];
+    qint64          sizes[5];
+    parts[0] = reinterpret_cast<const uchar*>( m_medias.constData() );
+    sizes[0] = m_medias.size() * sizeof( ProjectCache::MediaRecord );
+    parts[1] = reinterpret_cast<const uchar*>( m_clips.constData() );
+    sizes[1] = m_clips.size() * sizeof( ProjectCache::ClipRecord );
+    parts[2] = reinterpret_cast<const uchar*>( m_timelineClips.constData() );
+    sizes[2] = m_timelineClips.size() * sizeof( ProjectCache::TimelineClipRecord );
+    parts[3] = reinterpret_cast<const uchar*>( m_settings.constData() );
+    sizes[3] = m_settings.size() * sizeof( ProjectCache::SettingRecord );
+    parts[4] = reinterpret_cast<const uchar*>( m_strings.constData() );
+    sizes[4] = m_strings.size() * sizeof( ushort );
+
+    quint32     crc = ProjectCache::crc32( 0, reinterpret_cast<const uchar*>( &header ),
+                                           sizeof( header ) );
+    for ( int i = 0; i < 5; ++i )
+        crc = ProjectCache::crc32( crc, parts[i], sizes[i] );
+    header.checksum = crc;
+
+    if ( device->write( reinterpret_cast<const char*>( &header ), sizeof( header ) ) !=
+         (qint64)sizeof( header ) )
+        return false;
+    for ( int i = 0; i < 5; ++i )
+    {
+        if ( sizes[i] != 0 &&
+             device->write( reinterpret_cast<const char*>( parts[i] ), sizes[i] ) != sizes[i] )
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,179 @@
+/*****************************************************************************
+ * ProjectCache.h: Binary snapshot of a project, for fast reopening
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PROJECTCACHE_H
+#define PROJECTCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+class   QFile;
+class   QFileInfo;
+class   QIODevice;
+
+class   Clip;
+class   Media;
+
+/**
+ *  \brief  Read only access to a binary project cache.
+ *
+ *  The cache is written next to the XML project file, and holds the same
+ *  medias, clips, timeline and project settings. It's made of a fixed size
+ *  header, followed by arrays of fixed size records and a table of UTF-16
+ *  strings, so that it can be mapped and read in place without any parsing.
+ *
+ *  Values are stored in the host byte order. A cache written on a host with
+ *  another byte order fails the magic check, and the XML project is used.
+ */
+class   ProjectCache
+{
+    public:
+        static const quint32    Magic = 0x424d4c56;
+        static const quint32    Version = 1;
+
+        struct  Uuid
+        {
+            quint32     data1;
+            quint16     data2;
+            quint16     data3;
+            quint8      data4[8];
+        };
+        struct  Header
+        {
+            quint32     magic;
+            quint32     version;
+            /// CRC32 of the whole file, computed with this field set to 0
+            quint32     checksum;
+            quint32     nbMedias;
+            quint32     nbClips;
+            quint32     nbTimelineClips;
+            quint32     nbSettings;
+            /// Size of the string table, in UTF-16 code units
+            quint32     stringsSize;
+            /// Size and modification time of the XML project this cache matches
+            qint64      projectSize;
+            qint64      projectModified;
+        };
+        struct  MediaRecord
+        {
+            quint32     path;
+            quint32     pathLength;
+            Uuid        uuid;
+        };
+        struct  ClipRecord
+        {
+            quint32     media;
+            quint32     reserved;
+            qint64      begin;
+            qint64      end;
+            Uuid        uuid;
+        };
+        struct  TimelineClipRecord
+        {
+            quint32     media;
+            quint32     trackId;
+            quint32     trackType;
+            quint32     reserved;
+            qint64      startFrame;
+            qint64      begin;
+            qint64      end;
+        };
+        struct  SettingRecord
+        {
+            quint32     key;
+            quint32     keyLength;
+            quint32     value;
+            quint32     valueLength;
+        };
+
+        ProjectCache();
+        ~ProjectCache();
+
+        /**
+         *  \brief  Map the cache of a project.
+         *
+         *  \return false if there is no cache, or if it is invalid, or if it
+         *          doesn't match the current project file.
+         */
+        bool                        open( const QString& projectFile );
+
+        quint32                     nbMedias() const;
+        const MediaRecord&          media( quint32 index ) const;
+        quint32                     nbClips() const;
+        const ClipRecord&           clip( quint32 index ) const;
+        quint32                     nbTimelineClips() const;
+        const TimelineClipRecord&   timelineClip( quint32 index ) const;
+        quint32                     nbSettings() const;
+        const SettingRecord&        setting( quint32 index ) const;
+        /// Returns a copy of a string from the string table.
+        QString                     string( quint32 offset, quint32 length ) const;
+
+        /// Returns the name of the cache file for a project.
+        static QString              fileName( const QString& projectFile );
+        static QUuid                toUuid( const Uuid& uuid );
+        static Uuid                 fromUuid( const QUuid& uuid );
+        static quint32              crc32( quint32 crc, const uchar* data, qint64 size );
+
+    private:
+        QFile*                      m_file;
+        const Header*               m_header;
+        const MediaRecord*          m_medias;
+        const ClipRecord*           m_clips;
+        const TimelineClipRecord*   m_timelineClips;
+        const SettingRecord*        m_settings;
+        const ushort*               m_strings;
+};
+
+/**
+ *  \brief  Builds a binary project cache.
+ *
+ *  Medias must be added before the clips referencing them.
+ */
+class   ProjectCacheWriter
+{
+    public:
+        void                        addMedia( const Media* media );
+        void                        addClip( Clip* clip );
+        void                        addTimelineClip( unsigned int trackId, int trackType,
+                                                     qint64 startFrame, Clip* clip );
+        void                        addSetting( const QString& key, const QString& value );
+        /**
+         *  \brief  Write the cache.
+         *  \param  project The XML project file this cache matches.
+         */
+        bool                        write( QIODevice* device, const QFileInfo& project ) const;
+
+    private:
+        quint32                     addString( const QString& str );
+
+    private:
+        QHash<QUuid, quint32>                           m_mediaIndexes;
+        QVector<ProjectCache::MediaRecord>              m_medias;
+        QVector<ProjectCache::ClipRecord>               m_clips;
+        QVector<ProjectCache::TimelineClipRecord>       m_timelineClips;
+        QVector<ProjectCache::SettingRecord>            m_settings;
+        QString                                         m_strings;
+};
+
+#endif // PROJECTCACHE_H
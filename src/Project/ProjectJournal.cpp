@@ -0,0 +1,414 @@
+/*****************************************************************************
+ * ProjectJournal.cpp: Append-only journal of the project edits
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "Clip.h"
+#include "Library.h"
+#include "Media.h"
+#include "ProjectJournal.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QUrl>
+#include <QUuid>
+#include <QtDebug>
+
+#ifndef Q_OS_WIN
+    #include <unistd.h>
+#endif
+
+const QByteArray    ProjectJournal::Magic( "VLMCJOURNAL" );
+
+ProjectJournal::ProjectJournal( QObject* parent /*= NULL*/ ) :
+        QObject( parent ),
+        m_file( NULL ),
+        m_generation( 0 ),
+        m_size( 0 ),
+        m_rotating( false )
+{
+}
+
+ProjectJournal::~ProjectJournal()
+{
+    delete m_file;
+}
+
+QString
+ProjectJournal::fileName( const QString& projectFile )
+{
+    return projectFile + ".journal";
+}
+
+QString
+ProjectJournal::oldFileName( const QString& fileName )
+{
+    return fileName + ".old";
+}
+
+void
+ProjectJournal::start( const QString& fileName, quint32 generation )
+{
+    stop( false );
+    QFile::remove( fileName );
+    QFile::remove( ProjectJournal::oldFileName( fileName ) );
+    m_fileName = fileName;
+    m_generation = generation;
+    m_size = 0;
+}
+
+bool
+ProjectJournal::recover( const QString& fileName, quint32 generation )
+{
+    QList<QByteArray>   entries;
+
+    stop( false );
+    ProjectJournal::readSegment( ProjectJournal::oldFileName( fileName ), generation, entries );
+    ProjectJournal::readSegment( fileName, generation, entries );
+    foreach ( const QByteArray& entry, entries )
+        ProjectJournal::replay( entry );
+
+    //Merge the segments, so that the journal can be resumed as is.
+    if ( ProjectJournal::writeSegment( fileName, generation, entries ) == false )
+        return false;
+    QFile::remove( ProjectJournal::oldFileName( fileName ) );
+    m_fileName = fileName;
+    m_generation = generation;
+    m_size = entries.size();
+    return entries.isEmpty() == false;
+}
+
+void
+ProjectJournal::stop( bool discard )
+{
+    delete m_file;
+    m_file = NULL;
+    if ( discard == true && m_fileName.isEmpty() == false )
+    {
+        QFile::remove( m_fileName );
+        QFile::remove( ProjectJournal::oldFileName( m_fileName ) );
+    }
+    m_fileName = QString();
+    m_size = 0;
+    m_rotating = false;
+}
+
+void
+ProjectJournal::sync()
+{
+#ifndef Q_OS_WIN
+    if ( m_file != NULL )
+        ::fsync( m_file->handle() );
+#endif
+}
+
+void
+ProjectJournal::rotate()
+{
+    Q_ASSERT( m_rotating == false );
+
+    delete m_file;
+    m_file = NULL;
+    QString     oldName = ProjectJournal::oldFileName( m_fileName );
+    QFile::remove( oldName );
+    if ( m_size != 0 && QFile::rename( m_fileName, oldName ) == false )
+        qWarning() << "Can't rotate journal" << m_fileName;
+    ++m_generation;
+    m_size = 0;
+    m_rotating = true;
+}
+
+void
+ProjectJournal::commitRotation()
+{
+    if ( m_rotating == false )
+        return ;
+    QFile::remove( ProjectJournal::oldFileName( m_fileName ) );
+    m_rotating = false;
+}
+
+void
+ProjectJournal::abortRotation()
+{
+    if ( m_rotating == false )
+        return ;
+
+    QList<QByteArray>   entries;
+    QString             oldName = ProjectJournal::oldFileName( m_fileName );
+
+    delete m_file;
+    m_file = NULL;
+    --m_generation;
+    ProjectJournal::readSegment( oldName, m_generation, entries );
+    ProjectJournal::readSegment( m_fileName, m_generation, entries );
+    if ( ProjectJournal::writeSegment( m_fileName, m_generation, entries ) == true )
+        QFile::remove( oldName );
+    m_size = entries.size();
+    m_rotating = false;
+}
+
+bool
+ProjectJournal::isRotating() const
+{
+    return m_rotating;
+}
+
+const QString&
+ProjectJournal::fileName() const
+{
+    return m_fileName;
+}
+
+quint32
+ProjectJournal::generation() const
+{
+    return m_generation;
+}
+
+int
+ProjectJournal::size() const
+{
+    return m_size;
+}
+
+void
+ProjectJournal::append( const QByteArray& entry )
+{
+    if ( m_fileName.isEmpty() == true )
+        return ;
+    if ( m_file == NULL )
+    {
+        //The segment doesn't exist yet when nothing has been appended since
+        //it's been started.
+        bool    exists = ( m_size != 0 );
+
+        m_file = new QFile( m_fileName );
+        QIODevice::OpenMode     mode = QIODevice::WriteOnly | QIODevice::Unbuffered;
+        if ( m_file->open( exists == true ? mode | QIODevice::Append : mode | QIODevice::Truncate ) == false )
+        {
+            qWarning() << "Can't open journal" << m_fileName << ':' << m_file->errorString();
+            delete m_file;
+            m_file = NULL;
+            return ;
+        }
+        if ( exists == false )
+            m_file->write( Magic + ' ' + QByteArray::number( Version ) + ' ' +
+                           QByteArray::number( m_generation ) + '\n' );
+    }
+    //The file is unbuffered: each entry reaches the system in a single write.
+    if ( m_file->write( entry + '\n' ) != entry.size() + 1 )
+        qWarning() << "Can't write to journal" << m_fileName << ':' << m_file->errorString();
+    else
+        ++m_size;
+}
+
+void
+ProjectJournal::readSegment( const QString& fileName, quint32 generation,
+                             QList<QByteArray>& entries )
+{
+    QFile   file( fileName );
+
+    if ( file.open( QFile::ReadOnly ) == false )
+        return ;
+
+    QList<QByteArray>   header = file.readLine().trimmed().split( ' ' );
+    if ( header.size() != 3 || header.at( 0 ) != Magic ||
+         header.at( 1 ).toUInt() != Version )
+    {
+        qWarning() << "Invalid journal" << fileName;
+        return ;
+    }
+    if ( header.at( 2 ).toUInt() < generation )
+        return ;
+    while ( file.atEnd() == false )
+    {
+        QByteArray  line = file.readLine();
+
+        if ( line.endsWith( '\n' ) == false )
+            break ;
+        line.chop( 1 );
+        entries.append( line );
+    }
+}
+
+bool
+ProjectJournal::writeSegment( const QString& fileName, quint32 generation,
+                              const QList<QByteArray>& entries )
+{
+    QString     tmpFileName = fileName + ".tmp";
+    QFile       file( tmpFileName );
+
+    if ( file.open( QFile::WriteOnly | QFile::Truncate ) == false )
+    {
+        qWarning() << "Can't write journal" << tmpFileName << ':' << file.errorString();
+        return false;
+    }
+    file.write( Magic + ' ' + QByteArray::number( Version ) + ' ' +
+                QByteArray::number( generation ) + '\n' );
+    foreach ( const QByteArray& entry, entries )
+        file.write( entry + '\n' );
+    if ( file.flush() == false || file.error() != QFile::NoError )
+    {
+        qWarning() << "Can't write journal" << tmpFileName << ':' << file.errorString();
+        file.close();
+        file.remove();
+        return false;
+    }
+#ifndef Q_OS_WIN
+    ::fsync( file.handle() );
+#endif
+    file.close();
+    QFile::remove( fileName );
+    return QFile::rename( tmpFileName, fileName );
+}
+
+void
+ProjectJournal::clipAdded( Clip* clip, unsigned int trackId, qint64 pos,
+                           MainWorkflow::TrackType trackType )
+{
+    append( "add " + QByteArray::number( trackType ) + ' ' +
+            QByteArray::number( trackId ) + ' ' + QByteArray::number( pos ) + ' ' +
+            clip->getParent()->uuid().toString().toAscii() + ' ' +
+            QByteArray::number( clip->begin() ) + ' ' + QByteArray::number( clip->end() ) );
+}
+
+void
+ProjectJournal::clipRemoved( unsigned int trackId, qint64 pos,
+                             MainWorkflow::TrackType trackType )
+{
+    append( "remove " + QByteArray::number( trackType ) + ' ' +
+            QByteArray::number( trackId ) + ' ' + QByteArray::number( pos ) );
+}
+
+void
+ProjectJournal::clipMoved( unsigned int oldTrack, qint64 oldPos,
+                           unsigned int newTrack, qint64 newPos,
+                           MainWorkflow::TrackType trackType )
+{
+    append( "move " + QByteArray::number( trackType ) + ' ' +
+            QByteArray::number( oldTrack ) + ' ' + QByteArray::number( oldPos ) + ' ' +
+            QByteArray::number( newTrack ) + ' ' + QByteArray::number( newPos ) );
+}
+
+void
+ProjectJournal::clipResized( unsigned int trackId, qint64 oldPos, qint64 newPos,
+                             qint64 begin, qint64 end,
+                             MainWorkflow::TrackType trackType )
+{
+    append( "resize " + QByteArray::number( trackType ) + ' ' +
+            QByteArray::number( trackId ) + ' ' + QByteArray::number( oldPos ) + ' ' +
+            QByteArray::number( newPos ) + ' ' + QByteArray::number( begin ) + ' ' +
+            QByteArray::number( end ) );
+}
+
+void
+ProjectJournal::mediaAdded( Media* media )
+{
+    //The medias without a file aren't saved in the project either.
+    if ( media->fileInfo() == NULL )
+        return ;
+    //The path is the last field, and is encoded so that it stays on one line.
+    append( "media " + media->uuid().toString().toAscii() + ' ' +
+            QUrl::toPercentEncoding( media->fileInfo()->absoluteFilePath() ) );
+}
+
+void
+ProjectJournal::mediaRemoved( const QUuid& uuid )
+{
+    append( "unmedia " + uuid.toString().toAscii() );
+}
+
+void
+ProjectJournal::replay( const QByteArray& entry )
+{
+    MainWorkflow*           workflow = MainWorkflow::getInstance();
+    QList<QByteArray>       fields = entry.split( ' ' );
+    const QByteArray&       op = fields.at( 0 );
+
+    if ( op == "media" && fields.size() == 3 )
+    {
+        QString     path = QUrl::fromPercentEncoding( fields.at( 2 ) );
+        Library::getInstance()->addMedia( QFileInfo( path ), QString( fields.at( 1 ) ) );
+        return ;
+    }
+    if ( op == "unmedia" && fields.size() == 2 )
+    {
+        Library::getInstance()->removingMediaAsked( QUuid( QString( fields.at( 1 ) ) ) );
+        return ;
+    }
+
+    //Every timeline entry starts with the track type, the track and the clip position.
+    if ( fields.size() < 4 )
+    {
+        qWarning() << "Invalid journal entry" << entry;
+        return ;
+    }
+    MainWorkflow::TrackType trackType = static_cast<MainWorkflow::TrackType>( fields.at( 1 ).toUInt() );
+    unsigned int            trackId = fields.at( 2 ).toUInt();
+    qint64                  pos = fields.at( 3 ).toLongLong();
+
+    if ( trackType >= MainWorkflow::NbTrackType ||
+         static_cast<int>( trackId ) >= workflow->getTrackCount( trackType ) )
+    {
+        qWarning() << "Invalid track in journal entry" << entry;
+        return ;
+    }
+    if ( op == "add" && fields.size() == 7 )
+    {
+        QUuid   parent( QString( fields.at( 4 ) ) );
+
+        if ( Library::getInstance()->media( parent ) != NULL )
+        {
+            Clip*   clip = new Clip( parent, fields.at( 5 ).toLongLong(), fields.at( 6 ).toLongLong() );
+            workflow->addClip( clip, trackId, pos, trackType );
+        }
+        return ;
+    }
+
+    Clip*   clip = workflow->getClipAt( trackId, pos, trackType );
+    if ( clip == NULL )
+    {
+        qWarning() << "No clip matching journal entry" << entry;
+        return ;
+    }
+    if ( op == "remove" && fields.size() == 4 )
+    {
+        workflow->removeClip( clip->uuid(), trackId, trackType );
+        delete clip;
+    }
+    else if ( op == "move" && fields.size() == 6 )
+    {
+        unsigned int    newTrack = fields.at( 4 ).toUInt();
+
+        if ( static_cast<int>( newTrack ) < workflow->getTrackCount( trackType ) )
+            workflow->moveClip( clip->uuid(), trackId, newTrack, fields.at( 5 ).toLongLong(),
+                                trackType, true );
+    }
+    else if ( op == "resize" && fields.size() == 7 )
+    {
+        //Re-add the clip, so that the timeline picks its new boundaries.
+        workflow->removeClip( clip->uuid(), trackId, trackType );
+        clip->setBoundaries( fields.at( 5 ).toLongLong(), fields.at( 6 ).toLongLong() );
+        workflow->addClip( clip, trackId, fields.at( 4 ).toLongLong(), trackType );
+    }
+    else
+        qWarning() << "Invalid journal entry" << entry;
+}
@@ -0,0 +1,153 @@
+/*****************************************************************************
+ * ProjectJournal.h: Append-only journal of the project edits
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PROJECTJOURNAL_H
+#define PROJECTJOURNAL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "MainWorkflow.h"
+
+class   QFile;
+class   QUuid;
+
+class   Clip;
+class   Media;
+
+/**
+ *  \brief  Append-only journal of the edits made since the project was written.
+ *
+ *  Each edit is appended as one line of text, and handed to the system right
+ *  away, so that it survives a crash of VLMC. Syncing it to the disk is left
+ *  to sync(), which only has to flush the edits made since its last call.
+ *
+ *  Timeline clips are identified by their track and starting frame, as their
+ *  uuids aren't saved with the project.
+ *
+ *  A journal starts with its generation, which is the journal generation of
+ *  the project file it applies to. When the project is compacted in the
+ *  background, the journal is rotated: the current segment is kept as
+ *  "<journal>.old" until the new project file has been written, and the new
+ *  segment gets the next generation. When recovering, only the segments
+ *  whose generation isn't older than the project's one are replayed.
+ */
+class   ProjectJournal : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( ProjectJournal );
+
+    public:
+        static const QByteArray     Magic;
+        static const quint32        Version = 1;
+
+        ProjectJournal( QObject* parent = NULL );
+        ~ProjectJournal();
+
+        static QString      fileName( const QString& projectFile );
+        /**
+         *  \brief  Start a new journal segment, discarding the previous one.
+         *
+         *  The file is only created when the first edit is appended.
+         */
+        void                start( const QString& fileName, quint32 generation );
+        /**
+         *  \brief  Replay a journal on top of the loaded project, and resume it.
+         *
+         *  \param  generation  The journal generation of the loaded project.
+         *  \return false if there was no journal to replay.
+         */
+        bool                recover( const QString& fileName, quint32 generation );
+        /**
+         *  \brief  Close the journal.
+         *  \param  discard     If true, the journal files are removed.
+         */
+        void                stop( bool discard );
+        /**
+         *  \brief  Flush the appended edits to the disk.
+         *
+         *  This only uses fsync, and can be called from a signal handler.
+         */
+        void                sync();
+
+        /**
+         *  \brief  Start a segment for the next generation, keeping the current
+         *          one until commitRotation() or abortRotation() is called.
+         */
+        void                rotate();
+        /// The project file for the new generation has been written.
+        void                commitRotation();
+        /// The project file couldn't be written: merge back the previous segment.
+        void                abortRotation();
+        bool                isRotating() const;
+
+        const QString&      fileName() const;
+        quint32             generation() const;
+        /// The number of edits in the current segment.
+        int                 size() const;
+
+        void                clipAdded( Clip* clip, unsigned int trackId, qint64 pos,
+                                       MainWorkflow::TrackType trackType );
+        void                clipRemoved( unsigned int trackId, qint64 pos,
+                                         MainWorkflow::TrackType trackType );
+        void                clipMoved( unsigned int oldTrack, qint64 oldPos,
+                                       unsigned int newTrack, qint64 newPos,
+                                       MainWorkflow::TrackType trackType );
+        /**
+         *  \brief  A clip has been resized, and possibly moved on its track.
+         *  \param  begin   The new clip beginning.
+         *  \param  end     The new clip end.
+         */
+        void                clipResized( unsigned int trackId, qint64 oldPos, qint64 newPos,
+                                         qint64 begin, qint64 end,
+                                         MainWorkflow::TrackType trackType );
+
+    public slots:
+        void                mediaAdded( Media* media );
+        void                mediaRemoved( const QUuid& uuid );
+
+    private:
+        static QString      oldFileName( const QString& fileName );
+        void                append( const QByteArray& entry );
+        /**
+         *  \brief  Read the complete entries of a segment.
+         *
+         *  A segment older than generation is ignored, and so is the last
+         *  entry if it has been truncated by a crash.
+         */
+        static void         readSegment( const QString& fileName, quint32 generation,
+                                         QList<QByteArray>& entries );
+        static bool         writeSegment( const QString& fileName, quint32 generation,
+                                          const QList<QByteArray>& entries );
+        static void         replay( const QByteArray& entry );
+
+    private:
+        QFile*              m_file;
+        QString             m_fileName;
+        quint32             m_generation;
+        int                 m_size;
+        bool                m_rotating;
+};
+
+#endif // PROJECTJOURNAL_H
@@ -28,17 +28,29 @@
 
 #include "Library.h"
 #include "MainWorkflow.h"
+#include "ProjectCache.h"
+#include "ProjectJournal.h"
 #include "ProjectManager.h"
 #include "SettingsManager.h"
+#include "XmlStream.hpp"
 
+#include <QBuffer>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
 #include <QtDebug>
 #include <QTimer>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include <errno.h>
 #include <signal.h>
+#ifdef Q_OS_WIN
+    #include <windows.h>
+#else
+    #include <stdio.h>
+    #include <unistd.h>
+#endif
 
 #ifdef WITH_CRASHHANDLER
 void    ProjectManager::signalHandler( int sig )
@@ -59,6 +71,46 @@ void    ProjectManager::signalHandler( int sig )
 const QString   ProjectManager::unNamedProject = tr( "<Unnamed project>" );
 const QString   ProjectManager::unSavedProject = tr( "<Unsaved project>" );
 
+ProjectManager::CompactionWorker::CompactionWorker( QObject* parent ) :
+        QThread( parent ),
+        m_succeeded( false )
+{
+}
+
+void
+ProjectManager::CompactionWorker::compact( const QByteArray& data, const QString& fileName )
+{
+    Q_ASSERT( isRunning() == false );
+
+    m_data = data;
+    m_fileName = fileName;
+    m_succeeded = false;
+    start( QThread::LowPriority );
+}
+
+bool
+ProjectManager::CompactionWorker::succeeded() const
+{
+    return m_succeeded;
+}
+
+void
+ProjectManager::CompactionWorker::run()
+{
+    QFile   file( m_fileName + ".tmp" );
+
+    if ( file.open( QFile::WriteOnly | QFile::Truncate ) == false ||
+         file.write( m_data ) != m_data.size() )
+    {
+        qWarning() << "Can't save project to" << file.fileName() << ':' << file.errorString();
+        file.close();
+        file.remove();
+    }
+    else
+        m_succeeded = ProjectManager::commitProjectFile( file, m_fileName );
+    m_data.clear();
+}
+
 ProjectManager::ProjectManager() : m_projectFile( NULL ), m_needSave( false )
 {
     QSettings s;
@@ -74,11 +126,24 @@ ProjectManager::ProjectManager() : m_projectFile( NULL ), m_needSave( false )
     connect( this, SIGNAL( projectClosed() ), Library::getInstance(), SLOT( clear() ) );
     connect( this, SIGNAL( projectClosed() ), MainWorkflow::getInstance(), SLOT( clear() ) );
 
+    m_journal = new ProjectJournal( this );
+    connect( Library::getInstance(), SIGNAL( newMediaLoaded( Media* ) ),
+             m_journal, SLOT( mediaAdded( Media* ) ) );
+    connect( Library::getInstance(), SIGNAL( mediaRemoved( const QUuid& ) ),
+             m_journal, SLOT( mediaRemoved( const QUuid& ) ) );
+    m_compactionWorker = new CompactionWorker( this );
+    connect( m_compactionWorker, SIGNAL( finished() ), this, SLOT( compactionFinished() ) );
+
     VLMC_CREATE_PROJECT_DOUBLE( "video/VLMCOutputFPS", 29.97, "Output video FPS", "Frame Per Second used when previewing and rendering the project" );
     VLMC_CREATE_PROJECT_INT( "video/VideoProjectWidth", 480, "Video width", "Width resolution of the output video" );
     VLMC_CREATE_PROJECT_INT( "video/VideoProjectHeight", 300, "Video height", "Height resolution of the output video" );
     VLMC_CREATE_PROJECT_INT( "audio/AudioSampleRate", 0, "Audio samplerate", "Output project audio samplerate" );
     VLMC_CREATE_PROJECT_STRING( "general/VLMCWorkspace", QDir::homePath(), "Workspace location", "The place where all project's videos will be stored" );
+    VLMC_CREATE_PROJECT_STRING( "general/WatchedFolders", "", "Watched folders",
+                                "The new medias of these folders, separated by ';', are added to the library" );
+    SettingsManager::getInstance()->watchValue( "general/WatchedFolders", Library::getInstance(),
+                                                SLOT( setWatchedFolders( const QVariant& ) ),
+                                                SettingsManager::Project );
 
     VLMC_CREATE_PROJECT_STRING( "general/ProjectName", unNamedProject, "Project name", "The project name" );
     SettingsManager::getInstance()->watchValue( "general/ProjectName", this,
@@ -102,6 +167,9 @@ ProjectManager::ProjectManager() : m_projectFile( NULL ), m_needSave( false )
                                                 SettingsManager::Vlmc,
                                                 Qt::QueuedConnection );
     automaticSaveEnabledChanged( VLMC_GET_BOOL( "general/AutomaticBackup" ) );
+    VLMC_CREATE_PREFERENCE_BOOL( "general/ProjectCache", true, "Project cache",
+                            "When this option is activated, VLMC saves a binary copy "
+                            "of the project next to it, to reopen it faster" );
 }
 
 ProjectManager::~ProjectManager()
@@ -110,6 +178,9 @@ ProjectManager::~ProjectManager()
     QSettings s;
     s.sync();
 
+    //VLMC is exiting normally: the journal won't be recovered.
+    m_compactionWorker->wait();
+    m_journal->stop( true );
     if ( m_projectFile != NULL )
         delete m_projectFile;
 }
@@ -130,38 +201,130 @@ void    ProjectManager::cleanChanged( bool val )
     emit projectUpdated( projectName(), val );
 }
 
-void    ProjectManager::loadTimeline()
+void    ProjectManager::parseProjectNode( QXmlStreamReader& reader )
 {
-    QDomElement     root = m_domDocument->documentElement();
+    QHash<QString, QString>     values;
 
-    MainWorkflow::getInstance()->loadProject( root.firstChildElement( "timeline" ) );
-    emit projectUpdated( projectName(), true );
+    while ( XmlStream::readNextChild( reader ) == true )
+    {
+        QXmlStreamAttributes    attributes = reader.attributes();
+
+        if ( attributes.count() > 1 )
+            qWarning() << "Invalid number of attributes for" << reader.name().toString();
+        else if ( attributes.count() == 1 )
+            values[reader.name().toString()] = attributes.at( 0 ).value().toString();
+        XmlStream::skipElement( reader );
+    }
+    loadProjectValues( values );
 }
 
-void    ProjectManager::parseProjectNode( const QDomElement &node )
+void    ProjectManager::loadProjectValues( const QHash<QString, QString>& values )
 {
-    QDomElement     projectNameNode = node.firstChildElement( "ProjectName" );
-    m_projectName = projectNameNode.attribute( "value", ProjectManager::unNamedProject );
+    m_projectName = values.value( "ProjectName", ProjectManager::unNamedProject );
+    SettingsManager::getInstance()->load( "project", values );
 }
 
-void    ProjectManager::loadProject( const QString& fileName )
+bool    ProjectManager::loadProjectCache( const QString& fileName )
+{
+    ProjectCache    cache;
+
+    if ( cache.open( fileName ) == false )
+        return false;
+    Library::getInstance()->loadProject( cache );
+    MainWorkflow::getInstance()->loadProject( cache );
+
+    QHash<QString, QString>     values;
+    for ( quint32 i = 0; i < cache.nbSettings(); ++i )
+    {
+        const ProjectCache::SettingRecord&  record = cache.setting( i );
+        QString     key = cache.string( record.key, record.keyLength );
+
+        if ( key.startsWith( "project/" ) == true )
+            values[key.mid( 8 )] = cache.string( record.value, record.valueLength );
+    }
+    loadProjectValues( values );
+    return true;
+}
+
+bool    ProjectManager::saveProjectCache( const QString& fileName )
+{
+    ProjectCacheWriter  writer;
+
+    Library::getInstance()->saveProject( writer );
+    MainWorkflow::getInstance()->saveProject( writer );
+    SettingsManager::getInstance()->save( writer );
+
+    //The cache must be written after the project, as it records its
+    //size and modification time.
+    QString     cacheFileName = ProjectCache::fileName( fileName );
+    QString     tmpFileName = cacheFileName + ".tmp";
+    QFile       file( tmpFileName );
+
+    if ( file.open( QFile::WriteOnly | QFile::Truncate ) == false ||
+         writer.write( &file, QFileInfo( fileName ) ) == false ||
+         file.flush() == false )
+    {
+        qWarning() << "Can't write project cache" << tmpFileName << ':' << file.errorString();
+        file.close();
+        file.remove();
+        return false;
+    }
+    file.close();
+    if ( ProjectManager::replaceFile( tmpFileName, cacheFileName ) == false )
+    {
+        QFile::remove( tmpFileName );
+        return false;
+    }
+    return true;
+}
+
+void    ProjectManager::loadProject( const QString& fileName, bool renderOnly )
+{
+    if ( loadProjectFile( fileName, renderOnly ) == false || renderOnly == true )
+        return ;
+    //A project recovered from a legacy backup file doesn't keep a journal
+    //until it's been saved.
+    if ( m_projectFile != NULL )
+        m_journal->start( ProjectJournal::fileName( fileName ),
+                          ProjectManager::journalGeneration( fileName ) );
+}
+
+quint32 ProjectManager::journalGeneration( const QString& fileName )
+{
+    QFile       file( fileName );
+
+    if ( file.open( QFile::ReadOnly ) == false )
+        return 0;
+    QXmlStreamReader    reader( &file );
+    if ( XmlStream::readNextChild( reader ) == false )
+        return 0;
+    return reader.attributes().value( "journal" ).toString().toUInt();
+}
+
+bool    ProjectManager::loadProjectFile( const QString& fileName, bool renderOnly )
 {
     if ( fileName.isEmpty() == true )
-        return;
+        return false;
 
     if ( closeProject() == false )
-        return ;
+        return false;
 
+    QFile       file( fileName );
+    if ( file.open( QFile::ReadOnly ) == false )
+    {
+        qWarning() << "Can't open project file" << fileName << ':' << file.errorString();
+        return false;
+    }
     m_projectFile = new QFile( fileName );
-
-    m_domDocument = new QDomDocument;
-    m_projectFile->open( QFile::ReadOnly );
-    m_domDocument->setContent( m_projectFile );
-    m_projectFile->close();
     m_needSave = false;
 
     if ( ProjectManager::isBackupFile( fileName ) == false )
-        appendToRecentProject( fileName );
+    {
+        //The render processes load temporary snapshots, and would all
+        //write the recent projects at the same time.
+        if ( renderOnly == false )
+            appendToRecentProject( fileName );
+    }
     else
     {
         //Delete the project file representation, so the next time the user
@@ -170,12 +333,37 @@ void    ProjectManager::loadProject( const QString& fileName )
         m_projectFile = NULL;
     }
 
-    QDomElement     root = m_domDocument->documentElement();
+    m_projectName = ProjectManager::unNamedProject;
+    //The cache is only used when it matches the project file.
+    if ( VLMC_GET_BOOL( "general/ProjectCache" ) == true &&
+         loadProjectCache( fileName ) == true )
+    {
+        emit projectUpdated( projectName(), true );
+        return true;
+    }
 
-    parseProjectNode( root.firstChildElement( "project" ) );
-    connect( Library::getInstance(), SIGNAL( projectLoaded() ), this, SLOT( loadTimeline() ) );
-    Library::getInstance()->loadProject( root.firstChildElement( "medias" ) );
-    SettingsManager::getInstance()->load( root.firstChildElement( "project" ) );
+    //Parts are loaded in the file order. The medias are always written
+    //before the timeline, which needs them.
+    QXmlStreamReader    reader( &file );
+    if ( XmlStream::readNextChild( reader ) == true )
+    {
+        while ( XmlStream::readNextChild( reader ) == true )
+        {
+            if ( reader.name() == "medias" )
+                Library::getInstance()->loadProject( reader );
+            else if ( reader.name() == "timeline" )
+                MainWorkflow::getInstance()->loadProject( reader );
+            else if ( reader.name() == "project" )
+                parseProjectNode( reader );
+            else
+                XmlStream::skipElement( reader );
+        }
+    }
+    if ( reader.hasError() == true )
+        qWarning() << "Error while loading project" << fileName << ':'
+                << reader.errorString() << "at line" << reader.lineNumber();
+    emit projectUpdated( projectName(), true );
+    return true;
 }
 
 QString  ProjectManager::acquireProjectFileName()
@@ -212,32 +400,98 @@ void    ProjectManager::saveProject( bool saveAs /*= true*/ )
     //save the project with a new name
     if ( createNewProjectFile( saveAs ) == false )
         return ;
-    __saveProject( m_projectFile->fileName() );
+    waitForCompaction();
+
+    quint32     generation = m_journal->generation() + 1;
+    if ( __saveProject( m_projectFile->fileName(), generation ) == false )
+        return ;
+    if ( VLMC_GET_BOOL( "general/ProjectCache" ) == true )
+        saveProjectCache( m_projectFile->fileName() );
+    //Everything journaled so far is now in the project file.
+    m_journal->stop( true );
+    m_journal->start( ProjectJournal::fileName( m_projectFile->fileName() ), generation );
     emit projectSaved();
     emit projectUpdated( projectName(), true );
 }
 
-void    ProjectManager::__saveProject( const QString &fileName )
+bool    ProjectManager::__saveProject( const QString &fileName, quint32 journalGeneration )
 {
-    QDomImplementation    implem = QDomDocument().implementation();
-    //FIXME: Think about naming the project...
-    QString name = "VLMCProject";
-    QString publicId = "-//XADECK//DTD Stone 1.0 //EN";
-    QString systemId = "http://www-imagis.imag.fr/DTD/stone1.dtd";
-    QDomDocument doc(implem.createDocumentType( name, publicId, systemId ) );
+    //Write a temporary file next to the project, and replace the project
+    //only once it's complete, so that a failure never leaves a truncated one.
+    QString tmpFileName = fileName + ".tmp";
+    QFile   file( tmpFileName );
 
-    QDomElement rootNode = doc.createElement( "vlmc" );
+    if ( file.open( QFile::WriteOnly | QFile::Truncate ) == false )
+    {
+        qWarning() << "Can't save project to" << tmpFileName << ':' << file.errorString();
+        return false;
+    }
+
+    writeProject( &file, journalGeneration );
+    return ProjectManager::commitProjectFile( file, fileName );
+}
 
-    Library::getInstance()->saveProject( doc, rootNode );
-    MainWorkflow::getInstance()->saveProject( doc, rootNode );
-    SettingsManager::getInstance()->save( doc, rootNode );
+void    ProjectManager::writeProject( QIODevice* device, quint32 journalGeneration )
+{
+    QXmlStreamWriter    writer( device );
+    writer.setAutoFormatting( true );
+    writer.writeStartDocument();
+    //FIXME: Think about naming the project...
+    writer.writeDTD( "<!DOCTYPE VLMCProject PUBLIC '-//XADECK//DTD Stone 1.0 //EN' "
+                     "'http://www-imagis.imag.fr/DTD/stone1.dtd'>" );
+    writer.writeStartElement( "vlmc" );
+    writer.writeAttribute( "journal", QString::number( journalGeneration ) );
+    Library::getInstance()->saveProject( writer );
+    MainWorkflow::getInstance()->saveProject( writer );
+    SettingsManager::getInstance()->save( writer );
+    writer.writeEndElement();
+    writer.writeEndDocument();
+}
 
-    doc.appendChild( rootNode );
+bool    ProjectManager::commitProjectFile( QFile& file, const QString& fileName )
+{
+    QString tmpFileName = file.fileName();
 
-    QFile   file( fileName );
-    file.open( QFile::WriteOnly );
-    file.write( doc.toString().toAscii() );
+    if ( file.flush() == false || file.error() != QFile::NoError )
+    {
+        qWarning() << "Can't save project to" << tmpFileName << ':' << file.errorString();
+        file.close();
+        file.remove();
+        return false;
+    }
+#ifndef Q_OS_WIN
+    ::fsync( file.handle() );
+#endif
     file.close();
+    if ( ProjectManager::replaceFile( tmpFileName, fileName ) == false )
+    {
+        qWarning() << "Can't replace project file" << fileName;
+        QFile::remove( tmpFileName );
+        return false;
+    }
+    return true;
+}
+
+bool    ProjectManager::replaceFile( const QString& from, const QString& to )
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW( reinterpret_cast<const wchar_t*>( QDir::toNativeSeparators( from ).utf16() ),
+                        reinterpret_cast<const wchar_t*>( QDir::toNativeSeparators( to ).utf16() ),
+                        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != 0;
+#else
+    return ::rename( QFile::encodeName( from ).constData(),
+                     QFile::encodeName( to ).constData() ) == 0;
+#endif
+}
+
+void    ProjectManager::saveSnapshot( const QString &fileName )
+{
+    __saveProject( fileName, m_journal->generation() );
+}
+
+ProjectJournal* ProjectManager::journal()
+{
+    return m_journal;
 }
 
 void    ProjectManager::newProject( const QString &projectName )
@@ -245,6 +499,7 @@ void    ProjectManager::newProject( const QString &projectName )
     if ( closeProject() == false )
         return ;
     m_projectName = projectName;
+    m_journal->start( QDir::currentPath() + "/unsavedproject.vlmcjournal", 0 );
     emit projectUpdated( this->projectName(), false );
 }
 
@@ -252,6 +507,10 @@ bool    ProjectManager::closeProject()
 {
     if ( askForSaveIfModified() == false )
         return false;
+    //The project is either saved, or its changes are discarded: the journal
+    //has nothing left to recover.
+    waitForCompaction();
+    m_journal->stop( true );
     if ( m_projectFile != NULL )
     {
         delete m_projectFile;
@@ -299,19 +558,14 @@ void    ProjectManager::projectNameChanged( const QVariant& name )
 
 void    ProjectManager::emergencyBackup()
 {
-    QString     name;
+    //Every edit is already in the journal, it only has to reach the disk.
+    m_journal->sync();
 
+    QString     name;
     if ( m_projectFile != NULL )
-    {
         name = m_projectFile->fileName();
-        name += "backup";
-        __saveProject( name );
-    }
     else
-    {
-       name = QDir::currentPath() + "/unsavedproject.vlmcbackup";
-        __saveProject( name );
-    }
+        name = m_journal->fileName();
     QSettings   s;
     s.setValue( "EmergencyBackup", name );
     s.sync();
@@ -321,13 +575,27 @@ bool    ProjectManager::loadEmergencyBackup()
 {
     QSettings   s;
     QString lastProject = s.value( "EmergencyBackup" ).toString();
-    if ( QFile::exists( lastProject ) == true )
+    if ( QFile::exists( lastProject ) == false )
+        return false;
+
+    if ( lastProject.endsWith( ".vlmcjournal" ) == true )
     {
-        loadProject(  lastProject );
-        m_needSave = true;
-        return true;
+        //An unsaved project only has its journal.
+        if ( closeProject() == false )
+            return false;
+        m_journal->recover( lastProject, 0 );
+    }
+    else
+    {
+        if ( loadProjectFile( lastProject ) == false )
+            return false;
+        if ( m_projectFile != NULL )
+            m_journal->recover( ProjectJournal::fileName( lastProject ),
+                                ProjectManager::journalGeneration( lastProject ) );
     }
-    return false;
+    m_needSave = true;
+    emit projectUpdated( projectName(), false );
+    return true;
 }
 
 bool    ProjectManager::isBackupFile( const QString& projectFile )
@@ -372,9 +640,54 @@ void    ProjectManager::automaticSaveIntervalChanged( const QVariant& val )
 
 void    ProjectManager::autoSaveRequired()
 {
-    if ( m_projectFile == NULL )
+    //The edits are journaled as they're made, so this only has to make them
+    //durable. The project file is rewritten once the journal grew enough.
+    m_journal->sync();
+    if ( m_projectFile == NULL || m_journal->size() < journalCompactionSize ||
+         m_compactionWorker->isRunning() == true )
         return ;
-    saveProject( false );
+    compactJournal();
+}
+
+void    ProjectManager::compactJournal()
+{
+    //The project is serialized in memory, which is cheap compared to
+    //writing and syncing it. That part is left to the worker.
+    QBuffer     buffer;
+
+    buffer.open( QBuffer::WriteOnly );
+    writeProject( &buffer, m_journal->generation() + 1 );
+    buffer.close();
+    m_journal->rotate();
+    m_compactionWorker->compact( buffer.data(), m_projectFile->fileName() );
+}
+
+void    ProjectManager::waitForCompaction()
+{
+    m_compactionWorker->wait();
+    compactionFinished();
+}
+
+void    ProjectManager::compactionFinished()
+{
+    //This is also called by waitForCompaction(), before the queued
+    //notification of the worker is delivered.
+    if ( m_journal->isRotating() == false )
+        return ;
+    //finished() is emitted right before the thread actually ends.
+    m_compactionWorker->wait();
+    if ( m_compactionWorker->succeeded() == false )
+    {
+        m_journal->abortRotation();
+        return ;
+    }
+    m_journal->commitRotation();
+    //The project file is only up to date if nothing happened meanwhile.
+    if ( m_journal->size() == 0 )
+    {
+        emit projectSaved();
+        emit projectUpdated( projectName(), true );
+    }
 }
 
 QString ProjectManager::projectName() const
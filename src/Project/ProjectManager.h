@@ -23,14 +23,19 @@
 #ifndef PROJECTMANAGER_H
 #define PROJECTMANAGER_H
 
+#include <QHash>
 #include <QObject>
-#include <QDomDocument>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 
 #include "Singleton.hpp"
 
 class QFile;
+class QIODevice;
+class QXmlStreamReader;
+
+class ProjectJournal;
 
 class   ProjectManager : public QObject, public Singleton<ProjectManager>
 {
@@ -39,8 +44,17 @@ class   ProjectManager : public QObject, public Singleton<ProjectManager>
 public:
     static const QString    unNamedProject;
     static const QString    unSavedProject;
+    /// Number of journaled edits after which the project file is rewritten.
+    static const int        journalCompactionSize = 512;
 
-    void            loadProject( const QString& fileName );
+    /**
+     *  \brief      Load a project, and journal its edits.
+     *
+     *  \param      renderOnly  When true, the project is only loaded to be
+     *                          rendered, and won't be edited: no journal is
+     *                          started, and it isn't added to the recent projects.
+     */
+    void            loadProject( const QString& fileName, bool renderOnly = false );
     void            newProject( const QString& projectName );
     /**
      *  \brief      Ask the user for the project file she wants to load.
@@ -61,16 +75,96 @@ public:
     bool            closeProject();
     bool            askForSaveIfModified();
     bool            loadEmergencyBackup();
+    /**
+     *  \brief      Write the current project state to fileName.
+     *
+     *  Unlike saveProject(), this doesn't change the project file nor its
+     *  clean state. This is used to hand a frozen copy of the project to
+     *  a background render.
+     */
+    void            saveSnapshot( const QString& fileName );
+    /**
+     *  \brief      The journal the edits of the current project are appended to.
+     */
+    ProjectJournal* journal();
 
     static void     signalHandler( int sig );
 
 private:
+    /**
+     *  \brief      Write the project file to the disk, out of the GUI thread.
+     */
+    class   CompactionWorker : public QThread
+    {
+        public:
+            CompactionWorker( QObject* parent );
+            void            compact( const QByteArray& data, const QString& fileName );
+            bool            succeeded() const;
+        protected:
+            virtual void    run();
+        private:
+            QByteArray      m_data;
+            QString         m_fileName;
+            bool            m_succeeded;
+    };
+
     /**
      *  This shouldn't be call directly.
      *  It's only purpose it to write the project for very specific cases.
+     *  The project is streamed to a temporary file, which then replaces
+     *  fileName.
+     *  \param      journalGeneration   The generation of the journal that
+     *                                  will apply to this file.
+     *  \return     false if the project couldn't be written.
+     */
+    bool            __saveProject( const QString& fileName, quint32 journalGeneration );
+    void            writeProject( QIODevice* device, quint32 journalGeneration );
+    /**
+     *  \brief      Sync the temporary project file, and replace fileName by it.
+     *  \param      file    The temporary file, opened for writing.
+     */
+    static bool     commitProjectFile( QFile& file, const QString& fileName );
+    /**
+     *  \brief      Atomically replace the file \a to by the file \a from.
+     */
+    static bool     replaceFile( const QString& from, const QString& to );
+    /**
+     *  \brief      Read the generation of the journal applying to a project file.
+     */
+    static quint32  journalGeneration( const QString& fileName );
+    /**
+     *  \brief      Load a project file, without touching its journal.
+     *  \param      renderOnly  Don't add the project to the recent projects.
+     *  \return     false if the project couldn't be opened.
+     */
+    bool            loadProjectFile( const QString& fileName, bool renderOnly = false );
+    /**
+     *  \brief      Rewrite the project file in the background, and restart
+     *              the journal from it.
+     */
+    void            compactJournal();
+    /**
+     *  \brief      Wait for the background compaction, and handle its result.
+     */
+    void            waitForCompaction();
+    void            parseProjectNode( QXmlStreamReader& reader );
+    /**
+     *  \brief      Apply the values of the project settings node.
+     *  \param      values  The values, indexed by setting name.
+     */
+    void            loadProjectValues( const QHash<QString, QString>& values );
+    /**
+     *  \brief      Load the project from its binary cache.
+     *  \return     false if there is no valid cache matching fileName. In this
+     *              case, nothing has been loaded.
+     */
+    bool            loadProjectCache( const QString& fileName );
+    /**
+     *  \brief      Write the binary cache of a project.
+     *
+     *  This must be called once the project file itself has been written.
      */
-    void            __saveProject( const QString& fileName );
-    void            parseProjectNode( const QDomElement& node );
+    bool            saveProjectCache( const QString& fileName );
     void            emergencyBackup();
     static bool     isBackupFile( const QString& projectFile );
     void            appendToRecentProject( const QString& projectName );
@@ -91,21 +185,22 @@ private:
 
 private:
     QFile*          m_projectFile;
-    QDomDocument*   m_domDocument;
     bool            m_needSave;
     QStringList     m_recentsProjects;
     QString         m_projectName;
     QString         m_projectDescription;
     QTimer*         m_timer;
+    ProjectJournal* m_journal;
+    CompactionWorker*   m_compactionWorker;
 
     friend class    Singleton<ProjectManager>;
 
 private slots:
-    void            loadTimeline();
     void            cleanChanged( bool val );
     void            automaticSaveEnabledChanged( const QVariant& enabled );
     void            automaticSaveIntervalChanged( const QVariant& interval );
     void            autoSaveRequired();
+    void            compactionFinished();
     void            projectNameChanged( const QVariant& projectName );
 
 signals:
@@ -1,4 +1,8 @@
 #INPUT
-HEADERS +=  ProjectManager.h
+HEADERS +=  ProjectCache.h \
+    ProjectJournal.h \
+    ProjectManager.h
 
-SOURCES +=  ProjectManager.cpp
+SOURCES +=  ProjectCache.cpp \
+    ProjectJournal.cpp \
+    ProjectManager.cpp
@@ -0,0 +1,407 @@
+/*****************************************************************************
+ * BatchRenderer.cpp: Renders a project to a file, without any GUI
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "BatchRenderer.h"
+#include "Media.h"
+#include "MediaPlayerPool.h"
+#include "MetaDataManager.h"
+#include "PassthroughRenderer.h"
+#include "ProjectManager.h"
+#include "SegmentedRenderer.h"
+#include "SettingsManager.h"
+#include "StillImageCache.h"
+#include "VLCInstance.h"
+#include "WorkflowFileRenderer.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QTimer>
+#include <QtDebug>
+
+#include <stdio.h>
+
+const BatchRenderer::Preset     BatchRenderer::presets[] =
+{
+    { "default", 4000, 256 },
+    { "low", 1000, 128 },
+    { "high", 8000, 384 },
+    { NULL, 0, 0 }
+};
+
+BatchRenderer::BatchRenderer() :
+        m_preset( &presets[0] ),
+        m_width( 0 ),
+        m_height( 0 ),
+        m_fps( .0 ),
+        m_videoBitrate( 0 ),
+        m_audioBitrate( 0 ),
+        m_nbSegments( 1 ),
+        m_rangeBegin( 0 ),
+        m_rangeEnd( -1 ),
+        m_worker( false ),
+        m_passthrough( false ),
+        m_smartRender( false ),
+        m_renderer( NULL ),
+        m_passthroughRenderer( NULL ),
+        m_segmentedRenderer( NULL ),
+        m_out( stdout ),
+        m_lastFrame( 0 ),
+        m_lastPercent( -1 )
+{
+    qRegisterMetaType<MainWorkflow::TrackType>( "MainWorkflow::TrackType" );
+    qRegisterMetaType<MainWorkflow::FrameChangedReason>( "MainWorkflow::FrameChangedReason" );
+    qRegisterMetaType<QVariant>( "QVariant" );
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    delete m_segmentedRenderer;
+    delete m_passthroughRenderer;
+    delete m_renderer;
+    MainWorkflow::destroyInstance();
+    MediaPlayerPool::destroyInstance();
+    StillImageCache::destroyInstance();
+}
+
+void
+BatchRenderer::printUsage()
+{
+    QTextStream     err( stderr );
+
+    err << "Usage: vlmc --render <project.vlmc> --out <file> [options]" << endl
+        << "Options:" << endl
+        << "  --preset <name>     Encoding preset:";
+    for ( unsigned int i = 0; presets[i].name != NULL; ++i )
+        err << ' ' << presets[i].name;
+    err << endl
+        << "  --width <pixels>    Output width (defaults to the project's)" << endl
+        << "  --height <pixels>   Output height (defaults to the project's)" << endl
+        << "  --fps <fps>         Output framerate (defaults to the project's)" << endl
+        << "  --vbitrate <kbps>   Video bitrate (overrides the preset's)" << endl
+        << "  --abitrate <kbps>   Audio bitrate (overrides the preset's)" << endl
+        << "  --segments <n>      Split the project on cut points, and render up to n" << endl
+        << "                      segments in parallel processes" << endl
+        << "  --smart             Copy the untouched clips that already use the" << endl
+        << "                      export codecs, in place of reencoding them" << endl
+        << "  --trace=<file>      Save a Chrome trace of the render to file" << endl;
+}
+
+bool
+BatchRenderer::parseArguments( const QStringList& args )
+{
+    //Skip the program name.
+    for ( int i = 1; i < args.size(); ++i )
+    {
+        const QString&  arg = args[i];
+
+        //Handled by the Tracer.
+        if ( arg.startsWith( "--trace=" ) == true )
+            continue ;
+        if ( arg == "--worker" )
+        {
+            m_worker = true;
+            continue ;
+        }
+        if ( arg == "--passthrough" )
+        {
+            m_passthrough = true;
+            continue ;
+        }
+        if ( arg == "--smart" )
+        {
+            m_smartRender = true;
+            continue ;
+        }
+        if ( i + 1 >= args.size() )
+        {
+            qCritical() << "Missing value for" << arg;
+            printUsage();
+            return false;
+        }
+        const QString&  value = args[++i];
+        bool            ok = true;
+
+        if ( arg == "--render" )
+            m_projectFileName = value;
+        else if ( arg == "--out" )
+            m_outputFileName = value;
+        else if ( arg == "--preset" )
+        {
+            m_preset = NULL;
+            for ( unsigned int j = 0; presets[j].name != NULL; ++j )
+            {
+                if ( value == presets[j].name )
+                    m_preset = &presets[j];
+            }
+            ok = ( m_preset != NULL );
+        }
+        else if ( arg == "--width" )
+            m_width = value.toUInt( &ok );
+        else if ( arg == "--height" )
+            m_height = value.toUInt( &ok );
+        else if ( arg == "--fps" )
+            m_fps = value.toDouble( &ok );
+        else if ( arg == "--vbitrate" )
+            m_videoBitrate = value.toUInt( &ok );
+        else if ( arg == "--abitrate" )
+            m_audioBitrate = value.toUInt( &ok );
+        else if ( arg == "--segments" )
+        {
+            m_nbSegments = value.toInt( &ok );
+            ok = ( ok == true && m_nbSegments > 0 );
+        }
+        else if ( arg == "--range" )
+        {
+            bool    ok2 = false;
+            m_rangeBegin = value.section( ':', 0, 0 ).toLongLong( &ok );
+            m_rangeEnd = value.section( ':', 1, 1 ).toLongLong( &ok2 );
+            ok = ( ok == true && ok2 == true && m_rangeBegin < m_rangeEnd );
+        }
+        else
+        {
+            qCritical() << "Unknown option" << arg;
+            printUsage();
+            return false;
+        }
+        if ( ok == false )
+        {
+            qCritical() << "Invalid value for" << arg << ':' << value;
+            printUsage();
+            return false;
+        }
+    }
+    if ( m_projectFileName.isEmpty() == true || m_outputFileName.isEmpty() == true )
+    {
+        printUsage();
+        return false;
+    }
+    if ( QFileInfo( m_projectFileName ).isReadable() == false )
+    {
+        qCritical() << "Can't read project file" << m_projectFileName;
+        return false;
+    }
+    return true;
+}
+
+void
+BatchRenderer::start()
+{
+    LibVLCpp::Instance::getInstance( this );
+    //Creating the project manager first (so it can create all the project variables)
+    ProjectManager::getInstance();
+
+    if ( m_worker == false )
+        m_out << "Loading " << m_projectFileName << endl;
+    //The rendered project is never edited, and an export worker loads a
+    //temporary snapshot: don't leave a journal next to it, nor add it to
+    //the recent projects.
+    ProjectManager::getInstance()->loadProject( m_projectFileName, true );
+
+    //Medias are loaded synchronously, but their metadata are computed afterward.
+    MetaDataManager*    mdm = MetaDataManager::getInstance();
+    connect( mdm, SIGNAL( failedToCompute( Media* ) ),
+             this, SLOT( metaDataFailed( Media* ) ) );
+    if ( mdm->isComputing() == true )
+        connect( mdm, SIGNAL( allComputed() ), this, SLOT( render() ), Qt::QueuedConnection );
+    else
+        QTimer::singleShot( 0, this, SLOT( render() ) );
+}
+
+void
+BatchRenderer::render()
+{
+    MainWorkflow*   mainWorkflow = MainWorkflow::getInstance();
+
+    disconnect( MetaDataManager::getInstance(), SIGNAL( allComputed() ), this, SLOT( render() ) );
+    if ( mainWorkflow->getLengthFrame() <= 0 )
+    {
+        qCritical() << "There is nothing to render.";
+        QCoreApplication::exit( 1 );
+        return ;
+    }
+    if ( m_width == 0 )
+        m_width = VLMC_PROJECT_GET_UINT( "video/VideoProjectWidth" );
+    if ( m_height == 0 )
+        m_height = VLMC_PROJECT_GET_UINT( "video/VideoProjectHeight" );
+    if ( m_fps <= .0 )
+        m_fps = VLMC_PROJECT_GET_DOUBLE( "video/VLMCOutputFPS" );
+    if ( m_videoBitrate == 0 )
+        m_videoBitrate = m_preset->videoBitrate;
+    if ( m_audioBitrate == 0 )
+        m_audioBitrate = m_preset->audioBitrate;
+
+    if ( m_worker == false )
+    {
+        m_out << "Rendering " << mainWorkflow->getLengthFrame() << " frames to "
+              << m_outputFileName << " (" << m_width << 'x' << m_height << '@' << m_fps
+              << "fps, preset " << m_preset->name << ')' << endl;
+    }
+    m_time.start();
+    if ( m_passthrough == true )
+    {
+        qint64  clipStart;
+        Clip*   clip = mainWorkflow->getPassthroughClip( m_rangeBegin, m_rangeEnd, clipStart );
+        if ( clip == NULL )
+        {
+            qCritical() << "The range can't be copied";
+            QCoreApplication::exit( 1 );
+            return ;
+        }
+        m_passthroughRenderer = new PassthroughRenderer( clip, clipStart );
+        connect( m_passthroughRenderer, SIGNAL( renderComplete() ),
+                 this, SLOT( passthroughComplete() ) );
+        connect( m_passthroughRenderer, SIGNAL( error() ), this, SLOT( renderFailed() ) );
+        m_passthroughRenderer->render( m_outputFileName, m_rangeBegin, m_rangeEnd );
+        return ;
+    }
+    if ( m_nbSegments > 1 || m_smartRender == true )
+    {
+        m_segmentedRenderer = new SegmentedRenderer( m_outputFileName, workerArguments(), m_fps );
+        if ( m_smartRender == true )
+            m_segmentedRenderer->setSmartRender( m_width, m_height );
+        connect( m_segmentedRenderer, SIGNAL( progress( qint64 ) ),
+                 this, SLOT( segmentsProgress( qint64 ) ) );
+        connect( m_segmentedRenderer, SIGNAL( finished( bool ) ),
+                 this, SLOT( segmentsFinished( bool ) ) );
+        int     nbSegments = m_segmentedRenderer->start( m_nbSegments );
+        m_out << "Rendering " << nbSegments << " segments, using up to " << m_nbSegments
+              << " processes" << endl;
+        return ;
+    }
+
+    m_renderer = new WorkflowFileRenderer;
+    m_renderer->initializeRenderer();
+    connect( m_renderer, SIGNAL( frameChanged( qint64, MainWorkflow::FrameChangedReason ) ),
+             this, SLOT( frameChanged( qint64, MainWorkflow::FrameChangedReason ) ) );
+    connect( m_renderer, SIGNAL( renderComplete() ), this, SLOT( renderComplete() ) );
+    m_renderer->setRange( m_rangeBegin, m_rangeEnd );
+    m_renderer->render( m_outputFileName, m_width, m_height, m_fps,
+                        m_videoBitrate, m_audioBitrate );
+}
+
+void
+BatchRenderer::metaDataFailed( Media* media )
+{
+    qWarning() << "Failed to compute metadata for" << media->fileInfo()->absoluteFilePath();
+}
+
+void
+BatchRenderer::frameChanged( qint64 frame, MainWorkflow::FrameChangedReason )
+{
+    m_lastFrame = frame;
+    if ( m_worker == true )
+    {
+        qint64  end = ( m_rangeEnd >= 0 ? m_rangeEnd :
+                        MainWorkflow::getInstance()->getLengthFrame() );
+        int     percent = ( frame - m_rangeBegin ) * 100 / qMax( end - m_rangeBegin, (qint64)1 );
+
+        //Reported to the SegmentedRenderer, as absolute frames.
+        if ( percent != m_lastPercent )
+        {
+            m_lastPercent = percent;
+            m_out << "progress " << frame << endl;
+        }
+        return ;
+    }
+    printProgress( frame, MainWorkflow::getInstance()->getLengthFrame() );
+}
+
+void
+BatchRenderer::segmentsProgress( qint64 nbFrames )
+{
+    m_lastFrame = nbFrames;
+    printProgress( nbFrames, MainWorkflow::getInstance()->getLengthFrame() );
+}
+
+void
+BatchRenderer::printProgress( qint64 nbFrames, qint64 length )
+{
+    int     percent = ( length > 0 ? nbFrames * 100 / length : 0 );
+
+    if ( percent == m_lastPercent )
+        return ;
+    m_lastPercent = percent;
+    float   elapsed = m_time.elapsed() / 1000.0f;
+    m_out << '\r' << percent << "% (" << nbFrames << '/' << length << " frames, "
+          << ( elapsed > 0 ? nbFrames / elapsed : 0.0f ) << " fps)";
+    m_out.flush();
+}
+
+void
+BatchRenderer::printSummary( qint64 nbFrames )
+{
+    float   elapsed = m_time.elapsed() / 1000.0f;
+
+    m_out << endl << "Rendered " << nbFrames << " frames in " << elapsed << "s ("
+          << ( elapsed > 0 ? nbFrames / elapsed : 0.0f ) << " fps)" << endl;
+}
+
+void
+BatchRenderer::renderComplete()
+{
+    if ( m_worker == false )
+        printSummary( m_lastFrame );
+    QCoreApplication::exit( 0 );
+}
+
+void
+BatchRenderer::passthroughComplete()
+{
+    //Reported to the SegmentedRenderer, which reencodes what couldn't be copied.
+    m_out << "copied " << m_passthroughRenderer->copiedBegin() << ' '
+          << m_passthroughRenderer->copiedEnd() << endl;
+    renderComplete();
+}
+
+void
+BatchRenderer::renderFailed()
+{
+    QCoreApplication::exit( 1 );
+}
+
+void
+BatchRenderer::segmentsFinished( bool success )
+{
+    if ( success == false )
+    {
+        qCritical() << "Segmented render failed";
+        QCoreApplication::exit( 1 );
+        return ;
+    }
+    printSummary( MainWorkflow::getInstance()->getLengthFrame() );
+    QCoreApplication::exit( 0 );
+}
+
+QStringList
+BatchRenderer::workerArguments() const
+{
+    QStringList     args;
+
+    args << "--render" << m_projectFileName
+         << "--preset" << m_preset->name
+         << "--width" << QString::number( m_width )
+         << "--height" << QString::number( m_height )
+         << "--fps" << QString::number( m_fps )
+         << "--vbitrate" << QString::number( m_videoBitrate )
+         << "--abitrate" << QString::number( m_audioBitrate );
+    return args;
+}
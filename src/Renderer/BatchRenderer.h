@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * BatchRenderer.h: Renders a project to a file, without any GUI
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include "MainWorkflow.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QTime>
+
+class   Media;
+class   PassthroughRenderer;
+class   SegmentedRenderer;
+class   WorkflowFileRenderer;
+
+/**
+ *  \class  Loads a project and renders it to a file, from the command line.
+ *
+ *  This is used when vlmc is launched with --render, for instance to export
+ *  projects from a machine without any display. No widget is ever created.
+ */
+class   BatchRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( BatchRenderer )
+
+    public:
+        /**
+         *  \struct Encoding parameters that can be selected with --preset
+         */
+        struct  Preset
+        {
+            const char*     name;
+            quint32         videoBitrate;
+            quint32         audioBitrate;
+        };
+        static const Preset     presets[];
+
+        BatchRenderer();
+        ~BatchRenderer();
+
+        /**
+         *  \brief  Parse the command line arguments.
+         *
+         *  \return false if the arguments are invalid. The usage has then been
+         *          printed, and the application should exit.
+         */
+        bool                    parseArguments( const QStringList& args );
+        /**
+         *  \brief  Load the project. The render will start once every media
+         *          metadata is known.
+         */
+        void                    start();
+        static void             printUsage();
+
+    private:
+        void                    printProgress( qint64 nbFrames, qint64 length );
+        void                    printSummary( qint64 nbFrames );
+        /**
+         *  \brief  The arguments a segment worker needs, besides its range and output.
+         */
+        QStringList             workerArguments() const;
+
+    private:
+        QString                 m_projectFileName;
+        QString                 m_outputFileName;
+        const Preset*           m_preset;
+        quint32                 m_width;
+        quint32                 m_height;
+        double                  m_fps;
+        /// Overrides the preset's bitrates when not 0
+        quint32                 m_videoBitrate;
+        quint32                 m_audioBitrate;
+        int                     m_nbSegments;
+        /// The frames to render when running as a segment worker.
+        qint64                  m_rangeBegin;
+        qint64                  m_rangeEnd;
+        /// Report the progress in a machine readable way, for the SegmentedRenderer.
+        bool                    m_worker;
+        /// Copy the only clip of the range, in place of rendering it.
+        bool                    m_passthrough;
+        bool                    m_smartRender;
+        WorkflowFileRenderer*   m_renderer;
+        PassthroughRenderer*    m_passthroughRenderer;
+        SegmentedRenderer*      m_segmentedRenderer;
+        QTextStream             m_out;
+        QTime                   m_time;
+        qint64                  m_lastFrame;
+        int                     m_lastPercent;
+
+    private slots:
+        void                    render();
+        void                    metaDataFailed( Media* media );
+        void                    frameChanged( qint64 frame, MainWorkflow::FrameChangedReason );
+        void                    renderComplete();
+        void                    passthroughComplete();
+        void                    renderFailed();
+        void                    segmentsProgress( qint64 nbFrames );
+        void                    segmentsFinished( bool success );
+};
+
+#endif // BATCHRENDERER_H
@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * ExportJob.cpp: Renders the project in a background process
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "ExportJob.h"
+#include "MainWorkflow.h"
+#include "ProjectManager.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QtDebug>
+
+ExportJob::ExportJob( const QString& outputFileName, quint32 width, quint32 height,
+                      double fps, quint32 vbitrate, quint32 abitrate ) :
+        RenderJob( QFileInfo( outputFileName ).fileName(), outputFileName ),
+        m_process( NULL )
+{
+    m_snapshot = new QTemporaryFile( QDir::tempPath() + "/vlmc-export-XXXXXX.vlmc" );
+    //Only create the file: the project manager writes it by its name.
+    if ( m_snapshot->open() == true )
+    {
+        m_snapshot->close();
+        ProjectManager::getInstance()->saveSnapshot( m_snapshot->fileName() );
+    }
+    else
+        qWarning() << "Can't create a project snapshot for" << outputFileName;
+    m_length = MainWorkflow::getInstance()->getLengthFrame();
+    m_arguments << "--render" << m_snapshot->fileName()
+                << "--out" << outputFileName
+                << "--width" << QString::number( width )
+                << "--height" << QString::number( height )
+                << "--fps" << QString::number( fps )
+                << "--vbitrate" << QString::number( vbitrate )
+                << "--abitrate" << QString::number( abitrate )
+                //Have the process report its progress on its standard output.
+                << "--worker";
+}
+
+ExportJob::~ExportJob()
+{
+    if ( m_process != NULL )
+    {
+        disconnect( m_process, 0, this, 0 );
+        if ( m_process->state() != QProcess::NotRunning )
+        {
+            m_process->kill();
+            m_process->waitForFinished();
+        }
+        delete m_process;
+    }
+    delete m_snapshot;
+}
+
+bool
+ExportJob::doStart()
+{
+    if ( m_snapshot->fileName().isEmpty() == true )
+        return false;
+    m_process = new QProcess;
+    m_process->setProcessChannelMode( QProcess::ForwardedErrorChannel );
+    connect( m_process, SIGNAL( readyReadStandardOutput() ),
+             this, SLOT( readOutput() ) );
+    connect( m_process, SIGNAL( finished( int, QProcess::ExitStatus ) ),
+             this, SLOT( processFinished( int, QProcess::ExitStatus ) ) );
+    connect( m_process, SIGNAL( error( QProcess::ProcessError ) ),
+             this, SLOT( processError( QProcess::ProcessError ) ) );
+    m_process->start( QCoreApplication::applicationFilePath(), m_arguments );
+    return true;
+}
+
+void
+ExportJob::doCancel()
+{
+    disconnect( m_process, 0, this, 0 );
+    m_process->kill();
+    m_process->waitForFinished();
+    QFile::remove( outputFileName() );
+}
+
+void
+ExportJob::readOutput()
+{
+    qint64      frame = -1;
+
+    while ( m_process->canReadLine() == true )
+    {
+        QByteArray  line = m_process->readLine().trimmed();
+        if ( line.startsWith( "progress " ) == true )
+            frame = line.mid( 9 ).toLongLong();
+    }
+    if ( frame >= 0 )
+        setProgress( frame, m_length );
+}
+
+void
+ExportJob::processFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+    bool    success = ( exitStatus == QProcess::NormalExit && exitCode == 0 );
+
+    if ( success == false )
+        qWarning() << "Failed to render" << outputFileName();
+    setFinished( success );
+}
+
+void
+ExportJob::processError( QProcess::ProcessError error )
+{
+    //Other errors are followed by finished()
+    if ( error != QProcess::FailedToStart )
+        return ;
+    qWarning() << "Can't start the render process for" << outputFileName();
+    setFinished( false );
+}
@@ -0,0 +1,71 @@
+/*****************************************************************************
+ * ExportJob.h: Renders the project in a background process
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef EXPORTJOB_H
+#define EXPORTJOB_H
+
+#include "RenderJob.h"
+
+#include <QProcess>
+
+class   QTemporaryFile;
+
+/**
+ *  \class  Renders a snapshot of the project in a vlmc --render process.
+ *
+ *  The project is saved when the job is created, so that the timeline can
+ *  be edited while the job is pending or running.
+ *
+ *  Unlike a TranscodeJob, which only needs a media player and shares the
+ *  LibVLCpp::Instance, an export can't run in process: MainWorkflow, its
+ *  tracks and the render pipeline are singletons driving the timeline being
+ *  edited. Each export therefore runs in its own process, with its own
+ *  libvlc instance, which also lets several exports run at the same time.
+ */
+class   ExportJob : public RenderJob
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( ExportJob )
+
+    public:
+        ExportJob( const QString& outputFileName, quint32 width, quint32 height,
+                   double fps, quint32 vbitrate, quint32 abitrate );
+        ~ExportJob();
+
+    protected:
+        virtual bool                doStart();
+        virtual void                doCancel();
+
+    private:
+        QTemporaryFile*             m_snapshot;
+        QProcess*                   m_process;
+        QStringList                 m_arguments;
+        /// The length of the project, in frames, when the job was created.
+        qint64                      m_length;
+
+    private slots:
+        void                        readOutput();
+        void                        processFinished( int exitCode, QProcess::ExitStatus exitStatus );
+        void                        processError( QProcess::ProcessError error );
+};
+
+#endif // EXPORTJOB_H
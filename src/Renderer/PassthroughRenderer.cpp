@@ -0,0 +1,247 @@
+/*****************************************************************************
+ * PassthroughRenderer.cpp: Copies a clip to a file, without reencoding it
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "PassthroughRenderer.h"
+#include "Clip.h"
+#include "Media.h"
+#include "ProgramStream.h"
+#include "VLCMedia.h"
+#include "VLCMediaPlayer.h"
+#include "WorkflowFileRenderer.h"
+
+#include <QFile>
+#include <QHash>
+#include <QtDebug>
+
+#include <stdio.h>
+
+PassthroughRenderer::PassthroughRenderer( Clip* clip, qint64 clipStart ) :
+        m_clip( clip ),
+        m_clipStart( clipStart ),
+        m_begin( 0 ),
+        m_end( 0 ),
+        m_startTime( 0. ),
+        m_copiedBegin( 0 ),
+        m_copiedEnd( 0 ),
+        m_media( NULL ),
+        m_mediaPlayer( NULL )
+{
+}
+
+PassthroughRenderer::~PassthroughRenderer()
+{
+    if ( m_mediaPlayer != NULL )
+    {
+        m_mediaPlayer->stop();
+        delete m_mediaPlayer;
+    }
+    delete m_media;
+    if ( m_copyFileName.isEmpty() == false )
+        QFile::remove( m_copyFileName );
+}
+
+quint32
+PassthroughRenderer::fourcc( const char* codec )
+{
+    quint32     ret = 0;
+    bool        end = false;
+
+    //Short codec names are padded with spaces, as in "a52 "
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        if ( codec[i] == 0 )
+            end = true;
+        ret |= (quint32)(quint8)( end == true ? ' ' : codec[i] ) << ( 8 * i );
+    }
+    return ret;
+}
+
+bool
+PassthroughRenderer::canPassthrough( Clip* clip, quint32 width, quint32 height, double fps )
+{
+    Media*      media = clip->getParent();
+
+    return ( media->videoCodec() == fourcc( WorkflowFileRenderer::videoCodec ) &&
+             media->audioCodec() == fourcc( WorkflowFileRenderer::audioCodec ) &&
+             media->audioSampleRate() == WorkflowRenderer::audioSampleRate &&
+             media->audioChannels() == WorkflowRenderer::audioChannels &&
+             (quint32)media->width() == width && (quint32)media->height() == height &&
+             qAbs( media->fps() - fps ) < 0.01 );
+}
+
+void
+PassthroughRenderer::render( const QString& outputFileName, qint64 begin, qint64 end )
+{
+    Media*      media = m_clip->getParent();
+    char        buffer[64];
+
+    m_outputFileName = outputFileName;
+    m_copyFileName = outputFileName + ".copy";
+    m_begin = begin;
+    m_end = end;
+    m_copiedBegin = begin;
+    m_copiedEnd = begin;
+    //Start a bit before the range, so that the GOP containing its beginning
+    //is copied whole, and keep one more second, so that a keyframe right on
+    //the end of the range is part of it.
+    qint64      mediaBegin = m_clip->begin() + begin - m_clipStart;
+    qint64      mediaEnd = m_clip->begin() + end - m_clipStart;
+    m_startTime = qMax( 0., mediaBegin / media->fps() - SeekMargin );
+    m_media = new LibVLCpp::Media( media->mrl() );
+    if ( m_startTime > 0. )
+    {
+        sprintf( buffer, ":start-time=%f", m_startTime );
+        m_media->addOption( buffer );
+    }
+    sprintf( buffer, ":stop-time=%f", mediaEnd / media->fps() + 1.0 );
+    m_media->addOption( buffer );
+    QString     soutStr = ":sout=#standard{access=file,mux=" +
+                          QString( WorkflowFileRenderer::muxer ) +
+                          ",dst=\"" + m_copyFileName + "\"}";
+    m_media->addOption( soutStr.toStdString().c_str() );
+    m_media->addOption( ":no-sout-keep" );
+
+    m_mediaPlayer = new LibVLCpp::MediaPlayer;
+    m_mediaPlayer->setMedia( m_media );
+    connect( m_mediaPlayer, SIGNAL( endReached() ), this, SLOT( endReached() ),
+             Qt::QueuedConnection );
+    connect( m_mediaPlayer, SIGNAL( errorEncountered() ), this, SLOT( errorEncountered() ),
+             Qt::QueuedConnection );
+    m_mediaPlayer->play();
+}
+
+qint64
+PassthroughRenderer::copiedBegin() const
+{
+    return m_copiedBegin;
+}
+
+qint64
+PassthroughRenderer::copiedEnd() const
+{
+    return m_copiedEnd;
+}
+
+bool
+PassthroughRenderer::trim()
+{
+    Media*          media = m_clip->getParent();
+    ProgramStream   copy( m_copyFileName );
+    QFile           output( m_outputFileName );
+
+    if ( copy.open() == false )
+        return false;
+    if ( output.open( QFile::WriteOnly | QFile::Truncate ) == false )
+    {
+        qCritical() << "Can't open" << m_outputFileName << ':' << output.errorString();
+        return false;
+    }
+
+    //Find the first keyframe of the range, and the last one before its end.
+    const QList<ProgramStream::Packet>&     packets = copy.packets();
+    qint64      mediaBegin = m_clip->begin() + m_begin - m_clipStart;
+    qint64      mediaEnd = m_clip->begin() + m_end - m_clipStart;
+    qint64      origin = -1;
+    int         first = -1;
+    int         last = -1;
+    qint64      firstFrame = 0;
+    qint64      lastFrame = 0;
+    //The first video packet of the copy is presented at the start time.
+    for ( int i = 0; i < packets.size() && origin < 0; ++i )
+    {
+        if ( ProgramStream::isVideo( packets[i].streamId ) == true && packets[i].pts >= 0 )
+            origin = packets[i].pts;
+    }
+    qint64      originFrame = qRound64( m_startTime * media->fps() );
+    for ( int i = 0; i < packets.size(); ++i )
+    {
+        if ( packets[i].keyframe == false )
+            continue ;
+        qint64  frame = originFrame +
+                        qRound64( ProgramStream::difference( packets[i].pts, origin ) *
+                                  media->fps() / ProgramStream::ClockRate );
+        if ( first < 0 )
+        {
+            if ( frame >= mediaBegin && frame < mediaEnd )
+            {
+                first = i;
+                firstFrame = frame;
+            }
+        }
+        else if ( frame <= mediaEnd )
+        {
+            last = i;
+            lastFrame = frame;
+        }
+    }
+    //There's no whole GOP in the range: it will be entirely reencoded.
+    if ( first < 0 || last < 0 )
+        return true;
+
+    //Keep the video GOPs, and the other streams' packets presented meanwhile.
+    qint64                  beginPts = packets[first].pts;
+    qint64                  endPts = packets[last].pts;
+    QHash<quint8, bool>     keepStream;
+    QList<bool>             keep;
+    for ( int i = 0; i < packets.size(); ++i )
+    {
+        const ProgramStream::Packet&    packet = packets[i];
+
+        if ( ProgramStream::isVideo( packet.streamId ) == true )
+            keep.append( i >= first && i < last );
+        else
+        {
+            //A packet without timestamp continues the previous one of its stream.
+            if ( packet.pts >= 0 )
+                keepStream[packet.streamId] = ( ProgramStream::difference( packet.pts, beginPts ) >= 0 &&
+                                                ProgramStream::difference( packet.pts, endPts ) < 0 );
+            keep.append( keepStream.value( packet.streamId, false ) );
+        }
+    }
+    if ( copy.write( output, keep, 0 ) == false )
+        return false;
+    m_copiedBegin = firstFrame - m_clip->begin() + m_clipStart;
+    m_copiedEnd = lastFrame - m_clip->begin() + m_clipStart;
+    return true;
+}
+
+void
+PassthroughRenderer::endReached()
+{
+    m_mediaPlayer->stop();
+    bool    success = trim();
+    QFile::remove( m_copyFileName );
+    if ( success == false )
+    {
+        emit error();
+        return ;
+    }
+    emit renderComplete();
+}
+
+void
+PassthroughRenderer::errorEncountered()
+{
+    qCritical() << "Failed to copy" << m_clip->getParent()->mrl();
+    m_mediaPlayer->stop();
+    emit error();
+}
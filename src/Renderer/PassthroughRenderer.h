@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * PassthroughRenderer.h: Copies a clip to a file, without reencoding it
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PASSTHROUGHRENDERER_H
+#define PASSTHROUGHRENDERER_H
+
+#include <QObject>
+#include <QString>
+
+class   Clip;
+namespace LibVLCpp
+{
+    class   Media;
+    class   MediaPlayer;
+}
+
+/**
+ *  \class  Stream copies a part of a clip's media to a file.
+ *
+ *  This is used to export the parts of the timeline where a clip is rendered
+ *  untouched, and already encoded as the export would encode it.
+ *  A compressed stream can only be cut on a keyframe: only the whole GOPs of
+ *  the wanted range are copied, and the frames before the first keyframe and
+ *  after the last one have to be reencoded by the caller.
+ *  The copied packets keep their timestamps, which are rebased when the
+ *  parts of the export are concatenated.
+ */
+class   PassthroughRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( PassthroughRenderer )
+
+    public:
+        /**
+         *  \param  clip        The clip to copy
+         *  \param  clipStart   The clip position in the timeline
+         */
+        PassthroughRenderer( Clip* clip, qint64 clipStart );
+        ~PassthroughRenderer();
+
+        /**
+         *  \brief  Copy the GOPs of the clip rendered in [begin;end[ to outputFileName.
+         */
+        void                    render( const QString& outputFileName, qint64 begin, qint64 end );
+        /**
+         *  \return The first frame of the timeline that has been copied.
+         */
+        qint64                  copiedBegin() const;
+        /**
+         *  \return The frame following the last copied one. It is equal to
+         *          copiedBegin() if there was no whole GOP to copy.
+         */
+        qint64                  copiedEnd() const;
+        /**
+         *  \brief  Check if a clip can be copied in place of being reencoded.
+         *
+         *  The clip's media has to use the export codecs and audio format, and
+         *  the output size and framerate.
+         */
+        static bool             canPassthrough( Clip* clip, quint32 width, quint32 height,
+                                                double fps );
+        /**
+         *  \return The VLC fourcc for a codec name.
+         */
+        static quint32          fourcc( const char* codec );
+        /// Time copied before the range, so that it starts with a keyframe, in seconds.
+        static const int        SeekMargin = 5;
+
+    private:
+        /**
+         *  \brief  Keep the whole GOPs of the copy in the output file.
+         */
+        bool                    trim();
+
+    private:
+        Clip*                   m_clip;
+        qint64                  m_clipStart;
+        QString                 m_outputFileName;
+        /// The untrimmed copy, from SeekMargin before the range.
+        QString                 m_copyFileName;
+        /// Time of the media the copy starts at, in seconds.
+        double                  m_startTime;
+        qint64                  m_begin;
+        qint64                  m_end;
+        qint64                  m_copiedBegin;
+        qint64                  m_copiedEnd;
+        LibVLCpp::Media*        m_media;
+        LibVLCpp::MediaPlayer*  m_mediaPlayer;
+
+    private slots:
+        void                    endReached();
+        void                    errorEncountered();
+
+    signals:
+        void                    renderComplete();
+        void                    error();
+};
+
+#endif // PASSTHROUGHRENDERER_H
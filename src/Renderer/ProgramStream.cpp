@@ -0,0 +1,286 @@
+/*****************************************************************************
+ * ProgramStream.cpp: Parses and rewrites MPEG program streams
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "ProgramStream.h"
+
+#include <QFile>
+#include <QtDebug>
+
+static const qint64     TimestampMask = ( Q_INT64_C( 1 ) << 33 ) - 1;
+
+//PES timestamps: 4 bits prefix, then 33 bits split by marker bits.
+static qint64
+readTimestamp( const uchar* p )
+{
+    return ( (qint64)( ( p[0] >> 1 ) & 0x07 ) << 30 ) |
+           ( (qint64)p[1] << 22 ) |
+           ( (qint64)( p[2] >> 1 ) << 15 ) |
+           ( (qint64)p[3] << 7 ) |
+           ( p[4] >> 1 );
+}
+
+static void
+writeTimestamp( uchar* p, qint64 ts )
+{
+    p[0] = ( p[0] & 0xF0 ) | ( ( ts >> 29 ) & 0x0E ) | 0x01;
+    p[1] = ( ts >> 22 ) & 0xFF;
+    p[2] = ( ( ts >> 14 ) & 0xFE ) | 0x01;
+    p[3] = ( ts >> 7 ) & 0xFF;
+    p[4] = ( ( ts << 1 ) & 0xFE ) | 0x01;
+}
+
+//MPEG-2 pack header SCR base, the extension is left untouched.
+static qint64
+readScr( const uchar* p )
+{
+    return ( (qint64)( ( p[0] >> 3 ) & 0x07 ) << 30 ) |
+           ( (qint64)( p[0] & 0x03 ) << 28 ) |
+           ( (qint64)p[1] << 20 ) |
+           ( (qint64)( ( p[2] >> 3 ) & 0x1F ) << 15 ) |
+           ( (qint64)( p[2] & 0x03 ) << 13 ) |
+           ( (qint64)p[3] << 5 ) |
+           ( p[4] >> 3 );
+}
+
+static void
+writeScr( uchar* p, qint64 scr )
+{
+    p[0] = 0x44 | ( ( scr >> 27 ) & 0x38 ) | ( ( scr >> 28 ) & 0x03 );
+    p[1] = ( scr >> 20 ) & 0xFF;
+    p[2] = 0x04 | ( ( scr >> 12 ) & 0xF8 ) | ( ( scr >> 13 ) & 0x03 );
+    p[3] = ( scr >> 5 ) & 0xFF;
+    p[4] = 0x04 | ( ( scr << 3 ) & 0xF8 ) | ( p[4] & 0x03 );
+}
+
+//Look for the first slice of the access unit, and check if it's an IDR one.
+static bool
+hasIdr( const uchar* p, qint64 size )
+{
+    for ( qint64 i = 0; i + 3 < size; ++i )
+    {
+        if ( p[i] != 0 || p[i + 1] != 0 || p[i + 2] != 1 )
+            continue ;
+        int     type = p[i + 3] & 0x1F;
+        if ( type == 5 )
+            return true;
+        if ( type == 1 )
+            return false;
+        i += 2;
+    }
+    return false;
+}
+
+ProgramStream::ProgramStream( const QString& fileName ) :
+        m_data( NULL )
+{
+    m_file = new QFile( fileName );
+}
+
+ProgramStream::~ProgramStream()
+{
+    if ( m_data != NULL )
+        m_file->unmap( m_data );
+    delete m_file;
+}
+
+bool
+ProgramStream::open()
+{
+    if ( m_file->open( QFile::ReadOnly ) == false )
+    {
+        qCritical() << "Can't open" << m_file->fileName() << ':' << m_file->errorString();
+        return false;
+    }
+    qint64  size = m_file->size();
+    if ( size == 0 )
+        return true;
+    m_data = m_file->map( 0, size );
+    if ( m_data == NULL )
+    {
+        qCritical() << "Can't map" << m_file->fileName() << ':' << m_file->errorString();
+        return false;
+    }
+    parse( m_data, size );
+    return true;
+}
+
+void
+ProgramStream::parse( const uchar* data, qint64 size )
+{
+    qint64      pos = 0;
+    //The pack and system headers are part of the following packet.
+    qint64      packetStart = 0;
+    qint64      scrOffset = -1;
+
+    while ( pos + 6 <= size )
+    {
+        if ( data[pos] != 0 || data[pos + 1] != 0 || data[pos + 2] != 1 )
+        {
+            ++pos;
+            continue ;
+        }
+        quint8  code = data[pos + 3];
+        //End code
+        if ( code == 0xB9 )
+            break ;
+        if ( code == 0xBA )
+        {
+            if ( ( data[pos + 4] & 0xC0 ) == 0x40 )
+            {
+                if ( pos + 14 > size )
+                    break ;
+                scrOffset = pos + 4;
+                pos += 14 + ( data[pos + 13] & 0x07 );
+            }
+            else
+            {
+                //MPEG-1 pack header, whose SCR is left as is.
+                scrOffset = -1;
+                pos += 12;
+            }
+            continue ;
+        }
+        if ( code < 0xBB )
+        {
+            ++pos;
+            continue ;
+        }
+        qint64  end = pos + 6 + ( ( data[pos + 4] << 8 ) | data[pos + 5] );
+        //Truncated packet
+        if ( end > size )
+            break ;
+        //System header
+        if ( code == 0xBB )
+        {
+            pos = end;
+            continue ;
+        }
+        Packet  packet;
+        packet.offset = packetStart;
+        packet.size = end - packetStart;
+        packet.streamId = code;
+        packet.scrOffset = scrOffset;
+        packet.ptsOffset = -1;
+        packet.dtsOffset = -1;
+        packet.pts = -1;
+        packet.keyframe = false;
+        //Program stream map, padding and private stream 2 have no PES header.
+        if ( code != 0xBC && code != 0xBE && code != 0xBF &&
+             end - pos >= 9 && ( data[pos + 6] & 0xC0 ) == 0x80 )
+        {
+            int     flags = data[pos + 7] >> 6;
+            qint64  payload = pos + 9 + data[pos + 8];
+            if ( ( flags & 0x02 ) != 0 && pos + 14 <= end )
+            {
+                packet.ptsOffset = pos + 9;
+                packet.pts = readTimestamp( data + pos + 9 );
+            }
+            if ( flags == 0x03 && pos + 19 <= end )
+                packet.dtsOffset = pos + 14;
+            if ( isVideo( code ) == true && packet.pts >= 0 && payload < end )
+                packet.keyframe = hasIdr( data + payload, end - payload );
+        }
+        m_packets.append( packet );
+        packetStart = end;
+        scrOffset = -1;
+        pos = end;
+    }
+}
+
+const QList<ProgramStream::Packet>&
+ProgramStream::packets() const
+{
+    return m_packets;
+}
+
+qint64
+ProgramStream::firstPts() const
+{
+    qint64      first = -1;
+    bool        video = false;
+
+    foreach ( const Packet& packet, m_packets )
+    {
+        if ( packet.pts < 0 || ( video == true && isVideo( packet.streamId ) == false ) )
+            continue ;
+        if ( video == false && isVideo( packet.streamId ) == true )
+        {
+            video = true;
+            first = packet.pts;
+        }
+        else if ( first < 0 || difference( packet.pts, first ) < 0 )
+            first = packet.pts;
+    }
+    return first;
+}
+
+bool
+ProgramStream::write( QFile& output, const QList<bool>& keep, qint64 shift ) const
+{
+    for ( int i = 0; i < m_packets.size(); ++i )
+    {
+        if ( keep.isEmpty() == false && keep.at( i ) == false )
+            continue ;
+        const Packet&   packet = m_packets.at( i );
+        QByteArray      buffer( reinterpret_cast<const char*>( m_data + packet.offset ),
+                                packet.size );
+        uchar*          data = reinterpret_cast<uchar*>( buffer.data() );
+
+        if ( packet.scrOffset >= 0 )
+        {
+            uchar*  scr = data + packet.scrOffset - packet.offset;
+            writeScr( scr, ( readScr( scr ) + shift ) & TimestampMask );
+        }
+        if ( packet.ptsOffset >= 0 )
+        {
+            uchar*  pts = data + packet.ptsOffset - packet.offset;
+            writeTimestamp( pts, ( readTimestamp( pts ) + shift ) & TimestampMask );
+        }
+        if ( packet.dtsOffset >= 0 )
+        {
+            uchar*  dts = data + packet.dtsOffset - packet.offset;
+            writeTimestamp( dts, ( readTimestamp( dts ) + shift ) & TimestampMask );
+        }
+        if ( output.write( buffer ) != buffer.size() )
+        {
+            qCritical() << "Can't write to" << output.fileName() << ':' << output.errorString();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+ProgramStream::isVideo( quint8 streamId )
+{
+    return ( streamId & 0xF0 ) == 0xE0;
+}
+
+qint64
+ProgramStream::difference( qint64 a, qint64 b )
+{
+    qint64  diff = ( a - b ) & TimestampMask;
+
+    if ( diff >= ( Q_INT64_C( 1 ) << 32 ) )
+        diff -= ( Q_INT64_C( 1 ) << 33 );
+    return diff;
+}
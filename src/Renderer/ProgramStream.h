@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * ProgramStream.h: Parses and rewrites MPEG program streams
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PROGRAMSTREAM_H
+#define PROGRAMSTREAM_H
+
+#include <QList>
+#include <QString>
+
+class   QFile;
+
+/**
+ *  \class  Splits an MPEG program stream, as written by the export muxer, in
+ *          packets, so that parts of it can be dropped and its timestamps
+ *          shifted without demuxing it.
+ *
+ *  Only the MPEG-2 pack and PES headers timestamps are read and rewritten.
+ */
+class   ProgramStream
+{
+    public:
+        /// The frequency of the timestamps.
+        static const qint64     ClockRate = 90000;
+
+        /**
+         *  \brief  A PES packet, along with the pack and system headers that
+         *          precede it.
+         */
+        struct  Packet
+        {
+            qint64      offset;
+            qint64      size;
+            quint8      streamId;
+            /// Offsets of the timestamps in the file, or -1 if absent.
+            qint64      scrOffset;
+            qint64      ptsOffset;
+            qint64      dtsOffset;
+            /// The PTS, or -1 if absent.
+            qint64      pts;
+            /// True if the packet starts an H.264 IDR access unit.
+            bool        keyframe;
+        };
+
+        ProgramStream( const QString& fileName );
+        ~ProgramStream();
+
+        /**
+         *  \brief  Read the packets, up to the end code.
+         *  \return false if the file can't be read.
+         */
+        bool                    open();
+        const QList<Packet>&    packets() const;
+        /**
+         *  \return The smallest video PTS of the stream, or of any stream if
+         *          there's no video, or -1 if there's no timestamp at all.
+         */
+        qint64                  firstPts() const;
+        /**
+         *  \brief  Append packets to output, shifting their timestamps.
+         *
+         *  \param  keep    Tells if each packet of packets() has to be copied.
+         *                  Every packet is copied if it is empty.
+         *  \param  shift   The value to add to the timestamps, in ClockRate units.
+         */
+        bool                    write( QFile& output, const QList<bool>& keep,
+                                       qint64 shift ) const;
+
+        static bool             isVideo( quint8 streamId );
+        /**
+         *  \return a - b, as timestamps wrapping over 33 bits.
+         */
+        static qint64           difference( qint64 a, qint64 b );
+
+    private:
+        void                    parse( const uchar* data, qint64 size );
+
+    private:
+        QFile*                  m_file;
+        uchar*                  m_data;
+        QList<Packet>           m_packets;
+};
+
+#endif // PROGRAMSTREAM_H
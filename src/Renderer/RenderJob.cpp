@@ -0,0 +1,133 @@
+/*****************************************************************************
+ * RenderJob.cpp: A job run by the RenderQueue
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "RenderJob.h"
+
+RenderJob::RenderJob( const QString& name, const QString& outputFileName ) :
+        m_name( name ),
+        m_outputFileName( outputFileName ),
+        m_state( Pending ),
+        m_nbFrames( 0 ),
+        m_nbTotalFrames( 0 )
+{
+}
+
+RenderJob::~RenderJob()
+{
+}
+
+const QString&
+RenderJob::name() const
+{
+    return m_name;
+}
+
+const QString&
+RenderJob::outputFileName() const
+{
+    return m_outputFileName;
+}
+
+RenderJob::State
+RenderJob::state() const
+{
+    return m_state;
+}
+
+bool
+RenderJob::isFinished() const
+{
+    return ( m_state != Pending && m_state != Running );
+}
+
+float
+RenderJob::progress() const
+{
+    if ( m_state == Done )
+        return 1.0f;
+    if ( m_nbTotalFrames <= 0 )
+        return 0.0f;
+    return qMin( (float)m_nbFrames / m_nbTotalFrames, 1.0f );
+}
+
+float
+RenderJob::fps() const
+{
+    if ( m_state != Running )
+        return 0.0f;
+    int     elapsed = m_time.elapsed();
+    if ( elapsed <= 0 )
+        return 0.0f;
+    return m_nbFrames * 1000.0f / elapsed;
+}
+
+qint64
+RenderJob::eta() const
+{
+    float   currentFps = fps();
+
+    if ( currentFps <= 0.0f || m_nbTotalFrames <= 0 )
+        return -1;
+    return (qint64)( qMax( m_nbTotalFrames - m_nbFrames, (qint64)0 ) / currentFps );
+}
+
+void
+RenderJob::start()
+{
+    if ( m_state != Pending )
+        return ;
+    m_state = Running;
+    m_time.start();
+    if ( doStart() == false )
+        setFinished( false );
+}
+
+void
+RenderJob::cancel()
+{
+    if ( isFinished() == true )
+        return ;
+    if ( m_state == Running )
+        doCancel();
+    m_state = Cancelled;
+    emit finished( this );
+}
+
+void
+RenderJob::setProgress( qint64 nbFrames, qint64 nbTotalFrames )
+{
+    if ( m_state != Running )
+        return ;
+    m_nbFrames = nbFrames;
+    m_nbTotalFrames = nbTotalFrames;
+    emit progressChanged( this );
+}
+
+void
+RenderJob::setFinished( bool success )
+{
+    //A cancelled job may still report its end afterward.
+    if ( m_state != Running )
+        return ;
+    m_state = ( success == true ? Done : Failed );
+    emit finished( this );
+}
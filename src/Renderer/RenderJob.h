@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * RenderJob.h: A job run by the RenderQueue
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDERJOB_H
+#define RENDERJOB_H
+
+#include <QObject>
+#include <QString>
+#include <QTime>
+
+/**
+ *  \class  A render or transcode, scheduled by the RenderQueue.
+ *
+ *  Jobs don't block the UI: they report their progress through signals,
+ *  and they are only deleted by the RenderQueue.
+ */
+class   RenderJob : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( RenderJob )
+
+    public:
+        enum    State
+        {
+            Pending,
+            Running,
+            Done,
+            Failed,
+            Cancelled
+        };
+
+        RenderJob( const QString& name, const QString& outputFileName );
+        virtual ~RenderJob();
+
+        const QString&              name() const;
+        const QString&              outputFileName() const;
+        State                       state() const;
+        bool                        isFinished() const;
+        /**
+         *  \return The progress, between 0 and 1.
+         */
+        float                       progress() const;
+        /**
+         *  \return The number of frames rendered per second since the job started.
+         */
+        float                       fps() const;
+        /**
+         *  \return The estimated remaining time, in seconds, or -1 if unknown.
+         */
+        qint64                      eta() const;
+
+        /**
+         *  \brief  Start the job. Only the RenderQueue should call this.
+         */
+        void                        start();
+        /**
+         *  \brief  Cancel the job, whether it is running or still pending.
+         */
+        void                        cancel();
+
+    protected:
+        /**
+         *  \return false if the job couldn't be started.
+         */
+        virtual bool                doStart() = 0;
+        /**
+         *  \brief  Stop a running job. finished() is emitted by cancel().
+         */
+        virtual void                doCancel() = 0;
+        void                        setProgress( qint64 nbFrames, qint64 nbTotalFrames );
+        /**
+         *  \brief  Flag a running job as done or failed, and emit finished()
+         */
+        void                        setFinished( bool success );
+
+    private:
+        QString                     m_name;
+        QString                     m_outputFileName;
+        State                       m_state;
+        qint64                      m_nbFrames;
+        qint64                      m_nbTotalFrames;
+        QTime                       m_time;
+
+    signals:
+        void                        progressChanged( RenderJob* job );
+        void                        finished( RenderJob* job );
+};
+
+#endif // RENDERJOB_H
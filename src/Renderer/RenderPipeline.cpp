@@ -0,0 +1,290 @@
+/*****************************************************************************
+ * RenderPipeline.cpp: Pipelined production of the workflow output
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "RenderPipeline.h"
+#include "LightVideoFrame.h"
+
+#include <QtDebug>
+
+RenderPipeline::Worker::Worker( RenderPipeline* pipeline, MainWorkflow::TrackType trackType ) :
+        m_pipeline( pipeline ),
+        m_trackType( trackType )
+{
+}
+
+void
+RenderPipeline::Worker::run()
+{
+    m_pipeline->composite( m_trackType );
+}
+
+RenderPipeline::RenderPipeline( MainWorkflow* mainWorkflow, quint32 width, quint32 height,
+                                double fps, quint32 nbChannels, quint32 rate ) :
+        m_mainWorkflow( mainWorkflow ),
+        m_width( width ),
+        m_height( height ),
+        m_fps( fps ),
+        m_nbChannels( nbChannels ),
+        m_rate( rate ),
+        m_running( false ),
+        m_begin( 0 ),
+        m_end( -1 ),
+        m_endFrame( -1 ),
+        m_endReached( false )
+{
+    const int   nbBuffers[MainWorkflow::NbTrackType] = { nbVideoBuffers, nbAudioBuffers };
+    const size_t    videoSize = m_width * m_height * Pixel::NbComposantes;
+
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
+        m_free[i] = new BoundedQueue<Buffer*>( nbBuffers[i] );
+        m_ready[i] = new BoundedQueue<Buffer*>( nbBuffers[i] );
+        for ( int j = 0; j < nbBuffers[i]; ++j )
+        {
+            Buffer*     buffer = new Buffer;
+            //Audio buffers are allocated when needed, as their size can vary.
+            buffer->allocatedSize = ( i == MainWorkflow::VideoTrack ? videoSize : 0 );
+            buffer->data = ( buffer->allocatedSize != 0 ? new quint8[buffer->allocatedSize] : NULL );
+            buffer->size = 0;
+            buffer->ptsDiff = 0;
+            buffer->endOfStream = false;
+            m_buffers.append( buffer );
+            m_free[i]->push( buffer );
+        }
+        m_workers[i] = new Worker( this, static_cast<MainWorkflow::TrackType>( i ) );
+        m_nbComposited[i] = 0;
+        m_nbEncoded[i] = 0;
+        m_occupancySum[i] = 0;
+    }
+    //The workflow emits its end from a render thread, so the signal is queued
+    //to the GUI thread by MainWorkflow, and arrives late: the render stops on
+    //m_endFrame, this is only a fallback.
+    connect( m_mainWorkflow, SIGNAL( mainWorkflowEndReached() ),
+             this, SLOT( mainWorkflowEndReached() ), Qt::DirectConnection );
+}
+
+RenderPipeline::~RenderPipeline()
+{
+    stop();
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
+        delete m_workers[i];
+        delete m_ready[i];
+        delete m_free[i];
+    }
+    foreach ( Buffer* buffer, m_buffers )
+    {
+        delete[] buffer->data;
+        delete buffer;
+    }
+}
+
+void
+RenderPipeline::start()
+{
+    m_endReached = false;
+    m_endFrame = ( m_end >= 0 ? m_end : m_mainWorkflow->getLengthFrame() );
+    m_nbEndOfStream = 0;
+    m_running = true;
+    m_time.start();
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_workers[i]->start();
+}
+
+void
+RenderPipeline::setRange( qint64 begin, qint64 end )
+{
+    m_begin = begin;
+    m_end = end;
+}
+
+void
+RenderPipeline::stop()
+{
+    if ( m_running == false )
+        return ;
+    m_running = false;
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
+        m_free[i]->abort();
+        m_ready[i]->abort();
+    }
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_workers[i]->wait();
+    dumpStats();
+}
+
+void
+RenderPipeline::composite( MainWorkflow::TrackType trackType )
+{
+    while ( true )
+    {
+        Buffer*     buffer = m_free[trackType]->pop();
+        if ( buffer == NULL )
+            return ;
+        //Audio buffers are consumed at the video pace, so their frame count is
+        //comparable to the video one.
+        qint64      position = m_begin + m_nbComposited[trackType];
+        buffer->endOfStream = ( m_endReached == true || position >= m_endFrame );
+        if ( buffer->endOfStream == false )
+        {
+            if ( trackType == MainWorkflow::VideoTrack )
+                compositeVideo( buffer );
+            else
+                compositeAudio( buffer );
+            m_mainWorkflow->nextFrame( trackType );
+            ++m_nbComposited[trackType];
+        }
+        if ( m_ready[trackType]->push( buffer ) == false || buffer->endOfStream == true )
+            return ;
+    }
+}
+
+void
+RenderPipeline::compositeVideo( Buffer* buffer )
+{
+    MainWorkflow::OutputBuffers*    ret =
+            m_mainWorkflow->getOutput( MainWorkflow::VideoTrack, false );
+    const LightVideoFrame&          frame = *( ret->video );
+
+    buffer->size = qMin( (size_t)frame->nboctets, buffer->allocatedSize );
+    memcpy( buffer->data, frame->frame.octets, buffer->size );
+    buffer->ptsDiff = frame->ptsDiff;
+}
+
+void
+RenderPipeline::compositeAudio( Buffer* buffer )
+{
+    MainWorkflow::OutputBuffers*        ret =
+            m_mainWorkflow->getOutput( MainWorkflow::AudioTrack, false );
+    AudioClipWorkflow::AudioSample*     sample = ret->audio;
+    size_t                              size;
+
+    if ( sample != NULL )
+        size = sample->size;
+    else
+        size = m_nbChannels * 2 * (quint32)( m_rate / m_fps );
+    if ( size > buffer->allocatedSize )
+    {
+        delete[] buffer->data;
+        buffer->data = new quint8[size];
+        buffer->allocatedSize = size;
+    }
+    buffer->size = size;
+    if ( sample != NULL )
+    {
+        memcpy( buffer->data, sample->buff, size );
+        buffer->ptsDiff = sample->ptsDiff;
+    }
+    else
+    {
+        memset( buffer->data, 0, size );
+        buffer->ptsDiff = 0;
+    }
+}
+
+RenderPipeline::Buffer*
+RenderPipeline::pop( MainWorkflow::TrackType trackType )
+{
+    m_occupancySum[trackType] += m_ready[trackType]->count();
+    Buffer*     buffer = m_ready[trackType]->pop();
+
+    if ( buffer == NULL )
+        return NULL;
+    if ( buffer->endOfStream == true )
+    {
+        //Only signal the end once every stream has been entirely consumed.
+        if ( m_nbEndOfStream.fetchAndAddOrdered( 1 ) == MainWorkflow::NbTrackType - 1 )
+            emit endReached();
+        return buffer;
+    }
+    ++m_nbEncoded[trackType];
+    return buffer;
+}
+
+void
+RenderPipeline::release( MainWorkflow::TrackType trackType, Buffer* buffer )
+{
+    if ( buffer == NULL || buffer->endOfStream == true )
+        return ;
+    m_free[trackType]->push( buffer );
+}
+
+void
+RenderPipeline::mainWorkflowEndReached()
+{
+    m_endReached = true;
+}
+
+RenderPipeline::StageStats
+RenderPipeline::computeStats( quint64 nbBuffers ) const
+{
+    StageStats  stats;
+    int         elapsed = m_time.elapsed();
+
+    stats.nbBuffers = nbBuffers;
+    stats.buffersPerSecond = ( elapsed > 0 ? nbBuffers * 1000.0f / elapsed : 0.0f );
+    return stats;
+}
+
+RenderPipeline::StageStats
+RenderPipeline::compositeStats( MainWorkflow::TrackType trackType ) const
+{
+    return computeStats( m_nbComposited[trackType] );
+}
+
+RenderPipeline::StageStats
+RenderPipeline::encodeStats( MainWorkflow::TrackType trackType ) const
+{
+    return computeStats( m_nbEncoded[trackType] );
+}
+
+RenderPipeline::QueueStats
+RenderPipeline::queueStats( MainWorkflow::TrackType trackType ) const
+{
+    QueueStats  stats;
+
+    stats.capacity = m_ready[trackType]->capacity();
+    stats.current = m_ready[trackType]->count();
+    stats.averageOccupancy = ( m_nbEncoded[trackType] > 0 ?
+                               (float)m_occupancySum[trackType] / m_nbEncoded[trackType] : 0.0f );
+    return stats;
+}
+
+void
+RenderPipeline::dumpStats() const
+{
+    static const char*  names[MainWorkflow::NbTrackType] = { "video", "audio" };
+
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
+        MainWorkflow::TrackType     type = static_cast<MainWorkflow::TrackType>( i );
+        StageStats                  composite = compositeStats( type );
+        StageStats                  encode = encodeStats( type );
+        QueueStats                  queue = queueStats( type );
+
+        qDebug() << "RenderPipeline:" << names[i]
+                 << "composited" << composite.nbBuffers << "(" << composite.buffersPerSecond << "/s )"
+                 << "encoded" << encode.nbBuffers << "(" << encode.buffersPerSecond << "/s )"
+                 << "queue" << queue.averageOccupancy << "/" << queue.capacity;
+    }
+}
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * RenderPipeline.h: Pipelined production of the workflow output
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDERPIPELINE_H
+#define RENDERPIPELINE_H
+
+#include "MainWorkflow.h"
+#include "BoundedQueue.hpp"
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QThread>
+#include <QTime>
+
+/**
+ *  \class  Produces the workflow output ahead of its consumer.
+ *
+ *  The decoding is already handled by each ClipWorkflow in its own thread.
+ *  This pipeline adds a compositing stage per track type, running in its own
+ *  thread and feeding a bounded queue of preallocated buffers. The encoder
+ *  (ie. the imem callbacks) only has to pop ready buffers, so that encoding
+ *  frame N overlaps compositing frame N+1 and decoding the following ones.
+ */
+class   RenderPipeline : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( RenderPipeline )
+
+    public:
+        struct  Buffer
+        {
+            quint8*     data;
+            size_t      size; ///< The used size of data
+            size_t      allocatedSize;
+            /**
+             *  \brief  The pts difference with the previous buffer.
+             *
+             *  0 means the pts has to be computed by the consumer, IE. this buffer
+             *  was filled by default because nothing was to be rendered.
+             */
+            qint64      ptsDiff;
+            bool        endOfStream;
+        };
+        /**
+         *  \struct Statistics of a stage, for a given track type.
+         */
+        struct  StageStats
+        {
+            quint64     nbBuffers; ///< Number of buffers that went through the stage
+            float       buffersPerSecond; ///< Average throughput since the pipeline started
+        };
+        struct  QueueStats
+        {
+            int         capacity; ///< The maximum number of ready buffers
+            int         current; ///< The current number of ready buffers
+            float       averageOccupancy; ///< Average number of ready buffers when popping
+        };
+
+        RenderPipeline( MainWorkflow* mainWorkflow, quint32 width, quint32 height,
+                        double fps, quint32 nbChannels, quint32 rate );
+        ~RenderPipeline();
+
+        /**
+         *  \brief  Launch the compositing threads.
+         *
+         *  The MainWorkflow is expected to be started already.
+         */
+        void                start();
+        /**
+         *  \brief  Only render the frames in [begin;end[
+         *
+         *  The workflow is expected to be positioned on begin already. The end of
+         *  stream will be sent as soon as end is reached, even if the workflow
+         *  goes on. Without a range, the render stops at the workflow's length,
+         *  as known when start() is called. This must be called before start()
+         */
+        void                setRange( qint64 begin, qint64 end );
+        /**
+         *  \brief  Stop the compositing threads, and unblock any pending pop().
+         *
+         *  This must be called before stopping the MainWorkflow.
+         */
+        void                stop();
+        /**
+         *  \brief  Get the next composited buffer, waiting for it if required.
+         *
+         *  Once the end of stream buffer has been popped for every track type, the
+         *  endReached() signal is emitted.
+         *  \return The next buffer, that must be given back with release(), or NULL
+         *          if the pipeline has been stopped.
+         */
+        Buffer*             pop( MainWorkflow::TrackType trackType );
+        void                release( MainWorkflow::TrackType trackType, Buffer* buffer );
+
+        StageStats          compositeStats( MainWorkflow::TrackType trackType ) const;
+        StageStats          encodeStats( MainWorkflow::TrackType trackType ) const;
+        QueueStats          queueStats( MainWorkflow::TrackType trackType ) const;
+        /**
+         *  \brief  Dump the statistics of every stage, using qDebug()
+         */
+        void                dumpStats() const;
+
+        /// Number of video frames that can be composited ahead of the encoder.
+        static const int    nbVideoBuffers = 8;
+        /// Number of audio buffers that can be mixed ahead of the encoder.
+        static const int    nbAudioBuffers = 32;
+
+    private:
+        class   Worker : public QThread
+        {
+            public:
+                Worker( RenderPipeline* pipeline, MainWorkflow::TrackType trackType );
+            protected:
+                virtual void    run();
+            private:
+                RenderPipeline*             m_pipeline;
+                MainWorkflow::TrackType     m_trackType;
+        };
+
+        void                composite( MainWorkflow::TrackType trackType );
+        void                compositeVideo( Buffer* buffer );
+        void                compositeAudio( Buffer* buffer );
+        StageStats          computeStats( quint64 nbBuffers ) const;
+
+    private:
+        MainWorkflow*               m_mainWorkflow;
+        quint32                     m_width;
+        quint32                     m_height;
+        double                      m_fps;
+        quint32                     m_nbChannels;
+        quint32                     m_rate;
+        bool                        m_running;
+        qint64                      m_begin;
+        /// The first frame not to render, or -1 to render until the workflow's end.
+        qint64                      m_end;
+        /// The first frame not to render in the current run, resolved by start().
+        qint64                      m_endFrame;
+        volatile bool               m_endReached;
+        QAtomicInt                  m_nbEndOfStream;
+        /// The buffers that can be filled, indexed by MainWorkflow::TrackType
+        BoundedQueue<Buffer*>*      m_free[MainWorkflow::NbTrackType];
+        /// The buffers ready to be encoded, indexed by MainWorkflow::TrackType
+        BoundedQueue<Buffer*>*      m_ready[MainWorkflow::NbTrackType];
+        QList<Buffer*>              m_buffers;
+        Worker*                     m_workers[MainWorkflow::NbTrackType];
+        QTime                       m_time;
+        quint64                     m_nbComposited[MainWorkflow::NbTrackType];
+        quint64                     m_nbEncoded[MainWorkflow::NbTrackType];
+        quint64                     m_occupancySum[MainWorkflow::NbTrackType];
+
+    private slots:
+        void                        mainWorkflowEndReached();
+
+    signals:
+        /**
+         *  \brief  Emitted when the last buffer has been popped by the encoder.
+         */
+        void                        endReached();
+};
+
+#endif // RENDERPIPELINE_H
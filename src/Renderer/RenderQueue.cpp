@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * RenderQueue.cpp: Schedules the render and transcode jobs
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "RenderQueue.h"
+#include "RenderJob.h"
+#include "SettingsManager.h"
+
+RenderQueue::RenderQueue() :
+        m_concurrency( 1 )
+{
+    SettingsManager::getInstance()->watchValue( "general/RenderQueueConcurrency", this,
+                                                SLOT( concurrencyChanged( QVariant ) ),
+                                                SettingsManager::Vlmc,
+                                                Qt::QueuedConnection );
+    concurrencyChanged( VLMC_GET_INT( "general/RenderQueueConcurrency" ) );
+}
+
+RenderQueue::~RenderQueue()
+{
+    //Running jobs are stopped by their destructor.
+    qDeleteAll( m_jobs );
+}
+
+void
+RenderQueue::enqueue( RenderJob* job )
+{
+    m_jobs.append( job );
+    connect( job, SIGNAL( progressChanged( RenderJob* ) ),
+             this, SIGNAL( jobUpdated( RenderJob* ) ) );
+    connect( job, SIGNAL( finished( RenderJob* ) ),
+             this, SLOT( jobFinished( RenderJob* ) ) );
+    emit jobAdded( job );
+    schedule();
+}
+
+void
+RenderQueue::cancel( RenderJob* job )
+{
+    job->cancel();
+}
+
+void
+RenderQueue::clearFinished()
+{
+    QList<RenderJob*>::iterator     it = m_jobs.begin();
+
+    while ( it != m_jobs.end() )
+    {
+        RenderJob*  job = *it;
+        if ( job->isFinished() == true )
+        {
+            it = m_jobs.erase( it );
+            emit jobRemoved( job );
+            delete job;
+        }
+        else
+            ++it;
+    }
+}
+
+const QList<RenderJob*>&
+RenderQueue::jobs() const
+{
+    return m_jobs;
+}
+
+int
+RenderQueue::nbRunningJobs() const
+{
+    int     nbRunning = 0;
+
+    foreach ( RenderJob* job, m_jobs )
+    {
+        if ( job->state() == RenderJob::Running )
+            ++nbRunning;
+    }
+    return nbRunning;
+}
+
+void
+RenderQueue::schedule()
+{
+    //A job failing right away reenters schedule() through jobFinished(),
+    //hence counting the running jobs again every time.
+    for ( int i = 0; i < m_jobs.size() && nbRunningJobs() < m_concurrency; ++i )
+    {
+        RenderJob*  job = m_jobs[i];
+        if ( job->state() != RenderJob::Pending )
+            continue ;
+        job->start();
+        emit jobUpdated( job );
+    }
+}
+
+void
+RenderQueue::jobFinished( RenderJob* job )
+{
+    emit jobUpdated( job );
+    schedule();
+}
+
+void
+RenderQueue::concurrencyChanged( const QVariant& concurrency )
+{
+    m_concurrency = qMax( concurrency.toInt(), 1 );
+    schedule();
+}
@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * RenderQueue.h: Schedules the render and transcode jobs
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <QList>
+#include <QObject>
+#include <QVariant>
+
+#include "Singleton.hpp"
+
+class   RenderJob;
+
+/**
+ *  \class  Runs the queued render and transcode jobs in the background.
+ *
+ *  At most general/RenderQueueConcurrency jobs run at the same time; the
+ *  others wait in the order they were enqueued.
+ */
+class   RenderQueue : public QObject, public Singleton<RenderQueue>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( RenderQueue )
+
+    public:
+        /**
+         *  \brief  Queue a job, and start it as soon as possible.
+         *
+         *  The queue takes ownership of the job.
+         */
+        void                        enqueue( RenderJob* job );
+        void                        cancel( RenderJob* job );
+        /**
+         *  \brief  Remove and delete the jobs that are over.
+         */
+        void                        clearFinished();
+        const QList<RenderJob*>&    jobs() const;
+        int                         nbRunningJobs() const;
+
+    private:
+        RenderQueue();
+        ~RenderQueue();
+        void                        schedule();
+
+    private:
+        QList<RenderJob*>           m_jobs;
+        int                         m_concurrency;
+
+        friend class    Singleton<RenderQueue>;
+
+    private slots:
+        void                        jobFinished( RenderJob* job );
+        void                        concurrencyChanged( const QVariant& concurrency );
+
+    signals:
+        void                        jobAdded( RenderJob* job );
+        /**
+         *  \brief  Emitted when a job's state or progress changes.
+         */
+        void                        jobUpdated( RenderJob* job );
+        void                        jobRemoved( RenderJob* job );
+};
+
+#endif // RENDERQUEUE_H
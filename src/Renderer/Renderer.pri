@@ -1,9 +1,27 @@
-HEADERS	+=	ClipRenderer.h	\
+HEADERS	+=	BatchRenderer.h	\
+		ClipRenderer.h	\
+		ExportJob.h	\
 		GenericRenderer.h	\
+		PassthroughRenderer.h	\
+		ProgramStream.h	\
+		RenderJob.h	\
+		RenderPipeline.h	\
+		RenderQueue.h	\
+		SegmentedRenderer.h	\
+		TranscodeJob.h	\
 		WorkflowFileRenderer.h	\
 		WorkflowRenderer.h
 
-SOURCES	+=	ClipRenderer.cpp	\
+SOURCES	+=	BatchRenderer.cpp	\
+		ClipRenderer.cpp	\
+		ExportJob.cpp	\
+		PassthroughRenderer.cpp	\
+		ProgramStream.cpp	\
+		RenderJob.cpp	\
+		RenderPipeline.cpp	\
+		RenderQueue.cpp	\
+		SegmentedRenderer.cpp	\
+		TranscodeJob.cpp	\
 		WorkflowFileRenderer.cpp	\
 		WorkflowRenderer.cpp
 
@@ -0,0 +1,406 @@
+/*****************************************************************************
+ * SegmentedRenderer.cpp: Renders a project in parallel, in several processes
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "SegmentedRenderer.h"
+#include "MainWorkflow.h"
+#include "PassthroughRenderer.h"
+#include "ProgramStream.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QtDebug>
+
+SegmentedRenderer::SegmentedRenderer( const QString& outputFileName,
+                                      const QStringList& workerArguments, double fps ) :
+        m_outputFileName( outputFileName ),
+        m_workerArguments( workerArguments ),
+        m_nbLaunched( 0 ),
+        m_nbDone( 0 ),
+        m_nbParts( 0 ),
+        m_nbWorkers( 1 ),
+        m_smartRender( false ),
+        m_width( 0 ),
+        m_height( 0 ),
+        m_fps( fps )
+{
+}
+
+SegmentedRenderer::~SegmentedRenderer()
+{
+    abort();
+    foreach ( Segment* seg, m_segments )
+    {
+        delete seg->process;
+        delete seg;
+    }
+}
+
+void
+SegmentedRenderer::setSmartRender( quint32 width, quint32 height )
+{
+    m_smartRender = true;
+    m_width = width;
+    m_height = height;
+}
+
+QList<qint64>
+SegmentedRenderer::computeSegments( const QList<qint64>& cutPoints, qint64 begin, qint64 end,
+                                    int nbSegments )
+{
+    QList<qint64>   boundaries;
+
+    boundaries.append( begin );
+    for ( int i = 1; i < nbSegments; ++i )
+    {
+        qint64  target = begin + ( end - begin ) * i / nbSegments;
+        qint64  best = -1;
+
+        //Find the closest cut point that is still after the previous boundary.
+        foreach ( qint64 cut, cutPoints )
+        {
+            if ( cut <= boundaries.last() || cut >= end )
+                continue ;
+            if ( best < 0 || qAbs( cut - target ) < qAbs( best - target ) )
+                best = cut;
+        }
+        if ( best < 0 )
+            break ;
+        boundaries.append( best );
+    }
+    boundaries.append( end );
+    return boundaries;
+}
+
+int
+SegmentedRenderer::start( int nbWorkers )
+{
+    MainWorkflow*   mainWorkflow = MainWorkflow::getInstance();
+    QList<qint64>   cutPoints = mainWorkflow->getCutPoints();
+    qint64          length = mainWorkflow->getLengthFrame();
+    qint64          reencodeBegin = 0;
+
+    m_nbWorkers = nbWorkers;
+    if ( m_smartRender == true )
+    {
+        //Every range between two cut points renders the same clips all along.
+        for ( int i = 0; i < cutPoints.size() - 1; ++i )
+        {
+            qint64  begin = cutPoints[i];
+            qint64  end = qMin( cutPoints[i + 1], length );
+            qint64  clipStart;
+
+            if ( begin >= length )
+                break ;
+            Clip*   clip = mainWorkflow->getPassthroughClip( begin, end, clipStart );
+            if ( clip == NULL || PassthroughRenderer::canPassthrough( clip, m_width, m_height,
+                                                                      m_fps ) == false )
+                continue ;
+            if ( begin > reencodeBegin )
+                addSegment( reencodeBegin, begin, false );
+            addSegment( begin, end, true );
+            reencodeBegin = end;
+        }
+    }
+    if ( reencodeBegin < length )
+        addSegment( reencodeBegin, length, false );
+
+    //Launch as much workers as allowed, the others will be launched when one finishes.
+    launchNext();
+    return m_segments.size();
+}
+
+void
+SegmentedRenderer::addSegment( qint64 begin, qint64 end, bool passthrough )
+{
+    QList<qint64>   boundaries;
+
+    if ( passthrough == false )
+    {
+        //Split the reencoded parts proportionally to their length, so that every worker
+        //is kept busy.
+        qint64  length = MainWorkflow::getInstance()->getLengthFrame();
+        int     nbSegments = qMax( (qint64)1, ( end - begin ) * m_nbWorkers / length );
+        boundaries = computeSegments( MainWorkflow::getInstance()->getCutPoints(),
+                                      begin, end, nbSegments );
+    }
+    else
+        boundaries << begin << end;
+
+    for ( int i = 0; i < boundaries.size() - 1; ++i )
+        m_segments.append( createSegment( boundaries[i], boundaries[i + 1], passthrough ) );
+}
+
+SegmentedRenderer::Segment*
+SegmentedRenderer::createSegment( qint64 begin, qint64 end, bool passthrough )
+{
+    Segment*    seg = new Segment;
+
+    seg->begin = begin;
+    seg->end = end;
+    seg->currentFrame = begin;
+    //Segments can be inserted afterward, so their index can't be used.
+    seg->fileName = m_outputFileName + ".part" + QString::number( m_nbParts++ );
+    seg->passthrough = passthrough;
+    seg->launched = false;
+    seg->done = false;
+    seg->copiedBegin = begin;
+    seg->copiedEnd = begin;
+    seg->process = new QProcess;
+    //Let the workers errors reach the console.
+    seg->process->setProcessChannelMode( QProcess::ForwardedErrorChannel );
+    connect( seg->process, SIGNAL( readyReadStandardOutput() ),
+             this, SLOT( readWorkerOutput() ) );
+    connect( seg->process, SIGNAL( finished( int, QProcess::ExitStatus ) ),
+             this, SLOT( workerFinished( int, QProcess::ExitStatus ) ) );
+    connect( seg->process, SIGNAL( error( QProcess::ProcessError ) ),
+             this, SLOT( workerError( QProcess::ProcessError ) ) );
+    return seg;
+}
+
+void
+SegmentedRenderer::splitPassthrough( Segment* seg )
+{
+    int     index = m_segments.indexOf( seg );
+
+    if ( seg->copiedEnd > seg->end )
+        seg->copiedEnd = seg->end;
+    if ( seg->copiedBegin < seg->begin || seg->copiedBegin >= seg->copiedEnd )
+    {
+        //Nothing was copied: the part is empty, and the range is reencoded.
+        m_segments.insert( index + 1, createSegment( seg->begin, seg->end, false ) );
+        seg->begin = seg->end;
+        return ;
+    }
+    if ( seg->copiedEnd < seg->end )
+        m_segments.insert( index + 1, createSegment( seg->copiedEnd, seg->end, false ) );
+    if ( seg->copiedBegin > seg->begin )
+        m_segments.insert( index, createSegment( seg->begin, seg->copiedBegin, false ) );
+    seg->begin = seg->copiedBegin;
+    seg->end = seg->copiedEnd;
+}
+
+void
+SegmentedRenderer::launchNext()
+{
+    while ( m_nbLaunched - m_nbDone < m_nbWorkers )
+    {
+        Segment*    next = NULL;
+        foreach ( Segment* seg, m_segments )
+        {
+            if ( seg->launched == true )
+                continue ;
+            if ( seg->passthrough == true )
+            {
+                next = seg;
+                break ;
+            }
+            if ( next == NULL )
+                next = seg;
+        }
+        if ( next == NULL )
+            return ;
+        launch( next );
+    }
+}
+
+void
+SegmentedRenderer::launch( Segment* seg )
+{
+    QStringList     args = m_workerArguments;
+
+    args << "--out" << seg->fileName
+         << "--range" << QString::number( seg->begin ) + ':' + QString::number( seg->end )
+         << "--worker";
+    if ( seg->passthrough == true )
+        args << "--passthrough";
+    qDebug() << ( seg->passthrough == true ? "Copying" : "Rendering" )
+             << "segment [" << seg->begin << ';' << seg->end << '[';
+    seg->launched = true;
+    ++m_nbLaunched;
+    seg->process->start( QCoreApplication::applicationFilePath(), args );
+}
+
+SegmentedRenderer::Segment*
+SegmentedRenderer::segment( QObject* process )
+{
+    foreach ( Segment* seg, m_segments )
+    {
+        if ( seg->process == process )
+            return seg;
+    }
+    return NULL;
+}
+
+void
+SegmentedRenderer::readWorkerOutput()
+{
+    Segment*    seg = segment( sender() );
+
+    if ( seg == NULL )
+        return ;
+    readOutput( seg );
+    updateProgress();
+}
+
+void
+SegmentedRenderer::readOutput( Segment* seg )
+{
+    //Workers write one "progress <frame>" or "copied <begin> <end>" line at a time.
+    while ( seg->process->canReadLine() == true )
+    {
+        QByteArray  line = seg->process->readLine().trimmed();
+        if ( line.startsWith( "progress " ) == true )
+            seg->currentFrame = line.mid( 9 ).toLongLong();
+        else if ( line.startsWith( "copied " ) == true )
+        {
+            QList<QByteArray>   range = line.mid( 7 ).split( ' ' );
+            if ( range.size() == 2 )
+            {
+                seg->copiedBegin = range[0].toLongLong();
+                seg->copiedEnd = range[1].toLongLong();
+            }
+        }
+    }
+}
+
+void
+SegmentedRenderer::updateProgress()
+{
+    qint64      nbFrames = 0;
+
+    foreach ( Segment* seg, m_segments )
+        nbFrames += seg->currentFrame - seg->begin;
+    emit progress( nbFrames );
+}
+
+void
+SegmentedRenderer::workerFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+    Segment*    seg = segment( sender() );
+
+    if ( seg == NULL || seg->done == true )
+        return ;
+    if ( exitStatus != QProcess::NormalExit || exitCode != 0 )
+    {
+        qCritical() << "Failed to render segment [" << seg->begin << ';' << seg->end << '[';
+        abort();
+        emit finished( false );
+        return ;
+    }
+    seg->done = true;
+    if ( seg->passthrough == true )
+    {
+        readOutput( seg );
+        splitPassthrough( seg );
+    }
+    seg->currentFrame = seg->end;
+    ++m_nbDone;
+    updateProgress();
+    launchNext();
+    if ( m_nbDone < m_segments.size() )
+        return ;
+    emit finished( concatenate() );
+}
+
+void
+SegmentedRenderer::workerError( QProcess::ProcessError error )
+{
+    Segment*    seg = segment( sender() );
+
+    //A crash is already reported by finished()
+    if ( seg == NULL || seg->done == true || error != QProcess::FailedToStart )
+        return ;
+    qCritical() << "Can't launch a render worker";
+    abort();
+    emit finished( false );
+}
+
+void
+SegmentedRenderer::abort()
+{
+    foreach ( Segment* seg, m_segments )
+    {
+        seg->done = true;
+        if ( seg->process->state() != QProcess::NotRunning )
+        {
+            seg->process->kill();
+            seg->process->waitForFinished();
+        }
+        QFile::remove( seg->fileName );
+    }
+}
+
+bool
+SegmentedRenderer::concatenate()
+{
+    //The MPEG program stream end code, that must only appear at the very end.
+    static const char   endCode[] = { 0x00, 0x00, 0x01, (char)0xB9 };
+    //Leave some room before the first frame, for the audio and the decoding timestamps.
+    static const qint64 origin = ProgramStream::ClockRate;
+    QFile               output( m_outputFileName );
+
+    if ( output.open( QFile::WriteOnly | QFile::Truncate ) == false )
+    {
+        qCritical() << "Can't open" << m_outputFileName << ':' << output.errorString();
+        return false;
+    }
+    bool    success = true;
+    foreach ( Segment* seg, m_segments )
+    {
+        {
+            ProgramStream   part( seg->fileName );
+            if ( part.open() == false )
+            {
+                success = false;
+                break ;
+            }
+            //Each worker starts its own timestamps: shift them so that the part's
+            //first frame is presented at its position in the timeline.
+            qint64  pts = part.firstPts();
+            if ( pts >= 0 )
+            {
+                qint64  target = origin + qRound64( seg->begin * ProgramStream::ClockRate / m_fps );
+                if ( part.write( output, QList<bool>(), target - pts ) == false )
+                {
+                    success = false;
+                    break ;
+                }
+            }
+        }
+        QFile::remove( seg->fileName );
+    }
+    if ( success == true &&
+         output.write( endCode, sizeof( endCode ) ) != sizeof( endCode ) )
+    {
+        qCritical() << "Failed to write to" << m_outputFileName << ':' << output.errorString();
+        success = false;
+    }
+    if ( success == false )
+    {
+        //Don't leave the remaining parts, nor a truncated output.
+        foreach ( Segment* seg, m_segments )
+            QFile::remove( seg->fileName );
+        output.close();
+        output.remove();
+    }
+    return success;
+}
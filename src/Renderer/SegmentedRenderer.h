@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * SegmentedRenderer.h: Renders a project in parallel, in several processes
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEGMENTEDRENDERER_H
+#define SEGMENTEDRENDERER_H
+
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+/**
+ *  \class  Splits the timeline in segments, and renders each of them in its own
+ *          vlmc --render process.
+ *
+ *  The segments are split on cut points, so that each worker starts on a clip
+ *  boundary. Each worker starts a new encoder, and therefore a new GOP.
+ *  The workers report their progress through their standard output, and
+ *  the resulting files are concatenated without being reencoded.
+ *
+ *  When smart rendering is enabled, the parts of the timeline that render a
+ *  single clip untouched, already encoded as the export would, get their own
+ *  segment, that is stream copied by a PassthroughRenderer. As only whole
+ *  GOPs can be copied, the frames around them are then reencoded by new
+ *  segments.
+ *
+ *  Every part starts with its own timestamps: they are rebased on the
+ *  timeline while concatenating.
+ */
+class   SegmentedRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( SegmentedRenderer )
+
+    public:
+        /**
+         *  \param  workerArguments The arguments to give every worker, besides
+         *                          its range and output file.
+         */
+        SegmentedRenderer( const QString& outputFileName, const QStringList& workerArguments,
+                           double fps );
+        ~SegmentedRenderer();
+
+        /**
+         *  \brief  Copy the untouched clips in place of reencoding them.
+         *
+         *  The output size is used to check if a clip can be copied as is.
+         */
+        void                        setSmartRender( quint32 width, quint32 height );
+        /**
+         *  \brief  Compute the segments, and launch the workers.
+         *
+         *  \param  nbWorkers   The number of workers that can run at the same time.
+         *                      The reencoded parts of the timeline are split in
+         *                      as many segments, as far as cut points allow it.
+         *  \return The number of segments.
+         */
+        int                         start( int nbWorkers );
+        /**
+         *  \brief  Compute the segments boundaries in [begin;end[
+         *
+         *  \return The first frame of every segment, followed by end.
+         */
+        static QList<qint64>        computeSegments( const QList<qint64>& cutPoints,
+                                                     qint64 begin, qint64 end,
+                                                     int nbSegments );
+
+    private:
+        struct  Segment
+        {
+            qint64          begin;
+            qint64          end;
+            qint64          currentFrame;
+            QString         fileName;
+            QProcess*       process;
+            bool            passthrough;
+            bool            launched;
+            bool            done;
+            /// The range actually copied by a passthrough segment.
+            qint64          copiedBegin;
+            qint64          copiedEnd;
+        };
+        void                        addSegment( qint64 begin, qint64 end, bool passthrough );
+        Segment*                    createSegment( qint64 begin, qint64 end, bool passthrough );
+        /**
+         *  \brief  Reencode the parts of a passthrough segment that couldn't
+         *          be copied.
+         */
+        void                        splitPassthrough( Segment* seg );
+        /**
+         *  \brief  Launch segments as long as there are less than m_nbWorkers
+         *          workers running.
+         *
+         *  The passthrough segments go first, as they may add segments.
+         */
+        void                        launchNext();
+        void                        launch( Segment* seg );
+        Segment*                    segment( QObject* process );
+        void                        readOutput( Segment* seg );
+        void                        updateProgress();
+        bool                        concatenate();
+        void                        abort();
+
+    private:
+        QString                     m_outputFileName;
+        QStringList                 m_workerArguments;
+        QList<Segment*>             m_segments;
+        int                         m_nbLaunched;
+        int                         m_nbDone;
+        int                         m_nbParts;
+        int                         m_nbWorkers;
+        bool                        m_smartRender;
+        quint32                     m_width;
+        quint32                     m_height;
+        double                      m_fps;
+
+    private slots:
+        void                        readWorkerOutput();
+        void                        workerFinished( int exitCode, QProcess::ExitStatus exitStatus );
+        void                        workerError( QProcess::ProcessError error );
+
+    signals:
+        /**
+         *  \param  nbFrames    The number of frames rendered by all the workers.
+         */
+        void                        progress( qint64 nbFrames );
+        void                        finished( bool success );
+};
+
+#endif // SEGMENTEDRENDERER_H
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * TranscodeJob.cpp: Transcodes a file on the shared VLC instance
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "TranscodeJob.h"
+#include "VLCMedia.h"
+#include "VLCMediaPlayer.h"
+
+#include <QFileInfo>
+#include <QtDebug>
+
+TranscodeJob::TranscodeJob( const QString& inputFileName, const QString& outputFileName,
+                            const QString& sout ) :
+        RenderJob( QFileInfo( inputFileName ).fileName(), outputFileName ),
+        m_inputFileName( inputFileName ),
+        m_sout( sout ),
+        m_media( NULL ),
+        m_mediaPlayer( NULL )
+{
+}
+
+TranscodeJob::~TranscodeJob()
+{
+    release();
+}
+
+void
+TranscodeJob::release()
+{
+    if ( m_mediaPlayer != NULL )
+    {
+        disconnect( m_mediaPlayer, 0, this, 0 );
+        m_mediaPlayer->stop();
+        delete m_mediaPlayer;
+        m_mediaPlayer = NULL;
+    }
+    delete m_media;
+    m_media = NULL;
+}
+
+bool
+TranscodeJob::doStart()
+{
+    QString     soutStr = ":sout=" + m_sout;
+
+    m_media = new LibVLCpp::Media( m_inputFileName );
+    m_media->addOption( soutStr.toStdString().c_str() );
+    m_media->addOption( ":no-sout-keep" );
+    m_mediaPlayer = new LibVLCpp::MediaPlayer;
+    m_mediaPlayer->setMedia( m_media );
+    //Events are sent from VLC's threads.
+    connect( m_mediaPlayer, SIGNAL( positionChanged( float ) ),
+             this, SLOT( positionChanged( float ) ), Qt::QueuedConnection );
+    connect( m_mediaPlayer, SIGNAL( endReached() ),
+             this, SLOT( endReached() ), Qt::QueuedConnection );
+    connect( m_mediaPlayer, SIGNAL( errorEncountered() ),
+             this, SLOT( errorEncountered() ), Qt::QueuedConnection );
+    m_mediaPlayer->play();
+    return true;
+}
+
+void
+TranscodeJob::doCancel()
+{
+    release();
+    QFile::remove( outputFileName() );
+}
+
+void
+TranscodeJob::positionChanged( float pos )
+{
+    if ( m_mediaPlayer == NULL )
+        return ;
+    //The length is only known once the input has been opened.
+    qint64  nbFrames = (qint64)( m_mediaPlayer->getLength() * m_mediaPlayer->getFps() / 1000 );
+    setProgress( (qint64)( pos * nbFrames ), nbFrames );
+}
+
+void
+TranscodeJob::endReached()
+{
+    release();
+    setFinished( true );
+}
+
+void
+TranscodeJob::errorEncountered()
+{
+    qWarning() << "Failed to transcode" << m_inputFileName;
+    release();
+    setFinished( false );
+}
@@ -0,0 +1,71 @@
+/*****************************************************************************
+ * TranscodeJob.h: Transcodes a file on the shared VLC instance
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRANSCODEJOB_H
+#define TRANSCODEJOB_H
+
+#include "RenderJob.h"
+
+namespace LibVLCpp
+{
+    class   Media;
+    class   MediaPlayer;
+}
+
+/**
+ *  \class  Transcodes a file using a sout chain.
+ *
+ *  This runs in the application's process, using the shared LibVLCpp::Instance.
+ */
+class   TranscodeJob : public RenderJob
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( TranscodeJob )
+
+    public:
+        /**
+         *  \param  sout    The stream output chain, without the ":sout=" prefix.
+         */
+        TranscodeJob( const QString& inputFileName, const QString& outputFileName,
+                      const QString& sout );
+        ~TranscodeJob();
+
+    protected:
+        virtual bool                doStart();
+        virtual void                doCancel();
+
+    private:
+        void                        release();
+
+    private:
+        QString                     m_inputFileName;
+        QString                     m_sout;
+        LibVLCpp::Media*            m_media;
+        LibVLCpp::MediaPlayer*      m_mediaPlayer;
+
+    private slots:
+        void                        positionChanged( float pos );
+        void                        endReached();
+        void                        errorEncountered();
+};
+
+#endif // TRANSCODEJOB_H
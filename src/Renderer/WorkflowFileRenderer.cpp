@@ -29,24 +29,32 @@
 #include "export/RendererSettings.h"
 
 #include <QTime>
+#include <QtDebug>
+
+const char* const    WorkflowFileRenderer::videoCodec = "h264";
+const char* const    WorkflowFileRenderer::audioCodec = "a52";
+const char* const    WorkflowFileRenderer::muxer = "ps";
 
 WorkflowFileRenderer::WorkflowFileRenderer() :
         WorkflowRenderer(),
-        m_image( NULL )
+        m_dialog( NULL ),
+        m_image( NULL ),
+        m_pipeline( NULL ),
+        m_rangeBegin( 0 ),
+        m_rangeEnd( -1 )
 {
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_encodedBuffers[i] = NULL;
 }
 
 WorkflowFileRenderer::~WorkflowFileRenderer()
 {
+    stop();
     delete m_image;
 }
 
 void        WorkflowFileRenderer::run()
 {
-//    char        buffer[256];
-
-    m_mainWorkflow->setCurrentFrame( 0, MainWorkflow::Renderer );
-
     //Setup dialog box for querying render parameters.
     RendererSettings    *settings = new RendererSettings;
     if ( settings->exec() == QDialog::Rejected )
@@ -54,7 +62,7 @@ void        WorkflowFileRenderer::run()
         delete settings;
         return ;
     }
-    m_outputFileName = settings->outputFileName();
+    QString     outputFileName = settings->outputFileName();
     quint32     width = settings->width();
     quint32     height = settings->height();
     double      fps = settings->fps();
@@ -62,14 +70,27 @@ void        WorkflowFileRenderer::run()
     quint32     abitrate = settings->audioBitrate();
     delete settings;
 
+    setupDialog( outputFileName, width, height );
+    render( outputFileName, width, height, fps, vbitrate, abitrate );
+}
+
+void
+WorkflowFileRenderer::render( const QString& outputFileName, quint32 width, quint32 height,
+                              double fps, quint32 vbitrate, quint32 abitrate )
+{
+//    char        buffer[256];
+
+    m_outputFileName = outputFileName;
+    m_mainWorkflow->setCurrentFrame( m_rangeBegin, MainWorkflow::Renderer );
     setupRenderer( width, height, fps );
-    setupDialog( width, height );
 
     //Media as already been created and mainly initialized by the WorkflowRenderer
-    QString     transcodeStr = ":sout=#transcode{vcodec=h264,vb=" + QString::number( vbitrate ) +
-                               ",acodec=a52,ab=" + QString::number( abitrate ) +
+    QString     transcodeStr = ":sout=#transcode{vcodec=" + QString( videoCodec ) +
+                               ",vb=" + QString::number( vbitrate ) +
+                               ",acodec=" + QString( audioCodec ) +
+                               ",ab=" + QString::number( abitrate ) +
                                ",no-hurry-up}"
-                               ":standard{access=file,mux=ps,dst=\""
+                               ":standard{access=file,mux=" + QString( muxer ) + ",dst=\""
                           + m_outputFileName + "\"}";
     m_media->addOption( transcodeStr.toStdString().c_str() );
 
@@ -78,37 +99,64 @@ void        WorkflowFileRenderer::run()
 
     m_mediaPlayer->setMedia( m_media );
 
-    connect( m_mainWorkflow, SIGNAL( mainWorkflowEndReached() ), this, SLOT( stop() ) );
+    //The workflow reaches its end before the encoder does, as the pipeline
+    //is still holding the last composited buffers.
+    disconnect( m_mainWorkflow, SIGNAL( mainWorkflowEndReached() ), this, 0 );
+    m_pipeline = new RenderPipeline( m_mainWorkflow, width, height, fps,
+                                     m_nbChannels, m_rate );
+    m_pipeline->setRange( m_rangeBegin, m_rangeEnd );
+    connect( m_pipeline, SIGNAL( endReached() ), this, SLOT( __endReached() ),
+             Qt::QueuedConnection );
     connect( m_mainWorkflow, SIGNAL( frameChanged( qint64, MainWorkflow::FrameChangedReason) ),
              this, SLOT( __frameChanged( qint64,MainWorkflow::FrameChangedReason ) ) );
 
     m_isRendering = true;
     m_stopping = false;
     m_paused = false;
-    m_pts = 0;
-    m_audioPts = 0;
+    m_pts = m_rangeBegin * 1000000 / fps;
+    m_audioPts = m_pts;
 
     m_mainWorkflow->setFullSpeedRender( true );
     m_mainWorkflow->startRender( width, height );
+    m_pipeline->start();
     m_mediaPlayer->play();
 }
 
+void
+WorkflowFileRenderer::setRange( qint64 begin, qint64 end )
+{
+    m_rangeBegin = begin;
+    m_rangeEnd = end;
+}
+
 void    WorkflowFileRenderer::stop()
 {
-    WorkflowRenderer::killRenderer();
+    //The compositing threads have to be stopped before the workflow is.
+    if ( m_pipeline != NULL )
+    {
+        m_pipeline->stop();
+        WorkflowRenderer::killRenderer();
+        delete m_pipeline;
+        m_pipeline = NULL;
+        for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+            m_encodedBuffers[i] = NULL;
+    }
 }
 
 void    WorkflowFileRenderer::cancelButtonClicked()
 {
     stop();
     disconnect();
-    m_dialog->done( 0 );
+    if ( m_dialog != NULL )
+        m_dialog->done( 0 );
 }
 
 void
 WorkflowFileRenderer::__endReached()
 {
-     cancelButtonClicked();
+    stop();
+    emit renderComplete();
+    cancelButtonClicked();
 }
 
 float   WorkflowFileRenderer::getFps() const
@@ -120,29 +168,67 @@ int
 WorkflowFileRenderer::lock( void *datas, qint64 *dts, qint64 *pts, quint32 *flags,
                             size_t *bufferSize, void **buffer )
 {
-    int         ret = WorkflowRenderer::lock( datas, dts, pts, flags, bufferSize, buffer );
-    EsHandler*  handler = reinterpret_cast<EsHandler*>( datas );
-    WorkflowFileRenderer* self = static_cast<WorkflowFileRenderer*>( handler->self );
+    EsHandler*              handler = reinterpret_cast<EsHandler*>( datas );
+    WorkflowFileRenderer*   self = static_cast<WorkflowFileRenderer*>( handler->self );
+    MainWorkflow::TrackType trackType = ( handler->type == Video ?
+                                          MainWorkflow::VideoTrack : MainWorkflow::AudioTrack );
 
-    if ( self->m_time.isValid() == false ||
-        self->m_time.elapsed() >= 1000 )
+    *dts = -1;
+    *flags = 0;
+    if ( handler->type != Video && handler->type != Audio )
     {
-        self->emit imageUpdated( (uchar*)self->m_renderVideoFrame );
-        self->m_time.restart();
+        qCritical() << "Invalid ES type";
+        return 1;
     }
-    return ret;
+    RenderPipeline::Buffer*     buff = self->m_pipeline->pop( trackType );
+    if ( buff == NULL || buff->endOfStream == true )
+        return 1;
+    self->m_encodedBuffers[trackType] = buff;
+
+    qint64      ptsDiff = buff->ptsDiff;
+    if ( handler->type == Video )
+    {
+        //Same fallback as the WorkflowRenderer, when nothing has been rendered
+        if ( ptsDiff == 0 )
+            ptsDiff = 1000000 / handler->fps;
+        self->m_pts = *pts = ptsDiff + self->m_pts;
+        if ( self->m_time.isValid() == false ||
+            self->m_time.elapsed() >= 1000 )
+        {
+            memcpy( self->m_renderVideoFrame, buff->data, buff->size );
+            self->emit imageUpdated( (uchar*)self->m_renderVideoFrame );
+            self->m_time.restart();
+        }
+    }
+    else
+    {
+        if ( ptsDiff == 0 )
+            ptsDiff = self->m_pts - self->m_audioPts;
+        self->m_audioPts = *pts = self->m_audioPts + ptsDiff;
+    }
+    *buffer = buff->data;
+    *bufferSize = buff->size;
+    return 0;
 }
 
 void        
-WorkflowFileRenderer::unlock( void *datas, size_t size, void* buff )
+WorkflowFileRenderer::unlock( void *datas, size_t, void* )
 {
-    WorkflowRenderer::unlock( datas, size, buff );
+    EsHandler*              handler = reinterpret_cast<EsHandler*>( datas );
+    WorkflowFileRenderer*   self = static_cast<WorkflowFileRenderer*>( handler->self );
+    MainWorkflow::TrackType trackType = ( handler->type == Video ?
+                                          MainWorkflow::VideoTrack : MainWorkflow::AudioTrack );
+
+    if ( self->m_pipeline != NULL )
+        self->m_pipeline->release( trackType, self->m_encodedBuffers[trackType] );
+    self->m_encodedBuffers[trackType] = NULL;
 }
 
 void        
 WorkflowFileRenderer::__frameChanged( qint64 frame, MainWorkflow::FrameChangedReason )
 {
-    m_dialog->setProgressBarValue( frame * 100 / m_mainWorkflow->getLengthFrame() );
+    if ( m_dialog != NULL )
+        m_dialog->setProgressBarValue( frame * 100 / m_mainWorkflow->getLengthFrame() );
 }
 
 void*       
@@ -170,11 +256,11 @@ WorkflowFileRenderer::height() const
 }
 
 void
-WorkflowFileRenderer::setupDialog( quint32 width, quint32 height )
+WorkflowFileRenderer::setupDialog( const QString& outputFileName, quint32 width, quint32 height )
 {
     m_dialog = new WorkflowFileRendererDialog( width, height );
     m_dialog->setModal( true );
-    m_dialog->setOutputFileName( m_outputFileName );
+    m_dialog->setOutputFileName( outputFileName );
     connect( m_dialog->m_ui.cancelButton, SIGNAL( clicked() ), this, SLOT( cancelButtonClicked() ) );
     connect( m_dialog, SIGNAL( finished(int) ), this, SLOT( stop() ) );
     connect( this, SIGNAL( imageUpdated( const uchar* ) ),
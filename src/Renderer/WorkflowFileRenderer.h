@@ -26,6 +26,7 @@
 #include "Workflow/MainWorkflow.h"
 #include "WorkflowRenderer.h"
 #include "WorkflowFileRendererDialog.h"
+#include "RenderPipeline.h"
 
 #include <QTime>
 
@@ -42,17 +43,52 @@ public:
                               size_t *bufferSize, void **buffer );
     static void         unlock( void* datas, size_t size, void* buff );
 
+    /**
+     *  \brief     Ask the user for the render parameters, and render the project.
+     */
     void                run();
+
+    /// The codecs and muxer used for the export, as named by VLC
+    static const char* const    videoCodec;
+    static const char* const    audioCodec;
+    static const char* const    muxer;
+    /**
+     *  \brief     Render the project to a file, without any user interaction.
+     *
+     *  This doesn't require any widget, so it can be used without a GUI.
+     *  renderComplete() will be emitted once the file has been written.
+     */
+    void                render( const QString& outputFileName, quint32 width, quint32 height,
+                                double fps, quint32 vbitrate, quint32 abitrate );
+    /**
+     *  \brief     Only render the frames in [begin;end[ during the next render()
+     *
+     *  The timestamps are kept relative to the whole project, so that the
+     *  segments can be concatenated afterward.
+     *  \param     end     The first frame not to render, or -1 to render until the end.
+     */
+    void                setRange( qint64 begin, qint64 end );
     virtual float       getFps() const;
 
 private:
-    void                setupDialog( quint32 width, quint32 height );
+    void                setupDialog( const QString& outputFileName, quint32 width, quint32 height );
 
 private:
     QString                     m_outputFileName;
     WorkflowFileRendererDialog* m_dialog;
     QImage*                     m_image;
     QTime                       m_time;
+    /**
+     *  \brief  Composites the output ahead of the encoder.
+     *
+     *  The imem callbacks only pop buffers from it, so that encoding never
+     *  waits for the composition of the current frame.
+     */
+    RenderPipeline*             m_pipeline;
+    qint64                      m_rangeBegin;
+    qint64                      m_rangeEnd;
+    /// The buffers currently held by the encoder, indexed by MainWorkflow::TrackType
+    RenderPipeline::Buffer*     m_encodedBuffers[MainWorkflow::NbTrackType];
 
 protected:
     virtual void*               getLockCallback();
@@ -68,6 +104,7 @@ private slots:
 
 signals:
     void                        imageUpdated( const uchar* image );
+    void                        renderComplete();
 };
 
 #endif // WORKFLOWFILERENDERER_H
@@ -22,6 +22,7 @@
 
 #include <QtDebug>
 #include <QThread>
+#include <QTimer>
 #include <QWaitCondition>
 
 #include "WorkflowRenderer.h"
@@ -29,11 +30,14 @@
 #include "SettingsManager.h"
 #include "LightVideoFrame.h"
 #include "MainWorkflow.h"
+#include "PlaybackStats.h"
 #include "GenericRenderer.h"
 #include "AudioClipWorkflow.h"
 #include "VLCMedia.h"
 #include "Clip.h"
 #include "VLCMediaPlayer.h"
+#include "MediaPlayerPool.h"
+#include "Tracer.h"
 
 WorkflowRenderer::WorkflowRenderer() :
             m_mainWorkflow( MainWorkflow::getInstance() ),
@@ -46,6 +50,11 @@ WorkflowRenderer::WorkflowRenderer() :
             m_height( 0 ),
             m_silencedAudioBuffer( NULL )
 {
+    m_trimTimer = new QTimer( this );
+    m_trimTimer->setSingleShot( true );
+    //Let the players become idle for long enough to be trimmed.
+    m_trimTimer->setInterval( MediaPlayerPool::maxIdleTime / 1000 + 1000 );
+    connect( m_trimTimer, SIGNAL( timeout() ), this, SLOT( trimMediaPlayers() ) );
 }
 
 void    WorkflowRenderer::initializeRenderer()
@@ -57,8 +66,8 @@ void    WorkflowRenderer::initializeRenderer()
     m_audioEsHandler->self = this;
     m_audioEsHandler->type = Audio;
 
-    m_nbChannels = 2;
-    m_rate = 48000;
+    m_nbChannels = audioChannels;
+    m_rate = audioSampleRate;
 
      //Workflow part
     connect( m_mainWorkflow, SIGNAL( mainWorkflowEndReached() ), this, SLOT( __endReached() ) );
@@ -117,6 +126,7 @@ int
 WorkflowRenderer::lock( void *datas, qint64 *dts, qint64 *pts, quint32 *flags,
                         size_t *bufferSize, void **buffer )
 {
+    VLMC_TRACE_SCOPE( "WorkflowRenderer::lock" );
     int             ret = 1;
     EsHandler*      handler = reinterpret_cast<EsHandler*>( datas );
     bool            paused = handler->self->m_paused;
@@ -127,7 +137,10 @@ WorkflowRenderer::lock( void *datas, qint64 *dts, qint64 *pts, quint32 *flags,
     {
         ret = handler->self->lockVideo( handler, pts, bufferSize, buffer );
         if ( paused == false )
+        {
             handler->self->m_mainWorkflow->nextFrame( MainWorkflow::VideoTrack );
+            PlaybackStats::getInstance()->frameDelivered();
+        }
     }
     else if ( handler->type == Audio )
     {
@@ -192,6 +205,8 @@ WorkflowRenderer::lockAudio( EsHandler *handler, qint64 *pts, size_t *bufferSize
     }
     else
     {
+        if ( m_stopping == false && m_paused == false )
+            PlaybackStats::getInstance()->audioUnderrun();
         nbSample = m_rate / handler->fps;
         unsigned int    buffSize = m_nbChannels * 2 * nbSample;
         if ( m_silencedAudioBuffer == NULL )
@@ -228,6 +243,7 @@ void        WorkflowRenderer::startPreview()
     //FIXME:: check if this doesn't require Qt::QueuedConnection
     connect( m_mediaPlayer, SIGNAL( stopped() ),    this,   SIGNAL( endReached() ) );
 
+    m_trimTimer->stop();
     m_mainWorkflow->setFullSpeedRender( false );
     m_mainWorkflow->startRender( m_width, m_height );
     m_isRendering = true;
@@ -235,6 +251,7 @@ void        WorkflowRenderer::startPreview()
     m_stopping = false;
     m_pts = 0;
     m_audioPts = 0;
+    PlaybackStats::getInstance()->start( m_outputFps );
     m_mediaPlayer->play();
 }
 
@@ -266,6 +283,7 @@ void        WorkflowRenderer::internalPlayPause( bool forcePause )
         if ( m_paused == true && forcePause == false )
         {
             m_paused = false;
+            PlaybackStats::getInstance()->setPaused( false );
             emit playing();
         }
         else
@@ -273,6 +291,7 @@ void        WorkflowRenderer::internalPlayPause( bool forcePause )
             if ( m_paused == false )
             {
                 m_paused = true;
+                PlaybackStats::getInstance()->setPaused( true );
                 emit paused();
             }
         }
@@ -294,10 +313,12 @@ WorkflowRenderer::killRenderer()
     m_isRendering = false;
     m_paused = false;
     m_stopping = true;
+    PlaybackStats::getInstance()->setPaused( true );
     m_mediaPlayer->stop();
     m_mainWorkflow->stop();
     delete[] m_silencedAudioBuffer;
     m_silencedAudioBuffer = NULL;
+    m_trimTimer->start();
 }
 
 qint64      WorkflowRenderer::getCurrentFrame() const
@@ -403,3 +424,9 @@ WorkflowRenderer::mainWorkflowLenghtChanged( qint64 newLength )
 //    }
 //    m_oldLength = newLength;
 }
+
+void
+WorkflowRenderer::trimMediaPlayers()
+{
+    MediaPlayerPool::getInstance()->trim();
+}
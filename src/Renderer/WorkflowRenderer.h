@@ -31,6 +31,7 @@
 
 class   Clip;
 
+class   QTimer;
 class   QWidget;
 class   QWaitCondition;
 class   QMutex;
@@ -53,6 +54,9 @@ class   WorkflowRenderer : public GenericRenderer
             Video, ///< Video type
             Subtitle ///< This is clearly not used by VLMC, but it fits imem module's model
         };
+        /// The audio format of the render.
+        static const quint32    audioSampleRate = 48000;
+        static const quint32    audioChannels = 2;
         /**
          *  \brief  This struct will be the type of the callback parameter
          *          in the lock / unlock callbacks
@@ -266,6 +270,8 @@ class   WorkflowRenderer : public GenericRenderer
         qint64              m_audioPts;
         quint32             m_width;
         quint32             m_height;
+        quint32             m_nbChannels;
+        quint32             m_rate;
 
     private:
         /**
@@ -276,13 +282,15 @@ class   WorkflowRenderer : public GenericRenderer
         size_t              m_videoBuffSize;
         EsHandler*          m_videoEsHandler;
         EsHandler*          m_audioEsHandler;
-        quint32             m_nbChannels;
-        quint32             m_rate;
         /**
          *  \brief          Used in permanent rendering mode, to know is some operations
          *                  has to be performed.
          */
         qint64              m_oldLength;
+        /**
+         *  \brief          Releases the idle media players once the render stopped.
+         */
+        QTimer*             m_trimTimer;
 
 
     public slots:
@@ -324,6 +332,7 @@ class   WorkflowRenderer : public GenericRenderer
          *  If the length comes to a 0 value again, the permanent playback will be stoped.
          */
         void                mainWorkflowLenghtChanged( qint64 newLength );
+        void                trimMediaPlayers();
 
 };
 
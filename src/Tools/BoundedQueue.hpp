@@ -0,0 +1,121 @@
+/*****************************************************************************
+ * BoundedQueue.hpp: A thread safe queue with a maximum size
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+/**
+ *  \class  A thread safe queue, that blocks the producer when full, and the
+ *          consumer when empty.
+ *
+ *  Once abort() has been called, every blocked or future call to pop() will
+ *  return a default constructed value, and push() won't block anymore.
+ */
+template <typename T>
+class   BoundedQueue
+{
+    public:
+        BoundedQueue( int capacity ) :
+                m_capacity( capacity ),
+                m_aborted( false )
+        {
+            m_mutex = new QMutex;
+            m_notEmpty = new QWaitCondition;
+            m_notFull = new QWaitCondition;
+        }
+        ~BoundedQueue()
+        {
+            delete m_notFull;
+            delete m_notEmpty;
+            delete m_mutex;
+        }
+        /**
+         *  \brief  Push a value, waiting for some room if the queue is full.
+         *  \return false if the queue has been aborted.
+         */
+        bool    push( const T& val )
+        {
+            QMutexLocker    lock( m_mutex );
+            while ( m_queue.count() >= m_capacity && m_aborted == false )
+                m_notFull->wait( m_mutex );
+            if ( m_aborted == true )
+                return false;
+            m_queue.enqueue( val );
+            m_notEmpty->wakeOne();
+            return true;
+        }
+        /**
+         *  \brief  Pop a value, waiting for one to be pushed if the queue is empty.
+         */
+        T       pop()
+        {
+            QMutexLocker    lock( m_mutex );
+            while ( m_queue.isEmpty() == true && m_aborted == false )
+                m_notEmpty->wait( m_mutex );
+            if ( m_aborted == true )
+                return T();
+            T   ret = m_queue.dequeue();
+            m_notFull->wakeOne();
+            return ret;
+        }
+        void    abort()
+        {
+            QMutexLocker    lock( m_mutex );
+            m_aborted = true;
+            m_notEmpty->wakeAll();
+            m_notFull->wakeAll();
+        }
+        int     count() const
+        {
+            QMutexLocker    lock( m_mutex );
+            return m_queue.count();
+        }
+        int     capacity() const
+        {
+            return m_capacity;
+        }
+        /**
+         *  \brief  Unconditionnaly empty the queue, and return its content.
+         */
+        QQueue<T>   takeAll()
+        {
+            QMutexLocker    lock( m_mutex );
+            QQueue<T>       ret = m_queue;
+            m_queue.clear();
+            m_notFull->wakeAll();
+            return ret;
+        }
+
+    private:
+        QQueue<T>           m_queue;
+        int                 m_capacity;
+        bool                m_aborted;
+        QMutex*             m_mutex;
+        QWaitCondition*     m_notEmpty;
+        QWaitCondition*     m_notFull;
+};
+
+#endif // BOUNDEDQUEUE_HPP
@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * SeqLock.hpp: Lock free publication of small values
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <QAtomicInt>
+
+/**
+ *  \class  A value protected by a sequence counter.
+ *
+ *  Readers never block, nor change the sequence: they retry if a writer was
+ *  publishing a new value meanwhile. Qt 4 has no atomic load with a barrier,
+ *  so they read the sequence through a read-modify-write that adds 0; it
+ *  still takes the sequence's cache line exclusively, so heavily contended
+ *  reads are not free. Writers are serialized by the
+ *  sequence counter itself, so this is meant for values that are written
+ *  often by a single thread, and occasionally by another one.
+ *  T must be a plain value type, such as a qint64 on 32 bits platforms.
+ */
+template <typename T>
+class   SeqLocked
+{
+    public:
+        SeqLocked( const T& value = T() ) : m_sequence( 0 ), m_value( value )
+        {
+        }
+        T       get() const
+        {
+            forever
+            {
+                //Adding 0 is the only acquire load Qt 4 provides.
+                int     begin = m_sequence.fetchAndAddAcquire( 0 );
+                if ( ( begin & 1 ) != 0 )
+                    continue ;
+                T       value = m_value;
+                //Full barrier, so that the value is read before the sequence.
+                if ( m_sequence.fetchAndAddOrdered( 0 ) == begin )
+                    return value;
+            }
+        }
+        void    set( const T& value )
+        {
+            int     sequence = beginWrite();
+            m_value = value;
+            m_sequence.fetchAndStoreRelease( sequence + 2 );
+        }
+        /**
+         *  \brief  Atomically add \a delta to the value.
+         *  \return The new value.
+         */
+        T       add( const T& delta )
+        {
+            int     sequence = beginWrite();
+            T       value = m_value + delta;
+            m_value = value;
+            m_sequence.fetchAndStoreRelease( sequence + 2 );
+            return value;
+        }
+
+    private:
+        int     beginWrite()
+        {
+            forever
+            {
+                int     sequence = m_sequence;
+                if ( ( sequence & 1 ) == 0 &&
+                     m_sequence.testAndSetAcquire( sequence, sequence + 1 ) == true )
+                    return sequence;
+            }
+        }
+
+    private:
+        mutable QAtomicInt  m_sequence;
+        volatile T          m_value;
+};
+
+#endif // SEQLOCK_HPP
@@ -1,10 +1,14 @@
-HEADERS += MemoryPool.hpp \
+HEADERS += BoundedQueue.hpp \
     QSingleton.hpp \
+    SeqLock.hpp \
     Singleton.hpp \
     Toggleable.hpp \
+    Tracer.h \
     WaitCondition.hpp \
+    XmlStream.hpp \
     VlmcDebug.h \
     Pool.hpp \
     mdate.h \
     SynchronisationHelper.hpp
-SOURCES += VlmcDebug.cpp
+SOURCES += VlmcDebug.cpp \
+    Tracer.cpp
@@ -0,0 +1,282 @@
+/*****************************************************************************
+ * Tracer.cpp: Records trace points and exports them as Chrome trace events
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "Tracer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QtDebug>
+
+QAtomicInt  Tracer::s_enabled = 0;
+
+/**
+ *  Only the owning thread appends events. The count published with release
+ *  semantics tells the reader which events are complete: below bufferSize,
+ *  it's the number of events, and above, the buffer is full and the
+ *  count minus bufferSize is the index of the oldest event.
+ *  The owning thread also flags the buffer while it may append, so that
+ *  save() can wait for the events being recorded when tracing stops.
+ */
+class   Tracer::ThreadBuffer
+{
+    public:
+        ThreadBuffer() : threadId( -1 ), m_count( 0 ), m_free( 0 ), m_writing( 0 )
+        {
+            m_events = new Event[Tracer::bufferSize];
+        }
+        ~ThreadBuffer()
+        {
+            delete[] m_events;
+        }
+        void        append( const char* name, qint64 begin, qint64 end, qint64 arg )
+        {
+            int     count = m_count;
+            Event&  event = m_events[count < bufferSize ? count : count - bufferSize];
+
+            event.name = name;
+            event.begin = begin;
+            event.duration = end - begin;
+            event.arg = arg;
+            event.threadId = threadId;
+            ++count;
+            if ( count == 2 * bufferSize )
+                count = bufferSize;
+            m_count.fetchAndStoreRelease( count );
+        }
+        /// \brief  Append the events to list, oldest first.
+        void        copyEvents( QList<Event>& list )
+        {
+            int     count = m_count.fetchAndAddAcquire( 0 );
+
+            if ( count < bufferSize )
+            {
+                for ( int i = 0; i < count; ++i )
+                    list.append( m_events[i] );
+                return ;
+            }
+            for ( int i = 0; i < bufferSize; ++i )
+                list.append( m_events[( count - bufferSize + i ) % bufferSize] );
+        }
+        /**
+         *  \brief  Flag the buffer as being written. The full barrier
+         *          orders it before the tracing state is read again.
+         */
+        void        beginWrite()
+        {
+            m_writing.fetchAndStoreOrdered( 1 );
+        }
+        void        endWrite()
+        {
+            m_writing.fetchAndStoreRelease( 0 );
+        }
+        /// \brief  Wait until the owning thread isn't appending anymore.
+        void        waitForWriter() const
+        {
+            while ( m_writing != 0 )
+                QThread::yieldCurrentThread();
+        }
+        void        release()
+        {
+            m_free.fetchAndStoreRelease( 1 );
+        }
+        bool        acquire()
+        {
+            return m_free.testAndSetAcquire( 1, 0 );
+        }
+
+        /// \brief  Index in the thread names of the thread owning the buffer.
+        int         threadId;
+
+    private:
+        Event*      m_events;
+        QAtomicInt  m_count;
+        QAtomicInt  m_free;
+        QAtomicInt  m_writing;
+};
+
+Tracer::BufferRef::~BufferRef()
+{
+    //The events are kept until a new thread reuses the buffer and overwrites them.
+    buffer->release();
+}
+
+Tracer::Tracer() :
+        m_startTime( mdate() )
+{
+    m_mutex = new QMutex;
+}
+
+Tracer::~Tracer()
+{
+    delete m_mutex;
+    qDeleteAll( m_buffers );
+}
+
+void
+Tracer::setup( const QStringList& args )
+{
+    foreach ( const QString& arg, args )
+    {
+        if ( arg.startsWith( "--trace=" ) == true )
+            m_outputFileName = arg.mid( 8 );
+    }
+    if ( m_outputFileName.isEmpty() == true )
+        return ;
+    start();
+    connect( qApp, SIGNAL( aboutToQuit() ), this, SLOT( saveOnExit() ) );
+}
+
+void
+Tracer::start()
+{
+    s_enabled.fetchAndStoreOrdered( 1 );
+}
+
+void
+Tracer::stop()
+{
+    s_enabled.fetchAndStoreOrdered( 0 );
+}
+
+void
+Tracer::record( const char* name, qint64 begin, qint64 end, qint64 arg )
+{
+    if ( isEnabled() == false )
+        return ;
+    ThreadBuffer*   buffer = getInstance()->threadBuffer();
+
+    //A scope may have begun before tracing was stopped: check again once
+    //the buffer is flagged, so that save() either waits for this event or
+    //we see that tracing is stopped. Only this thread's buffer is written.
+    buffer->beginWrite();
+    if ( isEnabled() == true )
+        buffer->append( name, begin, end, arg );
+    buffer->endWrite();
+}
+
+Tracer::ThreadBuffer*
+Tracer::threadBuffer()
+{
+    if ( m_localBuffer.hasLocalData() == true )
+        return m_localBuffer.localData()->buffer;
+
+    QMutexLocker    lock( m_mutex );
+    QThread*        thread = QThread::currentThread();
+    QString         name = thread->objectName();
+    ThreadBuffer*   buffer = NULL;
+
+    if ( thread == QCoreApplication::instance()->thread() )
+        name = "main";
+    else if ( name.isEmpty() == true )
+        name = thread->metaObject()->className();
+    foreach ( ThreadBuffer* it, m_buffers )
+    {
+        if ( it->acquire() == true )
+        {
+            buffer = it;
+            break ;
+        }
+    }
+    if ( buffer == NULL )
+    {
+        buffer = new ThreadBuffer;
+        m_buffers.append( buffer );
+    }
+    buffer->threadId = m_threadNames.size();
+    m_threadNames.append( name );
+    m_localBuffer.setLocalData( new BufferRef( buffer ) );
+    return buffer;
+}
+
+static QString
+escape( const QString& str )
+{
+    QString     ret = str;
+
+    ret.replace( '\\', "\\\\" );
+    ret.replace( '"', "\\\"" );
+    return ret;
+}
+
+bool
+Tracer::save( const QString& fileName )
+{
+    QFile       file( fileName );
+    bool        wasEnabled = isEnabled();
+
+    if ( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) == false )
+    {
+        qWarning() << "Can't write the trace to" << fileName << ':' << file.errorString();
+        return false;
+    }
+    stop();
+
+    QTextStream     out( &file );
+    qint64          pid = QCoreApplication::applicationPid();
+    QList<Event>    events;
+    QMutexLocker    lock( m_mutex );
+
+    out << "{\"traceEvents\":[" << endl;
+    for ( int i = 0; i < m_threadNames.size(); ++i )
+    {
+        if ( i > 0 )
+            out << ',' << endl;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << i << ",\"args\":{\"name\":\""
+            << escape( m_threadNames[i] ) << "\"}}";
+    }
+    //Events being appended must be complete before the buffers are read.
+    //A writer still waiting for the lock in threadBuffer() hasn't flagged
+    //its buffer yet, and will see that tracing is stopped.
+    foreach ( ThreadBuffer* buffer, m_buffers )
+    {
+        buffer->waitForWriter();
+        buffer->copyEvents( events );
+    }
+    lock.unlock();
+    foreach ( const Event& event, events )
+    {
+        //There is at least a thread name before any event.
+        out << ',' << endl;
+        out << "{\"name\":\"" << event.name << "\",\"cat\":\"vlmc\",\"ph\":\"X\""
+            << ",\"ts\":" << event.begin - m_startTime << ",\"dur\":" << event.duration
+            << ",\"pid\":" << pid << ",\"tid\":" << event.threadId;
+        if ( event.arg >= 0 )
+            out << ",\"args\":{\"frame\":" << event.arg << '}';
+        out << '}';
+    }
+    out << endl;
+    out << "],\"displayTimeUnit\":\"ms\"}" << endl;
+    if ( wasEnabled == true )
+        start();
+    return out.status() == QTextStream::Ok;
+}
+
+void
+Tracer::saveOnExit()
+{
+    if ( save( m_outputFileName ) == true )
+        qDebug() << "Trace saved to" << m_outputFileName;
+}
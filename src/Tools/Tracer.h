@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * Tracer.h: Records trace points and exports them as Chrome trace events
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "Singleton.hpp"
+#include "mdate.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadStorage>
+
+class   QMutex;
+
+/**
+ *  \class  Records scoped trace points, and saves them in the Chrome trace
+ *          event format, that chrome://tracing and Perfetto can open.
+ *
+ *  Each thread writes in its own ring buffer without taking any lock, so
+ *  only the latest events of each thread are kept. When tracing is
+ *  disabled, a trace point costs a single test.
+ *
+ *  The instance must be created from the main thread before any trace point
+ *  is recorded, which setup() does.
+ *  \sa     VLMC_TRACE_SCOPE
+ */
+class   Tracer : public QObject, public Singleton<Tracer>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY( Tracer )
+
+    public:
+        /// \brief  Number of events kept for each thread.
+        static const int        bufferSize = 4096;
+
+        static bool             isEnabled() { return s_enabled != 0; }
+        /**
+         *  \brief  Record a complete event in the calling thread's buffer.
+         *  \param  name    Must live as long as the application, as it's
+         *                  not copied. String literals are fine.
+         *  \param  arg     The frame number the event relates to, or -1.
+         */
+        static void             record( const char* name, qint64 begin, qint64 end,
+                                        qint64 arg );
+
+        /**
+         *  \brief  Start tracing if --trace=<file> was given, and save the
+         *          trace to that file when the application quits.
+         */
+        void                    setup( const QStringList& args );
+        void                    start();
+        void                    stop();
+        /**
+         *  \brief  Write the recorded events as a Chrome trace JSON file.
+         *
+         *  Tracing is stopped during the export, and the events being
+         *  recorded are waited for, so that the ring buffers don't get
+         *  overwritten while they are read.
+         */
+        bool                    save( const QString& fileName );
+
+    private:
+        Tracer();
+        ~Tracer();
+
+        struct  Event
+        {
+            const char*     name;
+            qint64          begin;
+            qint64          duration;
+            qint64          arg;
+            int             threadId;
+        };
+        class   ThreadBuffer;
+        /**
+         *  \brief  Owned by a thread's local storage. Gives the buffer back
+         *          when the thread exits, as the thread storage deletes it.
+         */
+        struct  BufferRef
+        {
+            BufferRef( ThreadBuffer* b ) : buffer( b ) {}
+            ~BufferRef();
+            ThreadBuffer*   buffer;
+        };
+
+        ThreadBuffer*           threadBuffer();
+
+    private:
+        static QAtomicInt       s_enabled;
+        /// \brief  Protects the buffer list and the thread names.
+        QMutex*                 m_mutex;
+        /// \brief  Buffers are reused once their thread exited, but never freed.
+        QList<ThreadBuffer*>    m_buffers;
+        QStringList             m_threadNames;
+        QThreadStorage<BufferRef*>  m_localBuffer;
+        qint64                  m_startTime;
+        QString                 m_outputFileName;
+
+    private slots:
+        void                    saveOnExit();
+
+        friend class    Singleton<Tracer>;
+};
+
+/**
+ *  \class  Records a complete event lasting from its construction to its
+ *          destruction.
+ */
+class   TraceScope
+{
+    public:
+        TraceScope( const char* name, qint64 arg = -1 ) :
+                m_name( name ),
+                m_arg( arg ),
+                m_begin( Tracer::isEnabled() == true ? mdate() : -1 )
+        {
+        }
+        ~TraceScope()
+        {
+            if ( m_begin >= 0 )
+                Tracer::record( m_name, m_begin, mdate(), m_arg );
+        }
+
+    private:
+        const char*     m_name;
+        qint64          m_arg;
+        qint64          m_begin;
+};
+
+/**
+ *  \brief  Trace the rest of the current scope. Only one per scope.
+ */
+#define VLMC_TRACE_SCOPE( name )            TraceScope  traceScope( name )
+/**
+ *  \brief  Same as VLMC_TRACE_SCOPE, with the frame number the event relates to.
+ */
+#define VLMC_TRACE_SCOPE_ARG( name, arg )   TraceScope  traceScope( name, arg )
+
+#endif // TRACER_H
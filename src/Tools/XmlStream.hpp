@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * XmlStream.hpp: Helpers for QXmlStreamReader based parsers
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef XMLSTREAM_HPP
+#define XMLSTREAM_HPP
+
+#include <QXmlStreamReader>
+
+/**
+ *  \brief  Helpers to walk a QXmlStreamReader element by element.
+ *
+ *  These only rely on the Qt 4.5 API, which doesn't provide
+ *  readNextStartElement() nor skipCurrentElement().
+ */
+namespace   XmlStream
+{
+    /**
+     *  \brief  Move to the next child element of the current element.
+     *
+     *  The reader must either be on the parent start element, or on the end
+     *  of a completely read child element.
+     *  \return false once the end of the parent element has been reached.
+     */
+    inline bool     readNextChild( QXmlStreamReader& reader )
+    {
+        while ( reader.atEnd() == false )
+        {
+            reader.readNext();
+            if ( reader.isStartElement() == true )
+                return true;
+            if ( reader.isEndElement() == true )
+                return false;
+        }
+        return false;
+    }
+
+    /**
+     *  \brief  Skip the current element, along with all its children.
+     *
+     *  The reader must be on a start element, and will be left on its end.
+     */
+    inline void     skipElement( QXmlStreamReader& reader )
+    {
+        int     depth = 1;
+
+        while ( depth > 0 && reader.atEnd() == false )
+        {
+            reader.readNext();
+            if ( reader.isStartElement() == true )
+                ++depth;
+            else if ( reader.isEndElement() == true )
+                --depth;
+        }
+    }
+}
+
+#endif // XMLSTREAM_HPP
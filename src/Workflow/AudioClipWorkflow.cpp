@@ -23,6 +23,8 @@
 #include <QtDebug>
 
 #include "AudioClipWorkflow.h"
+#include "PlaybackStats.h"
+#include "Tracer.h"
 #include "VLCMedia.h"
 
 AudioClipWorkflow::AudioClipWorkflow( Clip *clip ) :
@@ -64,6 +66,9 @@ AudioClipWorkflow::getOutput( ClipWorkflow::GetMode mode )
     QMutexLocker    lock( m_renderLock );
     QMutexLocker    lock2( m_computedBuffersMutex );
 
+    PlaybackStats::getInstance()->bufferFill( MainWorkflow::AudioTrack,
+                                              getNbComputedBuffers(),
+                                              getMaxComputedBuffers() );
     if ( preGetOutput() == false )
         return NULL;
     if ( isEndReached() == true )
@@ -107,6 +112,7 @@ AudioClipWorkflow::createBuffer( size_t size )
 void
 AudioClipWorkflow::lock( AudioClipWorkflow *cw, quint8 **pcm_buffer , quint32 size )
 {
+    VLMC_TRACE_SCOPE( "AudioClipWorkflow::lock" );
     QMutexLocker    lock( cw->m_availableBuffersMutex );
     cw->m_renderLock->lock();
     cw->m_computedBuffersMutex->lock();
@@ -137,6 +143,7 @@ AudioClipWorkflow::unlock( AudioClipWorkflow *cw, quint8 *pcm_buffer,
     Q_UNUSED( rate );
     Q_UNUSED( bits_per_sample );
     Q_UNUSED( size );
+    VLMC_TRACE_SCOPE( "AudioClipWorkflow::unlock" );
 
     cw->computePtsDiff( pts );
     AudioSample* as = cw->m_computedBuffers.last();
@@ -22,23 +22,24 @@
 
 #include "vlmc.h"
 #include "ClipWorkflow.h"
-#include "MemoryPool.hpp"
 #include "LightVideoFrame.h"
+#include "MediaPlayerPool.h"
+#include "PlaybackStats.h"
 #include "Clip.h"
 #include "VLCMediaPlayer.h"
 #include "WaitCondition.hpp"
 #include "VLCMedia.h"
 
-#include <QReadWriteLock>
+#include <QMutex>
 #include <QWaitCondition>
 #include <QtDebug>
 
 ClipWorkflow::ClipWorkflow( Clip::Clip* clip ) :
                 m_mediaPlayer(NULL),
                 m_clip( clip ),
-                m_state( ClipWorkflow::Stopped )
+                m_state( ClipWorkflow::Stopped ),
+                m_fullSpeedRender( false )
 {
-    m_stateLock = new QReadWriteLock;
     m_initWaitCond = new WaitCondition;
     m_pausingStateWaitCond = new WaitCondition;
     m_renderLock = new QMutex;
@@ -51,7 +52,6 @@ ClipWorkflow::~ClipWorkflow()
     delete m_renderLock;
     delete m_pausingStateWaitCond;
     delete m_initWaitCond;
-    delete m_stateLock;
     delete m_availableBuffersMutex;
     delete m_computedBuffersMutex;
 }
@@ -67,7 +67,7 @@ void    ClipWorkflow::initialize()
     m_previousPts = -1;
     m_pauseDuration = -1;
     initVlcOutput();
-    m_mediaPlayer = MemoryPool<LibVLCpp::MediaPlayer>::getInstance()->get();
+    m_mediaPlayer = MediaPlayerPool::getInstance()->get();
     m_mediaPlayer->setMedia( m_vlcMedia );
 
     connect( m_mediaPlayer, SIGNAL( playing() ), this, SLOT( loadingComplete() ), Qt::DirectConnection );
@@ -82,7 +82,8 @@ void    ClipWorkflow::loadingComplete()
     connect( m_mediaPlayer, SIGNAL( playing() ), this, SLOT( mediaPlayerUnpaused() ), Qt::DirectConnection );
     connect( m_mediaPlayer, SIGNAL( paused() ), this, SLOT( mediaPlayerPaused() ), Qt::DirectConnection );
     QMutexLocker    lock( m_initWaitCond->getMutex() );
-    setState( Rendering );
+    //The clip may have been stopped while initializing.
+    transition( Initializing, Rendering );
     m_initWaitCond->wake();
 }
 
@@ -98,19 +99,26 @@ void    ClipWorkflow::adjustBegin()
 
 bool    ClipWorkflow::isEndReached() const
 {
-    QReadLocker lock( m_stateLock );
-    return m_state == ClipWorkflow::EndReached;
+    return getState() == ClipWorkflow::EndReached;
 }
 
 bool    ClipWorkflow::isStopped() const
 {
-    QReadLocker lock( m_stateLock );
-    return m_state == ClipWorkflow::Stopped;
+    return getState() == ClipWorkflow::Stopped;
 }
 
 ClipWorkflow::State     ClipWorkflow::getState() const
 {
-    return m_state;
+    return static_cast<State>( static_cast<int>( m_state ) );
+}
+
+bool
+ClipWorkflow::isRunning( State state )
+{
+    return ( state == ClipWorkflow::Rendering ||
+             state == ClipWorkflow::Paused ||
+             state == ClipWorkflow::PauseRequired ||
+             state == ClipWorkflow::UnpauseRequired );
 }
 
 void    ClipWorkflow::clipEndReached()
@@ -129,7 +137,7 @@ void            ClipWorkflow::stop()
     {
         m_mediaPlayer->stop();
         disconnect( m_mediaPlayer, SIGNAL( endReached() ), this, SLOT( clipEndReached() ) );
-        MemoryPool<LibVLCpp::MediaPlayer>::getInstance()->release( m_mediaPlayer );
+        MediaPlayerPool::getInstance()->release( m_mediaPlayer );
         m_mediaPlayer = NULL;
         setState( Stopped );
         delete m_vlcMedia;
@@ -144,31 +152,64 @@ ClipWorkflow::setTime( qint64 time )
 {
     m_mediaPlayer->setTime( time );
     resyncClipWorkflow();
-    QWriteLocker    lock( m_stateLock );
-    if ( m_state == ClipWorkflow::Paused )
+    if ( transition( ClipWorkflow::Paused, ClipWorkflow::UnpauseRequired ) == true )
     {
 //        qDebug() << "Unpausing media player after set time";
-        m_mediaPlayer->pause();
-        m_state = ClipWorkflow::UnpauseRequired;
+        togglePause();
     }
 }
 
 bool            ClipWorkflow::isRendering() const
 {
-    QReadLocker lock( m_stateLock );
-    return m_state == ClipWorkflow::Rendering;
+    return getState() == ClipWorkflow::Rendering;
 }
 
 void            ClipWorkflow::setState( State state )
 {
-    QWriteLocker    lock( m_stateLock );
 //        qDebug() << '[' << (void*)this << "] Setting state to" << state;
-    m_state = state;
+    State   previous = static_cast<State>( m_state.fetchAndStoreOrdered( state ) );
+#ifndef QT_NO_DEBUG
+    if ( isValidTransition( previous, state ) == false )
+        qWarning() << "ClipWorkflow: unexpected state transition from"
+                << previous << "to" << state;
+#else
+    Q_UNUSED( previous );
+#endif
 }
 
-QReadWriteLock* ClipWorkflow::getStateLock()
+bool
+ClipWorkflow::transition( State from, State to )
+{
+    Q_ASSERT( isValidTransition( from, to ) == true );
+    return m_state.testAndSetOrdered( from, to );
+}
+
+bool
+ClipWorkflow::isValidTransition( State from, State to )
 {
-    return m_stateLock;
+    if ( from == to )
+        return true;
+    switch ( from )
+    {
+    case Stopped:
+        return ( to == Initializing || to == Rendering || to == Muted );
+    case Initializing:
+        return ( to == Rendering || to == Stopped || to == EndReached );
+    case Rendering:
+        return ( to == PauseRequired || to == EndReached || to == Stopped );
+    case PauseRequired:
+        return ( to == Paused || to == Stopped || to == EndReached );
+    case Paused:
+        return ( to == UnpauseRequired || to == Stopped || to == EndReached );
+    case UnpauseRequired:
+        return ( to == Rendering || to == PauseRequired ||
+                 to == Stopped || to == EndReached );
+    case EndReached:
+    case Muted:
+        return ( to == Stopped );
+    default:
+        return false;
+    }
 }
 
 void        ClipWorkflow::waitForCompleteInit()
@@ -198,13 +239,12 @@ void        ClipWorkflow::postGetOutput()
     //If we're running out of computed buffers, refill our stack.
     if ( getNbComputedBuffers() < getMaxComputedBuffers() / 3 )
     {
-        QWriteLocker        lock( m_stateLock );
-        if ( m_state == ClipWorkflow::Paused )
+        if ( transition( ClipWorkflow::Paused, ClipWorkflow::UnpauseRequired ) == true )
         {
 //            qWarning() << "Unpausing media player. type:" << debugType;
-            m_state = ClipWorkflow::UnpauseRequired;
 //            This will act like an "unpause";
-            m_mediaPlayer->pause();
+            togglePause();
+            PlaybackStats::getInstance()->clipWorkflowUnpaused();
         }
 //        else
 //            qCritical() << "Running out of computed buffers ! debugType:" << debugType;
@@ -218,11 +258,22 @@ void        ClipWorkflow::commonUnlock()
     if ( getNbComputedBuffers() >= getMaxComputedBuffers() )
     {
 //        qWarning() << "Pausing clip workflow. Type:" << debugType;
-        setState( ClipWorkflow::PauseRequired );
-        m_mediaPlayer->pause();
+        //Only pause a running source, and only once: a concurrent stop, end
+        //of media, or pending pause makes the CAS fail.
+        if ( transition( ClipWorkflow::Rendering, ClipWorkflow::PauseRequired ) == true ||
+             transition( ClipWorkflow::UnpauseRequired, ClipWorkflow::PauseRequired ) == true )
+        {
+            togglePause();
+            PlaybackStats::getInstance()->clipWorkflowPaused();
+        }
     }
 }
 
+void        ClipWorkflow::togglePause()
+{
+    m_mediaPlayer->pause();
+}
+
 void    ClipWorkflow::computePtsDiff( qint64 pts )
 {
     if ( m_previousPts == -1 )
@@ -252,7 +303,8 @@ void    ClipWorkflow::computePtsDiff( qint64 pts )
 void    ClipWorkflow::mediaPlayerPaused()
 {
 //    qWarning() << "\n\nMedia player paused, waiting for buffers to be consumed.Type:" << debugType;
-    setState( ClipWorkflow::Paused );
+    if ( transition( ClipWorkflow::PauseRequired, ClipWorkflow::Paused ) == false )
+        return ;
     m_beginPausePts = mdate();
 //    qDebug() << "got pause pts:" << m_beginPausePts;
 }
@@ -260,7 +312,8 @@ void    ClipWorkflow::mediaPlayerPaused()
 void    ClipWorkflow::mediaPlayerUnpaused()
 {
 //    qWarning() << "Media player unpaused. Go back to rendering. Type:" << debugType;
-    setState( ClipWorkflow::Rendering );
+    if ( transition( ClipWorkflow::UnpauseRequired, ClipWorkflow::Rendering ) == false )
+        return ;
     m_pauseDuration = mdate() - m_beginPausePts;
 //    qDebug() << "pause duration:" << m_pauseDuration;
 }
@@ -27,7 +27,6 @@
 
 #include <QObject>
 
-class   QReadWriteLock;
 class   QMutex;
 
 class   Clip;
@@ -40,6 +39,27 @@ namespace LibVLCpp
     class   Media;
 }
 
+/**
+ *  \brief Base class of the clip renderers.
+ *
+ *  The state is kept in an atomic integer, so that it can be checked from the
+ *  render loop without locking. Transitions that depend on the current state
+ *  are done with a compare and swap (see transition()). The allowed
+ *  transitions are:
+ *
+ *  \verbatim
+    Stopped         -> Initializing, Rendering, Muted
+    Initializing    -> Rendering, Stopped, EndReached
+    Rendering       -> PauseRequired, EndReached, Stopped
+    PauseRequired   -> Paused, Stopped, EndReached
+    Paused          -> UnpauseRequired, Stopped, EndReached
+    UnpauseRequired -> Rendering, PauseRequired, Stopped, EndReached
+    EndReached      -> Stopped
+    Muted           -> Stopped
+    \endverbatim
+ *
+ *  Setting a state to its current value is always allowed.
+ */
 class   ClipWorkflow : public QObject
 {
     Q_OBJECT
@@ -99,7 +119,7 @@ class   ClipWorkflow : public QObject
         bool                    preGetOutput();
         void                    postGetOutput();
         virtual void            initVlcOutput() = 0;
-        void                    initialize();
+        virtual void            initialize();
 
         /**
          *  Return true ONLY if the state is equal to EndReached.
@@ -121,12 +141,18 @@ class   ClipWorkflow : public QObject
 
         /**
          *  Returns the current workflow state.
-         *  Be carrefull, as this function is NOT thread safe, and return the
-         *  state without locking the state.
-         *  It's your job to do it, by calling the getStateLock() method.
+         *  As the state may change right after this call, callers checking
+         *  several states should work on a single returned value.
          */
         State                   getState() const;
 
+        /**
+         *  \return    true if the state is one of the states where the
+         *              workflow has a running source, ie Rendering, or any of
+         *              the pausing states.
+         */
+        static bool             isRunning( State state );
+
         /**
             \brief              Returns the Clip this workflow instance is based
                                 uppon, so that you can query information on it.
@@ -136,30 +162,14 @@ class   ClipWorkflow : public QObject
         /**
             \brief  Stop this workflow.
         */
-        void                    stop();
+        virtual void            stop();
         /**
          *  \brief  Set the rendering position
          *  \param  time    The position in millisecond
          */
-        void                    setTime( qint64 time );
-
-        /**
-         *  This method must be used to change the state of the ClipWorkflow
-         *  from outside its render loop, otherwise, it may lead to deadlocks.
-         *  No additional operations will be executed (for example, if setting
-         *  the new state to stop, the media player won't be stopped.)
-         *  This is mainly to change the behaviour of the render loop.
-         */
-        void                    queryStateChange( State newState );
+        virtual void            setTime( qint64 time );
 
-        /**
-         *  This returns the QReadWriteLock that protects the ClipWorkflow's state.
-         *  It should be use to lock the value when checking states from outside this
-         *  class.
-         */
-        QReadWriteLock*         getStateLock();
-
-        void                    waitForCompleteInit();
+        virtual void            waitForCompleteInit();
 
         virtual void*           getLockCallback() const = 0;
         virtual void*           getUnlockCallback() const = 0;
@@ -184,12 +194,32 @@ class   ClipWorkflow : public QObject
         bool                    isResyncRequired();
 
     private:
-        void                    setState( State state );
         void                    adjustBegin();
+        static bool             isValidTransition( State from, State to );
 
     protected:
+        /**
+         *  \brief  Unconditionnaly set the state.
+         *
+         *  In debug builds, a warning is issued when the transition isn't part
+         *  of the transition table.
+         */
+        void                    setState( State state );
+        /**
+         *  \brief  Atomically switch the state from \a from to \a to.
+         *  \return true if the state was \a from and has been changed.
+         */
+        bool                    transition( State from, State to );
         void                    computePtsDiff( qint64 pts );
         void                    commonUnlock();
+        /**
+         *  \brief  Pause or unpause the source feeding the buffers.
+         *
+         *  By default, this toggles the media player pause state. The state
+         *  has already been set to PauseRequired or UnpauseRequired when this
+         *  is called.
+         */
+        virtual void            togglePause();
         /**
          *  \warning    Must be called from a thread safe context.
          *              This thread safe context has to be set
@@ -219,8 +249,7 @@ class   ClipWorkflow : public QObject
         LibVLCpp::MediaPlayer*  m_mediaPlayer;
         Clip*                   m_clip;
         QMutex*                 m_renderLock;
-        QReadWriteLock*         m_stateLock;
-        State                   m_state;
+        QAtomicInt              m_state;
         qint64                  m_previousPts;
         qint64                  m_currentPts;
         /**
@@ -239,11 +268,13 @@ class   ClipWorkflow : public QObject
         bool                    m_fullSpeedRender;
         int                     debugType;
 
-    private slots:
-        void                    loadingComplete();
+    protected slots:
         void                    clipEndReached();
         void                    mediaPlayerPaused();
         void                    mediaPlayerUnpaused();
+
+    private slots:
+        void                    loadingComplete();
         void                    resyncClipWorkflow();
 };
 
@@ -0,0 +1,361 @@
+/*****************************************************************************
+ * GeneratorClipWorkflow.cpp: Clip workflow rendering synthetic frames and samples
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "vlmc.h"
+#include "GeneratorClipWorkflow.h"
+#include "Clip.h"
+#include "LightVideoFrame.h"
+#include "MainWorkflow.h"
+#include "Media.h"
+
+#include <QMutex>
+#include <QUrl>
+#include <QWaitCondition>
+#include <QtDebug>
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    //Same output format as the one AudioClipWorkflow asks to smem.
+    const quint32   sampleRate = 48000;
+    const quint32   nbChannels = 2;
+    const int       defaultTone = 1000;
+
+    //75% color bars
+    const quint8    bars[][Pixel::NbComposantes] =
+    {
+        { 191, 191, 191 },
+        { 191, 191, 0 },
+        { 0, 191, 191 },
+        { 0, 191, 0 },
+        { 191, 0, 191 },
+        { 191, 0, 0 },
+        { 0, 0, 191 }
+    };
+    const quint32   nbBars = sizeof( bars ) / sizeof( bars[0] );
+    //The frame number is drawn as a row of black and white blocks, MSB first.
+    const quint32   nbCounterBits = 32;
+}
+
+template <typename ClipWorkflowType>
+GeneratorClipWorkflow<ClipWorkflowType>::GeneratorClipWorkflow( Clip* clip ) :
+        ClipWorkflowType( clip ),
+        m_producer( NULL ),
+        m_position( 0 ),
+        m_clockOrigin( 0 ),
+        m_originFrame( 0 ),
+        m_pauseToggled( false ),
+        m_stopRequired( false ),
+        m_width( 0 ),
+        m_height( 0 ),
+        m_tone( defaultTone )
+{
+    m_positionLock = new QMutex;
+    m_wakeLock = new QMutex;
+    m_wakeCond = new QWaitCondition;
+
+    QUrl    url( clip->getParent()->mrl() );
+    if ( url.hasQueryItem( "tone" ) == true )
+        m_tone = url.queryItemValue( "tone" ).toInt();
+}
+
+template <typename ClipWorkflowType>
+GeneratorClipWorkflow<ClipWorkflowType>::~GeneratorClipWorkflow()
+{
+    if ( m_producer != NULL )
+        stop();
+    delete m_wakeCond;
+    delete m_wakeLock;
+    delete m_positionLock;
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::initialize()
+{
+    this->m_currentPts = -1;
+    this->m_previousPts = -1;
+    this->m_pauseDuration = -1;
+    m_width = MainWorkflow::getInstance()->getWidth();
+    m_height = MainWorkflow::getInstance()->getHeight();
+    initVlcOutput();
+    {
+        QMutexLocker    lock( m_positionLock );
+        m_position = this->m_clip->begin();
+        resetClock();
+    }
+    m_pauseToggled = false;
+    m_stopRequired = false;
+    this->setState( ClipWorkflow::Rendering );
+    m_producer = new Producer( this );
+    m_producer->start();
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::waitForCompleteInit()
+{
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::stop()
+{
+    if ( m_producer == NULL )
+    {
+        qDebug() << "ClipWorkflow has already been stopped";
+        return ;
+    }
+    {
+        QMutexLocker    lock( m_wakeLock );
+        m_stopRequired = true;
+        m_wakeCond->wakeAll();
+    }
+    m_producer->wait();
+    delete m_producer;
+    m_producer = NULL;
+    this->setState( ClipWorkflow::Stopped );
+    this->flushComputedBuffers();
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::setTime( qint64 time )
+{
+    {
+        //Waits for the frame being rendered, so that the flush gets rid of it.
+        QMutexLocker    lock( m_positionLock );
+        m_position = qRound64( time * this->m_clip->getParent()->fps() / 1000.0 );
+        resetClock();
+    }
+    this->flushComputedBuffers();
+    {
+        QMutexLocker    lock( this->m_renderLock );
+        this->m_previousPts = -1;
+        this->m_currentPts = -1;
+    }
+    if ( this->transition( ClipWorkflow::Paused, ClipWorkflow::UnpauseRequired ) == true )
+        togglePause();
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::togglePause()
+{
+    QMutexLocker    lock( m_wakeLock );
+    m_pauseToggled = true;
+    m_wakeCond->wakeAll();
+}
+
+template <typename ClipWorkflowType>
+bool
+GeneratorClipWorkflow<ClipWorkflowType>::waitForUnpause()
+{
+    QMutexLocker    lock( m_wakeLock );
+
+    while ( m_pauseToggled == false && m_stopRequired == false )
+        m_wakeCond->wait( m_wakeLock );
+    m_pauseToggled = false;
+    return m_stopRequired == false;
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::resetClock()
+{
+    m_clockOrigin = mdate();
+    m_originFrame = m_position;
+}
+
+template <typename ClipWorkflowType>
+void
+GeneratorClipWorkflow<ClipWorkflowType>::produce()
+{
+    const qint64    nbFrames = this->m_clip->getParent()->nbFrames();
+    const qint64    period = qRound64( 1000000.0 / this->m_clip->getParent()->fps() );
+
+    forever
+    {
+        {
+            QMutexLocker    lock( m_wakeLock );
+            if ( m_stopRequired == true )
+                return ;
+        }
+        ClipWorkflow::State     state = this->getState();
+        if ( state == ClipWorkflow::PauseRequired )
+        {
+            //The toggle came from our own commonUnlock() call.
+            {
+                QMutexLocker    lock( m_wakeLock );
+                m_pauseToggled = false;
+            }
+            this->mediaPlayerPaused();
+            continue ;
+        }
+        if ( state == ClipWorkflow::Paused )
+        {
+            if ( waitForUnpause() == false )
+                return ;
+            continue ;
+        }
+        if ( state == ClipWorkflow::UnpauseRequired )
+        {
+            this->mediaPlayerUnpaused();
+            QMutexLocker    lock( m_positionLock );
+            resetClock();
+            continue ;
+        }
+        if ( this->m_fullSpeedRender == false )
+        {
+            qint64      delay;
+            {
+                QMutexLocker    lock( m_positionLock );
+                delay = m_clockOrigin + ( m_position - m_originFrame ) * period - mdate();
+            }
+            //Sleep at most a frame at once, to check for stop and seek requests.
+            if ( delay >= 1000 )
+            {
+                SleepMS( qMin( delay, period ) / 1000 );
+                continue ;
+            }
+        }
+        QMutexLocker    lock( m_positionLock );
+        if ( m_position >= nbFrames )
+        {
+            lock.unlock();
+            this->clipEndReached();
+            return ;
+        }
+        render( m_position, m_clockOrigin + ( m_position - m_originFrame ) * period );
+        ++m_position;
+    }
+}
+
+template <>
+void
+VideoGeneratorClipWorkflow::initVlcOutput()
+{
+    preallocate();
+}
+
+template <>
+void
+VideoGeneratorClipWorkflow::render( qint64 frame, qint64 pts )
+{
+    typedef void    (*LockCallback)( VideoClipWorkflow*, void**, int );
+    typedef void    (*UnlockCallback)( VideoClipWorkflow*, void*, int, int, int, int, qint64 );
+
+    LockCallback    lockCallback = reinterpret_cast<LockCallback>( getLockCallback() );
+    UnlockCallback  unlockCallback = reinterpret_cast<UnlockCallback>( getUnlockCallback() );
+    const quint32   stride = m_width * Pixel::NbComposantes;
+    const quint32   barsHeight = m_height * 3 / 4;
+    const int       size = stride * m_height;
+    void*           buffer;
+
+    lockCallback( this, &buffer, size );
+    quint8*     pixels = static_cast<quint8*>( buffer );
+    //Draw a single row, and copy it to the other ones.
+    for ( quint32 x = 0; x < m_width; ++x )
+        memcpy( pixels + x * Pixel::NbComposantes, bars[x * nbBars / m_width],
+                Pixel::NbComposantes );
+    for ( quint32 y = 1; y < barsHeight; ++y )
+        memcpy( pixels + y * stride, pixels, stride );
+    quint8*     counter = pixels + barsHeight * stride;
+    for ( quint32 x = 0; x < m_width; ++x )
+    {
+        quint32     bit = nbCounterBits - 1 - x * nbCounterBits / m_width;
+        memset( counter + x * Pixel::NbComposantes, ( ( frame >> bit ) & 1 ) ? 255 : 0,
+                Pixel::NbComposantes );
+    }
+    for ( quint32 y = barsHeight + 1; y < m_height; ++y )
+        memcpy( pixels + y * stride, counter, stride );
+    unlockCallback( this, buffer, m_width, m_height, Pixel::NbComposantes * 8, size, pts );
+}
+
+template <>
+void
+AudioGeneratorClipWorkflow::initVlcOutput()
+{
+}
+
+template <>
+void
+AudioGeneratorClipWorkflow::render( qint64 frame, qint64 pts )
+{
+    typedef void    (*LockCallback)( AudioClipWorkflow*, quint8**, quint32 );
+    typedef void    (*UnlockCallback)( AudioClipWorkflow*, quint8*, quint32, quint32,
+                                       quint32, quint32, quint32, qint64 );
+
+    LockCallback    lockCallback = reinterpret_cast<LockCallback>( getLockCallback() );
+    UnlockCallback  unlockCallback = reinterpret_cast<UnlockCallback>( getUnlockCallback() );
+    const quint32   nbSamples = qRound( sampleRate / m_clip->getParent()->fps() );
+    const quint32   size = nbSamples * nbChannels * sizeof( float );
+    const qint64    firstSample = frame * nbSamples;
+    quint8*         buffer;
+
+    lockCallback( this, &buffer, size );
+    float*      samples = reinterpret_cast<float*>( buffer );
+    for ( quint32 i = 0; i < nbSamples; ++i )
+    {
+        float   value = 0.0f;
+        if ( m_tone > 0 )
+        {
+            //Only keep the phase, so that the precision doesn't drop along the clip.
+            double  phase = fmod( (double)( firstSample + i ) * m_tone, sampleRate ) / sampleRate;
+            value = 0.25f * sin( 2.0 * M_PI * phase );
+        }
+        for ( quint32 channel = 0; channel < nbChannels; ++channel )
+            samples[i * nbChannels + channel] = value;
+    }
+    unlockCallback( this, buffer, nbChannels, sampleRate, nbSamples, sizeof( float ) * 8,
+                    size, pts );
+}
+
+template class  GeneratorClipWorkflow<VideoClipWorkflow>;
+template class  GeneratorClipWorkflow<AudioClipWorkflow>;
+
+qint64
+decodeGeneratedFrameNumber( const LightVideoFrame& frame )
+{
+    const quint32   width = frame->width;
+    const quint32   height = frame->height;
+
+    if ( width < nbCounterBits || height < 4 )
+        return -1;
+    //The last row always belongs to the counter.
+    const quint8*   row = frame->frame.octets + ( height - 1 ) * width * Pixel::NbComposantes;
+    qint64          number = 0;
+    for ( quint32 bit = 0; bit < nbCounterBits; ++bit )
+    {
+        //Sample the middle of each block.
+        quint32     x = ( 2 * bit + 1 ) * width / ( 2 * nbCounterBits );
+        quint8      value = row[x * Pixel::NbComposantes];
+        number <<= 1;
+        if ( value > 200 )
+            number |= 1;
+        else if ( value > 55 )
+            return -1;
+    }
+    return number;
+}
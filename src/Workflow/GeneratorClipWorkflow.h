@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * GeneratorClipWorkflow.h: Clip workflow rendering synthetic frames and samples
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef GENERATORCLIPWORKFLOW_H
+#define GENERATORCLIPWORKFLOW_H
+
+#include "AudioClipWorkflow.h"
+#include "VideoClipWorkflow.h"
+
+#include <QThread>
+
+class   QMutex;
+class   QWaitCondition;
+
+class   LightVideoFrame;
+
+/**
+ *  \class  Renders a generator:// media without any decoder.
+ *
+ *  A producer thread plays smem's part: it feeds the Video or Audio
+ *  ClipWorkflow it derives from through its own lock and unlock callbacks,
+ *  pauses when the computed buffers are full, and paces itself in real time
+ *  unless a full speed render has been required.
+ *  Video frames are color bars with the frame number encoded on the bottom
+ *  rows, and audio buffers contain a sine tone.
+ *
+ *  \sa     Media::generatorPrefix
+ */
+template <typename ClipWorkflowType>
+class   GeneratorClipWorkflow : public ClipWorkflowType
+{
+    public:
+        GeneratorClipWorkflow( Clip* clip );
+        ~GeneratorClipWorkflow();
+
+        virtual void            initialize();
+        /// \brief  The producer is running as soon as initialize() returns.
+        virtual void            waitForCompleteInit();
+        virtual void            stop();
+        virtual void            setTime( qint64 time );
+
+    protected:
+        virtual void            initVlcOutput();
+        virtual void            togglePause();
+
+    private:
+        class   Producer : public QThread
+        {
+            public:
+                Producer( GeneratorClipWorkflow* cw ) : m_cw( cw ) {}
+            protected:
+                virtual void    run() { m_cw->produce(); }
+            private:
+                GeneratorClipWorkflow*  m_cw;
+        };
+        friend class    Producer;
+
+        void                    produce();
+        /**
+         *  \brief  Render a frame, or the audio samples lasting as long as
+         *          a frame, through the smem callbacks.
+         */
+        void                    render( qint64 frame, qint64 pts );
+        /**
+         *  \brief  Block until the pause is toggled back.
+         *  \return false if the producer has to stop.
+         */
+        bool                    waitForUnpause();
+        /// \warning    m_positionLock must be held.
+        void                    resetClock();
+
+    private:
+        Producer*               m_producer;
+        /// \brief  Protects the position and the clock.
+        QMutex*                 m_positionLock;
+        qint64                  m_position;
+        /// \brief  The time at which m_originFrame was due, as returned by mdate()
+        qint64                  m_clockOrigin;
+        qint64                  m_originFrame;
+        /**
+         *  \brief  Only protects m_pauseToggled and m_stopRequired.
+         *
+         *  It's never held while locking anything else, as togglePause() may
+         *  be called with the state, render and buffer locks held.
+         */
+        QMutex*                 m_wakeLock;
+        QWaitCondition*         m_wakeCond;
+        bool                    m_pauseToggled;
+        bool                    m_stopRequired;
+        quint32                 m_width;
+        quint32                 m_height;
+        /// \brief  The tone frequency, in Hz
+        int                     m_tone;
+};
+
+typedef GeneratorClipWorkflow<VideoClipWorkflow>    VideoGeneratorClipWorkflow;
+typedef GeneratorClipWorkflow<AudioClipWorkflow>    AudioGeneratorClipWorkflow;
+
+template <> void    VideoGeneratorClipWorkflow::initVlcOutput();
+template <> void    VideoGeneratorClipWorkflow::render( qint64 frame, qint64 pts );
+template <> void    AudioGeneratorClipWorkflow::initVlcOutput();
+template <> void    AudioGeneratorClipWorkflow::render( qint64 frame, qint64 pts );
+
+/**
+ *  \brief  Read back the frame number a VideoGeneratorClipWorkflow drew.
+ *  \return The frame number, or -1 if the frame doesn't look generated.
+ */
+qint64      decodeGeneratedFrameNumber( const LightVideoFrame& frame );
+
+#endif // GENERATORCLIPWORKFLOW_H
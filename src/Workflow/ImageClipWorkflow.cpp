@@ -24,13 +24,17 @@
 #include "Clip.h"
 #include "LightVideoFrame.h"
 #include "MainWorkflow.h"
+#include "StillImageCache.h"
+#include "Tracer.h"
 #include "VLCMediaPlayer.h"
 #include "VLCMedia.h"
 
 ImageClipWorkflow::ImageClipWorkflow( Clip *clip ) :
         ClipWorkflow( clip ),
         m_buffer( NULL ),
-        m_stackedBuffer( NULL )
+        m_cached( false ),
+        m_width( 0 ),
+        m_height( 0 )
 {
     //This is used to queue the media player stopping, as it can't be asked for
     //from vlc's input thread (well it can but it will deadlock)
@@ -38,6 +42,67 @@ ImageClipWorkflow::ImageClipWorkflow( Clip *clip ) :
              this, SLOT( stopComputation() ), Qt::QueuedConnection );
 }
 
+ImageClipWorkflow::~ImageClipWorkflow()
+{
+    releaseBuffer();
+}
+
+void
+ImageClipWorkflow::initialize()
+{
+    quint32     width = MainWorkflow::getInstance()->getWidth();
+    quint32     height = MainWorkflow::getInstance()->getHeight();
+
+    //The project resolution changed since the last decoding.
+    if ( m_buffer != NULL && ( width != m_width || height != m_height ) )
+        releaseBuffer();
+    m_width = width;
+    m_height = height;
+    if ( m_buffer == NULL )
+    {
+        m_buffer = StillImageCache::getInstance()->acquire( m_clip->getParent()->uuid(),
+                                                            m_width, m_height );
+        if ( m_buffer != NULL )
+            m_cached = true;
+    }
+    if ( m_cached == true )
+    {
+        setState( ClipWorkflow::Rendering );
+        return ;
+    }
+    ClipWorkflow::initialize();
+}
+
+void
+ImageClipWorkflow::stop()
+{
+    if ( m_mediaPlayer == NULL && m_cached == true )
+        setState( ClipWorkflow::Stopped );
+    else
+        ClipWorkflow::stop();
+}
+
+void
+ImageClipWorkflow::setTime( qint64 )
+{
+}
+
+void
+ImageClipWorkflow::releaseBuffer()
+{
+    QMutexLocker    lock( m_renderLock );
+
+    if ( m_buffer == NULL )
+        return ;
+    if ( m_cached == true )
+        StillImageCache::getInstance()->release( m_clip->getParent()->uuid(),
+                                                 m_width, m_height );
+    else
+        delete m_buffer;
+    m_buffer = NULL;
+    m_cached = false;
+}
+
 void
 ImageClipWorkflow::initVlcOutput()
 {
@@ -83,19 +148,20 @@ ImageClipWorkflow::getOutput( ClipWorkflow::GetMode )
 {
     QMutexLocker    lock( m_renderLock );
 
-    return m_stackedBuffer;
+    if ( m_buffer == NULL )
+        return NULL;
+    return new StackedBuffer( m_buffer );
 }
 
 void
 ImageClipWorkflow::lock(ImageClipWorkflow *cw, void **pp_ret, int size )
 {
+    VLMC_TRACE_SCOPE( "ImageClipWorkflow::lock" );
     cw->m_renderLock->lock();
     if ( cw->m_buffer == NULL )
     {
         //        cw->m_buffer = new LightVideoFrame( size );
-        cw->m_buffer = new LightVideoFrame( MainWorkflow::getInstance()->getWidth(),
-                                            MainWorkflow::getInstance()->getHeight() );
-        cw->m_stackedBuffer = new StackedBuffer( cw->m_buffer );
+        cw->m_buffer = new LightVideoFrame( cw->m_width, cw->m_height );
     }
     *pp_ret = (*(cw->m_buffer))->frame.octets;
 }
@@ -103,6 +169,7 @@ ImageClipWorkflow::lock(ImageClipWorkflow *cw, void **pp_ret, int size )
 void
 ImageClipWorkflow::unlock(ImageClipWorkflow *cw, void *buffer, int width, int height, int bpp, int size, qint64 pts)
 {
+    VLMC_TRACE_SCOPE( "ImageClipWorkflow::unlock" );
     cw->m_renderLock->unlock();
     cw->emit computedFinished();
 }
@@ -126,7 +193,15 @@ ImageClipWorkflow::getMaxComputedBuffers() const
 void
 ImageClipWorkflow::stopComputation()
 {
+    if ( m_mediaPlayer == NULL )
+        return ;
     m_mediaPlayer->stop();
+    //Once the media player is stopped, nothing will be written in the buffer
+    //anymore, so it can be shared with other clips using this image.
+    QMutexLocker    lock( m_renderLock );
+    if ( m_cached == false && m_buffer != NULL )
+        m_cached = StillImageCache::getInstance()->insert( m_clip->getParent()->uuid(),
+                                                           m_width, m_height, m_buffer );
 }
 
 void
@@ -142,5 +217,6 @@ ImageClipWorkflow::StackedBuffer::StackedBuffer( LightVideoFrame *lvf ) :
 void
 ImageClipWorkflow::StackedBuffer::release()
 {
-    return ;
+    //The frame itself belongs to the ImageClipWorkflow or to the StillImageCache.
+    delete this;
 }
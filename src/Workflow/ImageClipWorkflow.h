@@ -38,10 +38,24 @@ class   ImageClipWorkflow : public ClipWorkflow
                 virtual void    release();
         };
         ImageClipWorkflow( Clip* clip );
+        ~ImageClipWorkflow();
 
         void                    *getLockCallback() const;
         void                    *getUnlockCallback() const;
         virtual void            *getOutput( ClipWorkflow::GetMode mode );
+        /**
+         *  \brief  Initialize the workflow.
+         *
+         *  If the still has already been decoded at the project resolution,
+         *  the decoded frame is taken from the StillImageCache, and no media
+         *  player is launched.
+         */
+        virtual void            initialize();
+        virtual void            stop();
+        /**
+         *  \brief  A still never needs to be repositioned.
+         */
+        virtual void            setTime( qint64 time );
     protected:
         virtual void            initVlcOutput();
         virtual quint32         getNbComputedBuffers() const;
@@ -53,9 +67,16 @@ class   ImageClipWorkflow : public ClipWorkflow
         static void             unlock( ImageClipWorkflow* clipWorkflow, void* buffer,
                                         int width, int height, int bpp, int size,
                                         qint64 pts );
+        /**
+         *  \brief  Release the current buffer, either to the cache or by deleting it.
+         */
+        void                    releaseBuffer();
     private:
         LightVideoFrame         *m_buffer;
-        StackedBuffer           *m_stackedBuffer;
+        /// true if m_buffer is owned by the StillImageCache
+        bool                    m_cached;
+        quint32                 m_width;
+        quint32                 m_height;
 
     private slots:
         void                    stopComputation();
@@ -29,28 +29,33 @@
 #include "Library.h"
 #include "LightVideoFrame.h"
 #include "MainWorkflow.h"
+#include "Media.h"
+#include "MediaPlayerPool.h"
+#include "PlaybackStats.h"
+#include "ProjectCache.h"
 #include "TrackWorkflow.h"
 #include "TrackHandler.h"
 #include "SettingsManager.h"
+#include "Tracer.h"
+#include "XmlStream.hpp"
+#include "mdate.h"
 
-#include <QDomElement>
+#include <QMutex>
+#include <QTimer>
 
 LightVideoFrame     *MainWorkflow::blackOutput = NULL;
 
 MainWorkflow::MainWorkflow( int trackCount ) :
         m_lengthFrame( 0 ),
-        m_renderStarted( false ),
+        m_renderStarted( 0 ),
         m_width( 0 ),
-        m_height( 0 )
+        m_height( 0 ),
+        m_frameNotificationPending( 0 )
 {
-    m_currentFrameLock = new QReadWriteLock;
-    m_renderStartedMutex = new QMutex;
-
     m_effectEngine = new EffectsEngine;
     m_effectEngine->disable();
 
     m_tracks = new TrackHandler*[MainWorkflow::NbTrackType];
-    m_currentFrame = new qint64[MainWorkflow::NbTrackType];
     for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
     {
         MainWorkflow::TrackType trackType =
@@ -58,9 +63,14 @@ MainWorkflow::MainWorkflow( int trackCount ) :
         m_tracks[i] = new TrackHandler( trackCount, trackType, m_effectEngine );
         connect( m_tracks[i], SIGNAL( tracksEndReached() ),
                  this, SLOT( tracksEndReached() ) );
-        m_currentFrame[i] = 0;
+        m_renderMutex[i] = new QMutex;
+        m_clipFetchTime[i] = 0;
+        m_effectsTime[i] = 0;
     }
     m_outputBuffers = new OutputBuffers;
+    m_lastFrameNotification.start();
+    //The clip workflows report to it from their own threads, so create it now.
+    PlaybackStats::getInstance();
 }
 
 MainWorkflow::~MainWorkflow()
@@ -69,11 +79,11 @@ MainWorkflow::~MainWorkflow()
     stop();
 
     delete m_effectEngine;
-    delete m_renderStartedMutex;
-    delete m_currentFrameLock;
-    delete m_currentFrame;
     for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
         delete m_tracks[i];
+        delete m_renderMutex[i];
+    }
     delete[] m_tracks;
 }
 
@@ -114,7 +124,6 @@ MainWorkflow::computeLength()
 void
 MainWorkflow::startRender( quint32 width, quint32 height )
 {
-    m_renderStarted = true;
     m_width = width;
     m_height = height;
     if ( blackOutput != NULL )
@@ -122,22 +131,41 @@ MainWorkflow::startRender( quint32 width, quint32 height )
     blackOutput = new LightVideoFrame( m_width, m_height );
     // FIX ME vvvvvv , It doesn't update meta info (nbpixels, nboctets, etc.
     memset( (*blackOutput)->frame.octets, 0, (*blackOutput)->nboctets );
+    unsigned int    nbActiveTracks = 0;
     for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+    {
         m_tracks[i]->startRender();
+        nbActiveTracks += m_tracks[i]->getActiveTrackCount();
+    }
+    //Each active track may need a player for its current clip, and one for the
+    //preloaded one.
+    MediaPlayerPool::getInstance()->reserve( nbActiveTracks * 2 );
     computeLength();
+    m_renderStarted.fetchAndStoreRelease( 1 );
 }
 
 MainWorkflow::OutputBuffers*
 MainWorkflow::getOutput( TrackType trackType, bool paused )
 {
-    QMutexLocker        lock( m_renderStartedMutex );
+    if ( m_renderStarted == 0 )
+        return m_outputBuffers;
+    QMutexLocker        lock( m_renderMutex[trackType] );
 
-    if ( m_renderStarted == true )
+    //stop() may have been called while we were waiting for the lock.
+    if ( m_renderStarted != 0 )
     {
-        QReadLocker         lock2( m_currentFrameLock );
-
-        m_tracks[trackType]->getOutput( m_currentFrame[VideoTrack],
-                                        m_currentFrame[trackType], paused );
+        if ( m_reactivateTracks[trackType].fetchAndStoreAcquire( 0 ) != 0 )
+            m_tracks[trackType]->activateAll();
+        //Both positions may move while we render, so work on a snapshot.
+        qint64              currentFrame = m_currentFrame[VideoTrack].get();
+        qint64              subFrame = ( trackType == VideoTrack ? currentFrame :
+                                         m_currentFrame[trackType].get() );
+        VLMC_TRACE_SCOPE_ARG( "MainWorkflow::getOutput", subFrame );
+        mtime_t             begin = mdate();
+
+        m_tracks[trackType]->getOutput( currentFrame, subFrame, paused );
+        mtime_t             fetched = mdate();
+        m_clipFetchTime[trackType] = fetched - begin;
         if ( trackType == MainWorkflow::VideoTrack )
         {
             m_effectEngine->render();
@@ -146,6 +174,7 @@ MainWorkflow::getOutput( TrackType trackType, bool paused )
                 m_outputBuffers->video = blackOutput;
             else
                 m_outputBuffers->video = &tmp;
+            m_effectsTime[trackType] = mdate() - fetched;
         }
         else
         {
@@ -157,23 +186,57 @@ MainWorkflow::getOutput( TrackType trackType, bool paused )
 }
 
 void
-MainWorkflow::nextFrame( MainWorkflow::TrackType trackType )
+MainWorkflow::getOutputTimings( TrackType trackType, qint64& clipFetch,
+                                qint64& effects ) const
 {
-    QWriteLocker    lock( m_currentFrameLock );
+    clipFetch = m_clipFetchTime[trackType];
+    effects = m_effectsTime[trackType];
+}
 
-    ++m_currentFrame[trackType];
+void
+MainWorkflow::nextFrame( MainWorkflow::TrackType trackType )
+{
+    m_currentFrame[trackType].add( 1 );
     if ( trackType == MainWorkflow::VideoTrack )
-        emit frameChanged( m_currentFrame[MainWorkflow::VideoTrack], Renderer );
+        notifyFrameChanged();
 }
 
 void
 MainWorkflow::previousFrame( MainWorkflow::TrackType trackType )
 {
-    QWriteLocker    lock( m_currentFrameLock );
-
-    --m_currentFrame[trackType];
+    m_currentFrame[trackType].add( -1 );
     if ( trackType == MainWorkflow::VideoTrack )
-        emit frameChanged( m_currentFrame[MainWorkflow::VideoTrack], Renderer );
+        notifyFrameChanged();
+}
+
+void
+MainWorkflow::notifyFrameChanged()
+{
+    if ( m_frameNotificationPending.testAndSetOrdered( 0, 1 ) == true )
+        QMetaObject::invokeMethod( this, "publishFrame", Qt::QueuedConnection );
+}
+
+void
+MainWorkflow::publishFrame()
+{
+    int     elapsed = m_lastFrameNotification.elapsed();
+
+    if ( elapsed >= 0 && elapsed < FrameNotificationInterval )
+    {
+        QTimer::singleShot( FrameNotificationInterval - elapsed, this, SLOT( publishFrame() ) );
+        return ;
+    }
+    flushFrameNotification();
+}
+
+void
+MainWorkflow::flushFrameNotification()
+{
+    //Clear the flag first, so that a frame rendered meanwhile is notified again.
+    if ( m_frameNotificationPending.fetchAndStoreOrdered( 0 ) == 0 )
+        return ;
+    m_lastFrameNotification.start();
+    emit frameChanged( getCurrentFrame(), Renderer );
 }
 
 qint64
@@ -192,15 +255,17 @@ MainWorkflow::getClipPosition( const QUuid& uuid, unsigned int trackId,
 void
 MainWorkflow::stop()
 {
-    QMutexLocker    lock( m_renderStartedMutex );
-    QWriteLocker    lock2( m_currentFrameLock );
+    QMutexLocker    lock( m_renderMutex[VideoTrack] );
+    QMutexLocker    lock2( m_renderMutex[AudioTrack] );
 
-    m_renderStarted = false;
+    m_renderStarted = 0;
     for (unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i)
     {
         m_tracks[i]->stop();
-        m_currentFrame[i] = 0;
+        m_currentFrame[i].set( 0 );
+        m_reactivateTracks[i] = 0;
     }
+    MediaPlayerPool::getInstance()->endSession();
     emit frameChanged( 0, Renderer );
 }
 
@@ -265,18 +330,17 @@ void toggleBreakPoint()
 void
 MainWorkflow::setCurrentFrame( qint64 currentFrame, MainWorkflow::FrameChangedReason reason )
 {
-    QWriteLocker    lock( m_currentFrameLock );
-
     toggleBreakPoint();
-    if ( m_renderStarted == true )
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i)
+        m_currentFrame[i].set( currentFrame );
+    if ( m_renderStarted != 0 )
     {
         //Since any track can be reactivated, we reactivate all of them, and let them
-        //disable themself if required.
+        //disable themself if required. This is done by the render threads, before
+        //their next render.
         for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i)
-            m_tracks[i]->activateAll();
+            m_reactivateTracks[i].fetchAndStoreRelease( 1 );
     }
-    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i)
-        m_currentFrame[i] = currentFrame;
     emit frameChanged( currentFrame, reason );
 }
 
@@ -287,90 +351,85 @@ MainWorkflow::getClip( const QUuid &uuid, unsigned int trackId,
     return m_tracks[trackType]->getClip( uuid, trackId );
 }
 
+Clip*
+MainWorkflow::getClipAt( unsigned int trackId, qint64 start,
+                         MainWorkflow::TrackType trackType )
+{
+    return m_tracks[trackType]->getClipAt( trackId, start );
+}
+
 /**
  *  \warning    The mainworkflow is expected to be already cleared by the ProjectManager
  */
 void
-MainWorkflow::loadProject( const QDomElement &project )
+MainWorkflow::loadProject( QXmlStreamReader& reader )
 {
-    if ( project.isNull() == true || project.tagName() != "timeline" )
-    {
-        qWarning() << "Invalid timeline node (" << project.tagName() << ')';
-        return ;
-    }
-
-    QDomElement elem = project.firstChild().toElement();
-
-    while ( elem.isNull() == false )
+    while ( XmlStream::readNextChild( reader ) == true )
     {
         bool    ok;
 
-        Q_ASSERT( elem.tagName() == "track" );
-        unsigned int trackId = elem.attribute( "id" ).toUInt( &ok );
+        Q_ASSERT( reader.name() == "track" );
+        unsigned int trackId = reader.attributes().value( "id" ).toString().toUInt( &ok );
         if ( ok == false )
         {
-            qWarning() << "Invalid track number in project file";
+            reader.raiseError( "Invalid track number in project file" );
             return ;
         }
-        QDomElement clip = elem.firstChild().toElement();
-        while ( clip.isNull() == false )
+        while ( XmlStream::readNextChild( reader ) == true )
         {
             //Iterate over clip fields:
-            QDomElement clipProperty = clip.firstChild().toElement();
             QUuid                       parent;
             qint64                      begin;
             qint64                      end;
             qint64                      startPos;
             MainWorkflow::TrackType     trackType = MainWorkflow::VideoTrack;
 
-            while ( clipProperty.isNull() == false )
+            while ( XmlStream::readNextChild( reader ) == true )
             {
-                QString tagName = clipProperty.tagName();
+                QString tagName = reader.name().toString();
+                QString text = reader.readElementText();
                 bool    ok;
 
                 if ( tagName == "parent" )
-                    parent = QUuid( clipProperty.text() );
+                    parent = QUuid( text );
                 else if ( tagName == "begin" )
                 {
-                    begin = clipProperty.text().toLongLong( &ok );
+                    begin = text.toLongLong( &ok );
                     if ( ok == false )
                     {
-                        qWarning() << "Invalid clip begin";
+                        reader.raiseError( "Invalid clip begin" );
                         return ;
                     }
                 }
                 else if ( tagName == "end" )
                 {
-                    end = clipProperty.text().toLongLong( &ok );
+                    end = text.toLongLong( &ok );
                     if ( ok == false )
                     {
-                        qWarning() << "Invalid clip end";
+                        reader.raiseError( "Invalid clip end" );
                         return ;
                     }
                 }
                 else if ( tagName == "startFrame" )
                 {
-                    startPos = clipProperty.text().toLongLong( &ok );
+                    startPos = text.toLongLong( &ok );
                     if ( ok == false )
                     {
-                        qWarning() << "Invalid clip starting frame";
+                        reader.raiseError( "Invalid clip starting frame" );
                         return ;
                     }
                 }
                 else if ( tagName == "trackType" )
                 {
-                    trackType = static_cast<MainWorkflow::TrackType>(
-                                                    clipProperty.text().toUInt( &ok ) );
+                    trackType = static_cast<MainWorkflow::TrackType>( text.toUInt( &ok ) );
                     if ( ok == false )
                     {
-                        qWarning() << "Invalid track type starting frame";
+                        reader.raiseError( "Invalid track type starting frame" );
                         return ;
                     }
                 }
                 else
-                    qDebug() << "Unknown field" << clipProperty.tagName();
-
-                clipProperty = clipProperty.nextSibling().toElement();
+                    qDebug() << "Unknown field" << tagName;
             }
 
             if ( Library::getInstance()->media( parent ) != NULL )
@@ -378,22 +437,45 @@ MainWorkflow::loadProject( const QDomElement &project )
                 Clip        *c = new Clip( parent, begin, end );
                 addClip( c, trackId, startPos, trackType );
             }
+        }
+    }
+}
+
+void
+MainWorkflow::loadProject( const ProjectCache& cache )
+{
+    for ( quint32 i = 0; i < cache.nbTimelineClips(); ++i )
+    {
+        const ProjectCache::TimelineClipRecord&     record = cache.timelineClip( i );
 
-            clip = clip.nextSibling().toElement();
+        if ( record.media >= cache.nbMedias() || record.trackType >= NbTrackType )
+            continue ;
+        QUuid       parent = ProjectCache::toUuid( cache.media( record.media ).uuid );
+        if ( Library::getInstance()->media( parent ) != NULL )
+        {
+            Clip        *c = new Clip( parent, record.begin, record.end );
+            addClip( c, record.trackId, record.startFrame,
+                     static_cast<MainWorkflow::TrackType>( record.trackType ) );
         }
-        elem = elem.nextSibling().toElement();
     }
 }
 
 void
-MainWorkflow::saveProject( QDomDocument& doc, QDomElement& rootNode )
+MainWorkflow::saveProject( ProjectCacheWriter& writer )
+{
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_tracks[i]->save( writer );
+}
+
+void
+MainWorkflow::saveProject( QXmlStreamWriter& writer )
 {
-    QDomElement project = doc.createElement( "timeline" );
+    writer.writeStartElement( "timeline" );
     for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
     {
-        m_tracks[i]->save( doc, project );
+        m_tracks[i]->save( writer );
     }
-    rootNode.appendChild( project );
+    writer.writeEndElement();
 }
 
 void
@@ -412,6 +494,8 @@ MainWorkflow::tracksEndReached()
         if ( m_tracks[i]->endIsReached() == false )
             return ;
     }
+    //Let the last rendered frame be known before the end.
+    flushFrameNotification();
     emit mainWorkflowEndReached();
 }
 
@@ -424,9 +508,44 @@ MainWorkflow::getTrackCount( MainWorkflow::TrackType trackType ) const
 qint64
 MainWorkflow::getCurrentFrame() const
 {
-    QReadLocker     lock( m_currentFrameLock );
+    return m_currentFrame[MainWorkflow::VideoTrack].get();
+}
+
+QList<qint64>
+MainWorkflow::getCutPoints() const
+{
+    QList<qint64>   cutPoints;
+
+    for ( unsigned int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_tracks[i]->getCutPoints( cutPoints );
+    qSort( cutPoints );
+    for ( int i = cutPoints.size() - 1; i > 0; --i )
+    {
+        if ( cutPoints[i] == cutPoints[i - 1] )
+            cutPoints.removeAt( i );
+    }
+    return cutPoints;
+}
 
-    return m_currentFrame[MainWorkflow::VideoTrack];
+Clip*
+MainWorkflow::getPassthroughClip( qint64 begin, qint64 end, qint64& clipStart ) const
+{
+    Clip*       video;
+    Clip*       audio;
+    qint64      audioStart;
+
+    if ( m_tracks[VideoTrack]->getSingleClip( begin, end, video, clipStart ) == false ||
+         m_tracks[AudioTrack]->getSingleClip( begin, end, audio, audioStart ) == false ||
+         video == NULL || audio == NULL )
+        return NULL;
+    if ( clipStart > begin || clipStart + video->length() < end )
+        return NULL;
+    if ( audio->getParent() != video->getParent() || audioStart != clipStart ||
+         audio->begin() != video->begin() || audioStart + audio->length() < end )
+        return NULL;
+    if ( video->getParent()->fileType() != Media::Video )
+        return NULL;
+    return video;
 }
 
 quint32
@@ -462,7 +581,8 @@ MainWorkflow::setFullSpeedRender( bool val )
 Clip*
 MainWorkflow::split( Clip* toSplit, Clip* newClip, quint32 trackId, qint64 newClipPos, qint64 newClipBegin, MainWorkflow::TrackType trackType )
 {
-    QMutexLocker    lock( m_renderStartedMutex );
+    QMutexLocker    lock( m_renderMutex[VideoTrack] );
+    QMutexLocker    lock2( m_renderMutex[AudioTrack] );
 
     if ( newClip == NULL )
         newClip = new Clip( toSplit, newClipBegin, toSplit->end() );
@@ -477,7 +597,8 @@ MainWorkflow::resizeClip( Clip* clip, qint64 newBegin, qint64 newEnd, qint64 new
                           quint32 trackId, MainWorkflow::TrackType trackType,
                                       bool undoRedoAction /*= false*/ )
 {
-    QMutexLocker    lock( m_renderStartedMutex );
+    QMutexLocker    lock( m_renderMutex[VideoTrack] );
+    QMutexLocker    lock2( m_renderMutex[AudioTrack] );
 
     if ( newBegin != clip->begin() )
     {
@@ -490,7 +611,8 @@ void
 MainWorkflow::unsplit( Clip* origin, Clip* splitted, quint32 trackId,
                        MainWorkflow::TrackType trackType )
 {
-    QMutexLocker    lock( m_renderStartedMutex );
+    QMutexLocker    lock( m_renderMutex[VideoTrack] );
+    QMutexLocker    lock2( m_renderMutex[AudioTrack] );
 
     removeClip( splitted->uuid(), trackId, trackType );
     origin->setEnd( splitted->end(), true );
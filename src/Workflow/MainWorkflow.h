@@ -25,12 +25,15 @@
 #define MAINWORKFLOW_H
 
 #include "Singleton.hpp"
+#include "SeqLock.hpp"
 #include "AudioClipWorkflow.h"
 
-class   QDomDocument;
-class   QDomElement;
 class   QMutex;
-class   QReadWriteLock;
+class   QXmlStreamReader;
+class   QXmlStreamWriter;
+
+class   ProjectCache;
+class   ProjectCacheWriter;
 
 class   Clip;
 class   EffectsEngine;
@@ -38,7 +41,9 @@ class   LightVideoFrame;
 class   TrackHandler;
 class   TrackWorkflow;
 
+#include <QList>
 #include <QObject>
+#include <QTime>
 #include <QUuid>
 
 /**
@@ -122,6 +127,16 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
          *  \param  paused      The paused state of the renderer
          */
         OutputBuffers*          getOutput( TrackType trackType, bool paused );
+        /**
+         *  \brief  Get the time spent by the last getOutput() call for trackType.
+         *
+         *  \param  clipFetch   Will be set to the time spent fetching the clips
+         *                      output, in microseconds.
+         *  \param  effects     Will be set to the time spent in the effects engine,
+         *                      in microseconds. This is always 0 for AudioTrack.
+         */
+        void                    getOutputTimings( TrackType trackType, qint64& clipFetch,
+                                                  qint64& effects ) const;
         /**
          *  \brief  Returns the effect engine instance used by the workflow
          *
@@ -144,6 +159,21 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
          *                      in frames.
         */
         qint64                  getLengthFrame() const;
+        /**
+         *  \brief              Get the frames where a clip starts or ends, on any track.
+         *  \return             The sorted list of cut points, without duplicates.
+         */
+        QList<qint64>           getCutPoints() const;
+        /**
+         *  \brief              Check if [begin;end[ only renders a single clip, untouched.
+         *
+         *  This is the case when one video clip covers the whole range, alone, along
+         *  with the audio of the same media, at the same position.
+         *  \param  clipStart   Will be set to the position of the video clip.
+         *  \return             The video clip, or NULL if the range renders anything else.
+         */
+        Clip*                   getPassthroughClip( qint64 begin, qint64 end,
+                                                    qint64& clipStart ) const;
 
         /**
          *  \brief              Get the currently rendered frame.
@@ -163,6 +193,9 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
         /**
          *  \brief              Unconditionnaly switch to the next frame.
          *
+         *  This is called from the render threads, so the resulting frameChanged()
+         *  signals are coalesced, and delivered from the MainWorkflow thread at
+         *  most every FrameNotificationInterval milliseconds.
          *  \param  trackType   The type of the frame counter to increment.
          *                      Though it seems odd to speak about frame for AudioTrack,
          *                      it's mainly a render position used for
@@ -286,6 +319,15 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
          */
         Clip*                   getClip( const QUuid& uuid, unsigned int trackId,
                                          MainWorkflow::TrackType trackType );
+        /**
+         *  \brief              Get the clip starting at a given frame.
+         *  \param  trackId : the track id
+         *  \param  start : the clip's starting frame
+         *  \param  trackType : the track type (audio or video)
+         *  \returns    The clip starting at start, or NULL.
+         */
+        Clip*                   getClipAt( unsigned int trackId, qint64 start,
+                                           MainWorkflow::TrackType trackType );
 
         /**
          *  \brief              Get the number of track for a specific type
@@ -359,26 +401,52 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
          *  This method will update the attribute m_lengthFrame
          */
         void                    computeLength();
+        /**
+         *  \brief  Request a frameChanged() notification from any thread.
+         *
+         *  Only one notification may be pending at once. It will report the
+         *  position at the time it is delivered.
+         */
+        void                    notifyFrameChanged();
+        /**
+         *  \brief  Emit the pending frameChanged() notification, if any.
+         *
+         *  This must be called from the MainWorkflow thread.
+         */
+        void                    flushFrameNotification();
 
     private:
-        /// Lock for the m_currentFrame atribute.
-        QReadWriteLock*                 m_currentFrameLock;
+        /// Minimum delay between two frameChanged() signals emitted by the render.
+        static const int                FrameNotificationInterval = 33;
+
         /**
          *  \brief  An array of currently rendered frame.
          *
          *  This must be indexed with MainWorkflow::TrackType.
+         *  Each position is published on its own, so that the video and audio
+         *  render threads never wait for each other, nor for the GUI.
          *  The Audio array entry is designed to synchronize the renders internally, as it
          *  is not actually a frame.
          *  If you wish to know which frame is really rendered, you must use
          *  m_currentFrame[MainWorkflow::VideoTrack], which is the value that will be used
          *  when setCurrentFrame() is called.
          */
-        qint64*                         m_currentFrame;
+        SeqLocked<qint64>               m_currentFrame[NbTrackType];
         /// The workflow length, in frame.
         qint64                          m_lengthFrame;
-        /// This boolean describe is a render has been started
-        bool                            m_renderStarted;
-        QMutex*                         m_renderStartedMutex;
+        /// Non zero when a render has been started
+        QAtomicInt                      m_renderStarted;
+        /**
+         *  \brief  Serializes getOutput() for a track type against stop and
+         *          edition operations. Indexed by MainWorkflow::TrackType
+         */
+        QMutex*                         m_renderMutex[NbTrackType];
+        /**
+         *  \brief  Set by setCurrentFrame() when the tracks have to be
+         *          reactivated. This is done by the next getOutput() call for
+         *          each track type, so that a seek never waits for a render.
+         */
+        QAtomicInt                      m_reactivateTracks[NbTrackType];
 
         /// Contains the trackhandler, indexed by MainWorkflow::TrackType
         TrackHandler**                  m_tracks;
@@ -387,10 +455,17 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
 
         /// Effect engine instance.
         EffectsEngine*                  m_effectEngine;
+        /// Duration of the last getOutput() stages, indexed by MainWorkflow::TrackType
+        qint64                          m_clipFetchTime[NbTrackType];
+        qint64                          m_effectsTime[NbTrackType];
         /// Width used for the render
         quint32                         m_width;
         /// Height used for the render
         quint32                         m_height;
+        /// Non zero when a frameChanged() notification is pending.
+        QAtomicInt                      m_frameNotificationPending;
+        /// Time of the last coalesced frameChanged() notification.
+        QTime                           m_lastFrameNotification;
 
         friend class                    Singleton<MainWorkflow>;
 
@@ -403,21 +478,35 @@ class   MainWorkflow : public QObject, public Singleton<MainWorkflow>
          *  \sa     mainWorkflowEndReached()
          */
         void                            tracksEndReached();
+        /**
+         *  \brief  Deliver the pending frameChanged() notification, unless one
+         *          has been delivered less than FrameNotificationInterval ago.
+         *          In this case, the delivery is delayed.
+         */
+        void                            publishFrame();
 
     public slots:
         /**
-         *  \brief  load a project based on a QDomElement
+         *  \brief  load a project timeline
          *
-         *  \param  project             The project node to load.
+         *  \param  reader      A reader positionned on the timeline element start.
+         *                      It will be left on the element end.
          */
-        void                            loadProject( const QDomElement& project );
+        void                            loadProject( QXmlStreamReader& reader );
         /**
-         *  \brief          Save the project on a given node, for a given document.
+         *  \brief          Save the project timeline.
          *
-         *  \param  doc         A reference to the document.
-         *  \param  rootNode    A reference on the node that will contain the timeline.
+         *  \param  writer      The writer in which the timeline element will be written.
+         */
+        void                            saveProject( QXmlStreamWriter& writer );
+        /**
+         *  \brief  Load the timeline from a binary project cache.
+         */
+        void                            loadProject( const ProjectCache& cache );
+        /**
+         *  \brief  Add the timeline clips to a binary project cache.
          */
-        void                            saveProject( QDomDocument& doc, QDomElement& rootNode );
+        void                            saveProject( ProjectCacheWriter& writer );
         /**
          *  \brief      Clear the workflow.
          *
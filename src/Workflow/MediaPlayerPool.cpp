@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * MediaPlayerPool.cpp : Keeps a set of ready to use media players.
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "MediaPlayerPool.h"
+#include "VLCMediaPlayer.h"
+
+#include <QMutex>
+#include <QtDebug>
+
+#include <cstring>
+
+MediaPlayerPool::MediaPlayerPool() :
+        m_sessionPeak( 0 )
+{
+    m_mutex = new QMutex;
+    memset( &m_stats, 0, sizeof( m_stats ) );
+}
+
+MediaPlayerPool::~MediaPlayerPool()
+{
+    if ( m_stats.inUse != 0 )
+        qWarning() << m_stats.inUse << "media players are still in use while destroying the pool";
+    while ( m_idle.isEmpty() == false )
+        delete m_idle.takeLast().mediaPlayer;
+    delete m_mutex;
+}
+
+LibVLCpp::MediaPlayer*
+MediaPlayerPool::get()
+{
+    QMutexLocker            lock( m_mutex );
+    LibVLCpp::MediaPlayer*  mediaPlayer;
+
+    if ( m_idle.isEmpty() == true )
+    {
+        ++m_stats.misses;
+        mediaPlayer = new LibVLCpp::MediaPlayer;
+    }
+    else
+    {
+        ++m_stats.hits;
+        //Reuse the most recently released player, so that the oldest ones can be trimmed.
+        mediaPlayer = m_idle.takeLast().mediaPlayer;
+    }
+    ++m_stats.inUse;
+    if ( m_stats.inUse > m_stats.peakInUse )
+        m_stats.peakInUse = m_stats.inUse;
+    if ( m_stats.inUse > m_sessionPeak )
+        m_sessionPeak = m_stats.inUse;
+    return mediaPlayer;
+}
+
+void
+MediaPlayerPool::release( LibVLCpp::MediaPlayer* mediaPlayer )
+{
+    //The player will be given to another ClipWorkflow: forget about the previous one.
+    mediaPlayer->disconnect();
+
+    QMutexLocker    lock( m_mutex );
+    IdlePlayer      idle;
+
+    idle.mediaPlayer = mediaPlayer;
+    idle.releaseDate = mdate();
+    m_idle.append( idle );
+    --m_stats.inUse;
+    trimLocked();
+}
+
+void
+MediaPlayerPool::reserve( quint32 nbConcurrent )
+{
+    QMutexLocker    lock( m_mutex );
+
+    m_sessionPeak = qMax( nbConcurrent, m_stats.inUse );
+    while ( m_stats.inUse + m_idle.count() < nbConcurrent )
+    {
+        IdlePlayer      idle;
+
+        idle.mediaPlayer = new LibVLCpp::MediaPlayer;
+        idle.releaseDate = mdate();
+        //Fresh players go first, so that they're the last to be reused.
+        m_idle.prepend( idle );
+    }
+}
+
+void
+MediaPlayerPool::endSession()
+{
+    QMutexLocker    lock( m_mutex );
+    m_sessionPeak = m_stats.inUse;
+}
+
+void
+MediaPlayerPool::trim()
+{
+    QMutexLocker    lock( m_mutex );
+    trimLocked();
+}
+
+void
+MediaPlayerPool::trimLocked()
+{
+    mtime_t     now = mdate();
+
+    //Never release players that could be required by the current render session.
+    while ( (quint32)m_idle.count() > minIdlePlayers &&
+            (quint32)m_idle.count() > m_sessionPeak - m_stats.inUse &&
+            now - m_idle.first().releaseDate > maxIdleTime )
+    {
+        delete m_idle.takeFirst().mediaPlayer;
+        ++m_stats.trimmed;
+    }
+}
+
+MediaPlayerPool::Stats
+MediaPlayerPool::stats() const
+{
+    QMutexLocker    lock( m_mutex );
+    Stats           ret = m_stats;
+
+    ret.idle = m_idle.count();
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * MediaPlayerPool.h : Keeps a set of ready to use media players.
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MEDIAPLAYERPOOL_H
+#define MEDIAPLAYERPOOL_H
+
+#include "Singleton.hpp"
+#include "mdate.h"
+
+#include <QList>
+
+class   QMutex;
+
+namespace LibVLCpp
+{
+    class   MediaPlayer;
+}
+
+/**
+ *  \class  Holds fully constructed media players, so that activating a
+ *          ClipWorkflow doesn't have to create a new libvlc media player.
+ *
+ *  The pool grows when more players are required at the same time, and idle
+ *  players are released after a while, keeping at least minIdlePlayers warm.
+ */
+class   MediaPlayerPool : public Singleton<MediaPlayerPool>
+{
+    public:
+        struct  Stats
+        {
+            quint32     hits; ///< Number of get() served by a warm player
+            quint32     misses; ///< Number of get() that required a new player
+            quint32     trimmed; ///< Number of idle players released
+            quint32     inUse; ///< Number of players currently lent
+            quint32     peakInUse; ///< Maximum number of players lent at once
+            quint32     idle; ///< Number of warm players waiting in the pool
+        };
+
+        /**
+         *  \brief  Get a media player from the pool.
+         *
+         *  If no warm player is available, a new one is created.
+         *  \return A media player, that must be given back using release()
+         */
+        LibVLCpp::MediaPlayer*  get();
+        /**
+         *  \brief  Give a media player back to the pool.
+         *
+         *  The media player is expected to be stopped. Every connection from its
+         *  signals will be removed.
+         *  \param  mediaPlayer The media player to release.
+         */
+        void                    release( LibVLCpp::MediaPlayer* mediaPlayer );
+        /**
+         *  \brief  Ensure enough players are ready for a render session.
+         *
+         *  \param  nbConcurrent    The number of players that are expected to be
+         *                          used at the same time.
+         */
+        void                    reserve( quint32 nbConcurrent );
+        /**
+         *  \brief  Let the players reserved for the render session be trimmed.
+         */
+        void                    endSession();
+        /**
+         *  \brief  Release the players that have been idle for too long.
+         *
+         *  This is done each time a player is released, but has to be called
+         *  once the players stopped being used, for instance after a render.
+         */
+        void                    trim();
+        Stats                   stats() const;
+
+        /// The number of idle players that won't be trimmed.
+        static const quint32    minIdlePlayers = 2;
+        /// The time (in microseconds) after which an idle player can be released.
+        static const mtime_t    maxIdleTime = 10000000;
+
+    private:
+        MediaPlayerPool();
+        ~MediaPlayerPool();
+        /// Must be called with m_mutex locked.
+        void                    trimLocked();
+
+    private:
+        struct  IdlePlayer
+        {
+            LibVLCpp::MediaPlayer*  mediaPlayer;
+            mtime_t                 releaseDate;
+        };
+        /// The most recently released players are at the end of the list.
+        QList<IdlePlayer>       m_idle;
+        QMutex*                 m_mutex;
+        Stats                   m_stats;
+        /// The number of players expected to be used at once during this session.
+        quint32                 m_sessionPeak;
+
+        friend class    Singleton<MediaPlayerPool>;
+};
+
+#endif // MEDIAPLAYERPOOL_H
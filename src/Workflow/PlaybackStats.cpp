@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * PlaybackStats.cpp: Counters telling whether the playback keeps up
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "PlaybackStats.h"
+#include "mdate.h"
+
+PlaybackStats::PlaybackStats() :
+        m_deliveredFrames( 0 ),
+        m_lateFrames( 0 ),
+        m_audioUnderruns( 0 ),
+        m_pauses( 0 ),
+        m_unpauses( 0 ),
+        m_resyncRequired( 1 ),
+        m_dueOrigin( 0 ),
+        m_dueFrames( 0 ),
+        m_period( 0 ),
+        m_fps( 0.0 ),
+        m_playedTime( 0 ),
+        m_playOrigin( 0 ),
+        m_paused( true )
+{
+    for ( int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_bufferFill[i] = -1;
+}
+
+PlaybackStats::~PlaybackStats()
+{
+}
+
+void
+PlaybackStats::start( double fps )
+{
+    m_deliveredFrames = 0;
+    m_lateFrames = 0;
+    m_audioUnderruns = 0;
+    m_pauses = 0;
+    m_unpauses = 0;
+    for ( int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        m_bufferFill[i] = -1;
+    m_fps = fps;
+    m_period = fps > 0.0 ? qRound64( 1000000.0 / fps ) : 0;
+    m_playedTime = 0;
+    m_paused = true;
+    setPaused( false );
+}
+
+void
+PlaybackStats::setPaused( bool paused )
+{
+    if ( paused == m_paused )
+        return ;
+    m_paused = paused;
+    if ( paused == true )
+        m_playedTime += mdate() - m_playOrigin;
+    else
+    {
+        m_playOrigin = mdate();
+        //The time spent paused doesn't make the next frame late.
+        m_resyncRequired.fetchAndStoreOrdered( 1 );
+    }
+}
+
+PlaybackStats::Snapshot
+PlaybackStats::snapshot()
+{
+    Snapshot    ret;
+    qint64      playedTime = m_playedTime;
+
+    if ( m_paused == false )
+        playedTime += mdate() - m_playOrigin;
+    ret.deliveredFrames = m_deliveredFrames;
+    ret.expectedFrames = m_period > 0 ? playedTime / m_period : 0;
+    ret.lateFrames = m_lateFrames;
+    ret.audioUnderruns = m_audioUnderruns;
+    ret.pauses = m_pauses;
+    ret.unpauses = m_unpauses;
+    for ( int i = 0; i < MainWorkflow::NbTrackType; ++i )
+        ret.bufferFill[i] = m_bufferFill[i].fetchAndStoreOrdered( -1 );
+    return ret;
+}
+
+void
+PlaybackStats::frameDelivered()
+{
+    qint64      now = mdate();
+
+    m_deliveredFrames.ref();
+    //The first frame after a (re)start is due when it's delivered: the
+    //schedule doesn't count the time spent paused.
+    if ( m_resyncRequired.testAndSetOrdered( 1, 0 ) == true )
+    {
+        m_dueOrigin = now;
+        m_dueFrames = 0;
+    }
+    if ( now - ( m_dueOrigin + m_dueFrames * m_period ) > m_period / 2 )
+        m_lateFrames.ref();
+    ++m_dueFrames;
+}
+
+void
+PlaybackStats::audioUnderrun()
+{
+    m_audioUnderruns.ref();
+}
+
+void
+PlaybackStats::clipWorkflowPaused()
+{
+    m_pauses.ref();
+}
+
+void
+PlaybackStats::clipWorkflowUnpaused()
+{
+    m_unpauses.ref();
+}
+
+void
+PlaybackStats::bufferFill( MainWorkflow::TrackType trackType, quint32 nbBuffers,
+                           quint32 maxBuffers )
+{
+    int     fill = maxBuffers > 0 ? qMin( nbBuffers * 100 / maxBuffers, (quint32)100 ) : 0;
+    int     lowest;
+
+    //Only keep the lowest value, without locking.
+    do
+    {
+        lowest = m_bufferFill[trackType];
+        if ( lowest != -1 && lowest <= fill )
+            return ;
+    } while ( m_bufferFill[trackType].testAndSetOrdered( lowest, fill ) == false );
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * PlaybackStats.h: Counters telling whether the playback keeps up
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PLAYBACKSTATS_H
+#define PLAYBACKSTATS_H
+
+#include "MainWorkflow.h"
+#include "Singleton.hpp"
+
+#include <QAtomicInt>
+
+/**
+ *  \class  Counts what tells whether the playback keeps up with real time.
+ *
+ *  The counters are updated by the render and decoding threads, without
+ *  locking. The clock related methods (start(), setPaused() and
+ *  snapshot()) must be called from the same thread.
+ *  The instance is created by the MainWorkflow.
+ */
+class   PlaybackStats : public Singleton<PlaybackStats>
+{
+    public:
+        struct  Snapshot
+        {
+            int     deliveredFrames;
+            /// \brief  The number of frames that should have been delivered by now
+            int     expectedFrames;
+            /**
+             *  \brief  Frames delivered more than half a frame after they were
+             *          due. A frame is due one period after the previous one
+             *          was, starting when the playback is (re)started.
+             */
+            int     lateFrames;
+            /// \brief  Audio buffers replaced by silence, as no samples were ready
+            int     audioUnderruns;
+            /// \brief  Clip workflows paused because all their buffers were computed
+            int     pauses;
+            /// \brief  Clip workflows unpaused because they were running out of buffers
+            int     unpauses;
+            /**
+             *  \brief  The lowest fill level of the clip workflows' buffers since
+             *          the previous snapshot, in percent, or -1 if no buffer
+             *          was asked for.
+             */
+            int     bufferFill[MainWorkflow::NbTrackType];
+        };
+
+        /// \brief  Reset the counters and start the clock.
+        void        start( double fps );
+        void        setPaused( bool paused );
+        /// \brief  Get the counters, and start a new buffer fill window.
+        Snapshot    snapshot();
+
+        void        frameDelivered();
+        void        audioUnderrun();
+        void        clipWorkflowPaused();
+        void        clipWorkflowUnpaused();
+        /**
+         *  \brief  Report the number of computed buffers of a clip workflow, when
+         *          a buffer is asked.
+         */
+        void        bufferFill( MainWorkflow::TrackType trackType, quint32 nbBuffers,
+                                quint32 maxBuffers );
+
+    private:
+        PlaybackStats();
+        ~PlaybackStats();
+
+    private:
+        QAtomicInt  m_deliveredFrames;
+        QAtomicInt  m_lateFrames;
+        QAtomicInt  m_audioUnderruns;
+        QAtomicInt  m_pauses;
+        QAtomicInt  m_unpauses;
+        QAtomicInt  m_bufferFill[MainWorkflow::NbTrackType];
+        /// \brief  Asks the render thread to forget its last delivery time.
+        QAtomicInt  m_resyncRequired;
+        /// \brief  When the first frame since the last resync was due. Only
+        ///         used by the render thread, as m_dueFrames.
+        qint64      m_dueOrigin;
+        /// \brief  The frames delivered since the last resync.
+        qint64      m_dueFrames;
+        qint64      m_period;
+        double      m_fps;
+        qint64      m_playedTime;
+        qint64      m_playOrigin;
+        bool        m_paused;
+
+        friend class    Singleton<PlaybackStats>;
+};
+
+#endif // PLAYBACKSTATS_H
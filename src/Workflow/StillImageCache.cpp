@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * StillImageCache.cpp : Shares decoded still images between ImageClipWorkflows
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "StillImageCache.h"
+#include "LightVideoFrame.h"
+
+#include <QMutex>
+#include <QtDebug>
+
+uint
+qHash( const StillImageCache::Key& key )
+{
+    return qHash( key.uuid.toString() ) ^ ( key.width << 16 ) ^ key.height;
+}
+
+StillImageCache::StillImageCache()
+{
+    m_mutex = new QMutex;
+}
+
+StillImageCache::~StillImageCache()
+{
+    QHash<Key, Entry>::iterator     it = m_stills.begin();
+    QHash<Key, Entry>::iterator     end = m_stills.end();
+
+    for ( ; it != end; ++it )
+    {
+        qWarning() << "Still image" << it.key().uuid << "is still referenced"
+                << it.value().refCount << "times";
+        delete it.value().frame;
+    }
+    delete m_mutex;
+}
+
+LightVideoFrame*
+StillImageCache::acquire( const QUuid& mediaUuid, quint32 width, quint32 height )
+{
+    QMutexLocker                    lock( m_mutex );
+    QHash<Key, Entry>::iterator     it = m_stills.find( Key( mediaUuid, width, height ) );
+
+    if ( it == m_stills.end() )
+        return NULL;
+    ++it.value().refCount;
+    return it.value().frame;
+}
+
+bool
+StillImageCache::insert( const QUuid& mediaUuid, quint32 width, quint32 height,
+                         LightVideoFrame* frame )
+{
+    QMutexLocker    lock( m_mutex );
+    Key             key( mediaUuid, width, height );
+
+    if ( m_stills.contains( key ) == true )
+        return false;
+    Entry           entry;
+    entry.frame = frame;
+    entry.refCount = 1;
+    m_stills.insert( key, entry );
+    return true;
+}
+
+void
+StillImageCache::release( const QUuid& mediaUuid, quint32 width, quint32 height )
+{
+    QMutexLocker                    lock( m_mutex );
+    QHash<Key, Entry>::iterator     it = m_stills.find( Key( mediaUuid, width, height ) );
+
+    if ( it == m_stills.end() )
+    {
+        qWarning() << "Releasing an unknown still image:" << mediaUuid;
+        return ;
+    }
+    if ( --it.value().refCount == 0 )
+    {
+        delete it.value().frame;
+        m_stills.erase( it );
+    }
+}
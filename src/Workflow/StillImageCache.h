@@ -0,0 +1,103 @@
+/*****************************************************************************
+ * StillImageCache.h : Shares decoded still images between ImageClipWorkflows
+ *****************************************************************************
+ * Copyright (C) 2008-2010 VideoLAN
+ *
+ * Authors: Hugo Beauzee-Luyssen <hugo@vlmc.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef STILLIMAGECACHE_H
+#define STILLIMAGECACHE_H
+
+#include "Singleton.hpp"
+
+#include <QHash>
+#include <QUuid>
+
+class   QMutex;
+
+class   LightVideoFrame;
+
+/**
+ *  \class  Process wide cache of decoded still images.
+ *
+ *  Images are stored once decoded at a given resolution, and are shared
+ *  between every ImageClipWorkflow using the same media at this resolution.
+ *  Each entry is reference counted, and deleted when it's not used anymore.
+ */
+class   StillImageCache : public Singleton<StillImageCache>
+{
+    public:
+        /**
+         *  \brief  Get a reference on a decoded still.
+         *
+         *  \param  mediaUuid   The uuid of the image media.
+         *  \param  width       The width of the decoded image.
+         *  \param  height      The height of the decoded image.
+         *  \return The decoded image, or NULL if it hasn't been decoded yet.
+         *          A non NULL image must be released using release()
+         *  \warning    The returned frame must not be modified.
+         */
+        LightVideoFrame*        acquire( const QUuid& mediaUuid, quint32 width,
+                                         quint32 height );
+        /**
+         *  \brief  Insert a freshly decoded still in the cache.
+         *
+         *  On success, the cache takes ownership of the frame, and the caller holds
+         *  a reference on it, that must be released using release().
+         *  \return true if the frame was inserted. false if a still was already
+         *          cached for this media and resolution, in which case the caller
+         *          keeps the ownership of the frame.
+         */
+        bool                    insert( const QUuid& mediaUuid, quint32 width,
+                                        quint32 height, LightVideoFrame* frame );
+        /**
+         *  \brief  Release a reference obtained from acquire() or insert()
+         */
+        void                    release( const QUuid& mediaUuid, quint32 width,
+                                         quint32 height );
+
+    private:
+        StillImageCache();
+        ~StillImageCache();
+
+        struct  Key
+        {
+            Key( const QUuid& _uuid, quint32 _width, quint32 _height ) :
+                    uuid( _uuid ), width( _width ), height( _height ) {}
+            bool    operator==( const Key& key ) const
+            {
+                return uuid == key.uuid && width == key.width && height == key.height;
+            }
+            QUuid       uuid;
+            quint32     width;
+            quint32     height;
+        };
+        struct  Entry
+        {
+            LightVideoFrame*    frame;
+            quint32             refCount;
+        };
+        friend uint             qHash( const StillImageCache::Key& key );
+
+        QHash<Key, Entry>       m_stills;
+        QMutex*                 m_mutex;
+
+        friend class    Singleton<StillImageCache>;
+};
+
+#endif // STILLIMAGECACHE_H
@@ -25,8 +25,7 @@
 #include "TrackHandler.h"
 #include "TrackWorkflow.h"
 
-#include <QDomDocument>
-#include <QDomElement>
+#include <QXmlStreamWriter>
 
 LightVideoFrame* TrackHandler::nullOutput = NULL;
 
@@ -109,6 +108,36 @@ TrackHandler::getLength() const
     return m_length;
 }
 
+void
+TrackHandler::getCutPoints( QList<qint64>& cutPoints ) const
+{
+    for ( unsigned int i = 0; i < m_trackCount; ++i )
+        m_tracks[i]->getCutPoints( cutPoints );
+}
+
+bool
+TrackHandler::getSingleClip( qint64 begin, qint64 end, Clip*& clip, qint64& start ) const
+{
+    clip = NULL;
+    for ( unsigned int i = 0; i < m_trackCount; ++i )
+    {
+        Clip*       trackClip;
+        qint64      trackClipStart;
+
+        if ( m_tracks[i].hardDeactivated() == true )
+            continue ;
+        if ( m_tracks[i]->getSingleClip( begin, end, trackClip, trackClipStart ) == false )
+            return false;
+        if ( trackClip == NULL )
+            continue ;
+        if ( clip != NULL )
+            return false;
+        clip = trackClip;
+        start = trackClipStart;
+    }
+    return true;
+}
+
 void
 TrackHandler::getOutput( qint64 currentFrame, qint64 subFrame, bool paused )
 {
@@ -239,6 +268,14 @@ TrackHandler::getClip( const QUuid& uuid, unsigned int trackId )
     return m_tracks[trackId]->getClip( uuid );
 }
 
+Clip*
+TrackHandler::getClipAt( unsigned int trackId, qint64 start )
+{
+    Q_ASSERT( trackId < m_trackCount );
+
+    return m_tracks[trackId]->getClipAt( start );
+}
+
 void
 TrackHandler::clear()
 {
@@ -275,23 +312,44 @@ TrackHandler::getTrackCount() const
     return m_trackCount;
 }
 
+unsigned int
+TrackHandler::getActiveTrackCount() const
+{
+    unsigned int    count = 0;
+
+    for ( unsigned int i = 0; i < m_trackCount; ++i )
+    {
+        if ( m_tracks[i].activated() == true )
+            ++count;
+    }
+    return count;
+}
+
 void
-TrackHandler::save( QDomDocument& doc, QDomElement& timelineNode ) const
+TrackHandler::save( QXmlStreamWriter& writer ) const
 {
     for ( unsigned int i = 0; i < m_trackCount; ++i)
     {
         if ( m_tracks[i]->getLength() > 0 )
         {
-            QDomElement     trackNode = doc.createElement( "track" );
-
-            trackNode.setAttribute( "id", i );
-
-            m_tracks[i]->save( doc, trackNode );
-            timelineNode.appendChild( trackNode );
+            writer.writeStartElement( "track" );
+            writer.writeAttribute( "id", QString::number( i ) );
+            m_tracks[i]->save( writer );
+            writer.writeEndElement();
         }
     }
 }
 
+void
+TrackHandler::save( ProjectCacheWriter& writer ) const
+{
+    for ( unsigned int i = 0; i < m_trackCount; ++i)
+    {
+        if ( m_tracks[i]->getLength() > 0 )
+            m_tracks[i]->save( writer, i );
+    }
+}
+
 void
 TrackHandler::renderOneFrame()
 {
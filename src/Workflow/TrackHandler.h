@@ -45,7 +45,19 @@ class   TrackHandler : public QObject
          *  Returns the number of tracks in this handler
          */
         unsigned int            getTrackCount() const;
+        /**
+         *  Returns the number of tracks that are currently activated.
+         */
+        unsigned int            getActiveTrackCount() const;
         qint64                  getLength() const;
+        void                    getCutPoints( QList<qint64>& cutPoints ) const;
+        /**
+         *  \brief  Get the clip rendered in [begin;end[, if there's only one on
+         *          every unmuted track.
+         *  \sa     TrackWorkflow::getSingleClip()
+         */
+        bool                    getSingleClip( qint64 begin, qint64 end,
+                                               Clip*& clip, qint64& start ) const;
         void                    startRender();
         /**
          *  \param      currentFrame    The current rendering frame (ie the video frame, in all case)
@@ -67,6 +79,7 @@ class   TrackHandler : public QObject
         void                    muteTrack( unsigned int trackId );
         void                    unmuteTrack( unsigned int trackId );
         Clip*                   getClip( const QUuid& uuid, unsigned int trackId );
+        Clip*                   getClipAt( unsigned int trackId, qint64 start );
         void                    clear();
 
         //FIXME: remove this. This should go by the effect engine.
@@ -74,7 +87,8 @@ class   TrackHandler : public QObject
 
         bool                    endIsReached() const;
 
-        void                    save( QDomDocument& doc, QDomElement& timelineNode ) const;
+        void                    save( QXmlStreamWriter& writer ) const;
+        void                    save( ProjectCacheWriter& writer ) const;
 
         /**
          *  \brief      Will configure the track workflow so they render only one frame
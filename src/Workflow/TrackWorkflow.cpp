@@ -27,11 +27,13 @@
 #include "VideoClipWorkflow.h"
 #include "ImageClipWorkflow.h"
 #include "AudioClipWorkflow.h"
+#include "GeneratorClipWorkflow.h"
 #include "Clip.h"
 #include "Media.h"
+#include "ProjectCache.h"
+#include "Tracer.h"
 #include <QReadWriteLock>
-#include <QDomDocument>
-#include <QDomElement>
+#include <QXmlStreamWriter>
 
 TrackWorkflow::TrackWorkflow( unsigned int trackId, MainWorkflow::TrackType type  ) :
         m_trackId( trackId ),
@@ -63,7 +65,14 @@ TrackWorkflow::~TrackWorkflow()
 void    TrackWorkflow::addClip( Clip* clip, qint64 start )
 {
     ClipWorkflow* cw;
-    if ( m_trackType == MainWorkflow::VideoTrack )
+    if ( clip->getParent()->inputType() == Media::Generator )
+    {
+        if ( m_trackType == MainWorkflow::VideoTrack )
+            cw = new VideoGeneratorClipWorkflow( clip );
+        else
+            cw = new AudioGeneratorClipWorkflow( clip );
+    }
+    else if ( m_trackType == MainWorkflow::VideoTrack )
     {
         if ( clip->getParent()->fileType() == Media::Video )
             cw = new VideoClipWorkflow( clip );
@@ -99,6 +108,45 @@ qint64              TrackWorkflow::getLength() const
     return m_length;
 }
 
+void
+TrackWorkflow::getCutPoints( QList<qint64>& cutPoints ) const
+{
+    QReadLocker     lock( m_clipsLock );
+
+    QMap<qint64, ClipWorkflow*>::const_iterator     it = m_clips.begin();
+    QMap<qint64, ClipWorkflow*>::const_iterator     end = m_clips.end();
+
+    for ( ; it != end; ++it )
+    {
+        cutPoints.append( it.key() );
+        cutPoints.append( it.key() + it.value()->getClip()->length() );
+    }
+}
+
+bool
+TrackWorkflow::getSingleClip( qint64 begin, qint64 end, Clip*& clip, qint64& start ) const
+{
+    QReadLocker     lock( m_clipsLock );
+
+    QMap<qint64, ClipWorkflow*>::const_iterator     it = m_clips.begin();
+    QMap<qint64, ClipWorkflow*>::const_iterator     ite = m_clips.end();
+
+    clip = NULL;
+    for ( ; it != ite && it.key() < end; ++it )
+    {
+        ClipWorkflow*   cw = it.value();
+        if ( it.key() + cw->getClip()->length() <= begin )
+            continue ;
+        if ( cw->getState() == ClipWorkflow::Muted )
+            continue ;
+        if ( clip != NULL )
+            return false;
+        clip = cw->getClip();
+        start = it.key();
+    }
+    return true;
+}
+
 qint64              TrackWorkflow::getClipPosition( const QUuid& uuid ) const
 {
     QMap<qint64, ClipWorkflow*>::const_iterator     it = m_clips.begin();
@@ -127,30 +175,35 @@ Clip*               TrackWorkflow::getClip( const QUuid& uuid )
     return NULL;
 }
 
+Clip*               TrackWorkflow::getClipAt( qint64 start )
+{
+    QReadLocker     lock( m_clipsLock );
+    QMap<qint64, ClipWorkflow*>::const_iterator     it = m_clips.constFind( start );
+
+    if ( it == m_clips.constEnd() )
+        return NULL;
+    return it.value()->getClip();
+}
+
 void*
 TrackWorkflow::renderClip( ClipWorkflow* cw, qint64 currentFrame,
                                         qint64 start , bool needRepositioning,
                                         bool renderOneFrame, bool paused )
 {
+    VLMC_TRACE_SCOPE_ARG( "TrackWorkflow::renderClip", currentFrame );
     ClipWorkflow::GetMode       mode = ( paused == false || renderOneFrame == true ?
                                          ClipWorkflow::Pop : ClipWorkflow::Get );
 
-    cw->getStateLock()->lockForRead();
+    ClipWorkflow::State         state = cw->getState();
 //    qDebug() << "TrackWorkflow::renderClip. currentFrame:" << currentFrame << "trackType:" << m_trackType;
-    if ( cw->getState() == ClipWorkflow::Rendering ||
-         cw->getState() == ClipWorkflow::Paused ||
-         cw->getState() == ClipWorkflow::PauseRequired ||
-         cw->getState() == ClipWorkflow::UnpauseRequired )
+    if ( ClipWorkflow::isRunning( state ) == true )
     {
-        cw->getStateLock()->unlock();
-
         if ( cw->isResyncRequired() == true || needRepositioning == true )
             adjustClipTime( currentFrame, start, cw );
         return cw->getOutput( mode );
     }
-    else if ( cw->getState() == ClipWorkflow::Stopped )
+    else if ( state == ClipWorkflow::Stopped )
     {
-        cw->getStateLock()->unlock();
         cw->initialize();
         cw->waitForCompleteInit();
         if ( start != currentFrame || cw->getClip()->begin() != 0 ) //Clip was not started as its real begining
@@ -159,48 +212,81 @@ TrackWorkflow::renderClip( ClipWorkflow* cw, qint64 currentFrame,
         }
         return cw->getOutput( mode );
     }
-    else if ( cw->getState() == ClipWorkflow::EndReached ||
-              cw->getState() == ClipWorkflow::Muted )
+    else if ( state == ClipWorkflow::EndReached ||
+              state == ClipWorkflow::Muted )
     {
-        cw->getStateLock()->unlock();
         //The stopClipWorkflow() method will take care of that.
     }
     else
     {
-        qCritical() << "Unexpected state:" << cw->getState();
-        cw->getStateLock()->unlock();
+        qCritical() << "Unexpected state:" << state;
     }
     return NULL;
 }
 
 void                TrackWorkflow::preloadClip( ClipWorkflow* cw )
 {
-    cw->getStateLock()->lockForRead();
-
     if ( cw->getState() == ClipWorkflow::Stopped )
-    {
-        cw->getStateLock()->unlock();
         cw->initialize();
-        return ;
-    }
-    cw->getStateLock()->unlock();
 }
 
 void                TrackWorkflow::stopClipWorkflow( ClipWorkflow* cw )
 {
 //    qDebug() << "Stopping clip workflow";
-    cw->getStateLock()->lockForRead();
+    ClipWorkflow::State     state = cw->getState();
 
-    if ( cw->getState() == ClipWorkflow::Stopped ||
-         cw->getState() == ClipWorkflow::Muted )
-    {
-        cw->getStateLock()->unlock();
+    if ( state == ClipWorkflow::Stopped || state == ClipWorkflow::Muted )
         return ;
-    }
-    cw->getStateLock()->unlock();
     cw->stop();
 }
 
+bool
+TrackWorkflow::areContiguous( qint64 prevStart, ClipWorkflow* prev,
+                              qint64 start, ClipWorkflow* cw ) const
+{
+    Clip*   prevClip = prev->getClip();
+    Clip*   clip = cw->getClip();
+
+    if ( prevClip->getParent() != clip->getParent() )
+        return false;
+    //Images don't need any decoder continuity.
+    if ( clip->getParent()->fileType() == Media::Image )
+        return false;
+    if ( prevStart + prevClip->length() != start || prevClip->end() != clip->begin() )
+        return false;
+    return ( prev->getState() != ClipWorkflow::Muted &&
+             cw->getState() != ClipWorkflow::Muted );
+}
+
+//Must be called from a thread safe method (m_clipsLock locked)
+ClipWorkflow*
+TrackWorkflow::getContinuousFeeder( QMap<qint64, ClipWorkflow*>::const_iterator it,
+                                    qint64& feederStart ) const
+{
+    ClipWorkflow*   cw = it.value();
+    qint64          start = it.key();
+
+    //This clip already has its own decoder.
+    if ( cw->getState() != ClipWorkflow::Stopped )
+        return NULL;
+    while ( it != m_clips.begin() )
+    {
+        --it;
+        if ( areContiguous( it.key(), it.value(), start, cw ) == false )
+            return NULL;
+        ClipWorkflow*   prev = it.value();
+        if ( ClipWorkflow::isRunning( prev->getState() ) == true )
+        {
+            feederStart = it.key();
+            return prev;
+        }
+        //The previous clip may have been fed by one of its own predecessors.
+        cw = prev;
+        start = it.key();
+    }
+    return NULL;
+}
+
 bool                TrackWorkflow::checkEnd( qint64 currentFrame ) const
 {
     if ( m_clips.size() == 0 )
@@ -280,6 +366,23 @@ TrackWorkflow::getOutput( qint64 currentFrame, qint64 subFrame, bool paused )
         else
             needRepositioning = ( abs( subFrame - m_lastFrame ) > 1 ) ? true : false;
     }
+    //Find out if the clip to render can be fed by an already running decoder
+    //before deciding which ClipWorkflow should be stopped.
+    //On a cut, the current frame is contained by both clips: the last one is
+    //the one to render.
+    QMap<qint64, ClipWorkflow*>::const_iterator active = m_clips.constEnd();
+    for ( QMap<qint64, ClipWorkflow*>::const_iterator cit = m_clips.constBegin();
+          cit != m_clips.constEnd() && cit.key() <= currentFrame; ++cit )
+    {
+        if ( currentFrame <= cit.key() + cit.value()->getClip()->length() )
+            active = cit;
+    }
+    ClipWorkflow*                               feeder = NULL;
+    qint64                                      feederStart = 0;
+    if ( active != m_clips.constEnd() )
+        feeder = getContinuousFeeder( active, feederStart );
+
+    ClipWorkflow*                               rendered = NULL;
     while ( it != end )
     {
         qint64          start = it.key();
@@ -288,21 +391,39 @@ TrackWorkflow::getOutput( qint64 currentFrame, qint64 subFrame, bool paused )
 //        qDebug() << "Start:" << start << "Current Frame:" << currentFrame;
         if ( start <= currentFrame && currentFrame <= start + cw->getClip()->length() )
         {
-            if ( ret != NULL )
-                qCritical() << "There's more than one clip to render here. Undefined behaviour !";
-            ret = renderClip( cw, currentFrame, start, needRepositioning,
-                              renderOneFrame, paused );
-            if ( m_trackType == MainWorkflow::VideoTrack )
-                m_videoStackedBuffer = reinterpret_cast<StackedBuffer<LightVideoFrame*>*>( ret );
-            else
-                m_audioStackedBuffer = reinterpret_cast<StackedBuffer<AudioClipWorkflow::AudioSample*>*>( ret );
+            ClipWorkflow*   toRender = cw;
+            qint64          toRenderStart = start;
+            if ( feeder != NULL && cw != feeder )
+            {
+                toRender = feeder;
+                toRenderStart = feederStart;
+            }
+            //On a cut between two chained clips, don't pop the same decoder twice.
+            if ( toRender != rendered )
+            {
+                if ( ret != NULL )
+                    qCritical() << "There's more than one clip to render here. Undefined behaviour !";
+                ret = renderClip( toRender, currentFrame, toRenderStart, needRepositioning,
+                                  renderOneFrame, paused );
+                rendered = toRender;
+                if ( m_trackType == MainWorkflow::VideoTrack )
+                    m_videoStackedBuffer = reinterpret_cast<StackedBuffer<LightVideoFrame*>*>( ret );
+                else
+                    m_audioStackedBuffer = reinterpret_cast<StackedBuffer<AudioClipWorkflow::AudioSample*>*>( ret );
+            }
         }
         //Is it about to be rendered ?
         else if ( start > currentFrame &&
                 start - currentFrame < TrackWorkflow::nbFrameBeforePreload )
-            preloadClip( cw );
+        {
+            //No need to preload a clip that will be fed by its predecessor's
+            //decoder, as long as that decoder is running to hand it over.
+            qint64      handOverStart;
+            if ( getContinuousFeeder( it, handOverStart ) == NULL )
+                preloadClip( cw );
+        }
         //Is it supposed to be stopped ?
-        else
+        else if ( cw != feeder )
             stopClipWorkflow( cw );
         ++it;
     }
@@ -385,7 +506,7 @@ ClipWorkflow*       TrackWorkflow::removeClipWorkflow( const QUuid& id )
     return NULL;
 }
 
-void    TrackWorkflow::save( QDomDocument& doc, QDomElement& trackNode ) const
+void    TrackWorkflow::save( QXmlStreamWriter& writer ) const
 {
     QReadLocker     lock( m_clipsLock );
 
@@ -394,45 +515,27 @@ void    TrackWorkflow::save( QDomDocument& doc, QDomElement& trackNode ) const
 
     for ( ; it != end ; ++it )
     {
-        QDomElement     clipNode = doc.createElement( "clip" );
-
-        {
-            QDomElement     parent = doc.createElement( "parent" );
-
-            QDomCharacterData   text = doc.createTextNode( it.value()->getClip()->getParent()->uuid().toString() );
-            parent.appendChild( text );
-            clipNode.appendChild( parent );
-        }
-        {
-            QDomElement     startFrame = doc.createElement( "startFrame" );
-
-            QDomCharacterData   text = doc.createTextNode( QString::number( it.key() ) );
-            startFrame.appendChild( text );
-            clipNode.appendChild( startFrame );
-        }
-        {
-            QDomElement     begin = doc.createElement( "begin" );
+        Clip*   clip = it.value()->getClip();
+
+        writer.writeStartElement( "clip" );
+        writer.writeTextElement( "parent", clip->getParent()->uuid().toString() );
+        writer.writeTextElement( "startFrame", QString::number( it.key() ) );
+        writer.writeTextElement( "begin", QString::number( clip->begin() ) );
+        writer.writeTextElement( "end", QString::number( clip->end() ) );
+        writer.writeTextElement( "trackType", QString::number( m_trackType ) );
+        writer.writeEndElement();
+    }
+}
 
-            QDomCharacterData   text = doc.createTextNode( QString::number( it.value()->getClip()->begin() ) );
-            begin.appendChild( text );
-            clipNode.appendChild( begin );
-        }
-        {
-            QDomElement     end = doc.createElement( "end" );
+void    TrackWorkflow::save( ProjectCacheWriter& writer, unsigned int trackId ) const
+{
+    QReadLocker     lock( m_clipsLock );
 
-            QDomCharacterData   text = doc.createTextNode( QString::number( it.value()->getClip()->end() ) );
-            end.appendChild( text );
-            clipNode.appendChild( end );
-        }
-        {
-            QDomElement     trackType = doc.createElement( "trackType" );
+    QMap<qint64, ClipWorkflow*>::const_iterator     it = m_clips.begin();
+    QMap<qint64, ClipWorkflow*>::const_iterator     end = m_clips.end();
 
-            QDomCharacterData   text = doc.createTextNode( QString::number( m_trackType ) );
-            trackType.appendChild( text );
-            clipNode.appendChild( trackType );
-        }
-        trackNode.appendChild( clipNode );
-    }
+    for ( ; it != end ; ++it )
+        writer.addTimelineClip( trackId, m_trackType, it.key(), it.value()->getClip() );
 }
 
 void    TrackWorkflow::clear()
@@ -31,8 +31,6 @@
 class   ClipWorkflow;
 class   LightVideoFrame;
 
-class   QDomElement;
-class   QDomElement;
 template <typename T>
 class   QList;
 template <typename T, typename U>
@@ -40,6 +38,9 @@ class   QMap;
 class   QMutex;
 class   QReadWriteLock;
 class   QWaitCondition;
+class   QXmlStreamWriter;
+
+class   ProjectCacheWriter;
 
 //TODO: REMOVE THIS
 #ifndef FPS
@@ -69,11 +70,28 @@ class   TrackWorkflow : public QObject
         void                                    addClip( ClipWorkflow*, qint64 start );
         qint64                                  getClipPosition( const QUuid& uuid ) const;
         Clip*                                   getClip( const QUuid& uuid );
+        Clip*                                   getClipAt( qint64 start );
+        /**
+         *  \brief  Append the first and last frame of every clip to cutPoints.
+         */
+        void                                    getCutPoints( QList<qint64>& cutPoints ) const;
+        /**
+         *  \brief  Get the clip rendered in [begin;end[, if there's only one.
+         *
+         *  Muted clips are ignored.
+         *  \param  clip    Will be set to the only clip, or NULL if there's none.
+         *  \param  start   Will be set to the position of this clip.
+         *  \return false if more than one clip is rendered in this range.
+         */
+        bool                                    getSingleClip( qint64 begin, qint64 end,
+                                                               Clip*& clip, qint64& start ) const;
 
         //FIXME: this won't be reliable as soon as we change the fps from the configuration
         static const unsigned int               nbFrameBeforePreload = 60;
 
-        void                                    save( QDomDocument& doc, QDomElement& trackNode ) const;
+        void                                    save( QXmlStreamWriter& writer ) const;
+        void                                    save( ProjectCacheWriter& writer,
+                                                      unsigned int trackId ) const;
         void                                    clear();
 
         void                                    renderOneFrame();
@@ -102,6 +120,32 @@ class   TrackWorkflow : public QObject
         bool                                    checkEnd( qint64 currentFrame ) const;
         void                                    adjustClipTime( qint64 currentFrame, qint64 start, ClipWorkflow* cw );
         void                                    releasePreviousRender();
+        /**
+         *  \brief     Check if two clips are contiguous, both on the timeline and
+         *              in their parent media.
+         *
+         *  This is typically the case for the two halves of a splitted clip.
+         *  \param  prevStart   The starting frame of the first clip.
+         *  \param  prev        The first clip workflow.
+         *  \param  start       The starting frame of the second clip.
+         *  \param  cw          The second clip workflow.
+         */
+        bool                                    areContiguous( qint64 prevStart, ClipWorkflow* prev,
+                                                               qint64 start, ClipWorkflow* cw ) const;
+        /**
+         *  \brief     Look for a running ClipWorkflow that can keep feeding cw.
+         *
+         *  When a chain of contiguous clips from the same media is being rendered,
+         *  the first ClipWorkflow's decoder is kept running across the cuts, instead
+         *  of stopping it and restarting a new one at the exact same position.
+         *  \param  it          An iterator to the clip that's about to be rendered.
+         *  \param  feederStart Will be set to the starting frame of the returned
+         *                      ClipWorkflow.
+         *  \return The ClipWorkflow to render from, or NULL if cw has to use its own.
+         */
+        ClipWorkflow*                           getContinuousFeeder(
+                                                    QMap<qint64, ClipWorkflow*>::const_iterator it,
+                                                    qint64& feederStart ) const;
 
 
     private:
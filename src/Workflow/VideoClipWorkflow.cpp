@@ -22,12 +22,14 @@
 
 #include "VideoClipWorkflow.h"
 #include "MainWorkflow.h"
+#include "PlaybackStats.h"
 #include "StackedBuffer.hpp"
 #include "LightVideoFrame.h"
 #include "Clip.h"
+#include "Tracer.h"
 #include "VLCMedia.h"
 
-#include <QReadWriteLock>
+#include <QMutex>
 
 VideoClipWorkflow::VideoClipWorkflow( Clip *clip ) :
         ClipWorkflow( clip ),
@@ -108,6 +110,9 @@ VideoClipWorkflow::getOutput( ClipWorkflow::GetMode mode )
     QMutexLocker    lock( m_renderLock );
     QMutexLocker    lock2( m_computedBuffersMutex );
 
+    PlaybackStats::getInstance()->bufferFill( MainWorkflow::VideoTrack,
+                                              getNbComputedBuffers(),
+                                              getMaxComputedBuffers() );
     if ( preGetOutput() == false )
     {
         if ( m_lastRenderedFrame != NULL )
@@ -130,6 +135,7 @@ void
 VideoClipWorkflow::lock( VideoClipWorkflow *cw, void **pp_ret, int size )
 {
     Q_UNUSED( size );
+    VLMC_TRACE_SCOPE( "VideoClipWorkflow::lock" );
     QMutexLocker        lock( cw->m_availableBuffersMutex );
     LightVideoFrame*    lvf = NULL;
 
@@ -154,6 +160,7 @@ VideoClipWorkflow::unlock( VideoClipWorkflow *cw, void *buffer, int width,
     Q_UNUSED( height );
     Q_UNUSED( bpp );
     Q_UNUSED( size );
+    VLMC_TRACE_SCOPE( "VideoClipWorkflow::unlock" );
 
     cw->computePtsDiff( pts );
     LightVideoFrame     *lvf = cw->m_computedBuffers.last();
@@ -1,15 +1,23 @@
 HEADERS += AudioClipWorkflow.h \
     ClipWorkflow.h \
+    GeneratorClipWorkflow.h \
     MainWorkflow.h \
+    MediaPlayerPool.h \
+    PlaybackStats.h \
     TrackHandler.h \
     TrackWorkflow.h \
     VideoClipWorkflow.h \
     ImageClipWorkflow.h \
-    StackedBuffer.hpp
+    StackedBuffer.hpp \
+    StillImageCache.h
 SOURCES += AudioClipWorkflow.cpp \
     ClipWorkflow.cpp \
+    GeneratorClipWorkflow.cpp \
     MainWorkflow.cpp \
+    MediaPlayerPool.cpp \
+    PlaybackStats.cpp \
     TrackHandler.cpp \
     TrackWorkflow.cpp \
     VideoClipWorkflow.cpp \
-    ImageClipWorkflow.cpp
+    ImageClipWorkflow.cpp \
+    StillImageCache.cpp
@@ -27,8 +27,10 @@
  */
 
 #include "config.h"
+#include "BatchRenderer.h"
 #include "MainWindow.h"
 #include "SettingsManager.h"
+#include "Tracer.h"
 
 #include <QFile>
 
@@ -41,6 +43,34 @@
 #define EXPAND( x ) #x
 #define STRINGIFY( x ) EXPAND( x )
 
+static void
+setupApplication( QApplication& app )
+{
+    app.setApplicationName( "vlmc" );
+    app.setOrganizationName( "vlmc" );
+    app.setOrganizationDomain( "vlmc.org" );
+    app.setApplicationVersion( PROJECT_VERSION );
+    Tracer::getInstance()->setup( app.arguments() );
+}
+
+/**
+ *  \brief Render a project without launching the GUI.
+ *  \sa    BatchRenderer
+ */
+static int
+VLMCrender( int argc, char **argv )
+{
+    //No GUI, so that no display is required.
+    QApplication    app( argc, argv, false );
+    setupApplication( app );
+
+    BatchRenderer   renderer;
+    if ( renderer.parseArguments( app.arguments() ) == false )
+        return 1;
+    renderer.start();
+    return app.exec();
+}
+
 /**
  *  VLMC Entry point
  *  \brief this is the VLMC entry point
@@ -51,11 +81,14 @@
 int
 VLMCmain( int argc, char **argv )
 {
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( qstrcmp( argv[i], "--render" ) == 0 )
+            return VLMCrender( argc, argv );
+    }
+
     QApplication app( argc, argv );
-    app.setApplicationName( "vlmc" );
-    app.setOrganizationName( "vlmc" );
-    app.setOrganizationDomain( "vlmc.org" );
-    app.setApplicationVersion( PROJECT_VERSION );
+    setupApplication( app );
     //QSettings::setDefaultFormat( QSettings::IniFormat );
     //Preferences::changeLang( QSettings().value( "Lang" ).toString() );
 